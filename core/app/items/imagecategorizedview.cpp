@@ -24,9 +24,15 @@
 
 #include "imagecategorizedview.h"
 
+// C++ includes
+
+#include <algorithm>
+
 // Qt includes
 
 #include <QApplication>
+#include <QElapsedTimer>
+#include <QScrollBar>
 #include <QTimer>
 
 // Local includes
@@ -88,10 +94,20 @@ public:
         showToolTip(false),
         scrollToItemId(0),
         delayedEnterTimer(0),
-        currentMouseEvent(0)
+        currentMouseEvent(0),
+        lastScrollValue(0),
+        scrollVelocity(0.0),
+        lastPrefetchSize(0)
     {
     }
 
+    /// Time to load thumbnails in advance, in milliseconds of scrolling at current velocity
+    static const int PrefetchTime      = 500;
+    /// Scrolling is considered stopped after this delay, in milliseconds
+    static const int ScrollStopDelay   = 300;
+    /// Maximum distance to load thumbnails in advance, in viewport heights
+    static const int MaxPrefetchPages  = 4;
+
     ImageModel*           model;
     ImageSortFilterModel* filterModel;
 
@@ -105,6 +121,13 @@ public:
     QTimer*               delayedEnterTimer;
 
     QMouseEvent*          currentMouseEvent;
+
+    int                   lastScrollValue;
+    /// Pixels per millisecond, negative when scrolling up
+    double                scrollVelocity;
+    QElapsedTimer         scrollTimer;
+    QList<qlonglong>      lastPrefetchIds;
+    int                   lastPrefetchSize;
 };
 
 // -------------------------------------------------------------------------------
@@ -127,6 +150,9 @@ ImageCategorizedView::ImageCategorizedView(QWidget* const parent)
 
     connect(d->delayedEnterTimer, SIGNAL(timeout()),
             this, SLOT(slotDelayedEnter()));
+
+    connect(verticalScrollBar(), SIGNAL(valueChanged(int)),
+            this, SLOT(slotScrolled(int)));
 }
 
 ImageCategorizedView::~ImageCategorizedView()
@@ -717,11 +743,106 @@ void ImageCategorizedView::paintEvent(QPaintEvent* e)
     {
         QModelIndexList indexesToThumbnail = imageFilterModel()->mapListToSource(categorizedIndexesIn(viewport()->rect()));
         d->delegate->prepareThumbnails(thumbModel, indexesToThumbnail);
+        prefetchThumbnails(thumbModel);
     }
 
     ItemViewCategorized::paintEvent(e);
 }
 
+void ImageCategorizedView::slotScrolled(int value)
+{
+    const int delta    = value - d->lastScrollValue;
+    d->lastScrollValue = value;
+
+    if (!d->scrollTimer.isValid())
+    {
+        d->scrollTimer.start();
+        return;
+    }
+
+    const qint64 elapsed = d->scrollTimer.restart();
+
+    if (elapsed > Private::ScrollStopDelay)
+    {
+        // scrolling starts again, the velocity is unknown yet, only the direction
+        d->scrollVelocity = (delta < 0) ? -0.0001 : 0.0001;
+        return;
+    }
+
+    // smooth the velocity over the last scroll steps
+    const double velocity = (double)delta / qMax(elapsed, (qint64)1);
+    d->scrollVelocity     = 0.5 * d->scrollVelocity + 0.5 * velocity;
+}
+
+void ImageCategorizedView::prefetchThumbnails(ImageThumbnailModel* const thumbModel)
+{
+    // The visible rows are loaded first, then the rows ahead in the scroll direction,
+    // farther when scrolling fast. Everything is spread over several loading threads,
+    // the view thread finds the thumbnails in the cache or waits for the thread loading them.
+
+    const QRect viewRect = viewport()->rect();
+    double velocity      = d->scrollVelocity;
+
+    if (!d->scrollTimer.isValid() || d->scrollTimer.elapsed() > Private::ScrollStopDelay)
+    {
+        velocity = 0.0;
+    }
+
+    const bool scrollingUp = (velocity < 0.0) || ((velocity == 0.0) && (d->scrollVelocity < 0.0));
+    const int  distance    = qBound(viewRect.height(),
+                                    (int)(qAbs(velocity) * Private::PrefetchTime),
+                                    viewRect.height() * Private::MaxPrefetchPages);
+
+    QRect aheadRect(viewRect);
+
+    if (scrollingUp)
+    {
+        aheadRect.setBottom(viewRect.top() - 1);
+        aheadRect.setTop(viewRect.top() - distance);
+    }
+    else
+    {
+        aheadRect.setTop(viewRect.bottom() + 1);
+        aheadRect.setBottom(viewRect.bottom() + distance);
+    }
+
+    QModelIndexList indexes      = categorizedIndexesIn(viewRect);
+    QModelIndexList aheadIndexes = categorizedIndexesIn(aheadRect);
+
+    if (scrollingUp)
+    {
+        // nearest rows first
+        std::reverse(aheadIndexes.begin(), aheadIndexes.end());
+    }
+
+    foreach(const QModelIndex& index, aheadIndexes)
+    {
+        if (!indexes.contains(index))
+        {
+            indexes << index;
+        }
+    }
+
+    // do not restart the same request at each paint event
+
+    QModelIndexList  sourceIndexes = imageFilterModel()->mapListToSource(indexes);
+    QList<qlonglong> ids;
+
+    foreach(const QModelIndex& index, sourceIndexes)
+    {
+        ids << ImageModel::retrieveImageId(index);
+    }
+
+    if (ids == d->lastPrefetchIds && d->delegate->thumbnailSize().size() == d->lastPrefetchSize)
+    {
+        return;
+    }
+
+    d->lastPrefetchIds  = ids;
+    d->lastPrefetchSize = d->delegate->thumbnailSize().size();
+    d->delegate->prefetchThumbnails(thumbModel, sourceIndexes);
+}
+
 QItemSelectionModel* ImageCategorizedView::getSelectionModel() const
 {
     return selectionModel();
@@ -212,10 +212,12 @@ private Q_SLOTS:
     void slotIccSettingsChanged(const ICCSettingsContainer&, const ICCSettingsContainer&);
     void slotFileChanged(const QString& filePath);
     void slotDelayedEnter();
+    void slotScrolled(int value);
 
 private:
 
     void scrollToStoredItem();
+    void prefetchThumbnails(ImageThumbnailModel* const thumbModel);
 
 private:
 
@@ -79,6 +79,11 @@ public:
      */
     virtual void prepareThumbnails(ImageThumbnailModel* thumbModel, const QList<QModelIndex>& indexes);
 
+    /** Call this from a paint event, with the indexes expected to be painted soon,
+     *  in order of priority, so that thumbnails are loaded in advance.
+     */
+    virtual void prefetchThumbnails(ImageThumbnailModel* thumbModel, const QList<QModelIndex>& indexes);
+
     /**
      * Retrieve the thumbnail pixmap in given size for the ImageModel::ThumbnailRole for
      * the given index from the given index, which must adhere to ImageThumbnailModel semantics.
@@ -48,6 +48,7 @@ extern "C"
 #include <QByteArray>
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QGroupBox>
 #include <QHash>
 #include <QLabel>
@@ -64,6 +65,7 @@ extern "C"
 #include <QVBoxLayout>
 #include <QMessageBox>
 #include <QSet>
+#include <QStandardPaths>
 
 // KDE includes
 
@@ -101,6 +103,7 @@ extern "C"
 #include "tagscache.h"
 #include "thumbsdbaccess.h"
 #include "thumbnailloadthread.h"
+#include "thumbnailpackmigrator.h"
 #include "dnotificationwrapper.h"
 #include "dbjobinfo.h"
 #include "dbjobsmanager.h"
@@ -186,7 +189,11 @@ public:
         scanDAlbumsTimer(0),
         updatePAlbumsTimer(0),
         albumItemCountTimer(0),
-        tagItemCountTimer(0)
+        tagItemCountTimer(0),
+        dateItemCountTimer(0),
+        recountPAlbums(false),
+        recountTAlbums(false),
+        recountFaces(false)
     {
     }
 
@@ -228,12 +235,24 @@ public:
     QTimer*                     updatePAlbumsTimer;
     QTimer*                     albumItemCountTimer;
     QTimer*                     tagItemCountTimer;
+    QTimer*                     dateItemCountTimer;
     QSet<int>                   changedPAlbums;
 
     QMap<int, int>              pAlbumsCount;
     QMap<int, int>              tAlbumsCount;
     QMap<YearMonth, int>        dAlbumsCount;
     QMap<int, int>              fAlbumsCount;
+    QMap<QDateTime, int>        datesStatMap;
+
+    /** Albums, tags and items changed since the last count, to recount only these **/
+    QSet<int>                   dirtyPAlbumsCount;
+    QSet<int>                   dirtyTAlbumsCount;
+    QSet<qlonglong>             dirtyDAlbumsItems;
+    /** Added items, until the changeset of their creation date is received **/
+    QSet<qlonglong>             newDAlbumsItems;
+    bool                        recountPAlbums;
+    bool                        recountTAlbums;
+    bool                        recountFaces;
 
 public:
 
@@ -344,7 +363,7 @@ AlbumManager::AlbumManager()
     d->albumItemCountTimer->setSingleShot(true);
 
     connect(d->albumItemCountTimer, SIGNAL(timeout()),
-            this, SLOT(getAlbumItemsCount()));
+            this, SLOT(updateAlbumItemsCount()));
 
     // more expensive
     d->tagItemCountTimer = new QTimer(this);
@@ -352,7 +371,15 @@ AlbumManager::AlbumManager()
     d->tagItemCountTimer->setSingleShot(true);
 
     connect(d->tagItemCountTimer, SIGNAL(timeout()),
-            this, SLOT(getTagItemsCount()));
+            this, SLOT(updateTagItemsCount()));
+
+    // date count timer
+    d->dateItemCountTimer = new QTimer(this);
+    d->dateItemCountTimer->setInterval(1000);
+    d->dateItemCountTimer->setSingleShot(true);
+
+    connect(d->dateItemCountTimer, SIGNAL(timeout()),
+            this, SLOT(updateDateItemsCount()));
 }
 
 AlbumManager::~AlbumManager()
@@ -1034,6 +1061,41 @@ bool AlbumManager::setDatabase(const DbEngineParameters& params, bool priority,
     DbEngineGuiErrorHandler* const thumbnailsDBHandler = new DbEngineGuiErrorHandler(ThumbsDbAccess::parameters());
     ThumbsDbAccess::initDbEngineErrorHandler(thumbnailsDBHandler);
 
+    // Optionally switch thumbnails to the memory-mapped pack storage.
+    // The existing thumbnails database is migrated in background the first time.
+
+    {
+        KSharedConfigPtr config = KSharedConfig::openConfig();
+        KConfigGroup group      = config->group(QLatin1String("Album Settings"));
+
+        if (group.readEntry(QLatin1String("Thumbnail Pack Storage"), false))
+        {
+            DbEngineParameters thumbParams = CoreDbAccess::parameters().thumbnailParameters();
+            QString packDir;
+
+            if (thumbParams.isSQLite())
+            {
+                packDir = QFileInfo(DbEngineParameters::thumbnailDatabaseFileSQLite(thumbParams.databaseNameThumbnails)).absolutePath();
+            }
+            else
+            {
+                packDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1String("/thumbnails");
+            }
+
+            ThumbnailLoadThread::initializeThumbnailPack(packDir);
+
+            if (!group.readEntry(QLatin1String("Thumbnail Pack Migrated"), false))
+            {
+                ThumbnailPackMigrator* const migrator = new ThumbnailPackMigrator();
+
+                connect(migrator, SIGNAL(signalMigrated()),
+                        this, SLOT(slotThumbnailPackMigrated()));
+
+                migrator->start();
+            }
+        }
+    }
+
     // Activate the similarity database.
 
     SimilarityDbAccess::setParameters(params.similarityParameters());
@@ -1114,6 +1176,9 @@ void AlbumManager::startScan()
     connect(CoreDbAccess::databaseWatch(), SIGNAL(imageTagChange(ImageTagChangeset)),
             this, SLOT(slotImageTagChange(ImageTagChangeset)));
 
+    connect(CoreDbAccess::databaseWatch(), SIGNAL(imageChange(ImageChangeset)),
+            this, SLOT(slotImageChange(ImageChangeset)));
+
     // listen to image attribute changes
     connect(ImageAttributesWatch::instance(), SIGNAL(signalImageDateChanged(qlonglong)),
             d->scanDAlbumsTimer, SLOT(start()));
@@ -1527,6 +1592,8 @@ void AlbumManager::updateChangedPAlbums()
 void AlbumManager::getAlbumItemsCount()
 {
     d->albumItemCountTimer->stop();
+    d->dirtyPAlbumsCount.clear();
+    d->recountPAlbums = false;
 
     if (!ApplicationSettings::instance()->getShowFolderTreeViewItemsCount())
     {
@@ -1550,6 +1617,49 @@ void AlbumManager::getAlbumItemsCount()
             this, SLOT(slotAlbumsJobData(QMap<int,int>)));
 }
 
+void AlbumManager::updateAlbumItemsCount()
+{
+    d->albumItemCountTimer->stop();
+
+    if (!ApplicationSettings::instance()->getShowFolderTreeViewItemsCount())
+    {
+        d->dirtyPAlbumsCount.clear();
+        d->recountPAlbums = false;
+        return;
+    }
+
+    if (d->pAlbumsCount.isEmpty() || d->recountPAlbums)
+    {
+        getAlbumItemsCount();
+        return;
+    }
+
+    if (d->dirtyPAlbumsCount.isEmpty())
+    {
+        return;
+    }
+
+    // Do not cancel a running count, the changed albums are recounted after it
+    if (d->albumListJob)
+    {
+        d->albumItemCountTimer->start();
+        return;
+    }
+
+    AlbumsDBJobInfo jInfo;
+    jInfo.setFoldersJob();
+    jInfo.setAlbumsIds(d->dirtyPAlbumsCount.toList());
+    d->dirtyPAlbumsCount.clear();
+
+    d->albumListJob = DBJobsManager::instance()->startAlbumsJobThread(jInfo);
+
+    connect(d->albumListJob, SIGNAL(finished()),
+            this, SLOT(slotAlbumsJobResult()));
+
+    connect(d->albumListJob, SIGNAL(foldersData(QMap<int,int>)),
+            this, SLOT(slotAlbumsJobPartialData(QMap<int,int>)));
+}
+
 void AlbumManager::scanTAlbums()
 {
     d->scanTAlbumsTimer->stop();
@@ -1698,6 +1808,9 @@ void AlbumManager::getTagItemsCount()
 
     if (!ApplicationSettings::instance()->getShowFolderTreeViewItemsCount())
     {
+        d->dirtyTAlbumsCount.clear();
+        d->recountTAlbums = false;
+        d->recountFaces   = false;
         return;
     }
 
@@ -1705,8 +1818,58 @@ void AlbumManager::getTagItemsCount()
     personItemsCount();
 }
 
+void AlbumManager::updateTagItemsCount()
+{
+    d->tagItemCountTimer->stop();
+
+    if (!ApplicationSettings::instance()->getShowFolderTreeViewItemsCount())
+    {
+        d->dirtyTAlbumsCount.clear();
+        d->recountTAlbums = false;
+        d->recountFaces   = false;
+        return;
+    }
+
+    if (d->tAlbumsCount.isEmpty() || d->recountTAlbums)
+    {
+        tagItemsCount();
+    }
+    else if (!d->dirtyTAlbumsCount.isEmpty())
+    {
+        // Do not cancel a running count, the changed tags are recounted after it
+        if (d->tagListJob)
+        {
+            d->tagItemCountTimer->start();
+        }
+        else
+        {
+            TagsDBJobInfo jInfo;
+            jInfo.setFoldersJob();
+            jInfo.setTagsIds(d->dirtyTAlbumsCount.toList());
+            d->dirtyTAlbumsCount.clear();
+
+            d->tagListJob = DBJobsManager::instance()->startTagsJobThread(jInfo);
+
+            connect(d->tagListJob, SIGNAL(finished()),
+                    this, SLOT(slotTagsJobResult()));
+
+            connect(d->tagListJob, SIGNAL(foldersData(QMap<int,int>)),
+                    this, SLOT(slotTagsJobPartialData(QMap<int,int>)));
+        }
+    }
+
+    // The face counts are read from the image tag properties, they are not recounted per tag
+    if (d->recountFaces)
+    {
+        personItemsCount();
+    }
+}
+
 void AlbumManager::tagItemsCount()
 {
+    d->dirtyTAlbumsCount.clear();
+    d->recountTAlbums = false;
+
     if (d->tagListJob)
     {
         d->tagListJob->cancel();
@@ -1727,6 +1890,8 @@ void AlbumManager::tagItemsCount()
 
 void AlbumManager::personItemsCount()
 {
+    d->recountFaces = false;
+
     if (d->personListJob)
     {
         d->personListJob->cancel();
@@ -1837,6 +2002,8 @@ void AlbumManager::scanDAlbumsScheduled()
 void AlbumManager::scanDAlbums()
 {
     d->scanDAlbumsTimer->stop();
+    d->dateItemCountTimer->stop();
+    d->dirtyDAlbumsItems.clear();
 
     if (d->dateListJob)
     {
@@ -1855,6 +2022,42 @@ void AlbumManager::scanDAlbums()
             this, SLOT(slotDatesJobData(QMap<QDateTime,int>)));
 }
 
+void AlbumManager::updateDateItemsCount()
+{
+    d->dateItemCountTimer->stop();
+
+    if (d->dirtyDAlbumsItems.isEmpty())
+    {
+        return;
+    }
+
+    // Do not cancel a running scan, the changed months are recounted after it
+    if (d->dateListJob)
+    {
+        d->dateItemCountTimer->start();
+        return;
+    }
+
+    if (d->datesStatMap.isEmpty())
+    {
+        scanDAlbums();
+        return;
+    }
+
+    DatesDBJobInfo jInfo;
+    jInfo.setFoldersJob();
+    jInfo.setImageIds(d->dirtyDAlbumsItems.toList());
+    d->dirtyDAlbumsItems.clear();
+
+    d->dateListJob = DBJobsManager::instance()->startDatesJobThread(jInfo);
+
+    connect(d->dateListJob, SIGNAL(finished()),
+            this, SLOT(slotDatesJobResult()));
+
+    connect(d->dateListJob, SIGNAL(foldersData(QMap<QDateTime,int>)),
+            this, SLOT(slotDatesJobPartialData(QMap<QDateTime,int>)));
+}
+
 AlbumList AlbumManager::allPAlbums() const
 {
     AlbumList list;
@@ -3237,6 +3440,21 @@ void AlbumManager::slotAlbumsJobData(const QMap<int, int> &albumsStatMap)
     emit signalPAlbumsDirty(albumsStatMap);
 }
 
+void AlbumManager::slotAlbumsJobPartialData(const QMap<int, int>& albumsStatMap)
+{
+    if (albumsStatMap.isEmpty())
+    {
+        return;
+    }
+
+    for (QMap<int, int>::const_iterator it = albumsStatMap.constBegin() ; it != albumsStatMap.constEnd() ; ++it)
+    {
+        d->pAlbumsCount[it.key()] = it.value();
+    }
+
+    emit signalPAlbumsDirty(d->pAlbumsCount);
+}
+
 void AlbumManager::slotPeopleJobResult()
 {
     if (!d->personListJob)
@@ -3310,6 +3528,21 @@ void AlbumManager::slotTagsJobData(const QMap<int, int>& tagsStatMap)
     emit signalTAlbumsDirty(tagsStatMap);
 }
 
+void AlbumManager::slotTagsJobPartialData(const QMap<int, int>& tagsStatMap)
+{
+    if (tagsStatMap.isEmpty())
+    {
+        return;
+    }
+
+    for (QMap<int, int>::const_iterator it = tagsStatMap.constBegin() ; it != tagsStatMap.constEnd() ; ++it)
+    {
+        d->tAlbumsCount[it.key()] = it.value();
+    }
+
+    emit signalTAlbumsDirty(d->tAlbumsCount);
+}
+
 void AlbumManager::slotDatesJobResult()
 {
     if (!d->dateListJob)
@@ -3461,10 +3694,53 @@ void AlbumManager::slotDatesJobData(const QMap<QDateTime, int>& datesStatMap)
     }
 
     d->dAlbumsCount = yearMonthMap;
+    d->datesStatMap = datesStatMap;
     emit signalDAlbumsDirty(yearMonthMap);
     emit signalDatesMapDirty(datesStatMap);
 }
 
+void AlbumManager::slotDatesJobPartialData(const QMap<QDateTime, int>& datesStatMap)
+{
+    if (datesStatMap.isEmpty())
+    {
+        return;
+    }
+
+    // Each recounted month is in the map, replace all the dates of these months
+
+    QSet<QDate> months;
+
+    for (QMap<QDateTime, int>::const_iterator it = datesStatMap.constBegin() ; it != datesStatMap.constEnd() ; ++it)
+    {
+        months << QDate(it.key().date().year(), it.key().date().month(), 1);
+    }
+
+    QMap<QDateTime, int> mergedMap = d->datesStatMap;
+    QMap<QDateTime, int>::iterator it = mergedMap.begin();
+
+    while (it != mergedMap.end())
+    {
+        if (months.contains(QDate(it.key().date().year(), it.key().date().month(), 1)))
+        {
+            it = mergedMap.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    for (QMap<QDateTime, int>::const_iterator it2 = datesStatMap.constBegin() ; it2 != datesStatMap.constEnd() ; ++it2)
+    {
+        if (it2.value() > 0)
+        {
+            mergedMap.insert(it2.key(), it2.value());
+        }
+    }
+
+    slotDatesJobData(mergedMap);
+}
+
 void AlbumManager::slotAlbumChange(const AlbumChangeset& changeset)
 {
     if (d->changingDB || !d->rootPAlbum)
@@ -3598,9 +3874,50 @@ void AlbumManager::slotCollectionImageChange(const CollectionImageChangeset& cha
         case CollectionImageChangeset::Removed:
         case CollectionImageChangeset::RemovedAll:
 
-            if (!d->scanDAlbumsTimer->isActive())
+            // Only the albums and the months of the changed items are recounted.
+            // If the changeset is not precise enough, all counts are computed again.
+
+            if (changeset.albums().isEmpty())
             {
-                d->scanDAlbumsTimer->start();
+                d->recountPAlbums = true;
+            }
+            else
+            {
+                foreach(int albumId, changeset.albums())
+                {
+                    d->dirtyPAlbumsCount << albumId;
+                }
+            }
+
+            if (changeset.operation() == CollectionImageChangeset::Deleted || changeset.ids().isEmpty())
+            {
+                foreach(const qlonglong& id, changeset.ids())
+                {
+                    d->newDAlbumsItems.remove(id);
+                }
+
+                // The creation dates of deleted items are not available anymore
+                if (!d->scanDAlbumsTimer->isActive())
+                {
+                    d->scanDAlbumsTimer->start();
+                }
+            }
+            else
+            {
+                foreach(const qlonglong& id, changeset.ids())
+                {
+                    d->dirtyDAlbumsItems << id;
+
+                    if (changeset.operation() == CollectionImageChangeset::Added)
+                    {
+                        d->newDAlbumsItems << id;
+                    }
+                }
+
+                if (!d->dateItemCountTimer->isActive())
+                {
+                    d->dateItemCountTimer->start();
+                }
             }
 
             if (!d->albumItemCountTimer->isActive())
@@ -3627,6 +3944,35 @@ void AlbumManager::slotImageTagChange(const ImageTagChangeset& changeset)
         case ImageTagChangeset::Added:
         case ImageTagChangeset::Removed:
         case ImageTagChangeset::RemovedAll:
+
+            // Only the changed tags are recounted.
+            // If the changeset is not precise enough, all counts are computed again.
+
+            if (changeset.tags().isEmpty())
+            {
+                d->recountTAlbums = true;
+                d->recountFaces   = true;
+            }
+            else
+            {
+                foreach(int tagId, changeset.tags())
+                {
+                    d->dirtyTAlbumsCount << tagId;
+
+                    if (FaceTags::isPerson(tagId))
+                    {
+                        d->recountFaces = true;
+                    }
+                }
+            }
+
+            if (!d->tagItemCountTimer->isActive())
+            {
+                d->tagItemCountTimer->start();
+            }
+
+            break;
+
         // Add properties changed.
         // Reason: in people sidebar, the images are not
         // connected with the ImageTag table but by
@@ -3635,6 +3981,8 @@ void AlbumManager::slotImageTagChange(const ImageTagChangeset& changeset)
         // updated. This adoption should fix the problem.
         case ImageTagChangeset::PropertiesChanged:
 
+            d->recountFaces = true;
+
             if (!d->tagItemCountTimer->isActive())
             {
                 d->tagItemCountTimer->start();
@@ -3647,6 +3995,48 @@ void AlbumManager::slotImageTagChange(const ImageTagChangeset& changeset)
     }
 }
 
+void AlbumManager::slotImageChange(const ImageChangeset& changeset)
+{
+    if (!d->rootDAlbum || !(changeset.changes() & DatabaseFields::CreationDate))
+    {
+        return;
+    }
+
+    bool datesChanged = false;
+
+    foreach(const qlonglong& id, changeset.ids())
+    {
+        // The new month of the item is recounted. The month it comes from is unknown:
+        // except for new items, it is updated by the next scan of all dates.
+        // A new item is only expected once: later changes of its date are real changes.
+
+        d->dirtyDAlbumsItems << id;
+
+        if (!d->newDAlbumsItems.remove(id))
+        {
+            datesChanged = true;
+        }
+    }
+
+    if (!d->dateItemCountTimer->isActive())
+    {
+        d->dateItemCountTimer->start();
+    }
+
+    if (datesChanged && !d->scanDAlbumsTimer->isActive())
+    {
+        d->scanDAlbumsTimer->start();
+    }
+}
+
+void AlbumManager::slotThumbnailPackMigrated()
+{
+    KSharedConfigPtr config = KSharedConfig::openConfig();
+    KConfigGroup group      = config->group(QLatin1String("Album Settings"));
+    group.writeEntry(QLatin1String("Thumbnail Pack Migrated"), true);
+    config->sync();
+}
+
 void AlbumManager::slotImagesDeleted(const QList<qlonglong>& imageIds)
 {
     qCDebug(DIGIKAM_GENERAL_LOG) << "Got image deletion notification from ImageViewUtilities for " << imageIds.size() << " images.";
@@ -55,6 +55,7 @@ class AlbumChangeset;
 class TagChangeset;
 class SearchChangeset;
 class CollectionImageChangeset;
+class ImageChangeset;
 class ImageTagChangeset;
 
 /**
@@ -687,10 +688,13 @@ private Q_SLOTS:
 
     void slotDatesJobResult();
     void slotDatesJobData(const QMap<QDateTime, int>& datesStatMap);
+    void slotDatesJobPartialData(const QMap<QDateTime, int>& datesStatMap);
     void slotAlbumsJobResult();
     void slotAlbumsJobData(const QMap<int, int>& albumsStatMap);
+    void slotAlbumsJobPartialData(const QMap<int, int>& albumsStatMap);
     void slotTagsJobResult();
     void slotTagsJobData(const QMap<int, int>& tagsStatMap);
+    void slotTagsJobPartialData(const QMap<int, int>& tagsStatMap);
     void slotPeopleJobResult();
     void slotPeopleJobData(const QMap<QString, QMap<int, int> >& facesStatMap);
 
@@ -701,7 +705,9 @@ private Q_SLOTS:
     void slotSearchChange(const SearchChangeset& changeset);
     void slotCollectionImageChange(const CollectionImageChangeset& changeset);
     void slotImageTagChange(const ImageTagChangeset& changeset);
+    void slotImageChange(const ImageChangeset& changeset);
     void slotImagesDeleted(const QList<qlonglong>& imageIds);
+    void slotThumbnailPackMigrated();
 
     /**
      * Scan albums directly from database and creates new PAlbums
@@ -735,6 +741,15 @@ private Q_SLOTS:
     void tagItemsCount();
     void personItemsCount();
 
+    /**
+     * Recount only the albums, tags and months changed since the last count,
+     * and merge the results in the current counts.
+     * Fall back to a full recount if the changes are not precise enough.
+     */
+    void updateAlbumItemsCount();
+    void updateTagItemsCount();
+    void updateDateItemsCount();
+
 private:
 
     friend class AlbumManagerCreator;
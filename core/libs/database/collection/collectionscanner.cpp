@@ -36,12 +36,18 @@
 
 #include <QDir>
 #include <QFileInfo>
+#include <QFuture>
+#include <QQueue>
 #include <QReadWriteLock>
 #include <QReadLocker>
+#include <QScopedPointer>
 #include <QStringList>
 #include <QSet>
+#include <QThreadPool>
+#include <QThread>
 #include <QTime>
 #include <QWriteLocker>
+#include <QtConcurrent>    // krazy:exclude=includes
 
 // Local includes
 
@@ -267,6 +273,30 @@ void CollectionScannerHintContainerImplementation::clear()
 
 // --------------------------------------------------------------------
 
+/**
+ * A new file waiting in the scanning pipeline: its data are loaded from disk
+ * by a worker thread, then the scanner is committed to the database in enumeration order.
+ */
+class Q_DECL_HIDDEN CollectionScannerPendingFile
+{
+public:
+
+    explicit CollectionScannerPendingFile()
+        : scanner(0),
+          albumId(0)
+    {
+    }
+
+public:
+
+    ImageScanner* scanner;
+    QFileInfo     info;
+    int           albumId;
+    QFuture<void> loading;
+};
+
+// --------------------------------------------------------------------------
+
 class Q_DECL_HIDDEN CollectionScanner::Private
 {
 
@@ -279,8 +309,14 @@ public:
         updatingHashHint(false),
         recordHistoryIds(false),
         deferredFileScanning(false),
-        observer(0)
+        observer(0),
+        batchCommitSize(0)
     {
+        // Metadata parsing, image header loading and hashing are mostly I/O bound:
+        // allow more loaders than cores, but bound the number of files waiting for commit.
+        loaderPool.setMaxThreadCount(qMax(2, QThread::idealThreadCount()));
+        maxPendingFiles = 4 * loaderPool.maxThreadCount();
+        commitStep      = qMax(1, maxPendingFiles / 2);
     }
 
 public:
@@ -316,7 +352,10 @@ public:
         return false;
     }
 
-    void finishScanner(ImageScanner& scanner);
+    void finishScanner(ImageScanner& scanner, ImageScannerCommitBatch* const batch = 0);
+
+    /// Wait for the loaders of all pending files and drop them without commit.
+    void discardPendingFiles();
 
 public:
 
@@ -342,14 +381,21 @@ public:
     QSet<QString>                                 deferredAlbumPaths;
 
     CollectionScannerObserver*                    observer;
+
+    QThreadPool                                   loaderPool;
+    QQueue<CollectionScannerPendingFile>          pendingFiles;
+    int                                           maxPendingFiles;
+    int                                           commitStep;
+
+    int                                           batchCommitSize;
 };
 
-void CollectionScanner::Private::finishScanner(ImageScanner& scanner)
+void CollectionScanner::Private::finishScanner(ImageScanner& scanner, ImageScannerCommitBatch* const batch)
 {
     // Perform the actual write operation to the database
     {
         CoreDbOperationGroup group;
-        scanner.commit();
+        scanner.commit(batch);
     }
 
     if (recordHistoryIds && scanner.hasHistoryToResolve())
@@ -358,6 +404,16 @@ void CollectionScanner::Private::finishScanner(ImageScanner& scanner)
     }
 }
 
+void CollectionScanner::Private::discardPendingFiles()
+{
+    while (!pendingFiles.isEmpty())
+    {
+        CollectionScannerPendingFile pending = pendingFiles.dequeue();
+        pending.loading.waitForFinished();
+        delete pending.scanner;
+    }
+}
+
 // --------------------------------------------------------------------------
 
 CollectionScanner::CollectionScanner()
@@ -367,6 +423,7 @@ CollectionScanner::CollectionScanner()
 
 CollectionScanner::~CollectionScanner()
 {
+    d->discardPendingFiles();
     delete d;
 }
 
@@ -414,6 +471,15 @@ void CollectionScanner::loadNameFilters()
     d->nameFilters = d->imageFilterSet + d->audioFilterSet + d->videoFilterSet;
 }
 
+void CollectionScanner::setBatchCommitSize(int size)
+{
+    d->batchCommitSize = qMax(0, size);
+
+    // let enough files wait in the pipeline to fill a batch
+    d->maxPendingFiles = qMax(4 * d->loaderPool.maxThreadCount(), 2 * d->batchCommitSize);
+    d->commitStep      = qMax(1, d->maxPendingFiles / 2);
+}
+
 void CollectionScanner::setObserver(CollectionScannerObserver* const observer)
 {
     d->observer = observer;
@@ -1058,6 +1124,7 @@ void CollectionScanner::scanAlbum(const CollectionLocation& location, const QStr
     {
         if (!d->checkObserver())
         {
+            d->discardPendingFiles();
             return; // return directly, do not go to cleanup code after loop!
         }
 
@@ -1103,7 +1170,7 @@ void CollectionScanner::scanAlbum(const CollectionLocation& location, const QStr
             {
                 //qCDebug(DIGIKAM_DATABASE_LOG) << "Adding item " << fi->fileName();
 
-                scanNewFile(*fi, albumID);
+                queueNewFile(*fi, albumID);
 
                 // emit signals for scanned files with much higher granularity
                 if (d->wantSignals && counter && (counter % 2 == 0))
@@ -1129,6 +1196,12 @@ void CollectionScanner::scanAlbum(const CollectionLocation& location, const QStr
                 continue;
             }
 
+            // new files of this album are committed before descending into the sub-albums
+            if (!commitPendingFiles(d->pendingFiles.size()))
+            {
+                return;
+            }
+
             if (album == QLatin1String("/"))
             {
                 subalbum = QLatin1Char('/') + fi->fileName();
@@ -1142,6 +1215,11 @@ void CollectionScanner::scanAlbum(const CollectionLocation& location, const QStr
         }
     }
 
+    if (!commitPendingFiles(d->pendingFiles.size()))
+    {
+        return;
+    }
+
     if (d->wantSignals && counter)
     {
         emit scannedFiles(counter);
@@ -1261,7 +1339,14 @@ qlonglong CollectionScanner::scanNewFile(const QFileInfo& info, int albumId)
 
     ImageScanner scanner(info);
     scanner.setCategory(category(info));
+    prepareNewFile(scanner, info, albumId);
+    d->finishScanner(scanner);
+
+    return scanner.id();
+}
 
+void CollectionScanner::prepareNewFile(ImageScanner& scanner, const QFileInfo& info, int albumId)
+{
     // Check copy/move hints for single items
     qlonglong srcId = 0;
 
@@ -1296,10 +1381,76 @@ qlonglong CollectionScanner::scanNewFile(const QFileInfo& info, int albumId)
             scanner.newFile(albumId);
         }
     }
+}
 
-    d->finishScanner(scanner);
+void CollectionScanner::queueNewFile(const QFileInfo& info, int albumId)
+{
+    if (d->checkDeferred(info))
+    {
+        return;
+    }
 
-    return scanner.id();
+    // The loaders check the unique hash version: make sure it is read and cached
+    // by this thread, not by a loader while a commit transaction is open.
+    CoreDbAccess().db()->isUniqueHashV2();
+
+    CollectionScannerPendingFile pending;
+    pending.scanner = new ImageScanner(info);
+    pending.scanner->setCategory(category(info));
+    pending.info    = info;
+    pending.albumId = albumId;
+
+    // Stage 2: metadata, image information and unique hash are read by the loader pool.
+    // Loading from disk does not write to the database, the scanner is committed later.
+    pending.loading = QtConcurrent::run(&d->loaderPool, pending.scanner, &ImageScanner::loadFromDisk);
+    d->pendingFiles.enqueue(pending);
+
+    // Bound the queue: the enumeration waits here while the oldest files get committed.
+    if (d->pendingFiles.size() >= d->maxPendingFiles)
+    {
+        commitPendingFiles(d->commitStep);
+    }
+}
+
+bool CollectionScanner::commitPendingFiles(int count)
+{
+    // Stage 3: commit the oldest pending files, in enumeration order, grouped in one database operation.
+    // In batch commit mode, the rows of the batch are written with multi-row statements,
+    // and each batch is written in one transaction.
+    CoreDbOperationGroup group;
+    group.setMaximumTime(200);
+
+    QScopedPointer<ImageScannerCommitBatch> batch(d->batchCommitSize ? new ImageScannerCommitBatch : 0);
+
+    for (int i = 0 ; i < count && !d->pendingFiles.isEmpty() ; ++i)
+    {
+        if (!d->checkObserver())
+        {
+            batch.reset();
+            d->discardPendingFiles();
+            return false;
+        }
+
+        CollectionScannerPendingFile pending = d->pendingFiles.dequeue();
+        pending.loading.waitForFinished();
+
+        // data are already loaded: this only prepares the commit and checks the hints
+        prepareNewFile(*pending.scanner, pending.info, pending.albumId);
+        d->finishScanner(*pending.scanner, batch.data());
+        delete pending.scanner;
+
+        if (!batch)
+        {
+            group.allowLift();
+        }
+        else if (batch->count() >= d->batchCommitSize)
+        {
+            batch->flush();
+            group.lift();
+        }
+    }
+
+    return true;
 }
 
 qlonglong CollectionScanner::scanNewFileFullScan(const QFileInfo& info, int albumId)
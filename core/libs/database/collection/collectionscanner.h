@@ -48,6 +48,8 @@ class AlbumCopyMoveHint;
 class CollectionLocation;
 class CollectionScannerObserver;
 class ImageInfo;
+class ImageScanner;
+class ImageScannerCommitBatch;
 class ItemCopyMoveHint;
 class ItemChangeHint;
 class ItemMetadataAdjustmentHint;
@@ -182,6 +184,13 @@ public:
      */
     void safelyRemoveAlbums(const QList<int>& albumIds);
 
+    /**
+     * Call this to write new files to the database in batches of the given size:
+     * the rows of a batch are written with multi-row statements in one transaction.
+     * Default is 0, each file is written on its own.
+     */
+    void setBatchCommitSize(int size);
+
     /**
      * Set an observer to be able to cancel a running scan
      */
@@ -273,6 +282,16 @@ protected:
     qlonglong scanFile(const QFileInfo& fi, int albumId, qlonglong id, FileScanMode mode);
     qlonglong scanNewFile(const QFileInfo& info, int albumId);
     qlonglong scanNewFileFullScan(const QFileInfo& info, int albumId);
+    void      prepareNewFile(ImageScanner& scanner, const QFileInfo& info, int albumId);
+
+    /**
+     * Pipelined scanning of new files while scanning an album:
+     * queueNewFile() starts loading the file from disk in a worker thread,
+     * commitPendingFiles() writes the oldest count loaded files to the database.
+     * Returns false if the observer cancelled the scan, pending files are dropped then.
+     */
+    void      queueNewFile(const QFileInfo& info, int albumId);
+    bool      commitPendingFiles(int count);
 
 private:
 
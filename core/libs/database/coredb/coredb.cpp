@@ -71,7 +71,8 @@ public:
 
     explicit Private()
       : db(0),
-        uniqueHashVersion(-1)
+        uniqueHashVersion(-1),
+        fullTextIndexVersion(-1)
     {
     }
 
@@ -82,11 +83,17 @@ public:
     QList<int>           recentlyAssignedTags;
 
     int                  uniqueHashVersion;
+    int                  fullTextIndexVersion;
 
 public:
 
     QString constructRelatedImagesSQL(bool fromOrTo, DatabaseRelation::Type type, bool boolean);
     QList<qlonglong> execRelatedImagesQuery(DbEngineSqlQuery& query, qlonglong id, DatabaseRelation::Type type);
+    QVector<QVariantList> getFieldsOfItems(const QString& table, const QString& idField,
+                                           const QStringList& fieldNames, const QList<qlonglong>& imageIDs);
+    QString fullTextIdField() const;
+    void fillFullTextIndex(const QString& idCondition);
+    QString fullTextSourceState();
 };
 
 const QString CoreDB::Private::configGroupName(QLatin1String("CoreDB Settings"));
@@ -637,11 +644,16 @@ void CoreDB::deleteTag(int tagID)
     QString("DELETE FROM Tags WHERE id=?;"), tagID
     */
 
+    // The tag and its children are removed from the items by the database triggers.
+    const QList<qlonglong> imageIds = hasFullTextIndex() ? getItemIDsInTag(tagID, true) : QList<qlonglong>();
+
     QMap<QString, QVariant> bindingMap;
     bindingMap.insert(QLatin1String(":tagID"), tagID);
 
     d->db->execDBAction(d->db->getDBAction(QLatin1String("DeleteTag")), bindingMap);
     d->db->recordChangeset(TagChangeset(tagID, TagChangeset::Deleted));
+
+    updateFullTextIndex(imageIds);
 }
 
 void CoreDB::setTagIcon(int tagID, const QString& iconKDE, qlonglong iconID)
@@ -1096,6 +1108,262 @@ void CoreDB::setUniqueHashVersion(int version)
     setSetting(QLatin1String("uniqueHashVersion"), QString::number(d->uniqueHashVersion));
 }
 
+int CoreDB::getFullTextIndexVersion()
+{
+    if (d->fullTextIndexVersion == -1)
+    {
+        d->fullTextIndexVersion = getSetting(QLatin1String("FullTextIndexVersion")).toInt();
+    }
+
+    return d->fullTextIndexVersion;
+}
+
+void CoreDB::setFullTextIndexVersion(int version)
+{
+    d->fullTextIndexVersion = version;
+    setSetting(QLatin1String("FullTextIndexVersion"), QString::number(d->fullTextIndexVersion));
+}
+
+bool CoreDB::hasFullTextIndex()
+{
+    return (getFullTextIndexVersion() > 0);
+}
+
+QString CoreDB::Private::fullTextIdField() const
+{
+    return (db->databaseType() == BdEngineBackend::DbType::SQLite) ? QLatin1String("rowid")
+                                                                   : QLatin1String("imageid");
+}
+
+void CoreDB::Private::fillFullTextIndex(const QString& idCondition)
+{
+    // One row per image, the tag names and the comments being concatenated.
+    QString concat;
+    QString insert;
+
+    if (db->databaseType() == BdEngineBackend::DbType::SQLite)
+    {
+        concat = QString::fromUtf8("group_concat(%1, ' ')");
+        insert = QString::fromUtf8("INSERT INTO ImageFullText (rowid, name, tags, captions, titles) ");
+    }
+    else
+    {
+        concat = QString::fromUtf8("GROUP_CONCAT(%1 SEPARATOR ' ')");
+        insert = QString::fromUtf8("REPLACE INTO ImageFullText (imageid, name, tags, captions, titles) ");
+    }
+
+    db->execSql(insert +
+                QString::fromUtf8("SELECT Images.id, Images.name, "
+                                  " (SELECT %1 FROM ImageTags INNER JOIN Tags ON Tags.id=ImageTags.tagid "
+                                  "   WHERE ImageTags.imageid=Images.id), "
+                                  " (SELECT %2 FROM ImageComments "
+                                  "   WHERE ImageComments.imageid=Images.id AND ImageComments.type=%4), "
+                                  " (SELECT %2 FROM ImageComments "
+                                  "   WHERE ImageComments.imageid=Images.id AND ImageComments.type=%5) "
+                                  " FROM Images %3;")
+                .arg(concat.arg(QLatin1String("Tags.name")),
+                     concat.arg(QLatin1String("ImageComments.comment")),
+                     idCondition)
+                .arg((int)DatabaseComment::Comment)
+                .arg((int)DatabaseComment::Title));
+}
+
+void CoreDB::rebuildFullTextIndex()
+{
+    d->db->execSql(QString::fromUtf8("DELETE FROM ImageFullText;"));
+    d->fillFullTextIndex(QString());
+}
+
+void CoreDB::updateFullTextIndex(const QList<qlonglong>& imageIDs)
+{
+    if (imageIDs.isEmpty() || !hasFullTextIndex())
+    {
+        return;
+    }
+
+    const int     chunkSize = 500;
+    const QString idField   = d->fullTextIdField();
+
+    for (int start = 0 ; start < imageIDs.size() ; start += chunkSize)
+    {
+        QStringList ids;
+        const int end = qMin(start + chunkSize, imageIDs.size());
+
+        for (int i = start ; i < end ; ++i)
+        {
+            ids << QString::number(imageIDs.at(i));
+        }
+
+        // Rows of removed images are deleted, and are not inserted again.
+        d->db->execSql(QString::fromUtf8("DELETE FROM ImageFullText WHERE %1 IN (%2);")
+                       .arg(idField, ids.join(QLatin1Char(','))));
+        d->fillFullTextIndex(QString::fromUtf8("WHERE Images.id IN (%1)").arg(ids.join(QLatin1Char(','))));
+    }
+}
+
+QString CoreDB::fullTextCondition(const QString& text, int fields, QList<QVariant>* const boundValues)
+{
+    if (!hasFullTextIndex() || !(fields & FullTextAll))
+    {
+        return QString();
+    }
+
+    const bool isSQLite = (d->db->databaseType() == BdEngineBackend::DbType::SQLite);
+
+    // Split in words as both full text engines do: any character
+    // which is not a letter or a number separates the words.
+    QStringList words;
+    QString     word;
+
+    foreach(const QChar& c, text)
+    {
+        if (c.isLetterOrNumber())
+        {
+            word += c;
+        }
+        else
+        {
+            // With MySQL, underscores and apostrophes may be part of the words.
+            if (!isSQLite && (c == QLatin1Char('_') || c == QLatin1Char('\'')))
+            {
+                return QString();
+            }
+
+            if (!word.isEmpty())
+            {
+                words << word;
+                word.clear();
+            }
+        }
+    }
+
+    if (!word.isEmpty())
+    {
+        words << word;
+    }
+
+    if (words.isEmpty())
+    {
+        return QString();
+    }
+
+    QStringList columns;
+
+    if (fields & FullTextName)
+    {
+        columns << QLatin1String("name");
+    }
+
+    if (fields & FullTextTags)
+    {
+        columns << QLatin1String("tags");
+    }
+
+    if (fields & FullTextCaptions)
+    {
+        columns << QLatin1String("captions");
+    }
+
+    if (fields & FullTextTitles)
+    {
+        columns << QLatin1String("titles");
+    }
+
+    QStringList terms;
+
+    if (isSQLite)
+    {
+        QString columnFilter;
+
+        if ((fields & FullTextAll) != FullTextAll)
+        {
+            columnFilter = QLatin1Char('{') + columns.join(QLatin1Char(' ')) + QLatin1String("} : ");
+        }
+
+        foreach(const QString& w, words)
+        {
+            terms << columnFilter + QLatin1Char('"') + w + QLatin1String("\"*");
+        }
+
+        *boundValues << terms.join(QLatin1String(" AND "));
+
+        return QString::fromUtf8("Images.id IN (SELECT rowid FROM ImageFullText WHERE ImageFullText MATCH ?)");
+    }
+
+    foreach(const QString& w, words)
+    {
+        // Shorter words are not indexed with the default innodb_ft_min_token_size.
+        if (w.size() < 3)
+        {
+            return QString();
+        }
+
+        terms << QLatin1Char('+') + w + QLatin1Char('*');
+    }
+
+    // The FULLTEXT indexes cover all the columns, or one column.
+    QStringList matches;
+
+    if ((fields & FullTextAll) == FullTextAll)
+    {
+        matches << QString::fromUtf8("MATCH(%1) AGAINST (? IN BOOLEAN MODE)").arg(columns.join(QLatin1String(", ")));
+        *boundValues << terms.join(QLatin1Char(' '));
+    }
+    else
+    {
+        foreach(const QString& column, columns)
+        {
+            matches << QString::fromUtf8("MATCH(%1) AGAINST (? IN BOOLEAN MODE)").arg(column);
+            *boundValues << terms.join(QLatin1Char(' '));
+        }
+    }
+
+    return QString::fromUtf8("Images.id IN (SELECT imageid FROM ImageFullText WHERE %1)")
+           .arg(matches.join(QLatin1String(" OR ")));
+}
+
+QString CoreDB::Private::fullTextSourceState()
+{
+    // Counts and sums which change with nearly any change of the names, tags and comments.
+    QList<QVariant> values;
+
+    if (!db->execSql(QString::fromUtf8("SELECT "
+                                       " (SELECT COUNT(*) FROM Images), (SELECT MAX(id) FROM Images), "
+                                       " (SELECT SUM(LENGTH(name)) FROM Images), "
+                                       " (SELECT COUNT(*) FROM ImageTags), (SELECT SUM(imageid * tagid) FROM ImageTags), "
+                                       " (SELECT COUNT(*) FROM Tags), (SELECT SUM(LENGTH(name)) FROM Tags), "
+                                       " (SELECT COUNT(*) FROM ImageComments), "
+                                       " (SELECT SUM(imageid + LENGTH(comment)) FROM ImageComments);"),
+                     &values))
+    {
+        return QString();
+    }
+
+    QStringList state;
+
+    foreach(const QVariant& value, values)
+    {
+        state << value.toString();
+    }
+
+    return state.join(QLatin1Char(':'));
+}
+
+void CoreDB::storeFullTextIndexState()
+{
+    if (hasFullTextIndex())
+    {
+        setSetting(QLatin1String("FullTextIndexState"), d->fullTextSourceState());
+    }
+}
+
+bool CoreDB::isFullTextIndexStale()
+{
+    const QString state = getSetting(QLatin1String("FullTextIndexState"));
+
+    return (state.isEmpty() || state != d->fullTextSourceState());
+}
+
 /*
 QString CoreDB::getItemCaption(qlonglong imageID)
 {
@@ -1620,6 +1888,115 @@ QVariantList CoreDB::getImagesFields(qlonglong imageID, DatabaseFields::Images f
     return values;
 }
 
+QVector<QVariantList> CoreDB::Private::getFieldsOfItems(const QString& table, const QString& idField,
+                                                        const QStringList& fieldNames, const QList<qlonglong>& imageIDs)
+{
+    // The ids are given in the query itself, by chunks to respect the limits of the SQL engines.
+    const int chunkSize = 500;
+    const int columns   = fieldNames.size() + 1;
+
+    QVector<QVariantList> results(imageIDs.size());
+    QHash<qlonglong, int> positions;
+    positions.reserve(imageIDs.size());
+
+    for (int i = 0 ; i < imageIDs.size() ; ++i)
+    {
+        positions.insert(imageIDs.at(i), i);
+    }
+
+    for (int start = 0 ; start < imageIDs.size() ; start += chunkSize)
+    {
+        QStringList ids;
+        const int end = qMin(start + chunkSize, imageIDs.size());
+
+        for (int i = start ; i < end ; ++i)
+        {
+            ids << QString::number(imageIDs.at(i));
+        }
+
+        QVariantList values;
+        db->execSql(QString::fromUtf8("SELECT %1, %2 FROM %3 WHERE %1 IN (%4);")
+                    .arg(idField, fieldNames.join(QString::fromUtf8(", ")), table, ids.join(QLatin1Char(','))),
+                    &values);
+
+        for (int row = 0 ; row + columns <= values.size() ; row += columns)
+        {
+            QHash<qlonglong, int>::const_iterator pos = positions.constFind(values.at(row).toLongLong());
+
+            if (pos != positions.constEnd())
+            {
+                results[pos.value()] = values.mid(row + 1, columns - 1);
+            }
+        }
+    }
+
+    return results;
+}
+
+QVector<QVariantList> CoreDB::getImagesFields(const QList<qlonglong>& imageIDs, DatabaseFields::Images fields)
+{
+    if (fields == DatabaseFields::ImagesNone || imageIDs.isEmpty())
+    {
+        return QVector<QVariantList>(imageIDs.size());
+    }
+
+    QStringList fieldNames        = imagesFieldList(fields);
+    QVector<QVariantList> results = d->getFieldsOfItems(QLatin1String("Images"), QLatin1String("id"),
+                                                        fieldNames, imageIDs);
+
+    if (fields & DatabaseFields::ModificationDate)
+    {
+        int index = fieldNames.indexOf(QLatin1String("modificationDate"));
+
+        for (int i = 0 ; i < results.size() ; ++i)
+        {
+            if (!results.at(i).isEmpty())
+            {
+                results[i][index] = results.at(i).at(index).toDateTime();
+            }
+        }
+    }
+
+    return results;
+}
+
+QVector<QVariantList> CoreDB::getImageInformation(const QList<qlonglong>& imageIDs, DatabaseFields::ImageInformation fields)
+{
+    if (fields == DatabaseFields::ImageInformationNone || imageIDs.isEmpty())
+    {
+        return QVector<QVariantList>(imageIDs.size());
+    }
+
+    QStringList fieldNames        = imageInformationFieldList(fields);
+    QVector<QVariantList> results = d->getFieldsOfItems(QLatin1String("ImageInformation"), QLatin1String("imageid"),
+                                                        fieldNames, imageIDs);
+
+    QList<int> dateIndexes;
+
+    if (fields & DatabaseFields::CreationDate)
+    {
+        dateIndexes << fieldNames.indexOf(QLatin1String("creationDate"));
+    }
+
+    if (fields & DatabaseFields::DigitizationDate)
+    {
+        dateIndexes << fieldNames.indexOf(QLatin1String("digitizationDate"));
+    }
+
+    for (int i = 0 ; !dateIndexes.isEmpty() && i < results.size() ; ++i)
+    {
+        foreach (int index, dateIndexes)
+        {
+            if (!results.at(i).isEmpty())
+            {
+                results[i][index] = results.at(i).at(index).toDateTime();
+            }
+        }
+    }
+
+    return results;
+}
+
 QVariantList CoreDB::getImageInformation(qlonglong imageID, DatabaseFields::ImageInformation fields)
 {
     QVariantList values;
@@ -1836,6 +2213,18 @@ void CoreDB::addImageInformation(qlonglong imageID, const QVariantList& infos,
     d->db->recordChangeset(ImageChangeset(imageID, fields));
 }
 
+void CoreDB::addImageInformation(const QList<qlonglong>& imageIDs, const QList<QVariantList>& infos,
+                                 DatabaseFields::ImageInformation fields)
+{
+    if (fields == DatabaseFields::ImageInformationNone || imageIDs.isEmpty())
+    {
+        return;
+    }
+
+    replaceImageRows(QLatin1String("ImageInformation"), imageInformationFieldList(fields), imageIDs, infos);
+    d->db->recordChangeset(ImageChangeset(imageIDs, fields));
+}
+
 void CoreDB::changeImageInformation(qlonglong imageId, const QVariantList& infos,
                                     DatabaseFields::ImageInformation fields)
 {
@@ -1876,6 +2265,18 @@ void CoreDB::addImageMetadata(qlonglong imageID, const QVariantList& infos,
     d->db->recordChangeset(ImageChangeset(imageID, fields));
 }
 
+void CoreDB::addImageMetadata(const QList<qlonglong>& imageIDs, const QList<QVariantList>& infos,
+                              DatabaseFields::ImageMetadata fields)
+{
+    if (fields == DatabaseFields::ImageMetadataNone || imageIDs.isEmpty())
+    {
+        return;
+    }
+
+    replaceImageRows(QLatin1String("ImageMetadata"), imageMetadataFieldList(fields), imageIDs, infos);
+    d->db->recordChangeset(ImageChangeset(imageIDs, fields));
+}
+
 void CoreDB::changeImageMetadata(qlonglong imageId, const QVariantList& infos,
                                   DatabaseFields::ImageMetadata fields)
 {
@@ -1971,6 +2372,18 @@ void CoreDB::addImagePosition(qlonglong imageID, const QVariantList& infos, Data
     d->db->recordChangeset(ImageChangeset(imageID, fields));
 }
 
+void CoreDB::addImagePosition(const QList<qlonglong>& imageIDs, const QList<QVariantList>& infos,
+                              DatabaseFields::ImagePositions fields)
+{
+    if (fields == DatabaseFields::ImagePositionsNone || imageIDs.isEmpty())
+    {
+        return;
+    }
+
+    replaceImageRows(QLatin1String("ImagePositions"), imagePositionsFieldList(fields), imageIDs, infos);
+    d->db->recordChangeset(ImageChangeset(imageIDs, fields));
+}
+
 void CoreDB::changeImagePosition(qlonglong imageId, const QVariantList& infos,
                                   DatabaseFields::ImagePositions fields)
 {
@@ -2056,6 +2469,8 @@ int CoreDB::setImageComment(qlonglong imageID, const QString& comment, DatabaseC
                    boundValues, 0, &id);
 
     d->db->recordChangeset(ImageChangeset(imageID, DatabaseFields::ImageCommentsAll));
+    updateFullTextIndex(QList<qlonglong>() << imageID);
+
     return id.toInt();
 }
 
@@ -2079,6 +2494,11 @@ void CoreDB::changeImageComment(int commentId, qlonglong imageID, const QVariant
 
     d->db->execSql(query, boundValues);
     d->db->recordChangeset(ImageChangeset(imageID, fields));
+
+    if (fields & (DatabaseFields::CommentType | DatabaseFields::Comment))
+    {
+        updateFullTextIndex(QList<qlonglong>() << imageID);
+    }
 }
 
 void CoreDB::removeImageComment(int commentid, qlonglong imageid)
@@ -2087,6 +2507,7 @@ void CoreDB::removeImageComment(int commentid, qlonglong imageid)
                    commentid);
 
     d->db->recordChangeset(ImageChangeset(imageid, DatabaseFields::ImageCommentsAll));
+    updateFullTextIndex(QList<qlonglong>() << imageid);
 }
 
 QString CoreDB::getImageProperty(qlonglong imageID, const QString& property)
@@ -3073,6 +3494,48 @@ QStringList CoreDB::imageCommentsFieldList(DatabaseFields::ImageComments fields)
     return list;
 }
 
+void CoreDB::replaceImageRows(const QString& table, const QStringList& fieldNames,
+                              const QList<qlonglong>& imageIDs, const QList<QVariantList>& infos)
+{
+    Q_ASSERT(imageIDs.size() == infos.size());
+
+    // SQLite limits the number of bound values per statement to 999 by default
+    const int columns      = fieldNames.size() + 1;
+    const int rowsPerQuery = qMax(1, 999 / columns);
+
+    QString row(QLatin1Char('('));
+    addBoundValuePlaceholders(row, columns);
+    row += QLatin1Char(')');
+
+    for (int start = 0 ; start < imageIDs.size() ; start += rowsPerQuery)
+    {
+        const int end = qMin(start + rowsPerQuery, imageIDs.size());
+
+        QString query(QString::fromUtf8("REPLACE INTO %1 ( imageid, ").arg(table));
+        query += fieldNames.join(QLatin1String(", "));
+        query += QString::fromUtf8(" ) VALUES ");
+
+        QVariantList boundValues;
+
+        for (int i = start ; i < end ; ++i)
+        {
+            Q_ASSERT(fieldNames.size() == infos.at(i).size());
+
+            if (i != start)
+            {
+                query += QLatin1Char(',');
+            }
+
+            query       += row;
+            boundValues << imageIDs.at(i) << infos.at(i);
+        }
+
+        query += QLatin1Char(';');
+
+        d->db->execSql(query, boundValues);
+    }
+}
+
 void CoreDB::addBoundValuePlaceholders(QString& query, int count)
 {
     // adds no spaces at beginning or end
@@ -3160,6 +3623,7 @@ void CoreDB::addItemTag(qlonglong imageID, int tagID)
                    tagID);
 
     d->db->recordChangeset(ImageTagChangeset(imageID, tagID, ImageTagChangeset::Added));
+    updateFullTextIndex(QList<qlonglong>() << imageID);
 
     //don't save pick or color tags
     if (TagsCache::instance()->isInternalTag(tagID))
@@ -3214,6 +3678,7 @@ void CoreDB::addTagsToItems(QList<qlonglong> imageIDs, QList<int> tagIDs)
     query.addBindValue(tags);
     d->db->execBatch(query);
     d->db->recordChangeset(ImageTagChangeset(imageIDs, tagIDs, ImageTagChangeset::Added));
+    updateFullTextIndex(imageIDs);
 }
 
 QList<int> CoreDB::getRecentlyAssignedTags() const
@@ -3229,6 +3694,7 @@ void CoreDB::removeItemTag(qlonglong imageID, int tagID)
                    tagID);
 
     d->db->recordChangeset(ImageTagChangeset(imageID, tagID, ImageTagChangeset::Removed));
+    updateFullTextIndex(QList<qlonglong>() << imageID);
 }
 
 void CoreDB::removeItemAllTags(qlonglong imageID, const QList<int>& currentTagIds)
@@ -3238,6 +3704,7 @@ void CoreDB::removeItemAllTags(qlonglong imageID, const QList<int>& currentTagId
                    imageID);
 
     d->db->recordChangeset(ImageTagChangeset(imageID, currentTagIds, ImageTagChangeset::RemovedAll));
+    updateFullTextIndex(QList<qlonglong>() << imageID);
 }
 
 void CoreDB::removeTagsFromItems(QList<qlonglong> imageIDs, const QList<int>& tagIDs)
@@ -3264,6 +3731,7 @@ void CoreDB::removeTagsFromItems(QList<qlonglong> imageIDs, const QList<int>& ta
     query.addBindValue(tags);
     d->db->execBatch(query);
     d->db->recordChangeset(ImageTagChangeset(imageIDs, tagIDs, ImageTagChangeset::Removed));
+    updateFullTextIndex(imageIDs);
 }
 
 QStringList CoreDB::getItemNamesInAlbum(int albumID, bool recursive)
@@ -3394,6 +3862,68 @@ QMap<QDateTime, int> CoreDB::getAllCreationDatesAndNumberOfImages()
     return datesStatMap;
 }
 
+QMap<QDateTime, int> CoreDB::getCreationDatesAndNumberOfImages(const QList<qlonglong>& imageIDs)
+{
+    QMap<QDateTime, int> datesStatMap;
+    QSet<QDate>          months;
+    const int            chunkSize = 500;
+
+    // The items may not be in the collection anymore: their creation date
+    // is still read, to recount the month which they have been removed from.
+
+    for (int start = 0 ; start < imageIDs.size() ; start += chunkSize)
+    {
+        QStringList ids;
+        const int end = qMin(start + chunkSize, imageIDs.size());
+
+        for (int i = start ; i < end ; ++i)
+        {
+            ids << QString::number(imageIDs.at(i));
+        }
+
+        QList<QVariant> values;
+        d->db->execSql(QString::fromUtf8("SELECT creationDate FROM ImageInformation WHERE imageid IN (%1);")
+                       .arg(ids.join(QLatin1Char(','))), &values);
+
+        foreach(const QVariant& value, values)
+        {
+            QDateTime dateTime = value.toDateTime();
+
+            if (dateTime.isValid())
+            {
+                months << QDate(dateTime.date().year(), dateTime.date().month(), 1);
+            }
+        }
+    }
+
+    foreach(const QDate& month, months)
+    {
+        QList<QVariant> values;
+        d->db->execSql(QString::fromUtf8("SELECT creationDate FROM ImageInformation "
+                       " INNER JOIN Images ON Images.id=ImageInformation.imageid "
+                       " WHERE Images.status=1 "
+                       "   AND ImageInformation.creationDate < ? "
+                       "   AND ImageInformation.creationDate >= ?;"),
+                       QDateTime(month.addMonths(1)),
+                       QDateTime(month),
+                       &values);
+
+        datesStatMap.insert(QDateTime(month), 0);
+
+        foreach(const QVariant& value, values)
+        {
+            QDateTime dateTime = value.toDateTime();
+
+            if (dateTime.isValid())
+            {
+                datesStatMap[dateTime]++;
+            }
+        }
+    }
+
+    return datesStatMap;
+}
+
 QMap<int, int> CoreDB::getNumberOfImagesInAlbums()
 {
     QList<QVariant> values, allAbumIDs;
@@ -3432,6 +3962,43 @@ QMap<int, int> CoreDB::getNumberOfImagesInAlbums()
     return albumsStatMap;
 }
 
+QMap<int, int> CoreDB::getNumberOfImagesInAlbums(const QList<int>& albumIDs)
+{
+    QMap<int, int> albumsStatMap;
+    const int      chunkSize = 500;
+
+    foreach(int albumID, albumIDs)
+    {
+        albumsStatMap.insert(albumID, 0);
+    }
+
+    for (int start = 0 ; start < albumIDs.size() ; start += chunkSize)
+    {
+        QStringList ids;
+        const int end = qMin(start + chunkSize, albumIDs.size());
+
+        for (int i = start ; i < end ; ++i)
+        {
+            ids << QString::number(albumIDs.at(i));
+        }
+
+        QList<QVariant> values;
+        d->db->execSql(QString::fromUtf8("SELECT album, COUNT(*) FROM Images "
+                       " WHERE Images.status=1 AND album IN (%1) "
+                       " GROUP BY album;").arg(ids.join(QLatin1Char(','))), &values);
+
+        for (QList<QVariant>::const_iterator it = values.constBegin() ; it != values.constEnd() ;)
+        {
+            int albumID = (*it).toInt();
+            ++it;
+            albumsStatMap[albumID] = (*it).toInt();
+            ++it;
+        }
+    }
+
+    return albumsStatMap;
+}
+
 QMap<int, int> CoreDB::getNumberOfImagesInTags()
 {
     QList<QVariant> values, allTagIDs;
@@ -3472,6 +4039,44 @@ QMap<int, int> CoreDB::getNumberOfImagesInTags()
     return tagsStatMap;
 }
 
+QMap<int, int> CoreDB::getNumberOfImagesInTags(const QList<int>& tagIDs)
+{
+    QMap<int, int> tagsStatMap;
+    const int      chunkSize = 500;
+
+    foreach(int tagID, tagIDs)
+    {
+        tagsStatMap.insert(tagID, 0);
+    }
+
+    for (int start = 0 ; start < tagIDs.size() ; start += chunkSize)
+    {
+        QStringList ids;
+        const int end = qMin(start + chunkSize, tagIDs.size());
+
+        for (int i = start ; i < end ; ++i)
+        {
+            ids << QString::number(tagIDs.at(i));
+        }
+
+        QList<QVariant> values;
+        d->db->execSql(QString::fromUtf8("SELECT tagid, COUNT(*) FROM ImageTags "
+                       " INNER JOIN Images ON Images.id=ImageTags.imageid "
+                       " WHERE Images.status=1 AND tagid IN (%1) "
+                       " GROUP BY tagid;").arg(ids.join(QLatin1Char(','))), &values);
+
+        for (QList<QVariant>::const_iterator it = values.constBegin() ; it != values.constEnd() ;)
+        {
+            int tagID = (*it).toInt();
+            ++it;
+            tagsStatMap[tagID] = (*it).toInt();
+            ++it;
+        }
+    }
+
+    return tagsStatMap;
+}
+
 QMap<int, int> CoreDB::getNumberOfImagesInTagProperties(const QString& property)
 {
     QList<QVariant> values;
@@ -3730,6 +4335,8 @@ qlonglong CoreDB::addItem(int albumID, const QString& name,
 
     d->db->recordChangeset(ImageChangeset(id.toLongLong(), DatabaseFields::ImagesAll));
     d->db->recordChangeset(CollectionImageChangeset(id.toLongLong(), albumID, CollectionImageChangeset::Added));
+    updateFullTextIndex(QList<qlonglong>() << id.toLongLong());
+
     return id.toLongLong();
 }
 
@@ -3785,6 +4392,8 @@ void CoreDB::renameItem(qlonglong imageID, const QString& newName)
 {
     d->db->execSql(QString::fromUtf8("UPDATE Images SET name=? WHERE id=?;"),
                    newName, imageID);
+
+    updateFullTextIndex(QList<qlonglong>() << imageID);
 }
 
 /*
@@ -4212,6 +4821,50 @@ QList<qlonglong> CoreDB::getAllItems()
     return items;
 }
 
+QSet<QString> CoreDB::getAllUniqueHashes()
+{
+    QList<QVariant> values;
+
+    d->db->execSql(QString::fromUtf8("SELECT DISTINCT uniqueHash FROM Images;"),
+                    &values);
+
+    QSet<QString> hashes;
+
+    foreach(const QVariant& hash, values)
+    {
+        hashes << hash.toString();
+    }
+
+    return hashes;
+}
+
+QHash<qlonglong, QPair<int, int> > CoreDB::getAllVisibleItemsAlbumAndAlbumRoot()
+{
+    QList<QVariant> values;
+
+    d->db->execSql(QString::fromUtf8("SELECT Images.id, Images.album, Albums.albumRoot FROM Images "
+                                     " INNER JOIN Albums ON Albums.id=Images.album "
+                                     " WHERE Images.status=1;"),
+                   &values);
+
+    QHash<qlonglong, QPair<int, int> > items;
+    items.reserve(values.size() / 3);
+
+    for (QList<QVariant>::const_iterator it = values.constBegin() ; it != values.constEnd() ;)
+    {
+        qlonglong id    = (*it).toLongLong();
+        ++it;
+        int albumId     = (*it).toInt();
+        ++it;
+        int albumRootId = (*it).toInt();
+        ++it;
+
+        items.insert(id, qMakePair(albumId, albumRootId));
+    }
+
+    return items;
+}
+
 QList<ItemScanInfo> CoreDB::getItemScanInfos(int albumID)
 {
     QList<QVariant> values;
@@ -4546,6 +5199,12 @@ void CoreDB::deleteRemovedItems()
     d->db->execSql(QString::fromUtf8("DELETE FROM Images WHERE status=?;"),
                    (int)DatabaseItem::Obsolete);
 
+    if (hasFullTextIndex())
+    {
+        d->db->execSql(QString::fromUtf8("DELETE FROM ImageFullText WHERE %1 NOT IN (SELECT id FROM Images);")
+                       .arg(d->fullTextIdField()));
+    }
+
     d->db->recordChangeset(CollectionImageChangeset(QList<qlonglong>(), QList<int>(), CollectionImageChangeset::RemovedDeleted));
 }
 
@@ -4627,6 +5286,8 @@ void CoreDB::setTagName(int tagID, const QString& name)
     d->db->execSql(QString::fromUtf8("UPDATE Tags SET name=? WHERE id=?;"),
                    name, tagID);
     d->db->recordChangeset(TagChangeset(tagID, TagChangeset::Renamed));
+
+    updateFullTextIndex(getItemIDsInTag(tagID));
 }
 
 void CoreDB::moveItem(int srcAlbumID, const QString& srcName,
@@ -4646,6 +5307,7 @@ void CoreDB::moveItem(int srcAlbumID, const QString& srcName,
     d->db->execSql(QString::fromUtf8("UPDATE Images SET album=?, name=? "
                                      "WHERE id=?;"),
                    dstAlbumID, dstName, imageId);
+    updateFullTextIndex(QList<qlonglong>() << imageId);
     d->db->recordChangeset(CollectionImageChangeset(imageId, srcAlbumID, CollectionImageChangeset::Moved));
     d->db->recordChangeset(CollectionImageChangeset(imageId, srcAlbumID, CollectionImageChangeset::Removed));
     d->db->recordChangeset(CollectionImageChangeset(imageId, dstAlbumID, CollectionImageChangeset::Added));
@@ -4775,6 +5437,8 @@ void CoreDB::copyImageAttributes(qlonglong srcId, qlonglong dstId)
 
     copyImageTags(srcId, dstId);
     copyImageProperties(srcId, dstId);
+
+    updateFullTextIndex(QList<qlonglong>() << dstId);
 }
 
 void CoreDB::copyImageProperties(qlonglong srcId, qlonglong dstId)
@@ -4891,6 +5555,7 @@ void CoreDB::clearMetadataFromImage(qlonglong imageID)
         d->db->execSql(QString::fromUtf8("DELETE FROM ImageTags WHERE imageid=?;"),
                        imageID);
         d->db->recordChangeset(ImageTagChangeset(imageID, tagIds, ImageTagChangeset::RemovedAll));
+        updateFullTextIndex(QList<qlonglong>() << imageID);
     }
 
     QList<ImageTagProperty> properties = getImageTagProperties(imageID);
@@ -35,6 +35,8 @@
 #include <QDateTime>
 #include <QPair>
 #include <QMap>
+#include <QHash>
+#include <QSet>
 #include <QUuid>
 
 // Local includes
@@ -124,6 +126,59 @@ public:
 
     bool isUniqueHashV2();
 
+    // ----------- Full text index -----------
+
+    /**
+     * The text fields of the images stored in the full text index:
+     * the file name, the tag names, the comments and the titles.
+     */
+    enum FullTextField
+    {
+        FullTextName     = 0x01,
+        FullTextTags     = 0x02,
+        FullTextCaptions = 0x04,
+        FullTextTitles   = 0x08,
+        FullTextAll      = FullTextName | FullTextTags | FullTextCaptions | FullTextTitles
+    };
+
+    /**
+     * Returns the version of the full text index of this database, 0 if there is none.
+     * The index is a FTS5 table with SQLite and a table with FULLTEXT indexes with MySQL.
+     * The value is cached.
+     */
+    int  getFullTextIndexVersion();
+    void setFullTextIndexVersion(int version);
+    bool hasFullTextIndex();
+
+    /**
+     * Fill the full text index from the Images, ImageTags and ImageComments tables.
+     * The methods of this class changing the names, the tags or the comments of images
+     * update the index of these images. Call updateFullTextIndex() after changing them
+     * with other SQL statements.
+     */
+    void rebuildFullTextIndex();
+    void updateFullTextIndex(const QList<qlonglong>& imageIDs);
+
+    /**
+     * Returns an SQL condition matching the images with all the words of text,
+     * as word prefixes, in one of the given fields (a combination of FullTextField),
+     * and adds the values to bind to boundValues.
+     * Returns a null string if there is no full text index, or if it cannot be used
+     * for this text; the caller then needs to use LIKE conditions instead.
+     */
+    QString fullTextCondition(const QString& text, int fields, QList<QVariant>* const boundValues);
+
+    /**
+     * Only the versions of digiKam knowing the full text index maintain it: an older version,
+     * or another application sharing a MySQL server, leave it out of date.
+     * storeFullTextIndexState() records a fingerprint of the indexed tables when the database
+     * is closed, and isFullTextIndexStale() compares it when the database is opened again.
+     * The index is stale if the fingerprint changed or was never recorded. As the fingerprint
+     * is not updated after a crash, the index is then rebuilt as well.
+     */
+    void storeFullTextIndexState();
+    bool isFullTextIndexStale();
+
     // ----------- AlbumRoot operations -----------
 
     /**
@@ -360,6 +415,13 @@ public:
      */
     QMap<int, int> getNumberOfImagesInAlbums();
 
+    /**
+     * Returns a QMap<int,int> of album id -> count of items
+     * in the album, for the given albums only.
+     * Albums without items are returned with a count of 0.
+     */
+    QMap<int, int> getNumberOfImagesInAlbums(const QList<int>& albumIDs);
+
     // ----------- Operations on TAlbums -----------
 
     /**
@@ -632,6 +694,17 @@ public:
      */
     QList<qlonglong> getAllItems();
 
+    /**
+     * Returns the unique hashes of all items in images table.
+     */
+    QSet<QString> getAllUniqueHashes();
+
+    /**
+     * Returns the album id and the album root id of all visible items,
+     * in one query. The map key is the item id.
+     */
+    QHash<qlonglong, QPair<int, int> > getAllVisibleItemsAlbumAndAlbumRoot();
+
     /**
      * Returns the id of the item with the given filename in
      * the album with the given id.
@@ -702,6 +775,14 @@ public:
      */
     QMap<QDateTime, int> getAllCreationDatesAndNumberOfImages();
 
+    /**
+     * Returns a QMap<QDateTime,int> of creationDate -> count of items,
+     * restricted to the months of the creation dates of the given items.
+     * Each recounted month is present in the map at least with its first day,
+     * with a count of 0 if the month does not contain any item anymore.
+     */
+    QMap<QDateTime, int> getCreationDatesAndNumberOfImages(const QList<qlonglong>& imageIDs);
+
     // ----------- Item properties -----------
 
     /**
@@ -782,6 +863,16 @@ public:
      */
     QVariantList getImagesFields(qlonglong imageID, DatabaseFields::Images imagesFields);
 
+    /**
+     * Batch versions of getImagesFields() and getImageInformation() for a list of items,
+     * querying the database by chunks of ids instead of once per item.
+     * The values of each item are returned at the same position as the item in imageIDs,
+     * in the same order as for the single item versions. The list is empty if the item is not found.
+     */
+    QVector<QVariantList> getImagesFields(const QList<qlonglong>& imageIDs, DatabaseFields::Images imagesFields);
+    QVector<QVariantList> getImageInformation(const QList<qlonglong>& imageIDs,
+                                              DatabaseFields::ImageInformation imageInformationFields);
+
     /**
      * Add (or replace) the ImageInformation of the specified item.
      * If there is already an entry, it will be discarded.
@@ -802,6 +893,14 @@ public:
     void addImageInformation(qlonglong imageID, const QVariantList& infos,
                              DatabaseFields::ImageInformation fields = DatabaseFields::ImageInformationAll);
 
+    /**
+     * Add (or replace) the ImageInformation of several items at once,
+     * using multi-row statements. infos holds one list per item in imageIDs,
+     * each list containing the values indicated by fields, as for the method above.
+     */
+    void addImageInformation(const QList<qlonglong>& imageIDs, const QList<QVariantList>& infos,
+                             DatabaseFields::ImageInformation fields = DatabaseFields::ImageInformationAll);
+
     /**
      * Change the indicated fields of the image information for the specified item.
      * Fields not indicated by the fields parameter will not be touched.
@@ -844,6 +943,13 @@ public:
     void addImageMetadata(qlonglong imageID, const QVariantList& infos,
                           DatabaseFields::ImageMetadata fields = DatabaseFields::ImageMetadataAll);
 
+    /**
+     * Add (or replace) the ImageMetadata of several items at once, using multi-row statements.
+     * infos holds one list per item in imageIDs, as for the method above.
+     */
+    void addImageMetadata(const QList<qlonglong>& imageIDs, const QList<QVariantList>& infos,
+                          DatabaseFields::ImageMetadata fields = DatabaseFields::ImageMetadataAll);
+
     /**
      * Change the indicated fields of the image information for the specified item.
      * This method does nothing if the item does not yet have an entry in the ImageInformation table.
@@ -909,6 +1015,13 @@ public:
     void addImagePosition(qlonglong imageID, const QVariantList& infos,
                           DatabaseFields::ImagePositions fields = DatabaseFields::ImagePositionsAll);
 
+    /**
+     * Add (or replace) the ImagePosition of several items at once, using multi-row statements.
+     * infos holds one list per item in imageIDs, as for the method above.
+     */
+    void addImagePosition(const QList<qlonglong>& imageIDs, const QList<QVariantList>& infos,
+                          DatabaseFields::ImagePositions fields = DatabaseFields::ImagePositionsAll);
+
     /**
      * Change the indicated fields of the image information for the specified item.
      * This method does nothing if the item does not yet have an entry in the ImageInformation table.
@@ -1241,6 +1354,13 @@ public:
      */
     QMap<int, int> getNumberOfImagesInTags();
 
+    /**
+     * Returns a QMap<int,int> of tag id -> count of items
+     * with the tag, for the given tags only.
+     * Tags without items are returned with a count of 0.
+     */
+    QMap<int, int> getNumberOfImagesInTags(const QList<int>& tagIDs);
+
     /**
      * Returns a QMap<int,int> of tag id -> count of items
      * with the given tag property
@@ -1377,6 +1497,9 @@ private:
     void readSettings();
     void writeSettings();
 
+    void replaceImageRows(const QString& table, const QStringList& fieldNames,
+                          const QList<qlonglong>& imageIDs, const QList<QVariantList>& infos);
+
 private:
 
     class Private;
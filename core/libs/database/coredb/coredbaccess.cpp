@@ -85,20 +85,23 @@ public:
     bool                initializing;
 };
 
-class Q_DECL_HIDDEN CoreDbAccessMutexLocker : public QMutexLocker
+class Q_DECL_HIDDEN CoreDbAccessMutexLocker
 {
 public:
 
     explicit CoreDbAccessMutexLocker(CoreDbAccessStaticPriv* const d)
-        : QMutexLocker(&d->lock.mutex),
-          d(d)
+        : d(d)
     {
+        d->lock.lockForWriting();
+        d->lock.mutex.lock();
         d->lock.lockCount++;
     }
 
     ~CoreDbAccessMutexLocker()
     {
         d->lock.lockCount--;
+        d->lock.mutex.unlock();
+        d->lock.unlockForWriting();
     }
 
 public:
@@ -113,6 +116,7 @@ CoreDbAccess::CoreDbAccess()
     // You will want to call setParameters before constructing CoreDbAccess
     Q_ASSERT(d);
 
+    d->lock.lockForWriting();
     d->lock.mutex.lock();
     d->lock.lockCount++;
 
@@ -133,12 +137,14 @@ CoreDbAccess::~CoreDbAccess()
 {
     d->lock.lockCount--;
     d->lock.mutex.unlock();
+    d->lock.unlockForWriting();
 }
 
 CoreDbAccess::CoreDbAccess(bool)
 {
     // private constructor, when mutex is locked and
     // backend should not be checked
+    d->lock.lockForWriting();
     d->lock.mutex.lock();
     d->lock.lockCount++;
 }
@@ -199,6 +205,11 @@ void CoreDbAccess::setParameters(const DbEngineParameters& parameters, Applicati
     if (!d)
     {
         d = new CoreDbAccessStaticPriv();
+
+        // Read-only operations using CoreDbReadAccess run concurrently,
+        // on their own connection, only waiting for the writers.
+        // With SQLite, the tuning profile must enable write-ahead logging.
+        d->lock.allowConcurrentReaders = true;
     }
 
     CoreDbAccessMutexLocker lock(d);
@@ -210,6 +221,7 @@ void CoreDbAccess::setParameters(const DbEngineParameters& parameters, Applicati
 
     if (d->backend && d->backend->isOpen())
     {
+        d->db->storeFullTextIndexState();
         d->backend->close();
     }
 
@@ -346,6 +358,11 @@ void CoreDbAccess::cleanUpDatabase()
 
         if (d->backend)
         {
+            if (d->backend->isOpen())
+            {
+                d->db->storeFullTextIndexState();
+            }
+
             d->backend->close();
             delete d->db;
             delete d->backend;
@@ -359,7 +376,54 @@ void CoreDbAccess::cleanUpDatabase()
 
 // ----------------------------------------------------------------------
 
+CoreDbReadAccess::CoreDbReadAccess()
+    : m_access(0)
+{
+    // You will want to call setParameters before constructing CoreDbReadAccess
+    Q_ASSERT(CoreDbAccess::d);
+
+    if (CoreDbAccess::d->lock.lockForReading())
+    {
+        if (CoreDbAccess::d->backend->isOpen())
+        {
+            return;
+        }
+
+        // opening the database is a write operation
+        CoreDbAccess::d->lock.unlockForReading();
+    }
+
+    // concurrent readers disabled, or nested in a CoreDbAccess of this thread
+    m_access = new CoreDbAccess;
+}
+
+CoreDbReadAccess::~CoreDbReadAccess()
+{
+    if (m_access)
+    {
+        delete m_access;
+    }
+    else
+    {
+        CoreDbAccess::d->lock.unlockForReading();
+    }
+}
+
+CoreDB* CoreDbReadAccess::db() const
+{
+    return CoreDbAccess::d->db;
+}
+
+CoreDbBackend* CoreDbReadAccess::backend() const
+{
+    return CoreDbAccess::d->backend;
+}
+
+// ----------------------------------------------------------------------
+
 CoreDbAccessUnlock::CoreDbAccessUnlock()
+    : count(0),
+      writers(0)
 {
     // acquire lock
     CoreDbAccess::d->lock.mutex.lock();
@@ -370,6 +434,9 @@ CoreDbAccessUnlock::CoreDbAccessUnlock()
     // set lock count to 0
     CoreDbAccess::d->lock.lockCount = 0;
 
+    // release the write lock
+    writers = CoreDbAccess::d->lock.suspendWriting();
+
     // unlock
     for (int i = 0 ; i < count ; ++i)
     {
@@ -381,6 +448,8 @@ CoreDbAccessUnlock::CoreDbAccessUnlock()
 }
 
 CoreDbAccessUnlock::CoreDbAccessUnlock(CoreDbAccess* const)
+    : count(0),
+      writers(0)
 {
     // With the passed pointer, we have assured that the mutex is acquired
     // Store lock count
@@ -389,6 +458,9 @@ CoreDbAccessUnlock::CoreDbAccessUnlock(CoreDbAccess* const)
     // set lock count to 0
     CoreDbAccess::d->lock.lockCount = 0;
 
+    // release the write lock
+    writers = CoreDbAccess::d->lock.suspendWriting();
+
     // unlock
     for (int i = 0 ; i < count ; ++i)
     {
@@ -400,6 +472,9 @@ CoreDbAccessUnlock::CoreDbAccessUnlock(CoreDbAccess* const)
 
 CoreDbAccessUnlock::~CoreDbAccessUnlock()
 {
+    // the write lock is acquired before the mutex
+    CoreDbAccess::d->lock.resumeWriting(writers);
+
     // lock as often as it was locked before
     for (int i = 0 ; i < count ; ++i)
     {
@@ -150,6 +150,34 @@ private:
 
 // -----------------------------------------------------------------------------
 
+/**
+ * The CoreDbReadAccess provides access to the database for read-only operations.
+ * Use it as CoreDbAccess, but only to execute queries which do not write to the database:
+ * read accesses from different threads run concurrently, each with the connection of its
+ * thread, and only wait for the running CoreDbAccess writers.
+ * A CoreDbAccess created while holding a CoreDbReadAccess in the same thread
+ * only excludes the other writers. Nested in a CoreDbAccess of the same thread,
+ * a CoreDbReadAccess behaves as a CoreDbAccess.
+ */
+class DIGIKAM_DATABASE_EXPORT CoreDbReadAccess
+{
+public:
+
+    explicit CoreDbReadAccess();
+    ~CoreDbReadAccess();
+
+    CoreDB*        db()      const;
+    CoreDbBackend* backend() const;
+
+private:
+
+    CoreDbReadAccess(const CoreDbReadAccess&); // Disable
+
+    CoreDbAccess* m_access;
+};
+
+// -----------------------------------------------------------------------------
+
 class CoreDbAccessUnlock
 {
 public:
@@ -168,6 +196,7 @@ public:
 private:
 
     int count;
+    int writers;
 };
 
 } // namespace Digikam
@@ -171,6 +171,9 @@ void CoreDbCopyManager::copyDatabases(const DbEngineParameters& fromDBParameters
         }
     }
 
+    // The full text index is not copied, it is rebuilt when the target database is opened.
+    albumDB.setFullTextIndexVersion(0);
+
     fromDBbackend.close();
     toDBbackend.close();
 
@@ -69,6 +69,11 @@ int CoreDbSchemaUpdater::uniqueHashVersion()
     return 2;
 }
 
+int CoreDbSchemaUpdater::fullTextIndexVersion()
+{
+    return 1;
+}
+
 bool CoreDbSchemaUpdater::isUniqueHashUpToDate()
 {
     return CoreDbAccess().db()->getUniqueHashVersion() >= uniqueHashVersion();
@@ -151,6 +156,7 @@ bool CoreDbSchemaUpdater::update()
     }
 
     updateFilterSettings();
+    updateFullTextIndex();
 
     if (d->observer)
     {
@@ -540,6 +546,39 @@ bool CoreDbSchemaUpdater::updateFilterSettings()
     return true;
 }
 
+bool CoreDbSchemaUpdater::updateFullTextIndex()
+{
+    // The full text index is not part of the schema versions: it is optional,
+    // SQLite may be built without FTS5 and older MySQL servers lack InnoDB FULLTEXT indexes.
+    // Without it, the searches use LIKE conditions.
+    if (d->albumDB->getFullTextIndexVersion() == fullTextIndexVersion())
+    {
+        if (!d->albumDB->isFullTextIndexStale())
+        {
+            return true;
+        }
+
+        // Written by an older version or another application since it was last closed.
+        qCDebug(DIGIKAM_COREDB_LOG) << "Core database: the full text index is out of date";
+    }
+    else if (!d->backend->execDBAction(d->backend->getDBAction(QLatin1String("CreateFullTextIndex"))))
+    {
+        qCDebug(DIGIKAM_COREDB_LOG) << "Core database: full text index is not supported, text searches will not be indexed";
+        d->albumDB->setFullTextIndexVersion(0);
+        return false;
+    }
+
+    qCDebug(DIGIKAM_COREDB_LOG) << "Core database: building the full text index";
+
+    d->backend->beginTransaction();
+    d->albumDB->rebuildFullTextIndex();
+    d->backend->commitTransaction();
+
+    d->albumDB->setFullTextIndexVersion(fullTextIndexVersion());
+    d->albumDB->storeFullTextIndexState();
+    return true;
+}
+
 bool CoreDbSchemaUpdater::createDatabase()
 {
     if ( createTables() && createIndices() && createTriggers())
@@ -62,7 +62,17 @@ void AlbumsJob::run()
 {
     if (m_jobInfo.isFoldersJob())
     {
-        QMap<int, int> albumNumberMap = CoreDbAccess().db()->getNumberOfImagesInAlbums();
+        QMap<int, int> albumNumberMap;
+
+        if (m_jobInfo.albumsIds().isEmpty())
+        {
+            albumNumberMap = CoreDbAccess().db()->getNumberOfImagesInAlbums();
+        }
+        else
+        {
+            albumNumberMap = CoreDbAccess().db()->getNumberOfImagesInAlbums(m_jobInfo.albumsIds());
+        }
+
         emit foldersData(albumNumberMap);
     }
     else
@@ -96,7 +106,17 @@ void DatesJob::run()
 {
     if (m_jobInfo.isFoldersJob())
     {
-        QMap<QDateTime, int> dateNumberMap = CoreDbAccess().db()->getAllCreationDatesAndNumberOfImages();
+        QMap<QDateTime, int> dateNumberMap;
+
+        if (m_jobInfo.imageIds().isEmpty())
+        {
+            dateNumberMap = CoreDbAccess().db()->getAllCreationDatesAndNumberOfImages();
+        }
+        else
+        {
+            dateNumberMap = CoreDbAccess().db()->getCreationDatesAndNumberOfImages(m_jobInfo.imageIds());
+        }
+
         emit foldersData(dateNumberMap);
     }
     else
@@ -177,7 +197,17 @@ void TagsJob::run()
 {
     if (m_jobInfo.isFoldersJob())
     {
-        QMap<int, int> tagNumberMap = CoreDbAccess().db()->getNumberOfImagesInTags();
+        QMap<int, int> tagNumberMap;
+
+        if (m_jobInfo.tagsIds().isEmpty())
+        {
+            tagNumberMap = CoreDbAccess().db()->getNumberOfImagesInTags();
+        }
+        else
+        {
+            tagNumberMap = CoreDbAccess().db()->getNumberOfImagesInTags(m_jobInfo.tagsIds());
+        }
+
         //qCDebug(DIGIKAM_DBJOB_LOG) << tagNumberMap;
         emit foldersData(tagNumberMap);
     }
@@ -74,10 +74,17 @@ public:
     void setAlbum(const QString& album);
     QString album();
 
+    /**
+     * With a folders job, only count the items of these albums.
+     */
+    void setAlbumsIds(const QList<int>& albumsIds);
+    QList<int> albumsIds() const;
+
 private:
 
-    int     m_albumRootId;
-    QString m_album;
+    int        m_albumRootId;
+    QString    m_album;
+    QList<int> m_albumsIds;
 };
 
 // ---------------------------------------------
@@ -94,6 +101,9 @@ public:
     void setSpecialTag(const QString& tag);
     QString specialTag() const;
 
+    /**
+     * With a folders job, only count the items of these tags.
+     */
     void setTagsIds(const QList<int>& tagsIds);
     QList<int> tagsIds() const;
 
@@ -203,10 +213,17 @@ public:
     void setEndDate(const QDate& date);
     QDate endDate() const;
 
+    /**
+     * With a folders job, only count the items of the months of these items.
+     */
+    void setImageIds(const QList<qlonglong>& imageIds);
+    QList<qlonglong> imageIds() const;
+
 private:
 
-    QDate m_startDate;
-    QDate m_endDate;
+    QDate            m_startDate;
+    QDate            m_endDate;
+    QList<qlonglong> m_imageIds;
 };
 
 } // namespace Digikam
@@ -50,10 +50,102 @@ namespace Digikam
 
 DbEngineLocking::DbEngineLocking()
     : mutex(QMutex::Recursive),
-      lockCount(0) // create a recursive mutex
+      lockCount(0), // create a recursive mutex
+      allowConcurrentReaders(false),
+      concurrentReaders(false),
+      readWriteLock(QReadWriteLock::Recursive)
 {
 }
 
+void DbEngineLocking::lockForWriting()
+{
+    ThreadState& state = threadState.localData();
+
+    // A reader thread cannot wait for its own read lock to become a writer.
+    // It is still excluded from the other writers by the mutex.
+    if (!state.writers++ && concurrentReaders && !state.readers)
+    {
+        readWriteLock.lockForWrite();
+        state.exclusive = true;
+    }
+}
+
+void DbEngineLocking::unlockForWriting()
+{
+    ThreadState& state = threadState.localData();
+
+    if (!--state.writers && state.exclusive)
+    {
+        state.exclusive = false;
+        readWriteLock.unlock();
+    }
+}
+
+bool DbEngineLocking::lockForReading()
+{
+    ThreadState& state = threadState.localData();
+
+    if (!concurrentReaders || state.writers)
+    {
+        return false;
+    }
+
+    readWriteLock.lockForRead();
+    state.readers++;
+
+    return true;
+}
+
+void DbEngineLocking::unlockForReading()
+{
+    threadState.localData().readers--;
+    readWriteLock.unlock();
+}
+
+bool DbEngineLocking::isReaderOnly()
+{
+    if (!threadState.hasLocalData())
+    {
+        return false;
+    }
+
+    const ThreadState& state = threadState.localData();
+
+    return (state.readers && !state.writers);
+}
+
+int DbEngineLocking::suspendWriting()
+{
+    ThreadState& state = threadState.localData();
+    int writers        = state.writers;
+    state.writers      = 0;
+
+    if (state.exclusive)
+    {
+        state.exclusive = false;
+        readWriteLock.unlock();
+    }
+
+    return writers;
+}
+
+void DbEngineLocking::resumeWriting(int writers)
+{
+    if (!writers)
+    {
+        return;
+    }
+
+    ThreadState& state = threadState.localData();
+    state.writers      = writers;
+
+    if (concurrentReaders && !state.readers)
+    {
+        readWriteLock.lockForWrite();
+        state.exclusive = true;
+    }
+}
+
 // -----------------------------------------------------------------------------------------
 
 BdEngineBackendPrivate::BusyWaiter::BusyWaiter(BdEngineBackendPrivate* const d)
@@ -111,7 +203,6 @@ void DbEngineThreadData::closeDatabase()
 
 BdEngineBackendPrivate::BdEngineBackendPrivate(BdEngineBackend* const backend)
     : currentValidity(0),
-      isInTransaction(false),
       status(BdEngineBackend::Unavailable),
       lock(0),
       operationStatus(BdEngineBackend::ExecuteNormal),
@@ -170,6 +261,11 @@ QSqlDatabase BdEngineBackendPrivate::databaseForThread()
         if (threadData->database.open())
         {
             threadData->valid = currentValidity;
+
+            if (parameters.isSQLite())
+            {
+                applySQLiteTuning(threadData->database);
+            }
         }
         else
         {
@@ -190,7 +286,14 @@ QSqlDatabase BdEngineBackendPrivate::createDatabaseConnection()
     {
         QStringList toAdd;
         // enable shared cache, especially useful with SQLite >= 3.5.0
-        toAdd << QLatin1String("QSQLITE_ENABLE_SHARED_CACHE");
+        // NOTE: not with concurrent readers: its table level locks would serialize the connections
+        // of the threads again, while with write-ahead logging they can read concurrently.
+        // Without write-ahead logging, concurrent readers are disabled and the shared cache is used.
+        if (!lock->concurrentReaders)
+        {
+            toAdd << QLatin1String("QSQLITE_ENABLE_SHARED_CACHE");
+        }
+
         // We do our own waiting.
         toAdd << QLatin1String("QSQLITE_BUSY_TIMEOUT=0");
 
@@ -212,6 +315,77 @@ QSqlDatabase BdEngineBackendPrivate::createDatabaseConnection()
     return db;
 }
 
+DbEngineAction BdEngineBackendPrivate::sqliteTuningAction() const
+{
+    // The PRAGMA statements of the tuning profile are read from dbconfig.xml.
+    QString profile = parameters.sqliteTuningProfile.isEmpty() ? DbEngineParameters::SQLiteDefaultTuningProfile()
+                                                               : parameters.sqliteTuningProfile;
+
+    // A database can override the profile, ie. "SQLiteTuning_Throughput_thumbnailDatabase".
+    QString database = backendName;
+    database.remove(QLatin1Char('-'));
+
+    const QMap<QString, DbEngineAction>& actions = DbEngineConfig::element(parameters.databaseType).sqlStatements;
+    DbEngineAction action                        = actions.value(QLatin1String("SQLiteTuning_") + profile + QLatin1Char('_') + database);
+
+    if (action.name.isNull())
+    {
+        action = actions.value(QLatin1String("SQLiteTuning_") + profile);
+    }
+
+    if (action.name.isNull())
+    {
+        qCWarning(DIGIKAM_DBENGINE_LOG) << "Unknown SQLite tuning profile" << profile;
+    }
+
+    return action;
+}
+
+bool BdEngineBackendPrivate::sqliteWriteAheadLogging() const
+{
+    const QRegExp wal(QLatin1String("journal_mode\\s*=\\s*WAL"), Qt::CaseInsensitive);
+
+    foreach(const DbEngineActionElement& element, sqliteTuningAction().dbActionElements)
+    {
+        if (element.statement.contains(wal))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void BdEngineBackendPrivate::applySQLiteTuning(QSqlDatabase& db)
+{
+    // Most PRAGMA statements are per connection, so they are applied to each new connection.
+    // The journal mode is persistent in the database file.
+    foreach(const DbEngineActionElement& element, sqliteTuningAction().dbActionElements)
+    {
+        QSqlQuery query(db);
+
+        if (!query.exec(element.statement))
+        {
+            qCDebug(DIGIKAM_DBENGINE_LOG) << "Cannot apply SQLite tuning statement" << element.statement
+                                          << ":" << query.lastError();
+        }
+    }
+
+    if (lock->concurrentReaders)
+    {
+        // SQLite answers the journal mode in use, which is not WAL if it cannot be enabled,
+        // ie. on a network file system: the readers then wait for the writer.
+        QSqlQuery query(db);
+
+        if (query.exec(QLatin1String("PRAGMA journal_mode;")) && query.next() &&
+            query.value(0).toString().compare(QLatin1String("wal"), Qt::CaseInsensitive) != 0)
+        {
+            qCWarning(DIGIKAM_DBENGINE_LOG) << "Write-ahead logging is not available, journal mode is"
+                                            << query.value(0).toString();
+        }
+    }
+}
+
 void BdEngineBackendPrivate::closeDatabaseForThread()
 {
     if (threadDataStorage.hasLocalData())
@@ -490,16 +664,28 @@ void BdEngineBackendPrivate::connectionErrorAbortQueries()
 
 BdEngineBackendPrivate::AbstractUnlocker::AbstractUnlocker(BdEngineBackendPrivate* const d)
     : count(0),
+      writers(0),
+      reader(false),
       d(d)
 {
     // Why two mutexes? The main mutex is recursive and won't work with a condvar.
 
+    // A concurrent reader does not hold the main mutex, and must not wait for it:
+    // a writer may hold it while the other writers wait for the readers.
+    if (d->lock->isReaderOnly())
+    {
+        reader = true;
+        return;
+    }
+
     // acquire lock
     d->lock->mutex.lock();
     // store lock count
     count = d->lock->lockCount;
     // set lock count to 0
     d->lock->lockCount = 0;
+    // let the concurrent readers and the other writers in
+    writers = d->lock->suspendWriting();
 
     // unlock
     for (int i = 0 ; i < count ; ++i)
@@ -510,6 +696,11 @@ BdEngineBackendPrivate::AbstractUnlocker::AbstractUnlocker(BdEngineBackendPrivat
 
 void BdEngineBackendPrivate::AbstractUnlocker::finishAcquire()
 {
+    if (reader)
+    {
+        return;
+    }
+
     // drop lock acquired in first line. Main mutex is now free.
     // We maintain lock order (first main mutex, second error lock mutex)
     // but we drop main mutex lock for waiting on the cond var.
@@ -518,6 +709,9 @@ void BdEngineBackendPrivate::AbstractUnlocker::finishAcquire()
 
 BdEngineBackendPrivate::AbstractUnlocker::~AbstractUnlocker()
 {
+    // the write lock is acquired before the main mutex
+    d->lock->resumeWriting(writers);
+
     // lock main mutex as often as it was locked before
     for (int i = 0 ; i < count ; ++i)
     {
@@ -623,6 +817,53 @@ BdEngineBackend::DbType BdEngineBackend::databaseType() const
     return d->parameters.isSQLite() ? DbType::SQLite : DbType::MySQL;
 }
 
+QList<QPair<QString, QString> > BdEngineBackend::sqliteTuningSettings()
+{
+    Q_D(BdEngineBackend);
+
+    QList<QPair<QString, QString> > settings;
+
+    if (!d->parameters.isSQLite())
+    {
+        return settings;
+    }
+
+    const QStringList synchronousModes = QStringList() << QLatin1String("OFF")     << QLatin1String("NORMAL")
+                                                       << QLatin1String("FULL")    << QLatin1String("EXTRA");
+    const QStringList tempStoreModes   = QStringList() << QLatin1String("DEFAULT") << QLatin1String("FILE")
+                                                       << QLatin1String("MEMORY");
+    const QStringList pragmas          = QStringList() << QLatin1String("journal_mode") << QLatin1String("synchronous")
+                                                       << QLatin1String("cache_size")   << QLatin1String("mmap_size")
+                                                       << QLatin1String("temp_store");
+
+    QSqlDatabase db = d->databaseForThread();
+
+    foreach(const QString& pragma, pragmas)
+    {
+        QSqlQuery query(db);
+
+        if (!query.exec(QString::fromLatin1("PRAGMA %1;").arg(pragma)) || !query.next())
+        {
+            continue;
+        }
+
+        QString value = query.value(0).toString();
+
+        if (pragma == QLatin1String("synchronous"))
+        {
+            value = synchronousModes.value(value.toInt(), value);
+        }
+        else if (pragma == QLatin1String("temp_store"))
+        {
+            value = tempStoreModes.value(value.toInt(), value);
+        }
+
+        settings << qMakePair(pragma, value);
+    }
+
+    return settings;
+}
+
 BdEngineBackend::QueryState BdEngineBackend::execDBAction(const DbEngineAction& action,
                                                           QList<QVariant>* const values,
                                                           QVariant* const lastInsertId)
@@ -779,6 +1020,10 @@ bool BdEngineBackend::open(const DbEngineParameters& parameters)
     // This will make possibly opened thread dbs reload at next access
     d->currentValidity++;
 
+    // SQLite readers only run concurrently with write-ahead logging.
+    d->lock->concurrentReaders = d->lock->allowConcurrentReaders &&
+                                 (!parameters.isSQLite() || d->sqliteWriteAheadLogging());
+
     int retries = 0;
 
     forever
@@ -1664,7 +1909,6 @@ BdEngineBackend::QueryState BdEngineBackend::beginTransaction()
             }
         }
 
-        d->isInTransaction = true;
     }
 
     return BdEngineBackend::QueryState(BdEngineBackend::NoErrors);
@@ -1710,7 +1954,6 @@ BdEngineBackend::QueryState BdEngineBackend::commitTransaction()
             }
         }
 
-        d->isInTransaction = false;
         d->transactionFinished();
     }
 
@@ -1720,7 +1963,9 @@ BdEngineBackend::QueryState BdEngineBackend::commitTransaction()
 bool BdEngineBackend::isInTransaction() const
 {
     Q_D(const BdEngineBackend);
-    return d->isInTransaction;
+
+    // Transactions are per connection, hence per thread.
+    return (d->threadDataStorage.hasLocalData() && d->threadDataStorage.localData()->transactionCount);
 }
 
 void BdEngineBackend::rollbackTransaction()
@@ -30,10 +30,12 @@
 #include <QMap>
 #include <QMutex>
 #include <QObject>
+#include <QReadWriteLock>
 #include <QString>
 #include <QStringList>
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QThreadStorage>
 
 // Local includes
 
@@ -54,10 +56,68 @@ public:
 
     explicit DbEngineLocking();
 
+    /**
+     * Writers serialize on the recursive mutex, counting the recursion in lockCount.
+     * If concurrent readers are enabled, writers also hold the read-write lock for writing,
+     * acquired before the mutex, while readers only hold it for reading and never take
+     * the mutex: readers run concurrently with each other, each with the connection of its
+     * thread, and only writers serialize.
+     * Call lockForWriting() before locking the mutex and unlockForWriting() after unlocking it.
+     */
+    void lockForWriting();
+    void unlockForWriting();
+
+    /**
+     * Acquire the lock for reading. Returns false if concurrent readers are disabled
+     * or if the calling thread is a writer: then the caller shall act as a writer.
+     */
+    bool lockForReading();
+    void unlockForReading();
+
+    /**
+     * Returns true if the calling thread is a reader and not a writer.
+     */
+    bool isReaderOnly();
+
+    /**
+     * Used by the unlockers: release the write lock held by the calling thread
+     * and return the recursion count, which must be given back to resumeWriting().
+     */
+    int  suspendWriting();
+    void resumeWriting(int writers);
+
 public:
 
-    QMutex mutex;
-    int    lockCount;
+    QMutex             mutex;
+    int                lockCount;
+
+    /// Set by the owner of the database if its read-only accesses may run concurrently.
+    bool               allowConcurrentReaders;
+
+    /// Set by the backend when opening the database: SQLite needs write-ahead logging
+    /// for concurrent readers, which is enabled by the tuning profile.
+    bool               concurrentReaders;
+    QReadWriteLock     readWriteLock;
+
+private:
+
+    class ThreadState
+    {
+    public:
+
+        ThreadState()
+            : readers(0),
+              writers(0),
+              exclusive(false)
+        {
+        }
+
+        int  readers;
+        int  writers;
+        bool exclusive;
+    };
+
+    QThreadStorage<ThreadState> threadState;
 };
 
 // -----------------------------------------------------------------
@@ -216,6 +276,13 @@ public:
      */
     DbType databaseType() const;
 
+    /**
+     * For SQLite, return the values of the tuning PRAGMAs (journal_mode, synchronous, cache_size,
+     * mmap_size and temp_store) active on the connection of the current thread.
+     * Return an empty list with other database types.
+     */
+    QList<QPair<QString, QString> > sqliteTuningSettings();
+
     /**
      * Returns a database action with name, specified in actionName,
      * for the current database.
@@ -429,7 +496,7 @@ public:
     void rollbackTransaction();
 
     /**
-     * Returns if the database is in a different thread in a transaction.
+     * Returns if the connection of the calling thread is in a transaction.
      * Note that a transaction does not require holding CoreDbAccess.
      * Note that this does not give information about other processes
      * locking the database.
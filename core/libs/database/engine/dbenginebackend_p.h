@@ -72,7 +72,10 @@ public:
     QSqlError    databaseErrorForThread();
     void         setDatabaseErrorForThread(const QSqlError& lastError);
 
-    QSqlDatabase createDatabaseConnection();
+    QSqlDatabase   createDatabaseConnection();
+    DbEngineAction sqliteTuningAction() const;
+    bool           sqliteWriteAheadLogging() const;
+    void           applySQLiteTuning(QSqlDatabase& db);
     void closeDatabaseForThread();
     bool incrementTransactionCount();
     bool decrementTransactionCount();
@@ -107,8 +110,6 @@ public:
     // This compares to DbEngineThreadData's valid. If currentValidity is increased and > valid, the db is marked as invalid
     int                                       currentValidity;
 
-    bool                                      isInTransaction;
-
     QString                                   backendName;
 
     DbEngineParameters                        parameters;
@@ -142,6 +143,8 @@ public:
     protected:
 
         int                           count;
+        int                           writers;
+        bool                          reader;
         BdEngineBackendPrivate* const d;
     };
 
@@ -61,6 +61,7 @@ static const char* configDatabasePort                       = "Database Port";
 static const char* configDatabaseUsername                   = "Database Username";
 static const char* configDatabasePassword                   = "Database Password";
 static const char* configDatabaseConnectOptions             = "Database Connectoptions";
+static const char* configDatabaseSQLiteTuningProfile        = "Database SQLite Tuning Profile";
 // Legacy for older versions.
 static const char* configDatabaseFilePathEntry              = "Database File Path";
 static const char* configAlbumPathEntry                     = "Album Path";
@@ -83,7 +84,8 @@ QString DbEngineParameters::internalServerPrivatePath()
 
 DbEngineParameters::DbEngineParameters()
     : port(-1),
-      internalServer(false)
+      internalServer(false),
+      sqliteTuningProfile(SQLiteDefaultTuningProfile())
 {
 }
 
@@ -115,14 +117,16 @@ DbEngineParameters::DbEngineParameters(const QString& _type,
       databaseNameSimilarity(_databaseNameSimilarity),
       internalServerDBPath(_internalServerDBPath),
       internalServerMysqlServCmd(_internalServerMysqlServCmd),
-      internalServerMysqlInitCmd(_internalServerMysqlInitCmd)
+      internalServerMysqlInitCmd(_internalServerMysqlInitCmd),
+      sqliteTuningProfile(SQLiteDefaultTuningProfile())
 {
 }
 
 // Note no need to 
 DbEngineParameters::DbEngineParameters(const QUrl& url)
     : port(-1),
-      internalServer(false)
+      internalServer(false),
+      sqliteTuningProfile(SQLiteDefaultTuningProfile())
 {
     databaseType           = QUrlQuery(url).queryItemValue(QLatin1String("databaseType"));
     databaseNameCore       = QUrlQuery(url).queryItemValue(QLatin1String("databaseNameCore"));
@@ -138,6 +142,13 @@ DbEngineParameters::DbEngineParameters(const QUrl& url)
         port = queryPort.toInt();
     }
 
+    QString queryTuning    = QUrlQuery(url).queryItemValue(QLatin1String("sqliteTuningProfile"));
+
+    if (!queryTuning.isEmpty())
+    {
+        sqliteTuningProfile = queryTuning;
+    }
+
 #if defined(HAVE_MYSQLSUPPORT) && defined(HAVE_INTERNALMYSQL)
     QString queryServer = QUrlQuery(url).queryItemValue(QLatin1String("internalServer"));
 
@@ -183,6 +194,11 @@ void DbEngineParameters::insertInUrl(QUrl& url) const
         q.addQueryItem(QLatin1String("connectOptions"), connectOptions);
     }
 
+    if (!sqliteTuningProfile.isNull())
+    {
+        q.addQueryItem(QLatin1String("sqliteTuningProfile"), sqliteTuningProfile);
+    }
+
     if (!hostName.isNull())
     {
         q.addQueryItem(QLatin1String("hostName"), hostName);
@@ -224,6 +240,7 @@ void DbEngineParameters::removeFromUrl(QUrl& url)
     q.removeQueryItem(QLatin1String("databaseNameFace"));
     q.removeQueryItem(QLatin1String("databaseNameSimilarity"));
     q.removeQueryItem(QLatin1String("connectOptions"));
+    q.removeQueryItem(QLatin1String("sqliteTuningProfile"));
     q.removeQueryItem(QLatin1String("hostName"));
     q.removeQueryItem(QLatin1String("port"));
     q.removeQueryItem(QLatin1String("internalServer"));
@@ -244,6 +261,7 @@ bool DbEngineParameters::operator==(const DbEngineParameters& other) const
            databaseNameFace           == other.databaseNameFace           &&
            databaseNameSimilarity     == other.databaseNameSimilarity     &&
            connectOptions             == other.connectOptions             &&
+           sqliteTuningProfile        == other.sqliteTuningProfile        &&
            hostName                   == other.hostName                   &&
            port                       == other.port                       &&
            internalServer             == other.internalServer             &&
@@ -289,6 +307,16 @@ QString DbEngineParameters::MySQLDatabaseType()
     return QLatin1String("QMYSQL");
 }
 
+QString DbEngineParameters::SQLiteDefaultTuningProfile()
+{
+    return QLatin1String("Default");
+}
+
+QString DbEngineParameters::SQLiteThroughputTuningProfile()
+{
+    return QLatin1String("Throughput");
+}
+
 QString DbEngineParameters::SQLiteDatabaseFile() const
 {
     if (isSQLite())
@@ -361,6 +389,7 @@ void DbEngineParameters::readFromConfig(KSharedConfig::Ptr config, const QString
     userName                   = group.readEntry(configDatabaseUsername,                   QString());
     password                   = group.readEntry(configDatabasePassword,                   QString());
     connectOptions             = group.readEntry(configDatabaseConnectOptions,             QString());
+    sqliteTuningProfile        = group.readEntry(configDatabaseSQLiteTuningProfile,        SQLiteDefaultTuningProfile());
 #if defined(HAVE_MYSQLSUPPORT) && defined(HAVE_INTERNALMYSQL)
     internalServer             = group.readEntry(configInternalDatabaseServer,             false);
     internalServerDBPath       = group.readEntry(configInternalDatabaseServerPath,         internalServerPrivatePath());
@@ -591,6 +620,7 @@ void DbEngineParameters::writeToConfig(KSharedConfig::Ptr config, const QString&
     group.writeEntry(configDatabaseUsername,                   userName);
     group.writeEntry(configDatabasePassword,                   password);
     group.writeEntry(configDatabaseConnectOptions,             connectOptions);
+    group.writeEntry(configDatabaseSQLiteTuningProfile,        sqliteTuningProfile);
     group.writeEntry(configInternalDatabaseServer,             internalServer);
     group.writeEntry(configInternalDatabaseServerPath,         internalServerDBPath);
     group.writeEntry(configInternalDatabaseServerMysqlServCmd, internalServerMysqlServCmd);
@@ -796,6 +826,7 @@ QDebug operator<<(QDebug dbg, const DbEngineParameters& p)
     dbg.nospace() << "   DB Face Name:             " << p.databaseNameFace                                  << endl;
     dbg.nospace() << "   DB Similyritiy Name:      " << p.databaseNameSimilarity                            << endl;
     dbg.nospace() << "   Connect Options:          " << p.connectOptions                                    << endl;
+    dbg.nospace() << "   SQLite Tuning Profile:    " << p.sqliteTuningProfile                               << endl;
     dbg.nospace() << "   Host Name:                " << p.hostName                                          << endl;
     dbg.nospace() << "   Host port:                " << p.port                                              << endl;
     dbg.nospace() << "   Internal Server:          " << p.internalServer                                    << endl;
@@ -100,6 +100,15 @@ public:
     static QString SQLiteDatabaseType();
     static QString MySQLDatabaseType();
 
+    /**
+     *  Returns the names of the SQLite tuning profiles. A profile is a set of PRAGMA statements
+     *  applied to each new SQLite connection, defined as "SQLiteTuning_<name>" action in dbconfig.xml.
+     *  A "SQLiteTuning_<name>_<database>" action overrides it for one database, ie. thumbnailDatabase.
+     *  The throughput profile trades durability on power loss for speed with big collections.
+     */
+    static QString SQLiteDefaultTuningProfile();
+    static QString SQLiteThroughputTuningProfile();
+
     /**
      * Creates a unique hash of the values stored in this object.
      */
@@ -210,6 +219,9 @@ public:
     /// Settings stored in config file and used only with internal server at runtime to start server instance or init database tables.
     QString internalServerMysqlServCmd;
     QString internalServerMysqlInitCmd;
+
+    /// SQLite tuning profile applied to the connections of all databases. Not used with Mysql.
+    QString sqliteTuningProfile;
 };
 
 DIGIKAM_EXPORT QDebug operator<<(QDebug dbg, const DbEngineParameters& t);
@@ -38,6 +38,10 @@
 
 #include <QtGlobal>
 
+// Local includes
+
+#include "digikam_export.h"
+
 class QImage;
 
 namespace Digikam
@@ -181,7 +185,7 @@ public:
 
 // ---------------------------------------------------------------------------------
 
-class WeightBin
+class DIGIKAM_DATABASE_EXPORT WeightBin
 {
 public:
 
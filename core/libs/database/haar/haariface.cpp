@@ -40,6 +40,15 @@
 #include <QImage>
 #include <QImageReader>
 #include <QMap>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QtConcurrent>    // krazy:exclude=includes
 
 // Local includes
 
@@ -55,6 +64,7 @@
 #include "dbenginesqlquery.h"
 #include "similaritydb.h"
 #include "similaritydbaccess.h"
+#include "haarsignaturearena.h"
 
 using namespace std;
 
@@ -63,9 +73,6 @@ using namespace std;
 namespace Digikam
 {
 
-typedef QMap<qlonglong, Haar::SignatureData> SignatureCache;
-typedef QMap<qlonglong, int>                 AlbumCache;
-
 /** This class encapsulates the Haar signature in a QByteArray
  *  that can be stored as a BLOB in the database.
  *
@@ -150,133 +157,330 @@ public:
 
 // -----------------------------------------------------------------------------------------------------
 
-class Q_DECL_HIDDEN HaarIface::Private
+/** The scratch buffers of a thread of a duplicates search. The per image buffers are sized
+ *  to the signature arena once; only the entries touched by a query are reset after it.
+ */
+class Q_DECL_HIDDEN DuplicatesSearchScratch
 {
 public:
 
-    explicit Private()
+    explicit DuplicatesSearchScratch(int count)
+        : coefficientScores(count, 0.0),
+          touched(count, false)
     {
-        data                       = nullptr;
-        bin                        = nullptr;
-        signatureCache             = nullptr;
-        albumCache                 = nullptr;
-        useSignatureCache          = false;
+    }
+
+    /// Accumulation of the coefficients part of the score, for the images touched by a query.
+    QVector<double> coefficientScores;
+    QVector<bool>   touched;
 
-        signatureQuery             = QString::fromUtf8("SELECT M.imageid, M.matrix FROM ImageHaarMatrix AS M;");
+    QVector<int>    candidates;
+    QVector<double> candidateScores;
+};
+
+// -----------------------------------------------------------------------------------------------------
+
+/** This class holds the read-only data shared by all threads of a duplicates search:
+ *  the signature arena to compare with, and an inverted index which maps each signed
+ *  coefficient of each channel to the positions of the images which retain it.
+ *  The inverted index is used to prune the images which cannot reach the required score.
+ */
+class Q_DECL_HIDDEN DuplicatesSearchContext
+{
+public:
+
+    explicit DuplicatesSearchContext()
+        : arena(nullptr),
+          matches(nullptr),
+          searchResultRestriction(HaarIface::None),
+          requiredPercentage(0.0),
+          maximumPercentage(0.0),
+          canceled(0)
+    {
     }
 
-    ~Private()
+    ~DuplicatesSearchContext()
     {
-        delete data;
-        delete bin;
-        delete signatureCache;
-        delete albumCache;
+        qDeleteAll(scratchStore);
     }
 
-    void createLoadingBuffer()
+    /** Returns scratch buffers not used by another range. At most one set is allocated
+     *  per thread running concurrently, instead of one per range.
+     */
+    DuplicatesSearchScratch* acquireScratch()
     {
-        if (!data)
+        QMutexLocker lock(&scratchMutex);
+
+        if (!freeScratch.isEmpty())
         {
-            data = new Haar::ImageData;
+            return freeScratch.takeLast();
         }
+
+        DuplicatesSearchScratch* const scratch = new DuplicatesSearchScratch(arena->count());
+        scratchStore << scratch;
+
+        return scratch;
     }
 
-    void createWeightBin()
+    void releaseScratch(DuplicatesSearchScratch* const scratch)
     {
-        if (!bin)
-        {
-            bin = new Haar::WeightBin;
-        }
+        QMutexLocker lock(&scratchMutex);
+        freeScratch << scratch;
     }
 
-    void setSignatureCacheEnabled(bool cache, const QSet<qlonglong>& imageIds)
+    void build(const Haar::SignatureArena* const signatureArena)
     {
-        setSignatureCacheEnabled(cache);
+        arena           = signatureArena;
+        const int count = arena->count();
+
+        // Compressed row layout: the positions of the images having coefficient x in channel c are
+        // entries[c][offsets[c][x + NumberOfPixelsSquared]] .. entries[c][offsets[c][x + NumberOfPixelsSquared + 1] - 1]
+
+        const int bucketCount = 2 * Haar::NumberOfPixelsSquared + 1;
+        Haar::SignatureData sig;
 
-        // stop here if we disable cached signatures
-        if (!cache || imageIds.isEmpty())
+        for (int channel = 0 ; channel < 3 ; ++channel)
         {
-            return;
+            offsets[channel].fill(0, bucketCount + 1);
         }
 
-        // Remove all ids from the fully created signatureCache that are not needed for the duplicates search.
-        // This is usually faster then starting a query for every single id in imageIds.
-        for (SignatureCache::iterator it = signatureCache->begin();
-             it != signatureCache->end(); )
+        for (int pos = 0 ; pos < count ; ++pos)
         {
-            if (!imageIds.contains(it.key()))
+            arena->signature(pos, &sig);
+
+            for (int channel = 0 ; channel < 3 ; ++channel)
             {
-                it = signatureCache->erase(it);
+                for (int coef = 0 ; coef < Haar::NumberOfCoefficients ; ++coef)
+                {
+                    ++offsets[channel][sig.sig[channel][coef] + Haar::NumberOfPixelsSquared + 1];
+                }
             }
-            else
+        }
+
+        QVector<int> fill[3];
+
+        for (int channel = 0 ; channel < 3 ; ++channel)
+        {
+            QVector<int>& offset = offsets[channel];
+
+            for (int bucket = 0 ; bucket < bucketCount ; ++bucket)
             {
-                ++it;
+                offset[bucket + 1] += offset[bucket];
+            }
+
+            entries[channel].resize(offset[bucketCount]);
+            fill[channel] = offset;
+        }
+
+        for (int pos = 0 ; pos < count ; ++pos)
+        {
+            arena->signature(pos, &sig);
+
+            for (int channel = 0 ; channel < 3 ; ++channel)
+            {
+                for (int coef = 0 ; coef < Haar::NumberOfCoefficients ; ++coef)
+                {
+                    entries[channel][fill[channel][sig.sig[channel][coef] + Haar::NumberOfPixelsSquared]++] = pos;
+                }
             }
         }
     }
 
-    void setSignatureCacheEnabled(bool cache)
+public:
+
+    const Haar::SignatureArena*                 arena;
+
+    QVector<int>                                offsets[3];
+    QVector<int>                                entries[3];
+
+    /// The positions of the query images, in the order of the sequential search.
+    QVector<int>                                queries;
+
+    /// For each query, the matching image ids with their similarity, including the query itself.
+    QVector<QMap<qlonglong, double> >           matchStore;
+    QMap<qlonglong, double>*                    matches;
+
+    HaarIface::DuplicatesSearchRestrictions     searchResultRestriction;
+    double                                      requiredPercentage;
+    double                                      maximumPercentage;
+    QAtomicInt                                  canceled;
+
+private:
+
+    QMutex                                      scratchMutex;
+    QList<DuplicatesSearchScratch*>             scratchStore;
+    QList<DuplicatesSearchScratch*>             freeScratch;
+};
+
+// -----------------------------------------------------------------------------------------------------
+
+/// Worker scoring a range of the signature arena.
+static void scoreSignatureArena(const Haar::SignatureArena* const arena, const Haar::ScoreTable* const table,
+                                double* const scores, int start, int end)
+{
+    arena->scores(*table, scores, start, end);
+}
+
+// -----------------------------------------------------------------------------------------------------
+
+/** Load the signatures of the visible images in an arena, in one pass over the similarity database.
+ *  visibleItems maps the visible images to their album and album root.
+ *  If imageIds is not empty, only these images are loaded.
+ */
+static Haar::SignatureArena* loadSignatureArena(const QHash<qlonglong, QPair<int, int> >& visibleItems,
+                                                const QSet<qlonglong>& imageIds = QSet<qlonglong>())
+{
+    Haar::SignatureArena* const arena = new Haar::SignatureArena;
+    QHash<qlonglong, QPair<int, int> >::const_iterator item;
+
+    arena->reserve(imageIds.isEmpty() ? visibleItems.count() : imageIds.count());
+
+    // Variables for data read from DB
+    SimilarityDbAccess  similarityDbAccess;
+    DatabaseBlob        blob;
+    qlonglong           imageid;
+    Haar::SignatureData targetSig;
+
+    DbEngineSqlQuery query = similarityDbAccess.backend()->prepareQuery(
+                                 QString::fromUtf8("SELECT M.imageid, M.matrix FROM ImageHaarMatrix AS M;"));
+
+    if (!similarityDbAccess.backend()->exec(query))
     {
-        delete signatureCache;
-        signatureCache = nullptr;
-        delete albumCache;
-        albumCache     = nullptr;
+        return arena;
+    }
 
-        if (cache)
+    // We don't use SimilarityDb's convenience calls, as the result set is large
+    // and we try to avoid copying in a temporary QList<QVariant>
+    while (query.next())
+    {
+        imageid = query.value(0).toLongLong();
+
+        if (!imageIds.isEmpty() && !imageIds.contains(imageid))
         {
-            signatureCache = new SignatureCache();
-            albumCache     = new AlbumCache();
+            continue;
         }
-        useSignatureCache = cache;
 
-        // stop here if we disable cached signatures
-        if (!cache)
+        item = visibleItems.constFind(imageid);
+
+        if (item != visibleItems.constEnd())
         {
-            return;
+            blob.read(query.value(1).toByteArray(), &targetSig);
+            arena->append(imageid, item->first, item->second, targetSig);
         }
+    }
 
-        // Variables for data read from DB
-        SimilarityDbAccess  similarityDbAccess;
-        DatabaseBlob        blob;
-        qlonglong           imageid;
-        int                 albumid;
-        Haar::SignatureData targetSig;
+    return arena;
+}
 
-        // reference for easier access
-        SignatureCache& signatureCache = *this->signatureCache;
-        AlbumCache&     albumCache     = *this->albumCache;
+/** The signatures of all visible images, shared by all HaarIface instances of the process.
+ *  Reading and decoding them is the expensive part of a search, so they are only loaded again
+ *  after HaarIface::invalidateSignatureCache(), or when images were added, removed or moved
+ *  in the core database.
+ */
+class Q_DECL_HIDDEN SharedSignatureArena
+{
+public:
 
-        DbEngineSqlQuery query = similarityDbAccess.backend()->prepareQuery(signatureQuery);
+    explicit SharedSignatureArena()
+        : loadedGeneration(-1)
+    {
+    }
 
-        if (!similarityDbAccess.backend()->exec(query))
+    QSharedPointer<const Haar::SignatureArena> get()
+    {
+        // One query without the signatures, to check the images and their albums.
+        QHash<qlonglong, QPair<int, int> > items = CoreDbAccess().db()->getAllVisibleItemsAlbumAndAlbumRoot();
+
+        // Concurrent searches wait for the same loading.
+        QMutexLocker lock(&mutex);
+
+        const int currentGeneration = generation.load();
+
+        if (!arena || loadedGeneration != currentGeneration || visibleItems != items)
         {
-            return;
+            arena            = QSharedPointer<const Haar::SignatureArena>(loadSignatureArena(items));
+            visibleItems     = items;
+            loadedGeneration = currentGeneration;
         }
 
-        while (query.next())
+        return arena;
+    }
+
+public:
+
+    /// Incremented when the signatures in the similarity database change
+    QAtomicInt                                 generation;
+
+private:
+
+    QMutex                                     mutex;
+    QSharedPointer<const Haar::SignatureArena> arena;
+    QHash<qlonglong, QPair<int, int> >         visibleItems;
+    int                                        loadedGeneration;
+};
+
+Q_GLOBAL_STATIC(SharedSignatureArena, sharedSignatureArena)
+
+// -----------------------------------------------------------------------------------------------------
+
+class Q_DECL_HIDDEN HaarIface::Private
+{
+public:
+
+    explicit Private()
+    {
+        data                       = nullptr;
+        bin                        = nullptr;
+        useSignatureCache          = false;
+    }
+
+    ~Private()
+    {
+        delete data;
+        delete bin;
+    }
+
+    void createLoadingBuffer()
+    {
+        if (!data)
         {
-            imageid = query.value(0).toLongLong();
+            data = new Haar::ImageData;
+        }
+    }
 
-            // Get the album id and status of the item with the ImageInfo.
-            ImageInfo info(imageid);
-            if (!info.isNull() && info.isVisible())
-            {
-                blob.read(query.value(1).toByteArray(), &targetSig);
-                albumid = info.albumId();
-                signatureCache[imageid] = targetSig;
-                albumCache[imageid]     = albumid;
-            }
+    void createWeightBin()
+    {
+        if (!bin)
+        {
+            bin = new Haar::WeightBin;
+        }
+    }
+
+    /** The duplicates search loads the signatures of the images to scan in its own arena.
+     */
+    void setSignatureCacheEnabled(bool cache, const QSet<qlonglong>& imageIds = QSet<qlonglong>())
+    {
+        useSignatureCache = cache;
+
+        if (cache)
+        {
+            // Get the album id, album root id and status of all items at once,
+            // instead of one ImageInfo per signature.
+            signatureArena = QSharedPointer<const Haar::SignatureArena>(
+                                 loadSignatureArena(CoreDbAccess().db()->getAllVisibleItemsAlbumAndAlbumRoot(), imageIds));
+        }
+        else
+        {
+            signatureArena.clear();
         }
     }
 
-    bool             useSignatureCache;
-    Haar::ImageData* data;
-    Haar::WeightBin* bin;
-    SignatureCache*  signatureCache;
-    AlbumCache*      albumCache;
+    bool                                       useSignatureCache;
+    Haar::ImageData*                           data;
+    Haar::WeightBin*                           bin;
+    QSharedPointer<const Haar::SignatureArena> signatureArena;
 
-    QString          signatureQuery;
-    QSet<int>        albumRootsToSearch;
+    QSet<int>                                  albumRootsToSearch;
 };
 
 HaarIface::HaarIface()
@@ -289,6 +493,11 @@ HaarIface::~HaarIface()
     delete d;
 }
 
+void HaarIface::invalidateSignatureCache()
+{
+    sharedSignatureArena->generation.ref();
+}
+
 void HaarIface::setAlbumRootsToSearch(QList<int> albumRootIds)
 {
     setAlbumRootsToSearch(albumRootIds.toSet());
@@ -391,6 +600,8 @@ bool HaarIface::indexImage(qlonglong imageid)
                                                                 " (imageid, modificationDate, uniqueHash, matrix) "
                                                                 " VALUES(?, ?, ?, ?);"),
                                       imageid, info.modDateTime(), info.uniqueHash(), array);
+
+            invalidateSignatureCache();
         }
     }
 
@@ -468,7 +679,7 @@ QPair<double,QMap<qlonglong,double>> HaarIface::bestMatchesForImageWithThreshold
                                                              double maximumPercentage, QList<int>& targetAlbums,
                                                              DuplicatesSearchRestrictions searchResultRestriction, SketchType type)
 {
-    if ( !d->useSignatureCache || (d->signatureCache->isEmpty() && d->useSignatureCache) )
+    if ( !d->useSignatureCache || !d->signatureArena || d->signatureArena->isEmpty() )
     {
         Haar::SignatureData sig;
 
@@ -481,9 +692,15 @@ QPair<double,QMap<qlonglong,double>> HaarIface::bestMatchesForImageWithThreshold
     }
     else
     {
-        // reference for easier access
-        SignatureCache& signatureCache = *d->signatureCache;
-        Haar::SignatureData& sig       = signatureCache[imageid];
+        int pos = d->signatureArena->position(imageid);
+
+        if (pos == -1)
+        {
+            return QPair<double,QMap<qlonglong,double>>();
+        }
+
+        Haar::SignatureData sig;
+        d->signatureArena->signature(pos, &sig);
         return bestMatchesWithThreshold(imageid, &sig, requiredPercentage, maximumPercentage, targetAlbums, searchResultRestriction, type);
     }
 }
@@ -683,108 +900,73 @@ QMap<qlonglong, double> HaarIface::searchDatabase(Haar::SignatureData* const que
     // The table of constant weight factors applied to each channel and bin
     Haar::Weights weights((Haar::Weights::SketchType)type);
 
-    // layout the query signature for fast lookup
-    Haar::SignatureMap queryMapY, queryMapI, queryMapQ;
-    queryMapY.fill(querySig->sig[0]);
-    queryMapI.fill(querySig->sig[1]);
-    queryMapQ.fill(querySig->sig[2]);
-    Haar::SignatureMap* queryMaps[3] = { &queryMapY, &queryMapI, &queryMapQ };
+    // layout the query signature for the scoring kernels
+    Haar::ScoreTable table;
+    table.fill(*querySig, weights, *d->bin);
 
     // Map imageid -> score. Lowest score is best.
-    // any newly inserted value will be initialized with a score of 0, as required
     QMap<qlonglong, double> scores;
 
-    // Variables for data read from DB
-    SimilarityDbAccess  access;
-    DatabaseBlob        blob;
-    qlonglong           imageid;
-    int                 albumid;
-    Haar::SignatureData targetSig;
+    // The arena of a duplicates search, or else the one shared by the process.
+    // The reference keeps it alive if it is replaced meanwhile.
+    const QSharedPointer<const Haar::SignatureArena> arenaRef = d->signatureArena ? d->signatureArena
+                                                                                  : sharedSignatureArena->get();
+    const Haar::SignatureArena* const arena                   = arenaRef.data();
+    const int count                                           = arena->count();
 
-    // reference for easier access
-    SignatureCache& signatureCache = *d->signatureCache;
-    AlbumCache&     albumCache     = *d->albumCache;
+    if (count == 0)
+    {
+        return scores;
+    }
 
-    bool filterByAlbumRoots = !d->albumRootsToSearch.isEmpty();
+    // Score all signatures, split by ranges over the thread pool for large collections.
+    QVector<double> arenaScores(count);
 
-    // if no cache is used or the cache signature map is empty, query the database
-    if (!d->useSignatureCache || (signatureCache.isEmpty() && d->useSignatureCache))
+    if (count < 16384)
     {
-        DbEngineSqlQuery query = access.backend()->prepareQuery(d->signatureQuery);
+        arena->scores(table, arenaScores.data(), 0, count);
+    }
+    else
+    {
+        int chunkSize = qMax(Haar::SignatureArena::Lanes,
+                             count / QThreadPool::globalInstance()->maxThreadCount() + 1);
+        QList <QFuture<void> > tasks;
 
-        if (!access.backend()->exec(query))
+        for (int start = 0 ; start < count ; start += chunkSize)
         {
-            return scores;
+            tasks.append(QtConcurrent::run(scoreSignatureArena,
+                                           arena,
+                                           &table,
+                                           arenaScores.data(),
+                                           start,
+                                           qMin(start + chunkSize, count)
+                                          ));
         }
 
-        // We don't use SimilarityDb's convenience calls, as the result set is large
-        // and we try to avoid copying in a temporary QList<QVariant>
-        int albumRootId = 0;
-
-        while (query.next())
-        {
-            imageid = query.value(0).toLongLong();
-
-            // Get the album id, album root id and status of the item with the ImageInfo.
-            ImageInfo info(imageid);
-            if (!info.isNull() && info.isVisible())
-            {
-                if (filterByAlbumRoots)
-                {
-                    albumRootId = info.albumRootId();
-
-                    if (!d->albumRootsToSearch.contains(albumRootId))
-                    {
-                        continue;
-                    }
-                }
-
-                blob.read(query.value(1).toByteArray(), &targetSig);
-                albumid = info.albumId();
-
-                if (d->useSignatureCache)
-                {
-                    signatureCache[imageid] = targetSig;
-                    albumCache[imageid]     = albumid;
-                }
+        foreach(QFuture<void> t, tasks)
+            t.waitForFinished();
+    }
 
-                // If the image is the original one or
-                // No restrictions apply or
-                // SameAlbum restriction applies and the albums are equal or
-                // DifferentAlbum restriction applies and the albums differ
-                // then calculate the score.
-                // Also, restrict to target album
-                if ( fulfillsRestrictions(imageid, albumid, originalImageId, originalAlbumId, targetAlbums, searchResultRestriction) )
-                {
-                    double&              score = scores[imageid];
-                    Haar::SignatureData& qSig  = *querySig;
-                    Haar::SignatureData& tSig  = targetSig;
+    bool filterByAlbumRoots = !d->albumRootsToSearch.isEmpty();
 
-                    score = calculateScore(qSig, tSig, weights, queryMaps);
-                }
-            }
-        }
-    }
-    // read cached signature map if possible
-    else
+    for (int pos = 0 ; pos < count ; ++pos)
     {
-        foreach(const qlonglong& imageid, signatureCache.keys())
+        if (filterByAlbumRoots && !d->albumRootsToSearch.contains(arena->albumRootId(pos)))
         {
-            albumid = albumCache[imageid];
-
-            // If the image is the original one or
-            // No restrictions apply or
-            // SameAlbum restriction applies and the albums are equal or
-            // DifferentAlbum restriction applies and the albums differ
-            // then calculate the score.
-            if ( fulfillsRestrictions(imageid, albumid, originalImageId, originalAlbumId, targetAlbums, searchResultRestriction) )
-            {
-                double& score              = scores[imageid];
-                Haar::SignatureData& qSig  = *querySig;
-                Haar::SignatureData& tSig  = signatureCache[imageid];
+            continue;
+        }
 
-                score = calculateScore(qSig, tSig, weights, queryMaps);
-            }
+        qlonglong imageid = arena->imageId(pos);
+
+        // If the image is the original one or
+        // No restrictions apply or
+        // SameAlbum restriction applies and the albums are equal or
+        // DifferentAlbum restriction applies and the albums differ
+        // then use the score.
+        // Also, restrict to target album
+        if ( fulfillsRestrictions(imageid, arena->albumId(pos), originalImageId, originalAlbumId, targetAlbums, searchResultRestriction) )
+        {
+            scores.insert(imageid, arenaScores.at(pos));
         }
     }
 
@@ -1056,9 +1238,9 @@ QMap< double,QMap< qlonglong,QList<qlonglong> > > HaarIface::findDuplicates(cons
     QMap<double,QMap<qlonglong,QList<qlonglong>>> resultsMap;
     QMap<double,QMap<qlonglong,QList<qlonglong>>>::iterator similarity_it;
     QSet<qlonglong>::const_iterator     it;
-    QPair<double,QMap<qlonglong,double>>      bestMatches;
     QList<qlonglong>                    imageIdList;
     QSet<qlonglong>                     resultsCandidates;
+    QSet<qlonglong>                     discardedCandidates;
 
     int                                 total        = 0;
     int                                 progress     = 0;
@@ -1073,50 +1255,127 @@ QMap< double,QMap< qlonglong,QList<qlonglong> > > HaarIface::findDuplicates(cons
 
     // create signature cache map for fast lookup
     d->setSignatureCacheEnabled(true, images2Scan);
+    d->createWeightBin();
+
+    // build the read-only index shared by all search threads
+    DuplicatesSearchContext context;
+    context.build(d->signatureArena.data());
+    context.searchResultRestriction = searchResultRestriction;
+    context.requiredPercentage      = requiredPercentage;
+    context.maximumPercentage       = maximumPercentage;
+
+    // Images without signature cannot have duplicates. Queries keep the order of the scan.
+    for (it = images2Scan.constBegin(); it != images2Scan.constEnd(); ++it)
+    {
+        int pos = d->signatureArena->position(*it);
+
+        if (pos != -1)
+        {
+            context.queries << pos;
+        }
+    }
+
+    context.matchStore.resize(context.queries.count());
+    context.matches = context.matchStore.data();
+
+    // dispatch the queries by ranges over the thread pool
+    const int queryCount = context.queries.count();
+    const int chunkSize  = qBound(1, queryCount / (QThreadPool::globalInstance()->maxThreadCount() * 8), 256);
+    QList <QFuture<void> > tasks;
+
+    for (int start = 0 ; start < queryCount ; start += chunkSize)
+    {
+        tasks.append(QtConcurrent::run(this,
+                                       &HaarIface::findDuplicatesInRange,
+                                       &context,
+                                       start,
+                                       qMin(start + chunkSize, queryCount)
+                                      ));
+    }
+
+    // Merge the matches in the order of the scan, as soon as their range is computed.
+    // An image already found as duplicate is not reported again, and an image without duplicates
+    // is not proposed as duplicate of the next ones, as it was removed from the signature cache before.
+    int query = 0;
 
     for (it = images2Scan.constBegin(); it != images2Scan.constEnd(); ++it)
     {
         if (observer && observer->isCanceled())
         {
+            context.canceled.storeRelease(1);
             break;
         }
 
-        if (!resultsCandidates.contains(*it))
+        if (d->signatureArena->position(*it) != -1)
         {
-            QList<int> targetAlbums;
-            // find images with required similarity
-            bestMatches = bestMatchesForImageWithThreshold(*it, requiredPercentage, maximumPercentage, targetAlbums, searchResultRestriction, ScannedSketch);
-            // We need only the image ids from the best matches map.
-            imageIdList = bestMatches.second.keys();
-            if (!imageIdList.isEmpty())
+            const int index = query++;
+            tasks[index / chunkSize].waitForFinished();
+
+            if (!resultsCandidates.contains(*it))
             {
-                // the list will usually contain one image: the original. Filter out.
-                if (!(imageIdList.count() == 1 && imageIdList.first() == *it))
+                QMap<qlonglong, double> bestMatches;
+                double                  avgPercentage = 0.0;
+                const QMap<qlonglong, double>& matches = context.matches[index];
+                SimilarityDbAccess      access;
+
+                for (QMap<qlonglong, double>::const_iterator match = matches.constBegin(); match != matches.constEnd(); ++match)
                 {
-                    // make a lookup for the average similarity
-                    similarity_it = resultsMap.find(bestMatches.first);
-                    // If there is an entry for this similarity, add the result set. Else, create a new similarity entry.
-                    if (similarity_it != resultsMap.end())
+                    if (match.key() != *it)
                     {
-                        similarity_it->insert(*it,imageIdList);
+                        if (discardedCandidates.contains(match.key()))
+                        {
+                            continue;
+                        }
+
+                        // Save the similarity of the found image to the original image.
+                        access.db()->setImageSimilarity(match.key(), *it, match.value());
+                        avgPercentage += match.value();
                     }
-                    else
+
+                    bestMatches.insert(match.key(), match.value());
+                }
+
+                if (bestMatches.count() > 1)
+                {
+                    // The original picture is not used for the average percentage.
+                    avgPercentage = avgPercentage / (bestMatches.count() - 1);
+                }
+
+                // We need only the image ids from the best matches map.
+                imageIdList = bestMatches.keys();
+
+                if (!imageIdList.isEmpty())
+                {
+                    // the list will usually contain one image: the original. Filter out.
+                    if (!(imageIdList.count() == 1 && imageIdList.first() == *it))
                     {
-                        QMap<qlonglong,QList<qlonglong>> result;
-                        result.insert(*it, imageIdList);
-                        resultsMap.insert(bestMatches.first,result);
+                        // make a lookup for the average similarity
+                        similarity_it = resultsMap.find(avgPercentage);
+                        // If there is an entry for this similarity, add the result set. Else, create a new similarity entry.
+                        if (similarity_it != resultsMap.end())
+                        {
+                            similarity_it->insert(*it,imageIdList);
+                        }
+                        else
+                        {
+                            QMap<qlonglong,QList<qlonglong>> result;
+                            result.insert(*it, imageIdList);
+                            resultsMap.insert(avgPercentage,result);
+                        }
+                        resultsCandidates << *it;
+                        resultsCandidates.unite(imageIdList.toSet());
                     }
-                    resultsCandidates << *it;
-                    resultsCandidates.unite(imageIdList.toSet());
                 }
             }
+
+            // release memory of merged matches
+            context.matches[index].clear();
         }
 
-        // if an imageid is not a results candidate, remove it from the cached signature map as well,
-        // to greatly improve speed
+        // if an imageid is not a results candidate, it is not a duplicate of the next images
         if (!resultsCandidates.contains(*it))
         {
-            d->signatureCache->remove(*it);
+            discardedCandidates << *it;
         }
 
         ++progress;
@@ -1127,6 +1386,10 @@ QMap< double,QMap< qlonglong,QList<qlonglong> > > HaarIface::findDuplicates(cons
         }
     }
 
+    // wait for all threads before to release the shared index
+    foreach(QFuture<void> t, tasks)
+        t.waitForFinished();
+
     // make sure the progress bar is really set to 100% when search is finished
     if (observer)
     {
@@ -1139,43 +1402,139 @@ QMap< double,QMap< qlonglong,QList<qlonglong> > > HaarIface::findDuplicates(cons
     return resultsMap;
 }
 
-double HaarIface::calculateScore(Haar::SignatureData& querySig, Haar::SignatureData& targetSig,
-                                 Haar::Weights& weights, Haar::SignatureMap** const queryMaps)
+void HaarIface::findDuplicatesInRange(DuplicatesSearchContext* const context, int start, int end)
 {
-    double score = 0.0;
+    const Haar::SignatureArena* const arena = context->arena;
+    const int count                         = arena->count();
 
-    // Step 1: Initialize scores with average intensity values of all three channels
-    for (int channel = 0; channel < 3; ++channel)
-    {
-        score += weights.weightForAverage(channel) * fabs( querySig.avg[channel] - targetSig.avg[channel] );
-    }
+    // The table of constant weight factors applied to each channel and bin
+    Haar::Weights weights((Haar::Weights::SketchType)ScannedSketch);
 
-    // Step 2: Decrease the score if query and target have significant coefficients in common
-    Haar::Idx* sig               = nullptr;
-    Haar::SignatureMap* queryMap = nullptr;
-    int x                        = 0;
+    // layout of the query signature for the scoring kernels
+    Haar::ScoreTable    table;
+    Haar::SignatureData querySig;
 
-    for (int channel = 0; channel < 3; ++channel)
+    // Buffers sized to the arena, reused by the next ranges once this one is done.
+    DuplicatesSearchScratch* const scratch           = context->acquireScratch();
+    double* const                  coefficientScores = scratch->coefficientScores.data();
+    bool* const                    touched           = scratch->touched.data();
+    QVector<int>&                  candidates        = scratch->candidates;
+    QVector<double>&               candidateScores   = scratch->candidateScores;
+    QList<int>                     targetAlbums;
+
+    // Set the supremum which solves the problem that if
+    // required == maximum, no results will be returned.
+    const double supremum = (floor(context->maximumPercentage*100 + 1.0))/100;
+
+    for (int index = start ; index < end ; ++index)
     {
-        sig      = targetSig.sig[channel];
-        queryMap = queryMaps[channel];
+        if (context->canceled.loadAcquire())
+        {
+            break;
+        }
 
-        for (int coef = 0; coef < Haar::NumberOfCoefficients; ++coef)
+        const int       pos     = context->queries.at(index);
+        const qlonglong imageid = arena->imageId(pos);
+        const int       albumId = arena->albumId(pos);
+        arena->signature(pos, &querySig);
+
+        double lowest, highest;
+        getBestAndWorstPossibleScore(&querySig, ScannedSketch, &lowest, &highest);
+        double scoreRange    = highest - lowest;
+        double requiredScore = lowest + scoreRange * (1.0 - context->requiredPercentage);
+
+        table.fill(querySig, weights, *d->bin);
+
+        candidates.clear();
+        candidateScores.clear();
+
+        if (requiredScore < 0.0)
+        {
+            // The averages part of the score is never negative: only images having at least one coefficient
+            // in common with the query can reach the required score. Find them with the inverted index.
+            for (int channel = 0 ; channel < 3 ; ++channel)
+            {
+                const int* const offsets = context->offsets[channel].constData();
+                const int* const entries = context->entries[channel].constData();
+
+                for (int coef = 0 ; coef < Haar::NumberOfCoefficients ; ++coef)
+                {
+                    int    x      = querySig.sig[channel][coef];
+                    double weight = table.weight(channel, x);
+                    int    bucket = x + Haar::NumberOfPixelsSquared;
+
+                    for (int entry = offsets[bucket] ; entry < offsets[bucket + 1] ; ++entry)
+                    {
+                        int target = entries[entry];
+
+                        if (!touched[target])
+                        {
+                            touched[target] = true;
+                            candidates << target;
+                        }
+
+                        coefficientScores[target] -= weight;
+                    }
+                }
+            }
+
+            // Only score the candidates whose bound can reach the required score, with a margin for rounding.
+            int kept = 0;
+
+            foreach(int target, candidates)
+            {
+                double bound              = coefficientScores[target] + arena->averagesScore(table, target);
+                coefficientScores[target] = 0.0;
+                touched[target]           = false;
+
+                if (bound <= requiredScore + 1e-6)
+                {
+                    candidates[kept++] = target;
+                    candidateScores << arena->score(table, target);
+                }
+            }
+
+            candidates.resize(kept);
+        }
+        else
         {
-            // x is a pixel index, either positive or negative, 0..16384
-            x = sig[coef];
+            // Any image can reach the required score: score all with the vectorized kernel.
+            candidateScores.resize(count);
+            arena->scores(table, candidateScores.data(), 0, count);
+
+            for (int target = 0 ; target < count ; ++target)
+            {
+                candidates << target;
+            }
+        }
+
+        QMap<qlonglong, double>& matches = context->matches[index];
+
+        for (int i = 0 ; i < candidates.count() ; ++i)
+        {
+            const int       target   = candidates.at(i);
+            const double    score    = candidateScores.at(i);
+            const qlonglong targetId = arena->imageId(target);
+
+            // If the score of the picture is at most the required (maximum) score and
+            // if the found image is the original one or the percentage is below the maximum.
+            if ((score > requiredScore) ||
+                !fulfillsRestrictions(targetId, arena->albumId(target), imageid, albumId,
+                                      targetAlbums, context->searchResultRestriction))
+            {
+                continue;
+            }
+
+            double percentage = 1.0 - (score - lowest) / scoreRange;
 
-            // If x is a significant coefficient with the same sign in the query signature as well,
-            // decrease the score (lower is better)
-            // Note: both method calls called with x accept positive or negative values
-            if ((*queryMap)[x])
+            if ((targetId == imageid) || (percentage < supremum))
             {
-                score -= weights.weight(d->bin->binAbs(x), channel);
+                matches.insert(targetId, percentage);
             }
         }
     }
 
-    return score;
+    context->releaseScratch(scratch);
 }
 
 } // namespace Digikam
@@ -46,6 +46,7 @@ namespace Digikam
 
 class DImg;
 class ImageInfo;
+class DuplicatesSearchContext;
 
 class HaarProgressObserver
 {
@@ -97,6 +98,12 @@ public:
 
     static int preferredSize();
 
+    /** The signatures of all images are loaded once and shared by the searches of the process.
+     *  Call this after adding, changing or removing signatures in the similarity database
+     *  other than with indexImage(), so that the next search loads them again.
+     */
+    static void invalidateSignatureCache();
+
     /** Adds an image to the index in the database.
      */
     bool indexImage(const QString& filename);
@@ -155,6 +162,7 @@ public:
      *  For each map item, the result values is list of candidate images which are duplicates of the key image.
      *  All images are referenced by id from database.
      *  The threshold is in the range 0..1, with 1 meaning identical signature.
+     *  The search is spread over the global thread pool, using a shared read-only signature index.
      */
     QMap< double,QMap< qlonglong,QList<qlonglong> > > findDuplicates(const QSet<qlonglong>& images2Scan, double requiredPercentage,
             double maximumPercentage, DuplicatesSearchRestrictions searchResultRestriction = DuplicatesSearchRestrictions::None, HaarProgressObserver* const observer = 0);
@@ -234,8 +242,11 @@ private:
     QMap<qlonglong, double> searchDatabase(Haar::SignatureData* const data, SketchType type, QList<int>& targetAlbums,
                                            DuplicatesSearchRestrictions searchResultRestriction = None,
                                            qlonglong originalImageId = -1, int albumId = -1);
-    double calculateScore(Haar::SignatureData& querySig, Haar::SignatureData& targetSig,
-                          Haar::Weights& weights, Haar::SignatureMap** const queryMaps);
+    /** Worker of the multi-threaded duplicates search. Computes the matches of all query
+     *  images in the range [start, end) of the shared read-only signature index.
+     *  Called concurrently from the global thread pool by findDuplicates().
+     */
+    void findDuplicatesInRange(DuplicatesSearchContext* const context, int start, int end);
 
 private:
 
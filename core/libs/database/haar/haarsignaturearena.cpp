@@ -0,0 +1,467 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-02
+ * Description : Packed in-memory store of Haar signatures
+ *               with vectorized scoring kernels
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "haarsignaturearena.h"
+
+// C++ includes
+
+#include <cmath>
+#include <cstring>
+
+// Local includes
+
+#include "digikam_debug.h"
+
+// SIMD includes
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#   include <immintrin.h>
+#   define HAAR_HAVE_AVX2_KERNEL
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define HAAR_HAVE_SSE2_KERNEL
+#endif
+
+using namespace std;
+
+namespace Digikam
+{
+
+namespace Haar
+{
+
+typedef void (*ScoreBlockFunction)(const ScoreTable& table, const SignatureArena::Block& block, double* const scores);
+
+/** All kernels apply, for each lane, the same double operations in the same order:
+ *  first the weighted differences of the channel averages, then the subtraction of the
+ *  weights of all target coefficients, the weight being 0 when the query does not retain it.
+ */
+static void scoreBlockGeneric(const ScoreTable& table, const SignatureArena::Block& block, double* const scores)
+{
+    const SignatureData& query = table.query();
+
+    for (int lane = 0 ; lane < SignatureArena::Lanes ; ++lane)
+    {
+        double score = 0.0;
+
+        // Step 1: Initialize scores with average intensity values of all three channels
+        for (int channel = 0 ; channel < 3 ; ++channel)
+        {
+            score += table.weightForAverage(channel) * fabs(query.avg[channel] - block.avg[channel][lane]);
+        }
+
+        // Step 2: Decrease the score if query and target have significant coefficients in common
+        for (int channel = 0 ; channel < 3 ; ++channel)
+        {
+            const float* const weights = table.channelTable(channel);
+
+            for (int coef = 0 ; coef < NumberOfCoefficients ; ++coef)
+            {
+                score -= weights[block.sig[channel][coef][lane]];
+            }
+        }
+
+        scores[lane] = score;
+    }
+}
+
+#ifdef HAAR_HAVE_SSE2_KERNEL
+
+static void scoreBlockSSE2(const ScoreTable& table, const SignatureArena::Block& block, double* const scores)
+{
+    const SignatureData& query = table.query();
+    const __m128d signMask     = _mm_set1_pd(-0.0);
+
+    for (int lane = 0 ; lane < SignatureArena::Lanes ; lane += 2)
+    {
+        __m128d score = _mm_setzero_pd();
+
+        for (int channel = 0 ; channel < 3 ; ++channel)
+        {
+            __m128d diff = _mm_sub_pd(_mm_set1_pd(query.avg[channel]), _mm_loadu_pd(&block.avg[channel][lane]));
+            diff         = _mm_andnot_pd(signMask, diff);
+            score        = _mm_add_pd(score, _mm_mul_pd(_mm_set1_pd(table.weightForAverage(channel)), diff));
+        }
+
+        for (int channel = 0 ; channel < 3 ; ++channel)
+        {
+            const float* const weights = table.channelTable(channel);
+
+            for (int coef = 0 ; coef < NumberOfCoefficients ; ++coef)
+            {
+                const Idx* const idx = &block.sig[channel][coef][lane];
+                score                = _mm_sub_pd(score, _mm_set_pd(weights[idx[1]], weights[idx[0]]));
+            }
+        }
+
+        _mm_storeu_pd(scores + lane, score);
+    }
+}
+
+#endif // HAAR_HAVE_SSE2_KERNEL
+
+#ifdef HAAR_HAVE_AVX2_KERNEL
+
+__attribute__((target("avx2")))
+static void scoreBlockAVX2(const ScoreTable& table, const SignatureArena::Block& block, double* const scores)
+{
+    const SignatureData& query = table.query();
+    const __m256d signMask     = _mm256_set1_pd(-0.0);
+    __m256d score              = _mm256_setzero_pd();
+
+    for (int channel = 0 ; channel < 3 ; ++channel)
+    {
+        __m256d diff = _mm256_sub_pd(_mm256_set1_pd(query.avg[channel]), _mm256_loadu_pd(block.avg[channel]));
+        diff         = _mm256_andnot_pd(signMask, diff);
+        score        = _mm256_add_pd(score, _mm256_mul_pd(_mm256_set1_pd(table.weightForAverage(channel)), diff));
+    }
+
+    for (int channel = 0 ; channel < 3 ; ++channel)
+    {
+        const float* const weights = table.channelTable(channel);
+
+        for (int coef = 0 ; coef < NumberOfCoefficients ; ++coef)
+        {
+            // Gather the weights of the 4 target coefficients, widen them to double and subtract.
+            __m128i idx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block.sig[channel][coef]));
+            score       = _mm256_sub_pd(score, _mm256_cvtps_pd(_mm_i32gather_ps(weights, idx, 4)));
+        }
+    }
+
+    _mm256_storeu_pd(scores, score);
+}
+
+#endif // HAAR_HAVE_AVX2_KERNEL
+
+static SignatureArena::Kernel& currentKernel()
+{
+    static SignatureArena::Kernel kernel = SignatureArena::bestSupportedKernel();
+    return kernel;
+}
+
+static ScoreBlockFunction kernelFunction(SignatureArena::Kernel kernel)
+{
+    switch (kernel)
+    {
+#ifdef HAAR_HAVE_AVX2_KERNEL
+        case SignatureArena::AVX2Kernel:
+            return scoreBlockAVX2;
+#endif
+#ifdef HAAR_HAVE_SSE2_KERNEL
+        case SignatureArena::SSE2Kernel:
+            return scoreBlockSSE2;
+#endif
+        default:
+            return scoreBlockGeneric;
+    }
+}
+
+// ---------------------------------------------------------------------------------
+
+ScoreTable::ScoreTable()
+{
+    // First 16k for negative values, second 16k for positive values, for each channel.
+    m_table = new float[3 * 2 * NumberOfPixelsSquared];
+    memset(m_table, 0, sizeof(float) * 3 * 2 * NumberOfPixelsSquared);
+    memset(&m_query, 0, sizeof(SignatureData));
+
+    for (int channel = 0 ; channel < 3 ; ++channel)
+    {
+        m_averageWeights[channel] = 0.0F;
+    }
+}
+
+ScoreTable::~ScoreTable()
+{
+    delete [] m_table;
+}
+
+void ScoreTable::fill(const SignatureData& query, const Weights& weights, const WeightBin& bin)
+{
+    // Only reset the entries of the previous query, all other entries are 0.
+    for (int channel = 0 ; channel < 3 ; ++channel)
+    {
+        float* const table = m_table + channel * 2 * NumberOfPixelsSquared + NumberOfPixelsSquared;
+
+        for (int coef = 0 ; coef < NumberOfCoefficients ; ++coef)
+        {
+            table[m_query.sig[channel][coef]] = 0.0F;
+        }
+    }
+
+    m_query = query;
+
+    for (int channel = 0 ; channel < 3 ; ++channel)
+    {
+        float* const table        = m_table + channel * 2 * NumberOfPixelsSquared + NumberOfPixelsSquared;
+        m_averageWeights[channel] = weights.weightForAverage(channel);
+
+        for (int coef = 0 ; coef < NumberOfCoefficients ; ++coef)
+        {
+            Idx x    = m_query.sig[channel][coef];
+            table[x] = weights.weight(bin.binAbs(x), channel);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------
+
+class Q_DECL_HIDDEN SignatureArena::Private
+{
+public:
+
+    explicit Private()
+      : count(0)
+    {
+    }
+
+    int                     count;
+    QVector<Block>          blocks;
+    QVector<qlonglong>      imageIds;
+    QVector<int>            albumIds;
+    QVector<int>            albumRootIds;
+    QHash<qlonglong, int>   positions;
+};
+
+SignatureArena::SignatureArena()
+    : d(new Private)
+{
+}
+
+SignatureArena::~SignatureArena()
+{
+    delete d;
+}
+
+void SignatureArena::clear()
+{
+    d->count = 0;
+    d->blocks.clear();
+    d->imageIds.clear();
+    d->albumIds.clear();
+    d->albumRootIds.clear();
+    d->positions.clear();
+}
+
+void SignatureArena::reserve(int count)
+{
+    d->blocks.reserve((count + Lanes - 1) / Lanes);
+    d->imageIds.reserve(count);
+    d->albumIds.reserve(count);
+    d->albumRootIds.reserve(count);
+    d->positions.reserve(count);
+}
+
+int SignatureArena::append(qlonglong imageId, int albumId, int albumRootId, const SignatureData& sig)
+{
+    const int pos  = d->count++;
+    const int lane = pos % Lanes;
+
+    if (lane == 0)
+    {
+        // Unused lanes of the last block are scored as empty signatures, and ignored.
+        Block block;
+        memset(&block, 0, sizeof(Block));
+        d->blocks << block;
+    }
+
+    Block& block = d->blocks.last();
+
+    for (int channel = 0 ; channel < 3 ; ++channel)
+    {
+        block.avg[channel][lane] = sig.avg[channel];
+
+        for (int coef = 0 ; coef < NumberOfCoefficients ; ++coef)
+        {
+            block.sig[channel][coef][lane] = sig.sig[channel][coef];
+        }
+    }
+
+    d->imageIds     << imageId;
+    d->albumIds     << albumId;
+    d->albumRootIds << albumRootId;
+    d->positions.insert(imageId, pos);
+
+    return pos;
+}
+
+int SignatureArena::count() const
+{
+    return d->count;
+}
+
+bool SignatureArena::isEmpty() const
+{
+    return (d->count == 0);
+}
+
+int SignatureArena::position(qlonglong imageId) const
+{
+    return d->positions.value(imageId, -1);
+}
+
+qlonglong SignatureArena::imageId(int pos) const
+{
+    return d->imageIds.at(pos);
+}
+
+int SignatureArena::albumId(int pos) const
+{
+    return d->albumIds.at(pos);
+}
+
+int SignatureArena::albumRootId(int pos) const
+{
+    return d->albumRootIds.at(pos);
+}
+
+void SignatureArena::signature(int pos, SignatureData* const sig) const
+{
+    const Block& block = d->blocks.at(pos / Lanes);
+    const int lane     = pos % Lanes;
+
+    for (int channel = 0 ; channel < 3 ; ++channel)
+    {
+        sig->avg[channel] = block.avg[channel][lane];
+
+        for (int coef = 0 ; coef < NumberOfCoefficients ; ++coef)
+        {
+            sig->sig[channel][coef] = block.sig[channel][coef][lane];
+        }
+    }
+}
+
+void SignatureArena::scores(const ScoreTable& table, double* const scores, int start, int end) const
+{
+    end = qMin(end, d->count);
+
+    if (start >= end)
+    {
+        return;
+    }
+
+    ScoreBlockFunction scoreBlock = kernelFunction(currentKernel());
+    const Block* const blocks     = d->blocks.constData();
+    double             blockScores[Lanes];
+
+    for (int b = start / Lanes ; b <= (end - 1) / Lanes ; ++b)
+    {
+        const int first = b * Lanes;
+
+        if ((first >= start) && (first + Lanes <= end))
+        {
+            scoreBlock(table, blocks[b], scores + first);
+        }
+        else
+        {
+            // Block partially in the range
+            scoreBlock(table, blocks[b], blockScores);
+
+            for (int pos = qMax(first, start) ; pos < qMin(first + Lanes, end) ; ++pos)
+            {
+                scores[pos] = blockScores[pos - first];
+            }
+        }
+    }
+}
+
+double SignatureArena::score(const ScoreTable& table, int pos) const
+{
+    const Block& block         = d->blocks.at(pos / Lanes);
+    const int lane             = pos % Lanes;
+    double score               = averagesScore(table, pos);
+
+    for (int channel = 0 ; channel < 3 ; ++channel)
+    {
+        const float* const weights = table.channelTable(channel);
+
+        for (int coef = 0 ; coef < NumberOfCoefficients ; ++coef)
+        {
+            score -= weights[block.sig[channel][coef][lane]];
+        }
+    }
+
+    return score;
+}
+
+double SignatureArena::averagesScore(const ScoreTable& table, int pos) const
+{
+    const SignatureData& query = table.query();
+    const Block& block         = d->blocks.at(pos / Lanes);
+    const int lane             = pos % Lanes;
+    double score               = 0.0;
+
+    for (int channel = 0 ; channel < 3 ; ++channel)
+    {
+        score += table.weightForAverage(channel) * fabs(query.avg[channel] - block.avg[channel][lane]);
+    }
+
+    return score;
+}
+
+SignatureArena::Kernel SignatureArena::bestSupportedKernel()
+{
+#ifdef HAAR_HAVE_AVX2_KERNEL
+
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return AVX2Kernel;
+    }
+
+#endif
+
+#ifdef HAAR_HAVE_SSE2_KERNEL
+
+    return SSE2Kernel;
+
+#else
+
+    return GenericKernel;
+
+#endif
+}
+
+void SignatureArena::setKernel(Kernel kernel)
+{
+    Kernel best = bestSupportedKernel();
+
+    if (kernel > best)
+    {
+        qCDebug(DIGIKAM_DATABASE_LOG) << "Haar scoring kernel" << kernel << "not supported, using" << best;
+        kernel = best;
+    }
+
+    currentKernel() = kernel;
+}
+
+SignatureArena::Kernel SignatureArena::kernel()
+{
+    return currentKernel();
+}
+
+} // namespace Haar
+
+} // namespace Digikam
@@ -0,0 +1,177 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-02
+ * Description : Packed in-memory store of Haar signatures
+ *               with vectorized scoring kernels
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_HAAR_SIGNATURE_ARENA_H
+#define DIGIKAM_HAAR_SIGNATURE_ARENA_H
+
+// Qt includes
+
+#include <QVector>
+#include <QHash>
+
+// Local includes
+
+#include "haar.h"
+#include "digikam_export.h"
+
+namespace Digikam
+{
+
+namespace Haar
+{
+
+/** This class is the lookup table of a query signature used by the scoring kernels.
+ *  For each channel and each signed coefficient, it gives the weight to subtract from
+ *  the score if a target signature retains this coefficient, or 0 if the query does not.
+ *  The table is allocated once and can be refilled for any number of queries.
+ */
+class DIGIKAM_DATABASE_EXPORT ScoreTable
+{
+public:
+
+    explicit ScoreTable();
+    ~ScoreTable();
+
+    /// Prepare the table for the given query signature.
+    void fill(const SignatureData& query, const Weights& weights, const WeightBin& bin);
+
+    /// Weight of the coefficient index in the channel, index in the range -16383..16383.
+    float weight(int channel, Idx index) const
+    {
+        return m_table[channel * 2 * NumberOfPixelsSquared + NumberOfPixelsSquared + index];
+    }
+
+    /// Pointer to the weight of coefficient 0 of the channel, for the gather instructions.
+    const float* channelTable(int channel) const
+    {
+        return m_table + channel * 2 * NumberOfPixelsSquared + NumberOfPixelsSquared;
+    }
+
+    const SignatureData& query() const
+    {
+        return m_query;
+    }
+
+    float weightForAverage(int channel) const
+    {
+        return m_averageWeights[channel];
+    }
+
+private:
+
+    ScoreTable(const ScoreTable&); // Disable
+
+    float*        m_table;
+    float         m_averageWeights[3];
+    SignatureData m_query;
+};
+
+// ---------------------------------------------------------------------------------
+
+/** This class packs Haar signatures in one contiguous buffer, to be loaded once per search session.
+ *  Entries are grouped by blocks of Lanes signatures. Inside a block, the averages and coefficients
+ *  are stored lane after lane (structure of arrays), so that the scoring kernel compares one query
+ *  with a whole block at once, using AVX2 gathers or SSE2 when the CPU supports them.
+ *  All kernels apply the same sequence of double operations to each lane, so they return
+ *  bit-identical scores.
+ */
+class DIGIKAM_DATABASE_EXPORT SignatureArena
+{
+public:
+
+    enum
+    {
+        Lanes = 4
+    };
+
+    enum Kernel
+    {
+        GenericKernel = 0,
+        SSE2Kernel,
+        AVX2Kernel
+    };
+
+public:
+
+    explicit SignatureArena();
+    ~SignatureArena();
+
+    void clear();
+    void reserve(int count);
+
+    /// Append a signature and return its position in the arena.
+    int  append(qlonglong imageId, int albumId, int albumRootId, const SignatureData& sig);
+
+    int  count()                            const;
+    bool isEmpty()                          const;
+
+    /// Return the position of the image in the arena, or -1 if not present.
+    int       position(qlonglong imageId)   const;
+
+    qlonglong imageId(int pos)              const;
+    int       albumId(int pos)              const;
+    int       albumRootId(int pos)          const;
+    void      signature(int pos, SignatureData* const sig) const;
+
+    /** Compute the scores of the query prepared in table against all signatures
+     *  in the range of positions [start, end). scores[i] receives the score of position i.
+     *  The buffer must have room for count() values. Lowest score is best.
+     */
+    void   scores(const ScoreTable& table, double* const scores, int start, int end) const;
+
+    /// Compute the score of the query prepared in table against the signature at position pos.
+    double score(const ScoreTable& table, int pos)         const;
+
+    /// Compute only the part of the score due to the channel averages, which is never negative.
+    double averagesScore(const ScoreTable& table, int pos) const;
+
+    /// Force the kernel to use, e.g. for testing. Unsupported kernels fall back to the best supported one.
+    static void   setKernel(Kernel kernel);
+    static Kernel kernel();
+    static Kernel bestSupportedKernel();
+
+public:
+
+    /// One block of signatures, the last index of each array being the lane.
+    class Block
+    {
+    public:
+
+        double avg[3][Lanes];
+        Idx    sig[3][NumberOfCoefficients][Lanes];
+    };
+
+private:
+
+    SignatureArena(const SignatureArena&); // Disable
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace Haar
+
+} // namespace Digikam
+
+#endif // DIGIKAM_HAAR_SIGNATURE_ARENA_H
@@ -197,6 +197,7 @@ ImageInfoData::ImageInfoData()
     category               = DatabaseItem::UndefinedCategory;
     fileSize               = 0;
     manualOrder            = 0;
+    shard                  = 0;
 
     longitude              = 0;
     latitude               = 0;
@@ -250,7 +251,7 @@ ImageInfo::ImageInfo(const ImageListerRecord& record)
 {
     m_data                         = ImageInfoStatic::cache()->infoForId(record.imageID);
 
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     bool newlyCreated              = m_data->albumId == -1;
 
     m_data->albumId                = record.albumID;
@@ -299,7 +300,7 @@ ImageInfo::ImageInfo(qlonglong ID)
 
         if (info.id)
         {
-            ImageInfoWriteLocker lock;
+            ImageInfoWriteLocker lock(m_data);
             m_data->albumId     = info.albumID;
             m_data->albumRootId = info.albumRootID;
             m_data->name        = info.itemName;
@@ -368,7 +369,7 @@ ImageInfo ImageInfo::fromLocationAlbumAndName(int locationId, const QString& alb
 
         info.m_data              = ImageInfoStatic::cache()->infoForId(shortInfo.id);
 
-        ImageInfoWriteLocker lock;
+        ImageInfoWriteLocker lock(info.m_data);
 
         info.m_data->albumId     = shortInfo.albumID;
         info.m_data->albumRootId = shortInfo.albumRootID;
@@ -493,24 +494,24 @@ QString ImageInfo::name() const
         return QString();
     }
 
-    ImageInfoReadLocker lock;
+    ImageInfoReadLocker lock(m_data);
     return m_data->name;
 }
 
-#define RETURN_IF_CACHED(x)       \
-    if (m_data->x##Cached)        \
-    {                             \
-        ImageInfoReadLocker lock; \
-        if (m_data->x##Cached)    \
-        {                         \
-            return m_data->x;     \
-        }                         \
+#define RETURN_IF_CACHED(x)               \
+    if (m_data->x##Cached)                \
+    {                                     \
+        ImageInfoReadLocker lock(m_data); \
+        if (m_data->x##Cached)            \
+        {                                 \
+            return m_data->x;             \
+        }                                 \
     }
 
 #define RETURN_ASPECTRATIO_IF_IMAGESIZE_CACHED()       \
     if (m_data->imageSizeCached)  \
     {                             \
-        ImageInfoReadLocker lock; \
+        ImageInfoReadLocker lock(m_data);   \
         if (m_data->imageSizeCached)    \
         {                         \
     return (double)m_data->imageSize.width()/m_data->imageSize.height();     \
@@ -518,7 +519,7 @@ QString ImageInfo::name() const
     }
 
 #define STORE_IN_CACHE_AND_RETURN(x, retrieveMethod) \
-    ImageInfoWriteLocker lock;                       \
+    ImageInfoWriteLocker lock(m_data);               \
     m_data.constCastData()->x##Cached = true;        \
     if (!values.isEmpty())                           \
     {                                                \
@@ -570,7 +571,7 @@ QString ImageInfo::title() const
         title = comments.defaultComment(DatabaseComment::Title);
     }
 
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data.constCastData()->defaultTitle       = title;
     m_data.constCastData()->defaultTitleCached = true;
     return m_data->defaultTitle;
@@ -592,7 +593,7 @@ QString ImageInfo::comment() const
         comment = comments.defaultComment();
     }
 
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data.constCastData()->defaultComment       = comment;
     m_data.constCastData()->defaultCommentCached = true;
     return m_data->defaultComment;
@@ -621,7 +622,7 @@ int ImageInfo::pickLabel() const
 
     int pickLabel = TagsCache::instance()->pickLabelFromTags(tagIds());
 
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data.constCastData()->pickLabel       = (pickLabel == -1) ? NoPickLabel : pickLabel;
     m_data.constCastData()->pickLabelCached = true;
     return m_data->pickLabel;
@@ -638,7 +639,7 @@ int ImageInfo::colorLabel() const
 
     int colorLabel = TagsCache::instance()->colorLabelFromTags(tagIds());
 
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data.constCastData()->colorLabel       = (colorLabel == -1) ? NoColorLabel : colorLabel;
     m_data.constCastData()->colorLabelCached = true;
     return m_data->colorLabel;
@@ -738,7 +739,7 @@ QSize ImageInfo::dimensions() const
     RETURN_IF_CACHED(imageSize)
 
     QVariantList values = CoreDbAccess().db()->getImageInformation(m_data->id, DatabaseFields::Width | DatabaseFields::Height);
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data.constCastData()->imageSizeCached = true;
 
     if (values.size() == 2)
@@ -759,12 +760,184 @@ QList<int> ImageInfo::tagIds() const
     RETURN_IF_CACHED(tagIds)
 
     QList<int> ids = CoreDbAccess().db()->getItemTagIDs(m_data->id);
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data.constCastData()->tagIds       = ids;
     m_data.constCastData()->tagIdsCached = true;
     return ids;
 }
 
+void ImageInfoList::loadFields(const DatabaseFields::Set& fields) const
+{
+    // Only the fields cached by ImageInfo are supported
+    DatabaseFields::Images imagesFields                = fields.getImages() &
+                                                         (DatabaseFields::Category    | DatabaseFields::ModificationDate |
+                                                          DatabaseFields::FileSize    | DatabaseFields::UniqueHash       |
+                                                          DatabaseFields::ManualOrder);
+    DatabaseFields::ImageInformation informationFields = fields.getImageInformation() &
+                                                         (DatabaseFields::Rating      | DatabaseFields::Format           |
+                                                          DatabaseFields::CreationDate | DatabaseFields::Width           |
+                                                          DatabaseFields::Height);
+
+    if (informationFields & (DatabaseFields::Width | DatabaseFields::Height))
+    {
+        informationFields |= DatabaseFields::Width | DatabaseFields::Height;
+    }
+
+    if (imagesFields == DatabaseFields::ImagesNone && informationFields == DatabaseFields::ImageInformationNone)
+    {
+        return;
+    }
+
+    ImageInfoList infoList;
+
+    foreach(const ImageInfo& info, *this)
+    {
+        if (!info.m_data)
+        {
+            continue;
+        }
+
+        ImageInfoReadLocker lock(info.m_data);
+
+        if (((imagesFields      & DatabaseFields::Category)         && !info.m_data->categoryCached)         ||
+            ((imagesFields      & DatabaseFields::ModificationDate) && !info.m_data->modificationDateCached) ||
+            ((imagesFields      & DatabaseFields::FileSize)         && !info.m_data->fileSizeCached)         ||
+            ((imagesFields      & DatabaseFields::UniqueHash)       && !info.m_data->uniqueHashCached)       ||
+            ((imagesFields      & DatabaseFields::ManualOrder)      && !info.m_data->manualOrderCached)      ||
+            ((informationFields & DatabaseFields::Rating)           && !info.m_data->ratingCached)           ||
+            ((informationFields & DatabaseFields::Format)           && !info.m_data->formatCached)           ||
+            ((informationFields & DatabaseFields::CreationDate)     && !info.m_data->creationDateCached)     ||
+            ((informationFields & DatabaseFields::Width)            && !info.m_data->imageSizeCached))
+        {
+            infoList << info;
+        }
+    }
+
+    if (infoList.isEmpty())
+    {
+        return;
+    }
+
+    QList<qlonglong> ids = infoList.toImageIdList();
+    QVector<QVariantList> imagesValues;
+    QVector<QVariantList> informationValues;
+
+    {
+        CoreDbAccess access;
+        imagesValues      = access.db()->getImagesFields(ids, imagesFields);
+        informationValues = access.db()->getImageInformation(ids, informationFields);
+    }
+
+    for (int i = 0 ; i < infoList.size() ; ++i)
+    {
+        const ImageInfo& info            = infoList.at(i);
+        const QVariantList& images       = imagesValues.at(i);
+        const QVariantList& information  = informationValues.at(i);
+        ImageInfoData* const data        = info.m_data.constCastData();
+        int index                        = 0;
+
+        ImageInfoWriteLocker lock(info.m_data);
+
+        // The values come in the order of the fields, see CoreDB::imagesFieldList()
+
+        if (imagesFields & DatabaseFields::Category)
+        {
+            if (!images.isEmpty())
+            {
+                data->category = (DatabaseItem::Category)images.at(index++).toInt();
+            }
+
+            data->categoryCached = true;
+        }
+
+        if (imagesFields & DatabaseFields::ModificationDate)
+        {
+            if (!images.isEmpty())
+            {
+                data->modificationDate = images.at(index++).toDateTime();
+            }
+
+            data->modificationDateCached = true;
+        }
+
+        if (imagesFields & DatabaseFields::FileSize)
+        {
+            if (!images.isEmpty())
+            {
+                data->fileSize = images.at(index++).toLongLong();
+            }
+
+            data->fileSizeCached = true;
+        }
+
+        if (imagesFields & DatabaseFields::UniqueHash)
+        {
+            if (!images.isEmpty())
+            {
+                data->uniqueHash = images.at(index++).toString();
+            }
+
+            data->uniqueHashCached = true;
+        }
+
+        if (imagesFields & DatabaseFields::ManualOrder)
+        {
+            if (!images.isEmpty())
+            {
+                data->manualOrder = images.at(index++).toLongLong();
+            }
+
+            data->manualOrderCached = true;
+        }
+
+        // See CoreDB::imageInformationFieldList()
+
+        index = 0;
+
+        if (informationFields & DatabaseFields::Rating)
+        {
+            if (!information.isEmpty())
+            {
+                data->rating = information.at(index++).toLongLong();
+            }
+
+            data->ratingCached = true;
+        }
+
+        if (informationFields & DatabaseFields::CreationDate)
+        {
+            if (!information.isEmpty())
+            {
+                data->creationDate = information.at(index++).toDateTime();
+            }
+
+            data->creationDateCached = true;
+        }
+
+        if (informationFields & DatabaseFields::Width)
+        {
+            if (!information.isEmpty())
+            {
+                int width       = information.at(index++).toInt();
+                int height      = information.at(index++).toInt();
+                data->imageSize = QSize(width, height);
+            }
+
+            data->imageSizeCached = true;
+        }
+
+        if (informationFields & DatabaseFields::Format)
+        {
+            if (!information.isEmpty())
+            {
+                data->format = information.at(index++).toString();
+            }
+
+            data->formatCached = true;
+        }
+    }
+}
+
 void ImageInfoList::loadTagIds() const
 {
     ImageInfoList infoList;
@@ -784,8 +957,6 @@ void ImageInfoList::loadTagIds() const
 
     QVector<QList<int> > allTagIds = CoreDbAccess().db()->getItemsTagIDs(infoList.toImageIdList());
 
-    ImageInfoWriteLocker lock;
-
     for (int i = 0 ; i < infoList.size() ; ++i)
     {
         const ImageInfo& info = infoList.at(i);
@@ -796,6 +967,8 @@ void ImageInfoList::loadTagIds() const
             continue;
         }
 
+        ImageInfoWriteLocker lock(info.m_data);
+
         info.m_data.constCastData()->tagIds       = ids;
         info.m_data.constCastData()->tagIdsCached = true;
     }
@@ -838,7 +1011,7 @@ QString ImageInfo::filePath() const
     }
 
     QString album = ImageInfoStatic::cache()->albumRelativePath(m_data->albumId);
-    ImageInfoReadLocker lock;
+    ImageInfoReadLocker lock(m_data);
 
     if (album == QLatin1String("/"))
     {
@@ -975,7 +1148,7 @@ int ImageInfo::numberOfGroupedImages() const
     RETURN_IF_CACHED(groupedImages)
 
     int groupedImages                           = CoreDbAccess().db()->getImagesRelatingTo(m_data->id, DatabaseRelation::Grouped).size();
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data.constCastData()->groupedImages       = groupedImages;
     m_data.constCastData()->groupedImagesCached = true;
     return m_data->groupedImages;
@@ -994,7 +1167,7 @@ qlonglong ImageInfo::groupImageId() const
     // list size should be 0 or 1
     int groupImage       = ids.isEmpty() ? -1 : ids.first();
 
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data.constCastData()->groupImage       = groupImage;
     m_data.constCastData()->groupImageCached = true;
     return m_data->groupImage;
@@ -1020,8 +1193,6 @@ void ImageInfoList::loadGroupImageIds() const
     QVector<QList<qlonglong> > allGroupIds = CoreDbAccess().db()->getImagesRelatedFrom(infoList.toImageIdList(),
                                                                                        DatabaseRelation::Grouped);
 
-    ImageInfoWriteLocker lock;
-
     for (int i = 0 ; i < infoList.size() ; ++i)
     {
         const ImageInfo& info            = infoList.at(i);
@@ -1032,6 +1203,8 @@ void ImageInfoList::loadGroupImageIds() const
             continue;
         }
 
+        ImageInfoWriteLocker lock(info.m_data);
+
         info.m_data.constCastData()->groupImage       = groupIds.isEmpty() ? -1 : groupIds.first();
         info.m_data.constCastData()->groupImageCached = true;
     }
@@ -1187,7 +1360,7 @@ ImagePosition ImageInfo::imagePosition() const
 
     if (!m_data->positionsCached)
     {
-        ImageInfoWriteLocker lock;
+        ImageInfoWriteLocker lock(m_data);
         m_data.constCastData()->longitude       = pos.longitudeNumber();
         m_data.constCastData()->latitude        = pos.latitudeNumber();
         m_data.constCastData()->altitude        = pos.altitude();
@@ -1656,7 +1829,7 @@ void ImageInfo::setPickLabel(int pickId)
         setTag(pickLabelTags[pickId]);
     }
 
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data->pickLabel       = pickId;
     m_data->pickLabelCached = true;
 }
@@ -1687,7 +1860,7 @@ void ImageInfo::setColorLabel(int colorId)
         setTag(colorLabelTags[colorId]);
     }
 
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data->colorLabel       = colorId;
     m_data->colorLabelCached = true;
 }
@@ -1701,7 +1874,7 @@ void ImageInfo::setRating(int value)
 
     CoreDbAccess().db()->changeImageInformation(m_data->id, QVariantList() << value, DatabaseFields::Rating);
 
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data->rating       = value;
     m_data->ratingCached = true;
 }
@@ -1715,7 +1888,7 @@ void ImageInfo::setManualOrder(qlonglong value)
 
     CoreDbAccess().db()->setItemManualOrder(m_data->id, value);
 
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data->manualOrder       = value;
     m_data->manualOrderCached = true;
 }
@@ -1739,7 +1912,7 @@ void ImageInfo::setName(const QString& newName)
 
     CoreDbAccess().db()->renameItem(m_data->id, newName);
 
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data->name = newName;
     ImageInfoStatic::cache()->cacheByName(m_data);
 }
@@ -1753,7 +1926,7 @@ void ImageInfo::setDateTime(const QDateTime& dateTime)
 
     CoreDbAccess().db()->changeImageInformation(m_data->id, QVariantList() << dateTime, DatabaseFields::CreationDate);
 
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data->creationDate       = dateTime;
     m_data->creationDateCached = true;
 }
@@ -1809,7 +1982,7 @@ ImageInfo ImageInfo::copyItem(int dstAlbumID, const QString& dstFileName)
     }
 
     {
-        ImageInfoReadLocker lock;
+        ImageInfoReadLocker lock(m_data);
 
         if (dstAlbumID == m_data->albumId && dstFileName == m_data->name)
         {
@@ -1946,7 +2119,7 @@ ImageInfo::DatabaseFieldsHashRaw ImageInfo::getDatabaseFieldsRaw(const DatabaseF
     ImageInfo::DatabaseFieldsHashRaw cachedHash;
     // consolidate to one ReadLocker. In particular, the shallow copy of the QHash must be done under protection
     {
-        ImageInfoReadLocker lock;
+        ImageInfoReadLocker lock(m_data);
         cachedVideoMetadata = m_data->videoMetadataCached;
         cachedImageMetadata = m_data->imageMetadataCached;
         cachedHash = m_data->databaseFieldsHashRaw;
@@ -1961,7 +2134,7 @@ ImageInfo::DatabaseFieldsHashRaw ImageInfo::getDatabaseFieldsRaw(const DatabaseF
         {
             const QVariantList fieldValues = CoreDbAccess().db()->getVideoMetadata(m_data->id, missingVideoMetadata);
 
-            ImageInfoWriteLocker lock;
+            ImageInfoWriteLocker lock(m_data);
             if (fieldValues.isEmpty())
             {
                 m_data.constCastData()->hasVideoMetadata = false;
@@ -1995,7 +2168,7 @@ ImageInfo::DatabaseFieldsHashRaw ImageInfo::getDatabaseFieldsRaw(const DatabaseF
         {
             const QVariantList fieldValues = CoreDbAccess().db()->getImageMetadata(m_data->id, missingImageMetadata);
 
-            ImageInfoWriteLocker lock;
+            ImageInfoWriteLocker lock(m_data);
             if (fieldValues.isEmpty())
             {
                 m_data.constCastData()->hasImageMetadata = false;
@@ -66,7 +66,7 @@ ImageInfoCache::~ImageInfoCache()
 template <class T>
 DSharedDataPointer<T> toStrongRef(T* weakRef)
 {
-    // Called under read lock
+    // Called under read lock of the shard, or of the names
     if (!weakRef)
     {
         return DSharedDataPointer<T>();
@@ -109,7 +109,7 @@ void ImageInfoCache::checkAlbums()
     {
         // list comes sorted from db
         QList<AlbumShortInfo> infos = CoreDbAccess().db()->getAlbumShortInfos();
-        ImageInfoWriteLocker lock;
+        QWriteLocker lock(&m_namesLock);
         m_albums                    = infos;
         m_needUpdateAlbums          = false;
     }
@@ -117,9 +117,11 @@ void ImageInfoCache::checkAlbums()
 
 DSharedDataPointer<ImageInfoData> ImageInfoCache::infoForId(qlonglong id)
 {
+    Shard& shard = m_shards[shardForId(id)];
+
     {
-        ImageInfoReadLocker lock;
-        DSharedDataPointer<ImageInfoData> ptr = toStrongRef(m_infos.value(id));
+        QReadLocker lock(&shard.lock);
+        DSharedDataPointer<ImageInfoData> ptr = toStrongRef(shard.infos.value(id));
 
         if (ptr)
         {
@@ -127,23 +129,35 @@ DSharedDataPointer<ImageInfoData> ImageInfoCache::infoForId(qlonglong id)
         }
     }
 
-    ImageInfoWriteLocker lock;
+    QWriteLocker lock(&shard.lock);
+
+    // Another thread may have created the data in the meantime
+    DSharedDataPointer<ImageInfoData> ptr = toStrongRef(shard.infos.value(id));
+
+    if (ptr)
+    {
+        return ptr;
+    }
+
     ImageInfoData* const data = new ImageInfoData();
     data->id                  = id;
-    m_infos[id]               = data;
+    data->shard               = shardForId(id);
+    shard.infos[id]           = data;
 
     return DSharedDataPointer<ImageInfoData>(data);
 }
 
 void ImageInfoCache::cacheByName(ImageInfoData* const data)
 {
-    // Called with Write lock
+    // Called with write lock of the shard of data
 
     if (!data || data->id == -1 || data->name.isEmpty())
     {
         return;
     }
 
+    QWriteLocker lock(&m_namesLock);
+
     // Called in a context where we can assume that the entry is not yet cached by name (newly created data)
     m_nameHash.remove(m_dataHash.value(data), data);
     m_nameHash.insert(data->name, data);
@@ -152,7 +166,8 @@ void ImageInfoCache::cacheByName(ImageInfoData* const data)
 
 DSharedDataPointer<ImageInfoData> ImageInfoCache::infoForPath(int albumRootId, const QString& relativePath, const QString& name)
 {
-    ImageInfoReadLocker lock;
+    // The data in the hash by file name cannot be deleted while the lock is held, see dropInfo().
+    QReadLocker lock(&m_namesLock);
     // We check all entries in the multi hash with matching file name
     QMultiHash<QString, ImageInfoData*>::const_iterator it;
 
@@ -186,19 +201,30 @@ void ImageInfoCache::dropInfo(ImageInfoData* const infodata)
         return;
     }
 
-    ImageInfoWriteLocker lock;
+    Shard& shard = m_shards[infodata->shard];
+    QWriteLocker lock(&shard.lock);
 
-    m_infos.remove(infodata->id);
+    // The id may already refer to a new data, if this one was dropped from another thread
+    QHash<qlonglong, ImageInfoData*>::iterator it = shard.infos.find(infodata->id);
+
+    if (it != shard.infos.end() && it.value() == infodata)
+    {
+        shard.infos.erase(it);
+    }
+
+    {
+        QWriteLocker namesLock(&m_namesLock);
+        m_nameHash.remove(m_dataHash.value(infodata), infodata);
+        m_nameHash.remove(infodata->name, infodata);
+        m_dataHash.remove(infodata);
+    }
 
-    m_nameHash.remove(m_dataHash.value(infodata), infodata);
-    m_nameHash.remove(infodata->name, infodata);
-    m_dataHash.remove(infodata);
     delete infodata;
 }
 
 QList<AlbumShortInfo>::const_iterator ImageInfoCache::findAlbum(int id)
 {
-    // Called with read lock
+    // Called with read lock of the names
     AlbumShortInfo info;
     info.id = id;
     // we use the fact that d->infos is sorted by id
@@ -208,7 +234,7 @@ QList<AlbumShortInfo>::const_iterator ImageInfoCache::findAlbum(int id)
 QString ImageInfoCache::albumRelativePath(int albumId)
 {
     checkAlbums();
-    ImageInfoReadLocker lock;
+    QReadLocker lock(&m_namesLock);
     QList<AlbumShortInfo>::const_iterator it = findAlbum(albumId);
 
     if (it != m_albums.constEnd())
@@ -221,123 +247,147 @@ QString ImageInfoCache::albumRelativePath(int albumId)
 
 void ImageInfoCache::invalidate()
 {
-    ImageInfoWriteLocker lock;
-    QHash<qlonglong, ImageInfoData*>::iterator it;
+    // Lock all shards, always in the same order
+    for (int i = 0 ; i < ShardCount ; ++i)
+    {
+        m_shards[i].lock.lockForWrite();
+    }
 
-    for (it = m_infos.begin() ; it != m_infos.end() ; ++it)
+    for (int i = 0 ; i < ShardCount ; ++i)
     {
-        if ((*it)->isReferenced())
-        {
-            (*it)->invalid = true;
-            (*it)->id      = -1;
-        }
-        else
+        QHash<qlonglong, ImageInfoData*>::iterator it;
+
+        for (it = m_shards[i].infos.begin() ; it != m_shards[i].infos.end() ; ++it)
         {
-            delete *it;
+            if ((*it)->isReferenced())
+            {
+                (*it)->invalid = true;
+                (*it)->id      = -1;
+            }
+            else
+            {
+                delete *it;
+            }
         }
+
+        m_shards[i].infos.clear();
     }
 
-    m_infos.clear();
-    m_albums.clear();
+    {
+        QWriteLocker namesLock(&m_namesLock);
+        m_albums.clear();
+    }
+
+    for (int i = ShardCount - 1 ; i >= 0 ; --i)
+    {
+        m_shards[i].lock.unlock();
+    }
 }
 
-void ImageInfoCache::slotImageChanged(const ImageChangeset& changeset)
+void ImageInfoCache::invalidateFields(ImageInfoData* const data, const DatabaseFields::Set& changes)
 {
-    ImageInfoWriteLocker lock;
+    // Called with write lock of the shard of data
+    // invalidate the relevant field. It will be lazy-loaded at first access.
 
-    foreach (const qlonglong& imageId, changeset.ids())
+    if (changes & DatabaseFields::ImageCommentsAll)
     {
-        QHash<qlonglong, ImageInfoData*>::iterator it = m_infos.find(imageId);
+        data->defaultCommentCached = false;
+        data->defaultTitleCached   = false;
+    }
 
-        if (it != m_infos.end())
-        {
-            // invalidate the relevant field. It will be lazy-loaded at first access.
-            DatabaseFields::Set changes = changeset.changes();
+    if (changes & DatabaseFields::Category)
+    {
+        data->categoryCached = false;
+    }
 
-            if (changes & DatabaseFields::ImageCommentsAll)
-            {
-                (*it)->defaultCommentCached = false;
-                (*it)->defaultTitleCached   = false;
-            }
+    if (changes & DatabaseFields::Format)
+    {
+        data->formatCached = false;
+    }
 
-            if (changes & DatabaseFields::Category)
-            {
-                (*it)->categoryCached = false;
-            }
+    if (changes & DatabaseFields::PickLabel)
+    {
+        data->pickLabelCached = false;
+    }
 
-            if (changes & DatabaseFields::Format)
-            {
-                (*it)->formatCached = false;
-            }
+    if (changes & DatabaseFields::ColorLabel)
+    {
+        data->colorLabelCached = false;
+    }
 
-            if (changes & DatabaseFields::PickLabel)
-            {
-                (*it)->pickLabelCached = false;
-            }
+    if (changes & DatabaseFields::Rating)
+    {
+        data->ratingCached = false;
+    }
 
-            if (changes & DatabaseFields::ColorLabel)
-            {
-                (*it)->colorLabelCached = false;
-            }
+    if (changes & DatabaseFields::CreationDate)
+    {
+        data->creationDateCached = false;
+    }
 
-            if (changes & DatabaseFields::Rating)
-            {
-                (*it)->ratingCached = false;
-            }
+    if (changes & DatabaseFields::ModificationDate)
+    {
+        data->modificationDateCached = false;
+    }
 
-            if (changes & DatabaseFields::CreationDate)
-            {
-                (*it)->creationDateCached = false;
-            }
+    if (changes & DatabaseFields::FileSize)
+    {
+        data->fileSizeCached = false;
+    }
 
-            if (changes & DatabaseFields::ModificationDate)
-            {
-                (*it)->modificationDateCached = false;
-            }
+    if (changes & DatabaseFields::ManualOrder)
+    {
+        data->manualOrderCached = false;
+    }
 
-            if (changes & DatabaseFields::FileSize)
-            {
-                (*it)->fileSizeCached = false;
-            }
+    if ((changes & DatabaseFields::Width) || (changes & DatabaseFields::Height))
+    {
+        data->imageSizeCached = false;
+    }
 
-            if (changes & DatabaseFields::ManualOrder)
-            {
-                (*it)->manualOrderCached = false;
-            }
+    if (changes & DatabaseFields::LatitudeNumber  ||
+        changes & DatabaseFields::LongitudeNumber ||
+        changes & DatabaseFields::Altitude)
+    {
+        data->positionsCached = false;
+    }
 
-            if ((changes & DatabaseFields::Width) || (changes & DatabaseFields::Height))
-            {
-                (*it)->imageSizeCached = false;
-            }
+    if (changes & DatabaseFields::ImageRelations)
+    {
+        data->groupedImagesCached = false;
+        data->groupImageCached    = false;
+    }
 
-            if (changes & DatabaseFields::LatitudeNumber  ||
-                changes & DatabaseFields::LongitudeNumber ||
-                changes & DatabaseFields::Altitude)
-            {
-                (*it)->positionsCached = false;
-            }
+    if (changes.hasFieldsFromVideoMetadata())
+    {
+        const DatabaseFields::VideoMetadata changedVideoMetadata = changes.getVideoMetadata();
+        data->videoMetadataCached&=~changedVideoMetadata;
 
-            if (changes & DatabaseFields::ImageRelations)
-            {
-                (*it)->groupedImagesCached = false;
-                (*it)->groupImageCached    = false;
-            }
+        data->databaseFieldsHashRaw.removeAllFields(changedVideoMetadata);
+    }
 
-            if (changes.hasFieldsFromVideoMetadata())
-            {
-                const DatabaseFields::VideoMetadata changedVideoMetadata = changes.getVideoMetadata();
-                (*it)->videoMetadataCached&=~changedVideoMetadata;
+    if (changes.hasFieldsFromImageMetadata())
+    {
+        const DatabaseFields::ImageMetadata changedImageMetadata = changes.getImageMetadata();
+        data->imageMetadataCached&=~changedImageMetadata;
 
-                (*it)->databaseFieldsHashRaw.removeAllFields(changedVideoMetadata);
-            }
+        data->databaseFieldsHashRaw.removeAllFields(changedImageMetadata);
+    }
+}
 
-            if (changes.hasFieldsFromImageMetadata())
-            {
-                const DatabaseFields::ImageMetadata changedImageMetadata = changes.getImageMetadata();
-                (*it)->imageMetadataCached&=~changedImageMetadata;
+void ImageInfoCache::slotImageChanged(const ImageChangeset& changeset)
+{
+    const DatabaseFields::Set changes = changeset.changes();
 
-                (*it)->databaseFieldsHashRaw.removeAllFields(changedImageMetadata);
-            }
+    foreach (const qlonglong& imageId, changeset.ids())
+    {
+        Shard& shard = m_shards[shardForId(imageId)];
+        QWriteLocker lock(&shard.lock);
+        QHash<qlonglong, ImageInfoData*>::iterator it = shard.infos.find(imageId);
+
+        if (it != shard.infos.end())
+        {
+            invalidateFields(*it, changes);
         }
     }
 }
@@ -349,13 +399,13 @@ void ImageInfoCache::slotImageTagChanged(const ImageTagChangeset& changeset)
         return;
     }
 
-    ImageInfoWriteLocker lock;
-
     foreach (const qlonglong& imageId, changeset.ids())
     {
-        QHash<qlonglong, ImageInfoData*>::iterator it = m_infos.find(imageId);
+        Shard& shard = m_shards[shardForId(imageId)];
+        QWriteLocker lock(&shard.lock);
+        QHash<qlonglong, ImageInfoData*>::iterator it = shard.infos.find(imageId);
 
-        if (it != m_infos.end())
+        if (it != shard.infos.end())
         {
             (*it)->tagIdsCached     = false;
             (*it)->colorLabelCached = false;
@@ -30,6 +30,7 @@
 #include <QMultiHash>
 #include <QHash>
 #include <QObject>
+#include <QReadWriteLock>
 
 // Local includes
 
@@ -42,16 +43,42 @@ namespace Digikam
 class AlbumShortInfo;
 class ImageInfoData;
 
+/** The cache is split in shards by image id, each shard having its own lock, so that threads
+ *  accessing different images do not contend on one global lock, for ex. when sorting a model.
+ *  The data of an image is protected by the lock of its shard, see ImageInfoReadLocker and
+ *  ImageInfoWriteLocker. The hash by file name and the albums are protected by a separate lock,
+ *  which is always taken after a shard lock, never before.
+ */
 // No EXPORT class
 class ImageInfoCache : public QObject
 {
     Q_OBJECT
 
+public:
+
+    enum
+    {
+        ShardCount = 32
+    };
+
 public:
 
     explicit ImageInfoCache();
     ~ImageInfoCache();
 
+    /**
+     * Return the shard of an image id, and the lock of a shard.
+     */
+    static int shardForId(qlonglong id)
+    {
+        return (int)(id & (ShardCount - 1));
+    }
+
+    QReadWriteLock* shardLock(int shard) const
+    {
+        return &m_shards[shard].lock;
+    }
+
     /**
      * Return an ImageInfoData object for the given image id.
      * A new object is created, or an existing object is returned.
@@ -68,7 +95,7 @@ public:
     /**
      * Call this to put data in the hash by file name if you have newly created data
      * and the name is filled.
-     * Call under write lock.
+     * Call under write lock of the shard of data.
      */
     void cacheByName(ImageInfoData* const data);
 
@@ -99,10 +126,25 @@ private:
 
     QList<AlbumShortInfo>::const_iterator findAlbum(int id);
     void                                  checkAlbums();
+    void                                  invalidateFields(ImageInfoData* const data, const DatabaseFields::Set& changes);
 
 private:
 
-    QHash<qlonglong, ImageInfoData*>    m_infos;
+    class Shard
+    {
+    public:
+
+        mutable QReadWriteLock           lock;
+        QHash<qlonglong, ImageInfoData*> infos;
+
+        /// Keeps the locks of two shards in different cache lines.
+        char                             padding[64];
+    };
+
+    Shard                               m_shards[ShardCount];
+
+    /// Protects the hash by file name and the albums
+    mutable QReadWriteLock              m_namesLock;
     QHash<ImageInfoData*, QString>      m_dataHash;
     QMultiHash<QString, ImageInfoData*> m_nameHash;
     volatile bool                       m_needUpdateAlbums;
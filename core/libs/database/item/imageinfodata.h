@@ -57,37 +57,12 @@ public:
 public:
 
     ImageInfoCache          m_cache;
-    QReadWriteLock          m_lock;
 
     static ImageInfoStatic* m_instance;
 };
 
 // -----------------------------------------------------------------------------------
 
-class ImageInfoReadLocker : public QReadLocker
-{
-public:
-
-    explicit ImageInfoReadLocker()
-        : QReadLocker(&ImageInfoStatic::m_instance->m_lock)
-    {
-    }
-};
-
-// -----------------------------------------------------------------------------------
-
-class ImageInfoWriteLocker : public QWriteLocker
-{
-public:
-
-    explicit ImageInfoWriteLocker()
-        : QWriteLocker(&ImageInfoStatic::m_instance->m_lock)
-    {
-    }
-};
-
-// -----------------------------------------------------------------------------------
-
 class ImageInfoData : public DSharedData
 {
 public:
@@ -98,6 +73,8 @@ public:
 public:
 
     qlonglong              id;
+    //! shard of the cache holding this data, see ImageInfoCache
+    int                    shard;
     qlonglong              currentReferenceImage;
     int                    albumId;
     int                    albumRootId;
@@ -163,6 +140,34 @@ public:
     DatabaseFieldsHashRaw databaseFieldsHashRaw;
 };
 
+// -----------------------------------------------------------------------------------
+
+/** Lock the data of an image for reading, through the lock of its shard in the cache.
+ */
+class ImageInfoReadLocker : public QReadLocker
+{
+public:
+
+    explicit ImageInfoReadLocker(const ImageInfoData* const data)
+        : QReadLocker(ImageInfoStatic::cache()->shardLock(data->shard))
+    {
+    }
+};
+
+// -----------------------------------------------------------------------------------
+
+/** Lock the data of an image for writing, through the lock of its shard in the cache.
+ */
+class ImageInfoWriteLocker : public QWriteLocker
+{
+public:
+
+    explicit ImageInfoWriteLocker(const ImageInfoData* const data)
+        : QWriteLocker(ImageInfoStatic::cache()->shardLock(data->shard))
+    {
+    }
+};
+
 } // namespace Digikam
 
 #endif // DIGIKAM_IMAGE_INFO_DATA_H
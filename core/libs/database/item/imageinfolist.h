@@ -32,6 +32,7 @@
 // Local includes
 
 #include "imageinfo.h"
+#include "coredbfields.h"
 #include "digikam_export.h"
 #include "digikam_config.h"
 
@@ -57,6 +58,14 @@ public:
     void loadGroupImageIds() const;
     void loadTagIds()        const;
 
+    /**
+     * Load the given fields of all items which are not cached yet, with one query per chunk of items,
+     * for ex. before sorting or filtering a whole model. The fields cached by ImageInfo are supported:
+     * Category, ModificationDate, FileSize, UniqueHash, ManualOrder, Rating, CreationDate,
+     * Width, Height and Format. Other fields are ignored.
+     */
+    void loadFields(const DatabaseFields::Set& fields) const;
+
     bool static namefileLessThan(const ImageInfo& d1, const ImageInfo& d2);
 
     /**
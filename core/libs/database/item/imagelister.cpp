@@ -40,6 +40,7 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QDataStream>
+#include <QHash>
 #include <QRegExp>
 #include <QDir>
 
@@ -209,7 +210,7 @@ void ImageLister::listAlbum(ImageListerReceiver* const receiver, int albumRootId
     if (d->recursive)
     {
         // SQLite allows no more than 999 parameters
-        const int maxParams = CoreDbAccess().backend()->maximumBoundValues();
+        const int maxParams = CoreDbReadAccess().backend()->maximumBoundValues();
 
         for (int i = 0 ; i < albumIds.size() ; i++)
         {
@@ -218,7 +219,7 @@ void ImageLister::listAlbum(ImageListerReceiver* const receiver, int albumRootId
             i                  += ids.count();
 
             QList<QVariant> v;
-            CoreDbAccess  access;
+            CoreDbReadAccess access;
             q += QString::fromUtf8("Images.album IN (");
             access.db()->addBoundValuePlaceholders(q, ids.size());
             q += QString::fromUtf8(");");
@@ -229,7 +230,7 @@ void ImageLister::listAlbum(ImageListerReceiver* const receiver, int albumRootId
     }
     else
     {
-        CoreDbAccess access;
+        CoreDbReadAccess access;
         query += QString::fromUtf8("Images.album = ?;");
         access.backend()->execSql(query, albumIds, &values);
     }
@@ -385,7 +386,7 @@ void ImageLister::listDateRange(ImageListerReceiver* const receiver, const QDate
     QList<QVariant> values;
 
     {
-        CoreDbAccess access;
+        CoreDbReadAccess access;
         access.backend()->execSql(QString::fromUtf8("SELECT DISTINCT Images.id, Images.name, Images.album, "
                                           "       Albums.albumRoot, "
                                           "       ImageInformation.rating, Images.category, "
@@ -553,7 +554,7 @@ void ImageLister::listSearch(ImageListerReceiver* const receiver, const QString&
 
     bool executionSuccess;
     {
-        CoreDbAccess access;
+        CoreDbReadAccess access;
         executionSuccess = access.backend()->execSql(sqlQuery, boundValues, &values);
 
         if (!executionSuccess)
@@ -676,7 +677,7 @@ void ImageLister::listImageTagPropertySearch(ImageListerReceiver* const receiver
 
     bool executionSuccess;
     {
-        CoreDbAccess access;
+        CoreDbReadAccess access;
         executionSuccess = access.backend()->execSql(sqlQuery, boundValues, &values);
 
         if (!executionSuccess)
@@ -878,197 +879,113 @@ void ImageLister::listHaarSearch(ImageListerReceiver* const receiver, const QStr
 
 void ImageLister::listFromHaarSearch(ImageListerReceiver* const receiver, const QMap<qlonglong,double>& imageSimilarityMap)
 {
-    QList<QVariant> values;
-    QString         errMsg;
-    bool            executionSuccess = true;
-
-    {
-        // Generate the query that returns the similarity as constant for a given image id.
-        CoreDbAccess access;
-        DbEngineSqlQuery query = access.backend()->prepareQuery(QString::fromUtf8(
-                             "SELECT DISTINCT Images.id, Images.name, Images.album, "
-                             "       Albums.albumRoot, "
-                             "       ImageInformation.rating, Images.category, "
-                             "       ImageInformation.format, ImageInformation.creationDate, "
-                             "       Images.modificationDate, Images.fileSize, "
-                             "       ImageInformation.width, ImageInformation.height "
-                             " FROM Images "
-                             "       LEFT JOIN ImageInformation ON Images.id=ImageInformation.imageid "
-                             "       LEFT JOIN Albums ON Albums.id=Images.album "
-                             " WHERE Images.status=1 AND Images.id = ?;"));
-
-        qlonglong imageId;
-        double similarity;
-
-        // Iterate over the image similarity map and bind the image id and similarity to the query.
-        for (QMap<qlonglong, double>::const_iterator it = imageSimilarityMap.constBegin() ; it != imageSimilarityMap.constEnd() ; ++it)
-        {
-            similarity = it.value();
-            imageId    = it.key();
-
-            query.bindValue(0, imageId);
-            executionSuccess = access.backend()->exec(query);
-
-            if (!executionSuccess)
-            {
-                errMsg = access.backend()->lastError();
-                break;
-            }
-
-            // Add the similarity to the table row.
-            QList<QVariant> tableRow = access.backend()->readToList(query);
-            tableRow.append(similarity);
-
-            // append results to list
-            values << tableRow;
-        }
-    }
-
-    if (!executionSuccess)
-    {
-        receiver->error(errMsg);
-        return;
-    }
-
-    int width, height;
-
-    for (QList<QVariant>::const_iterator it = values.constBegin() ; it != values.constEnd() ;)
-    {
-        ImageListerRecord record;
-
-        record.imageID           = (*it).toLongLong();
-        ++it;
-        record.name              = (*it).toString();
-        ++it;
-        record.albumID           = (*it).toInt();
-        ++it;
-        record.albumRootID       = (*it).toInt();
-        ++it;
-        record.rating            = (*it).toInt();
-        ++it;
-        record.category          = (DatabaseItem::Category)(*it).toInt();
-        ++it;
-        record.format            = (*it).toString();
-        ++it;
-        record.creationDate      = (*it).toDateTime();
-        ++it;
-        record.modificationDate  = (*it).toDateTime();
-        ++it;
-        record.fileSize          = toInt32BitSafe(it);
-        ++it;
-        width                    = (*it).toInt();
-        ++it;
-        height                   = (*it).toInt();
-        ++it;
-
-        record.imageSize         = QSize(width, height);
-
-        record.currentSimilarity = (*it).toDouble();
-        ++it;
-
-        receiver->receive(record);
-    }
+    listFromIdChunks(receiver, imageSimilarityMap.keys(), imageSimilarityMap);
 }
 
 void ImageLister::listFromIdList(ImageListerReceiver* const receiver, const QList<qlonglong>& imageIds)
 {
-    QList<QVariant> values;
-    QString         errMsg;
-    bool            executionSuccess = true;
+    listFromIdChunks(receiver, imageIds, QMap<qlonglong, double>());
+}
+
+void ImageLister::listFromIdChunks(ImageListerReceiver* const receiver, const QList<qlonglong>& imageIds,
+                                   const QMap<qlonglong, double>& imageSimilarityMap)
+{
+    // The ids are given in the query itself, by chunks to respect the limits of the SQL engines.
+    // The records of a chunk are passed to the receiver out of the database lock,
+    // before the next chunk is queried.
+    const int chunkSize = 500;
 
+    for (int start = 0 ; start < imageIds.size() ; start += chunkSize)
     {
-/*
-        // Unfortunately, we need to convert to QVariant
-        QList<QVariant> variantIdList;
+        QStringList ids;
+        const int   end = qMin(start + chunkSize, imageIds.size());
 
-        foreach(const qlonglong& id, imageIds)
+        for (int i = start ; i < end ; ++i)
         {
-            variantIdList << id;
+            ids << QString::number(imageIds.at(i));
         }
 
-        CoreDbAccess access;
-        QSqlQuery query = access.backend()->prepareQuery(QString::fromUtf8(
-                    "SELECT DISTINCT Images.id, Images.name, Images.album, "
-                    "       ImageInformation.rating, ImageInformation.creationDate, "
-                    "       Images.modificationDate, Images.fileSize, "
-                    "       ImageInformation.width, ImageInformation.height "
-                    " FROM Images "
-                    "       LEFT JOIN ImageInformation ON Images.id=ImageInformation.imageid "
-                    " WHERE Images.id = ?;"));
+        QList<QVariant> values;
+        QString         errMsg;
+        bool            executionSuccess;
 
-        query.addBindValue(variantIdList);
-        executionSuccess = query.execBatch
-*/
-        CoreDbAccess access;
-        DbEngineSqlQuery query = access.backend()->prepareQuery(QString::fromUtf8(
-                             "SELECT DISTINCT Images.id, Images.name, Images.album, "
-                             "       Albums.albumRoot, "
-                             "       ImageInformation.rating, Images.category, "
-                             "       ImageInformation.format, ImageInformation.creationDate, "
-                             "       Images.modificationDate, Images.fileSize, "
-                             "       ImageInformation.width, ImageInformation.height "
-                             " FROM Images "
-                             "       LEFT JOIN ImageInformation ON Images.id=ImageInformation.imageid "
-                             "       LEFT JOIN Albums ON Albums.id=Images.album "
-                             " WHERE Images.status=1 AND Images.id = ?;"));
-
-        foreach(const qlonglong& id, imageIds)
         {
-            query.bindValue(0, id);
-            executionSuccess = access.backend()->exec(query);
+            CoreDbReadAccess access;
+            executionSuccess = access.backend()->execSql(QString::fromUtf8(
+                                   "SELECT DISTINCT Images.id, Images.name, Images.album, "
+                                   "       Albums.albumRoot, "
+                                   "       ImageInformation.rating, Images.category, "
+                                   "       ImageInformation.format, ImageInformation.creationDate, "
+                                   "       Images.modificationDate, Images.fileSize, "
+                                   "       ImageInformation.width, ImageInformation.height "
+                                   " FROM Images "
+                                   "       LEFT JOIN ImageInformation ON Images.id=ImageInformation.imageid "
+                                   "       LEFT JOIN Albums ON Albums.id=Images.album "
+                                   " WHERE Images.status=1 AND Images.id IN (%1);")
+                                   .arg(ids.join(QLatin1Char(','))),
+                                   &values);
 
             if (!executionSuccess)
             {
                 errMsg = access.backend()->lastError();
-                break;
             }
+        }
 
-            // append results to list
-            values << access.backend()->readToList(query);
+        if (!executionSuccess)
+        {
+            receiver->error(errMsg);
+            return;
         }
 
-    }
+        QHash<qlonglong, ImageListerRecord> records;
+        records.reserve(end - start);
+        int width, height;
 
-    if (!executionSuccess)
-    {
-        receiver->error(errMsg);
-        return;
-    }
+        for (QList<QVariant>::const_iterator it = values.constBegin() ; it != values.constEnd() ;)
+        {
+            ImageListerRecord record;
 
-    int width, height;
+            record.imageID           = (*it).toLongLong();
+            ++it;
+            record.name              = (*it).toString();
+            ++it;
+            record.albumID           = (*it).toInt();
+            ++it;
+            record.albumRootID       = (*it).toInt();
+            ++it;
+            record.rating            = (*it).toInt();
+            ++it;
+            record.category          = (DatabaseItem::Category)(*it).toInt();
+            ++it;
+            record.format            = (*it).toString();
+            ++it;
+            record.creationDate      = (*it).toDateTime();
+            ++it;
+            record.modificationDate  = (*it).toDateTime();
+            ++it;
+            record.fileSize          = toInt32BitSafe(it);
+            ++it;
+            width                    = (*it).toInt();
+            ++it;
+            height                   = (*it).toInt();
+            ++it;
 
-    for (QList<QVariant>::const_iterator it = values.constBegin() ; it != values.constEnd() ;)
-    {
-        ImageListerRecord record;
+            record.imageSize         = QSize(width, height);
+            record.currentSimilarity = imageSimilarityMap.value(record.imageID);
 
-        record.imageID           = (*it).toLongLong();
-        ++it;
-        record.name              = (*it).toString();
-        ++it;
-        record.albumID           = (*it).toInt();
-        ++it;
-        record.albumRootID       = (*it).toInt();
-        ++it;
-        record.rating            = (*it).toInt();
-        ++it;
-        record.category          = (DatabaseItem::Category)(*it).toInt();
-        ++it;
-        record.format            = (*it).toString();
-        ++it;
-        record.creationDate      = (*it).toDateTime();
-        ++it;
-        record.modificationDate  = (*it).toDateTime();
-        ++it;
-        record.fileSize          = toInt32BitSafe(it);
-        ++it;
-        width                    = (*it).toInt();
-        ++it;
-        height                   = (*it).toInt();
-        ++it;
+            records.insert(record.imageID, record);
+        }
 
-        record.imageSize         = QSize(width, height);
+        // Keep the order of the given ids, as with one query per id.
+        for (int i = start ; i < end ; ++i)
+        {
+            QHash<qlonglong, ImageListerRecord>::const_iterator it = records.constFind(imageIds.at(i));
 
-        receiver->receive(record);
+            if (it != records.constEnd())
+            {
+                receiver->receive(it.value());
+            }
+        }
     }
 }
 
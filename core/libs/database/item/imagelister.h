@@ -140,6 +140,13 @@ private:
      */
     void listFromHaarSearch(ImageListerReceiver* const receiver, const QMap<qlonglong, double>& imageSimilarityMap);
     void listFromIdList(ImageListerReceiver* const receiver, const QList<qlonglong>& imageIds);
+
+    /**
+     * This method generates image records for the receiver with one query per chunk of ids,
+     * in the order of the ids. The similarity of an image is taken from imageSimilarityMap, if found.
+     */
+    void listFromIdChunks(ImageListerReceiver* const receiver, const QList<qlonglong>& imageIds,
+                          const QMap<qlonglong, double>& imageSimilarityMap);
     QSet<int> albumRootsToList() const;
 
 private:
@@ -1533,23 +1533,43 @@ bool ImageQueryBuilder::buildField(QString& sql, SearchXmlCachingReader& reader,
         addSqlOperator(sql, SearchXml::Or, true);
         buildField(sql, reader, QLatin1String("albumname"), boundValues, hooks);
 
-        addSqlOperator(sql, SearchXml::Or, false);
-        buildField(sql, reader, QLatin1String("filename"), boundValues, hooks);
-
-        addSqlOperator(sql, SearchXml::Or, false);
-        buildField(sql, reader, QLatin1String("tagname"), boundValues, hooks);
-
         addSqlOperator(sql, SearchXml::Or, false);
         buildField(sql, reader, QLatin1String("albumcaption"), boundValues, hooks);
 
         addSqlOperator(sql, SearchXml::Or, false);
         buildField(sql, reader, QLatin1String("albumcollection"), boundValues, hooks);
 
-        addSqlOperator(sql, SearchXml::Or, false);
-        buildField(sql, reader, QLatin1String("comment"), boundValues, hooks);
+        // The fields of the images are looked up in the full text index if there is one,
+        // instead of a LIKE condition on each table, which scans all the rows.
+        QString         fullTextCondition;
+        QList<QVariant> fullTextValues;
 
-        addSqlOperator(sql, SearchXml::Or, false);
-        buildField(sql, reader, QLatin1String("title"), boundValues, hooks);
+        if (relation == SearchXml::Like)
+        {
+            fullTextCondition = CoreDbReadAccess().db()->fullTextCondition(reader.value(), CoreDB::FullTextAll,
+                                                                           &fullTextValues);
+        }
+
+        if (!fullTextCondition.isNull())
+        {
+            addSqlOperator(sql, SearchXml::Or, false);
+            sql += QLatin1String(" (") + fullTextCondition + QLatin1String(") ");
+            *boundValues << fullTextValues;
+        }
+        else
+        {
+            addSqlOperator(sql, SearchXml::Or, false);
+            buildField(sql, reader, QLatin1String("filename"), boundValues, hooks);
+
+            addSqlOperator(sql, SearchXml::Or, false);
+            buildField(sql, reader, QLatin1String("tagname"), boundValues, hooks);
+
+            addSqlOperator(sql, SearchXml::Or, false);
+            buildField(sql, reader, QLatin1String("comment"), boundValues, hooks);
+
+            addSqlOperator(sql, SearchXml::Or, false);
+            buildField(sql, reader, QLatin1String("title"), boundValues, hooks);
+        }
 
         sql += QLatin1String(" ) ");
     }
@@ -41,6 +41,7 @@
 #include "coredb.h"
 #include "similaritydbaccess.h"
 #include "similaritydb.h"
+#include "haariface.h"
 #include "collectionlocation.h"
 #include "collectionmanager.h"
 #include "facetagseditor.h"
@@ -140,7 +141,8 @@ public:
           hasMetadata(false),
           loadedFromDisk(false),
           scanMode(ModifiedScan),
-          hasHistoryToResolve(false)
+          hasHistoryToResolve(false),
+          batch(0)
     {
         time.start();
     }
@@ -161,10 +163,93 @@ public:
     bool                   hasHistoryToResolve;
 
     ImageScannerCommit     commit;
+    ImageScannerCommitBatch* batch;
 
     QTime                  time;
 };
 
+// ---------------------------------------------------------------------------
+
+class Q_DECL_HIDDEN ImageScannerCommitBatch::Private
+{
+public:
+
+    class Rows
+    {
+    public:
+
+        QList<qlonglong>    ids;
+        QList<QVariantList> infos;
+    };
+
+public:
+
+    explicit Private()
+        : count(0)
+    {
+    }
+
+    /// Rows are grouped by field set, the key being the value of the flags
+    QMap<int, Rows> imageInformation;
+    QMap<int, Rows> imageMetadata;
+    QMap<int, Rows> imagePositions;
+
+    int             count;
+};
+
+ImageScannerCommitBatch::ImageScannerCommitBatch()
+    : d(new Private)
+{
+}
+
+ImageScannerCommitBatch::~ImageScannerCommitBatch()
+{
+    flush();
+    delete d;
+}
+
+int ImageScannerCommitBatch::count() const
+{
+    return d->count;
+}
+
+void ImageScannerCommitBatch::flush()
+{
+    if (d->imageInformation.isEmpty() && d->imageMetadata.isEmpty() && d->imagePositions.isEmpty())
+    {
+        d->count = 0;
+        return;
+    }
+
+    CoreDbAccess access;
+    QMap<int, Private::Rows>::const_iterator it;
+
+    for (it = d->imageInformation.constBegin() ; it != d->imageInformation.constEnd() ; ++it)
+    {
+        access.db()->addImageInformation(it.value().ids, it.value().infos,
+                                         DatabaseFields::ImageInformation(QFlag(it.key())));
+    }
+
+    for (it = d->imageMetadata.constBegin() ; it != d->imageMetadata.constEnd() ; ++it)
+    {
+        access.db()->addImageMetadata(it.value().ids, it.value().infos,
+                                      DatabaseFields::ImageMetadata(QFlag(it.key())));
+    }
+
+    for (it = d->imagePositions.constBegin() ; it != d->imagePositions.constEnd() ; ++it)
+    {
+        access.db()->addImagePosition(it.value().ids, it.value().infos,
+                                      DatabaseFields::ImagePositions(QFlag(it.key())));
+    }
+
+    d->imageInformation.clear();
+    d->imageMetadata.clear();
+    d->imagePositions.clear();
+    d->count = 0;
+}
+
+// ---------------------------------------------------------------------------
+
 ImageScanner::ImageScanner(const QFileInfo& info, const ItemScanInfo& scanInfo)
     : d(new Private)
 {
@@ -210,10 +295,27 @@ void ImageScanner::setCategory(DatabaseItem::Category category)
     d->scanInfo.category = category;
 }
 
-void ImageScanner::commit()
+void ImageScanner::commit(ImageScannerCommitBatch* const batch)
 {
     qCDebug(DIGIKAM_DATABASE_LOG) << "Scanning took" << d->time.restart() << "ms";
 
+    if (d->commit.operation == ImageScannerCommit::NoOp)
+    {
+        return;
+    }
+
+    d->batch = batch;
+    commitOperations();
+    d->batch = 0;
+
+    if (batch)
+    {
+        batch->d->count++;
+    }
+}
+
+void ImageScanner::commitOperations()
+{
     switch (d->commit.operation)
     {
         case ImageScannerCommit::NoOp:
@@ -228,6 +330,12 @@ void ImageScanner::commit()
 
     if (d->commit.copyImageAttributesId != -1)
     {
+        // the source may be an item whose rows are still in the batch
+        if (d->batch)
+        {
+            d->batch->flush();
+        }
+
         commitCopyImageAttributes();
         return;
     }
@@ -391,6 +499,7 @@ void ImageScanner::commitCopyImageAttributes()
     CoreDbAccess().db()->copyImageAttributes(d->commit.copyImageAttributesId, d->scanInfo.id);
     // Also copy the similarity information
     SimilarityDbAccess().db()->copySimilarityAttributes(d->commit.copyImageAttributesId, d->scanInfo.id);
+    HaarIface::invalidateSignatureCache();
     // Remove grouping for copied or identical images.
     CoreDbAccess().db()->removeAllImageRelationsFrom(d->scanInfo.id, DatabaseRelation::Grouped);
     CoreDbAccess().db()->removeAllImageRelationsTo(d->scanInfo.id, DatabaseRelation::Grouped);
@@ -626,7 +735,13 @@ void ImageScanner::scanImageInformation()
 
 void ImageScanner::commitImageInformation()
 {
-    if (d->scanMode == NewScan)
+    if (d->scanMode == NewScan && d->batch)
+    {
+        ImageScannerCommitBatch::Private::Rows& rows = d->batch->d->imageInformation[int(d->commit.imageInformationFields)];
+        rows.ids   << d->scanInfo.id;
+        rows.infos << d->commit.imageInformationInfos;
+    }
+    else if (d->scanMode == NewScan)
     {
         CoreDbAccess().db()->addImageInformation(d->scanInfo.id,
                                                  d->commit.imageInformationInfos,
@@ -690,6 +805,14 @@ void ImageScanner::scanImageMetadata()
 
 void ImageScanner::commitImageMetadata()
 {
+    if (d->batch)
+    {
+        ImageScannerCommitBatch::Private::Rows& rows = d->batch->d->imageMetadata[int(DatabaseFields::ImageMetadataAll)];
+        rows.ids   << d->scanInfo.id;
+        rows.infos << d->commit.imageMetadataInfos;
+        return;
+    }
+
     CoreDbAccess().db()->addImageMetadata(d->scanInfo.id, d->commit.imageMetadataInfos);
 }
 
@@ -719,6 +842,14 @@ void ImageScanner::scanImagePosition()
 
 void ImageScanner::commitImagePosition()
 {
+    if (d->batch)
+    {
+        ImageScannerCommitBatch::Private::Rows& rows = d->batch->d->imagePositions[int(DatabaseFields::ImagePositionsAll)];
+        rows.ids   << d->scanInfo.id;
+        rows.infos << d->commit.imagePositionInfos;
+        return;
+    }
+
     CoreDbAccess().db()->addImagePosition(d->scanInfo.id, d->commit.imagePositionInfos);
 }
 
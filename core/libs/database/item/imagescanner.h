@@ -40,6 +40,48 @@
 namespace Digikam
 {
 
+/**
+ * Collects the rows written to the ImageInformation, ImageMetadata and ImagePositions
+ * tables by the commit of several ImageScanner objects, and writes them with
+ * one multi-row statement per table and field set when flushed.
+ * The other tables are written immediately.
+ * Use it inside a CoreDbOperationGroup or a CoreDbTransaction spanning the batch,
+ * so that the whole batch is written in one transaction.
+ */
+class DIGIKAM_DATABASE_EXPORT ImageScannerCommitBatch
+{
+
+public:
+
+    explicit ImageScannerCommitBatch();
+
+    /**
+     * Flushes the rows still in the batch.
+     */
+    ~ImageScannerCommitBatch();
+
+    /**
+     * Returns the number of scanners committed to the batch since the last flush.
+     */
+    int  count() const;
+
+    /**
+     * Writes the collected rows to the database.
+     */
+    void flush();
+
+private:
+
+    ImageScannerCommitBatch(const ImageScannerCommitBatch&); // Disable
+
+    friend class ImageScanner;
+
+    class Private;
+    Private* const d;
+};
+
+// ---------------------------------------------------------------------------
+
 class DIGIKAM_DATABASE_EXPORT ImageScanner
 {
 
@@ -79,8 +121,10 @@ public:
      * Commits the scanned information to the database.
      * You must call this after scanning was done for any changes to take effect.
      * Only this method will perform write operations to the database.
+     * If a batch is given, the rows of the tables handled by the batch are
+     * only written when the batch is flushed.
      */
-    void commit();
+    void commit(ImageScannerCommitBatch* const batch = 0);
 
     /**
      * Returns the image id of the scanned file, if (yet) available.
@@ -230,6 +274,8 @@ public:
 
 protected:
 
+    void commitOperations();
+
     bool scanFromIdenticalFile();
     bool copyFromSource(qlonglong src);
     void commitCopyImageAttributes();
@@ -428,6 +428,7 @@ void ImageFilterModel::setImageFilterSettings(const ImageFilterSettings& setting
         d->needPrepareTags     = settings.isFilteringByTags();
         d->needPrepareGroups   = true;
         d->needPrepare         = d->needPrepareComments || d->needPrepareTags || d->needPrepareGroups;
+        d->prepareFields       = settings.watchFlags() | d->sorter.watchFlags();
 
         d->hasOneMatch         = false;
         d->hasOneMatchForText  = false;
@@ -647,6 +648,7 @@ void ImageFilterModelPreparer::process(ImageFilterModelTodoPackage package)
 
     // get thread-local copy
     bool needPrepareTags, needPrepareComments, needPrepareGroups;
+    DatabaseFields::Set prepareFields;
     QList<ImageFilterModelPrepareHook*> prepareHooks;
 
     {
@@ -654,6 +656,7 @@ void ImageFilterModelPreparer::process(ImageFilterModelTodoPackage package)
         needPrepareTags     = d->needPrepareTags;
         needPrepareComments = d->needPrepareComments;
         needPrepareGroups   = d->needPrepareGroups;
+        prepareFields       = d->prepareFields;
         prepareHooks        = d->prepareHooks;
     }
 
@@ -675,12 +678,11 @@ void ImageFilterModelPreparer::process(ImageFilterModelTodoPackage package)
     // The downside of QVector: At some point, we may need a QList for an API.
     // Nonetheless, QList and ImageInfo is fast. We could as well
     // reimplement ImageInfoList to ImageInfoVector (internally with templates?)
-    ImageInfoList infoList;
+    ImageInfoList infoList = ImageInfoList(package.infos.toList());
 
-    if (needPrepareTags || needPrepareGroups)
-    {
-        infoList = ImageInfoList(package.infos.toList());
-    }
+    // Load in bulk the fields compared by the filter and the sorter,
+    // instead of one query per item and field at first comparison.
+    infoList.loadFields(prepareFields);
 
     if (needPrepareTags)
     {
@@ -789,6 +791,18 @@ void ImageFilterModel::setImageSortSettings(const ImageSortSettings& sorter)
 {
     Q_D(ImageFilterModel);
     d->sorter = sorter;
+
+    {
+        QMutexLocker lock(&d->mutex);
+        d->prepareFields = d->filter.watchFlags() | d->sorter.watchFlags();
+    }
+
+    if (d->imageModel)
+    {
+        // Sorting compares each item several times: load the fields used for sorting at once.
+        ImageInfoList(d->imageModel->imageInfos()).loadFields(d->sorter.watchFlags());
+    }
+
     setCategorizedModel(d->sorter.categorizationMode != ImageSortSettings::NoCategories);
     invalidate();
 }
@@ -47,6 +47,7 @@ ImageFilterModel::ImageFilterModelPrivate::ImageFilterModelPrivate()
     needPrepareComments   = false;
     needPrepareTags       = false;
     needPrepareGroups     = false;
+    prepareFields         = DatabaseFields::Set();
     preparer              = 0;
     filterer              = 0;
     hasOneMatch           = false;
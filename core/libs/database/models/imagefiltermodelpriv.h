@@ -118,6 +118,9 @@ public:
     bool                                needPrepareTags;
     bool                                needPrepareGroups;
 
+    /// Fields used to filter and sort, loaded in bulk by the preparer
+    DatabaseFields::Set                 prepareFields;
+
     QMutex                              mutex;
     ImageFilterSettings                 filterCopy;
     VersionImageFilterSettings          versionFilterCopy;
@@ -34,6 +34,7 @@
 #include "digikam_export.h"
 #include "digikam_globals.h"
 #include "thumbnailloadthread.h"
+#include "thumbnailprefetcher.h"
 
 namespace Digikam
 {
@@ -45,6 +46,7 @@ public:
     explicit Private()
       : thread(0),
         preloadThread(0),
+        prefetcher(0),
         thumbSize(0),
         lastGlobalThumbSize(0),
         preloadThumbSize(0),
@@ -55,6 +57,7 @@ public:
 
     ThumbnailLoadThread*   thread;
     ThumbnailLoadThread*   preloadThread;
+    ThumbnailPrefetcher*   prefetcher;
     ThumbnailSize          thumbSize;
     ThumbnailSize          lastGlobalThumbSize;
     ThumbnailSize          preloadThumbSize;
@@ -84,6 +87,7 @@ ImageThumbnailModel::ImageThumbnailModel(QObject* const parent)
 ImageThumbnailModel::~ImageThumbnailModel()
 {
     delete d->preloadThread;
+    delete d->prefetcher;
     delete d;
 }
 
@@ -202,6 +206,28 @@ void ImageThumbnailModel::preloadThumbnails(const QList<QModelIndex>& indexesToP
     d->preloadThread->pregenerateGroup(ids, d->preloadThumbnailSize());
 }
 
+void ImageThumbnailModel::prefetchThumbnails(const QList<QModelIndex>& indexesToPrefetch, const ThumbnailSize& thumbSize)
+{
+    if (!d->thread)
+    {
+        return;
+    }
+
+    if (!d->prefetcher)
+    {
+        d->prefetcher = new ThumbnailPrefetcher;
+    }
+
+    QList<ThumbnailIdentifier> ids;
+
+    foreach(const QModelIndex& index, indexesToPrefetch)
+    {
+        ids << imageInfoRef(index).thumbnailIdentifier();
+    }
+
+    d->prefetcher->prefetch(ids, thumbSize.size());
+}
+
 void ImageThumbnailModel::preloadAllThumbnails()
 {
     preloadThumbnails(imageInfos());
@@ -213,6 +239,11 @@ void ImageThumbnailModel::imageInfosCleared()
     {
         d->preloadThread->stopAllTasks();
     }
+
+    if (d->prefetcher)
+    {
+        d->prefetcher->cancel();
+    }
 }
 
 QVariant ImageThumbnailModel::data(const QModelIndex& index, int role) const
@@ -116,6 +116,13 @@ public Q_SLOTS:
     void preloadThumbnails(const QList<QModelIndex>&);
     void preloadAllThumbnails();
 
+    /**
+     *  Load in advance the thumbnails of the given indexes, in order of priority, on several threads.
+     *  The pixmaps are created when the thumbnails are requested with prepareThumbnails() or data().
+     *  Note: Cancels prefetching of previously given indexes which are not in the list.
+     */
+    void prefetchThumbnails(const QList<QModelIndex>& indexesToPrefetch, const ThumbnailSize& thumbSize);
+
 Q_SIGNALS:
 
     void thumbnailAvailable(const QModelIndex& index, int requestedSize);
@@ -224,6 +224,55 @@ QList<int> ThumbsDb::findAll()
     return thumbIds;
 }
 
+ThumbsDbInfo ThumbsDb::findById(int thumbId)
+{
+    QList<QVariant> values;
+    d->db->execSql(QLatin1String("SELECT id, type, modificationDate, orientationHint, data "
+                                 "FROM Thumbnails "
+                                 "WHERE id=?;"),
+                   thumbId, &values);
+
+    ThumbsDbInfo info;
+    fillThumbnailInfo(values, info);
+    return info;
+}
+
+void ThumbsDb::findReferences(int thumbId, QList<QPair<QString, qlonglong> >& uniqueHashes,
+                              QStringList& filePaths, QStringList& customIdentifiers)
+{
+    QList<QVariant> values;
+    d->db->execSql(QLatin1String("SELECT uniqueHash, fileSize FROM UniqueHashes WHERE thumbId=?;"),
+                   thumbId, &values);
+
+    for (QList<QVariant>::const_iterator it = values.constBegin() ; it != values.constEnd() ; )
+    {
+        QString   hash = (*it).toString();
+        ++it;
+        qlonglong size = (*it).toLongLong();
+        ++it;
+
+        uniqueHashes << qMakePair(hash, size);
+    }
+
+    values.clear();
+    d->db->execSql(QLatin1String("SELECT path FROM FilePaths WHERE thumbId=?;"),
+                   thumbId, &values);
+
+    foreach(const QVariant& path, values)
+    {
+        filePaths << path.toString();
+    }
+
+    values.clear();
+    d->db->execSql(QLatin1String("SELECT identifier FROM CustomIdentifiers WHERE thumbId=?;"),
+                   thumbId, &values);
+
+    foreach(const QVariant& identifier, values)
+    {
+        customIdentifiers << identifier.toString();
+    }
+}
+
 QHash<QString, int> ThumbsDb::getFilePathsWithThumbnail()
 {
     DbEngineSqlQuery query = d->db->prepareQuery(QString::fromLatin1("SELECT path, id "
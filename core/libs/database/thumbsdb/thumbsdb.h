@@ -31,6 +31,8 @@
 #include <QString>
 #include <QHash>
 #include <QList>
+#include <QPair>
+#include <QStringList>
 
 // Local includes
 
@@ -103,6 +105,14 @@ public:
      */
     QList<int> findAll();
 
+    ThumbsDbInfo findById(int thumbId);
+
+    /** Returns all uniqueHash + fileSize pairs, file paths and custom identifiers
+     *  referencing the given thumbnail. Used to export thumbnails to another storage.
+     */
+    void findReferences(int thumbId, QList<QPair<QString, qlonglong> >& uniqueHashes,
+                        QStringList& filePaths, QStringList& customIdentifiers);
+
     BdEngineBackend::QueryState insertUniqueHash(const QString& uniqueHash, qlonglong fileSize, int thumbId);
     BdEngineBackend::QueryState insertFilePath(const QString& path, int thumbId);
     BdEngineBackend::QueryState insertCustomIdentifier(const QString& id, int thumbId);
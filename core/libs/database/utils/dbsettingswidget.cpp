@@ -99,6 +99,8 @@ public:
         ignoreDirectoriesBox   = 0;
         ignoreDirectoriesEdit  = 0;
         ignoreDirectoriesLabel = 0;
+        sqliteTuningBox        = 0;
+        sqliteTuning           = 0;
     }
 
     DVBox*             mysqlCmdBox;
@@ -136,6 +138,9 @@ public:
     QGroupBox*         ignoreDirectoriesBox;
     QLineEdit*         ignoreDirectoriesEdit;
     QLabel*            ignoreDirectoriesLabel;
+
+    DHBox*             sqliteTuningBox;
+    QComboBox*         sqliteTuning;
 };
 
 DatabaseSettingsWidget::DatabaseSettingsWidget(QWidget* const parent)
@@ -217,6 +222,19 @@ void DatabaseSettingsWidget::setupMainArea()
     d->dbPathEdit  = new DFileSelector(dbConfigBox);
     d->dbPathEdit->setFileDlgMode(QFileDialog::Directory);
 
+    d->sqliteTuningBox              = new DHBox(dbConfigBox);
+    QLabel* const sqliteTuningLabel = new QLabel(i18n("Tuning:"), d->sqliteTuningBox);
+    d->sqliteTuning                 = new QComboBox(d->sqliteTuningBox);
+    d->sqliteTuning->addItem(i18n("Default"),           DbEngineParameters::SQLiteDefaultTuningProfile());
+    d->sqliteTuning->addItem(i18n("Large collections"), DbEngineParameters::SQLiteThroughputTuningProfile());
+    d->sqliteTuning->setToolTip(i18n("<p>Select here the SQLite settings used with the databases.</p>"
+                                     "<p><b>Default</b> writes each change safely to the disk before to continue.</p>"
+                                     "<p><b>Large collections</b> uses write-ahead logging, so the views are read while changes "
+                                     "are written, uses more memory for caches and syncs the disk less often. "
+                                     "It is faster with huge collections, but the last changes can be lost on a power failure.</p>"));
+    sqliteTuningLabel->setBuddy(d->sqliteTuning);
+    d->sqliteTuningBox->setStretchFactor(d->sqliteTuning, 10);
+
     // --------------------------------------------------------
 
     d->mysqlCmdBox = new DVBox(dbConfigBox);
@@ -431,6 +449,7 @@ void DatabaseSettingsWidget::setupMainArea()
     vlay->addWidget(new DLineWidget(Qt::Horizontal));
     vlay->addWidget(d->dbPathLabel);
     vlay->addWidget(d->dbPathEdit);
+    vlay->addWidget(d->sqliteTuningBox);
     vlay->addWidget(d->mysqlCmdBox);
     vlay->addWidget(d->tab);
     vlay->setContentsMargins(spacing, spacing, spacing, spacing);
@@ -532,6 +551,7 @@ void DatabaseSettingsWidget::setDatabaseInputFields(int index)
         {
             d->dbPathLabel->setVisible(true);
             d->dbPathEdit->setVisible(true);
+            d->sqliteTuningBox->setVisible(true);
             d->mysqlCmdBox->setVisible(false);
             d->tab->setVisible(false);
 
@@ -544,6 +564,7 @@ void DatabaseSettingsWidget::setDatabaseInputFields(int index)
         {
             d->dbPathLabel->setVisible(true);
             d->dbPathEdit->setVisible(true);
+            d->sqliteTuningBox->setVisible(false);
             d->mysqlCmdBox->setVisible(true);
             d->tab->setVisible(false);
 
@@ -556,6 +577,7 @@ void DatabaseSettingsWidget::setDatabaseInputFields(int index)
         {
             d->dbPathLabel->setVisible(false);
             d->dbPathEdit->setVisible(false);
+            d->sqliteTuningBox->setVisible(false);
             d->mysqlCmdBox->setVisible(false);
             d->tab->setVisible(true);
 
@@ -738,6 +760,9 @@ void DatabaseSettingsWidget::setParametersFromSettings(const ApplicationSettings
 {
     d->orgPrms = settings->getDbEngineParameters();
 
+    int tuningIndex = d->sqliteTuning->findData(d->orgPrms.sqliteTuningProfile);
+    d->sqliteTuning->setCurrentIndex((tuningIndex == -1) ? 0 : tuningIndex);
+
     if (d->orgPrms.databaseType == DbEngineParameters::SQLiteDatabaseType())
     {
         d->dbPathEdit->setFileDlgPath(d->orgPrms.getCoreDatabaseNameOrDir());
@@ -816,6 +841,8 @@ DbEngineParameters DatabaseSettingsWidget::getDbEngineParameters() const
             break;
     }
 
+    prm.sqliteTuningProfile = d->sqliteTuning->currentData().toString();
+
     return prm;
 }
 
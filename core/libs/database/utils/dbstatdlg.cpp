@@ -41,6 +41,7 @@
 #include "coredb.h"
 #include "applicationsettings.h"
 #include "coredbaccess.h"
+#include "coredbbackend.h"
 #include "digikam_config.h"
 
 namespace Digikam
@@ -82,6 +83,16 @@ DBStatDlg::DBStatDlg(QWidget* const parent)
     if (dbBe == QLatin1String("QSQLITE"))
     {
         new QTreeWidgetItem(listView(), QStringList() << i18n("Database Path") << prm.getCoreDatabaseNameOrDir());
+        new QTreeWidgetItem(listView(), QStringList() << i18n("Tuning profile") << prm.sqliteTuningProfile);
+
+        // Values really in use by the core database connection.
+        QList<QPair<QString, QString> > pragmas = CoreDbAccess().backend()->sqliteTuningSettings();
+
+        for (int i = 0 ; i < pragmas.size() ; ++i)
+        {
+            new QTreeWidgetItem(listView(), QStringList() << QString::fromLatin1("PRAGMA %1").arg(pragmas.at(i).first)
+                                                          << pragmas.at(i).second);
+        }
     }
     else
     {
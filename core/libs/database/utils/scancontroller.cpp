@@ -28,6 +28,7 @@
 // Qt includes
 
 #include <QStringList>
+#include <QHash>
 #include <QFileInfo>
 #include <QPixmap>
 #include <QIcon>
@@ -111,7 +112,9 @@ public:
         progressDialog(0),
         advice(ScanController::Success),
         needTotalFiles(false),
-        totalFilesToScan(0)
+        totalFilesToScan(0),
+        completeScanBatchCommitSize(0),
+        finishScanBatchCommitSize(0)
     {
     }
 
@@ -160,6 +163,11 @@ public:
     bool                            needTotalFiles;
     int                             totalFilesToScan;
 
+    /// Batch commit sizes of the scans, passed with each scan task
+    QHash<QString, int>             scanTaskBatchCommitSizes;
+    int                             completeScanBatchCommitSize;
+    int                             finishScanBatchCommitSize;
+
 public:
 
     QPixmap albumPixmap()
@@ -432,19 +440,20 @@ void ScanController::completeCollectionScan(bool defer)
     d->progressDialog = 0;
 }
 
-void ScanController::completeCollectionScanInBackground(bool defer)
+void ScanController::completeCollectionScanInBackground(bool defer, int batchCommitSize)
 {
-    completeCollectionScanCore(true, defer);
+    completeCollectionScanCore(true, defer, batchCommitSize);
 }
 
-void ScanController::completeCollectionScanCore(bool needTotalFiles, bool defer)
+void ScanController::completeCollectionScanCore(bool needTotalFiles, bool defer, int batchCommitSize)
 {
     d->needTotalFiles = needTotalFiles;
 
     {
         QMutexLocker lock(&d->mutex);
-        d->needsCompleteScan = true;
-        d->deferFileScanning = defer;
+        d->needsCompleteScan           = true;
+        d->deferFileScanning           = defer;
+        d->completeScanBatchCommitSize = batchCommitSize;
         d->condVar.wakeAll();
     }
 
@@ -474,7 +483,7 @@ void ScanController::updateUniqueHash()
     d->needTotalFiles = false;
 }
 
-void ScanController::scheduleCollectionScan(const QString& path)
+void ScanController::scheduleCollectionScan(const QString& path, int batchCommitSize)
 {
     QMutexLocker lock(&d->mutex);
 
@@ -483,6 +492,11 @@ void ScanController::scheduleCollectionScan(const QString& path)
         d->scanTasks << path;
     }
 
+    if (batchCommitSize > d->scanTaskBatchCommitSizes.value(path))
+    {
+        d->scanTaskBatchCommitSizes[path] = batchCommitSize;
+    }
+
     d->condVar.wakeAll();
 }
 
@@ -623,6 +637,7 @@ void ScanController::cancelAllAndSuspendCollectionScan()
     d->continueScan           = false;
 
     d->scanTasks.clear();
+    d->scanTaskBatchCommitSizes.clear();
     d->continuePartialScan    = false;
 
     d->relaxedTimer->stop();
@@ -667,6 +682,7 @@ void ScanController::run()
         bool doFinishScan       = false;
         bool doPartialScan      = false;
         bool doUpdateUniqueHash = false;
+        int  batchCommitSize    = 0;
 
         QString task;
         {
@@ -682,6 +698,7 @@ void ScanController::run()
                 d->needsCompleteScan = false;
                 doScan               = true;
                 doScanDeferred       = d->deferFileScanning;
+                batchCommitSize      = d->completeScanBatchCommitSize;
             }
             else if (d->needsUpdateUniqueHash)
             {
@@ -692,11 +709,13 @@ void ScanController::run()
             {
                 // d->completeScanDeferredAlbums is only accessed from the thread, no need to copy
                 doFinishScan             = true;
+                batchCommitSize          = d->finishScanBatchCommitSize;
             }
             else if (!d->scanTasks.isEmpty() && !d->scanSuspended)
             {
-                doPartialScan = true;
-                task          = d->scanTasks.takeFirst();
+                doPartialScan   = true;
+                task            = d->scanTasks.takeFirst();
+                batchCommitSize = d->scanTaskBatchCommitSizes.take(task);
             }
             else
             {
@@ -728,6 +747,7 @@ void ScanController::run()
             scanner.setNeedFileCount(d->needTotalFiles);
             scanner.setDeferredFileScanning(doScanDeferred);
             scanner.setHintContainer(d->hints);
+            scanner.setBatchCommitSize(batchCommitSize);
 
             SimpleCollectionScannerObserver observer(&d->continueScan);
             scanner.setObserver(&observer);
@@ -739,7 +759,8 @@ void ScanController::run()
             if (doScanDeferred)
             {
                 d->completeScanDeferredAlbums = scanner.deferredAlbumPaths();
-                d->finishScanAllowed = false;
+                d->finishScanAllowed          = false;
+                d->finishScanBatchCommitSize  = batchCommitSize;
             }
         }
         else if (doFinishScan)
@@ -757,6 +778,7 @@ void ScanController::run()
             scanner.setNeedFileCount(true);//d->needTotalFiles);
 
             scanner.setHintContainer(d->hints);
+            scanner.setBatchCommitSize(batchCommitSize);
 
             SimpleCollectionScannerObserver observer(&d->continueScan);
             scanner.setObserver(&observer);
@@ -771,6 +793,7 @@ void ScanController::run()
         {
             CollectionScanner scanner;
             scanner.setHintContainer(d->hints);
+            scanner.setBatchCommitSize(batchCommitSize);
             //connectCollectionScanner(&scanner);
             SimpleCollectionScannerObserver observer(&d->continuePartialScan);
             scanner.setObserver(&observer);
@@ -88,8 +88,10 @@ public:
 
     /**
      * Scan Whole collection without to display a progress dialog or to manage splashscreen, as for NewItemsFinder tool.
+     * New files are written to the database in batches of batchCommitSize files,
+     * see CollectionScanner::setBatchCommitSize(). The deferred files are scanned with the same size.
      */
-    void completeCollectionScanInBackground(bool defer);
+    void completeCollectionScanInBackground(bool defer, int batchCommitSize = 0);
 
     /**
      * Carries out a complete collection scan, at the same time updating
@@ -102,8 +104,10 @@ public:
     /**
      * Schedules a scan of the specified part of the collection.
      * Asynchronous, returns immediately.
+     * New files are written to the database in batches of batchCommitSize files,
+     * see CollectionScanner::setBatchCommitSize(). Default is 0, no batches.
      */
-    void scheduleCollectionScan(const QString& path);
+    void scheduleCollectionScan(const QString& path, int batchCommitSize = 0);
 
     /**
      * Schedules a scan of the specified part of the collection.
@@ -262,7 +266,7 @@ private:
     void createProgressDialog();
     void setInitializationMessage();
 
-    void completeCollectionScanCore(bool needTotalFiles, bool defer);
+    void completeCollectionScanCore(bool needTotalFiles, bool defer, int batchCommitSize = 0);
 
     virtual void moreSchemaUpdateSteps(int numberOfSteps);
     virtual void schemaUpdateProgress(const QString& message, int numberOfSteps);
@@ -47,11 +47,20 @@ extern "C"
 #include <cstdlib>
 #include <cstdio>
 
+// Qt includes
+
+#include <QFuture>
+#include <QList>
+#include <QThreadPool>
+#include <QtConcurrent>    // krazy:exclude=includes
+
 // Local includes
 
 #include "digikam_debug.h"
 #include "dimg.h"
 #include "dimg_p.h"
+#include "dimgscale.h"
+#include "dimgscale_p.h"
 
 typedef uint64_t ullong;    // krazy:exclude=typedefs
 typedef int64_t  llong;     // krazy:exclude=typedefs
@@ -155,6 +164,13 @@ void dimgScaleAARGB16(DImgScaleInfo* const isi, ullong* const dest,
                       int dxx, int dyy, int dw, int dh,
                       int dow, int sow,
                       int clip_dx, int clip_dy, int clip_dw, int clip_dh);
+
+// 8 and 16 bit, RGB and RGBA, on the current kernel and by bands of rows for large images
+void dimgScaleAA(DImgScaleInfo* const isi, uchar* const dest,
+                 bool sixteenBit, bool hasAlpha,
+                 int dxx, int dyy, int dw, int dh,
+                 int dow, int sow,
+                 int clip_dx, int clip_dy, int clip_dw, int clip_dh);
 }
 
 using namespace DImgScale;
@@ -229,36 +245,9 @@ DImg DImg::smoothScaleClipped(int dw, int dh, int clipx, int clipy, int clipw, i
 
     DImg buffer(*this, clipw, cliph);
 
-    if (sixteenBit())
-    {
-        if (hasAlpha())
-        {
-            dimgScaleAARGBA16(scaleinfo, reinterpret_cast<ullong*>(buffer.bits()),
-                              0, 0, dw, dh, clipw, w,
-                              clipx, clipy, clipw, cliph);
-        }
-        else
-        {
-            dimgScaleAARGB16(scaleinfo, reinterpret_cast<ullong*>(buffer.bits()),
-                             0, 0, dw, dh, clipw, w,
-                             clipx, clipy, clipw, cliph);
-        }
-    }
-    else
-    {
-        if (hasAlpha())
-        {
-            dimgScaleAARGBA(scaleinfo, reinterpret_cast<uint*>(buffer.bits()),
-                            0, 0, dw, dh, clipw, w,
-                            clipx, clipy, clipw, cliph);
-        }
-        else
-        {
-            dimgScaleAARGB(scaleinfo, reinterpret_cast<uint*>(buffer.bits()),
-                           0, 0, dw, dh, clipw, w,
-                           clipx, clipy, clipw, cliph);
-        }
-    }
+    dimgScaleAA(scaleinfo, buffer.bits(), sixteenBit(), hasAlpha(),
+                0, 0, dw, dh, clipw, w,
+                clipx, clipy, clipw, cliph);
 
     delete scaleinfo;
 
@@ -336,46 +325,12 @@ DImg DImg::smoothScaleSection(int sx, int sy,
 
     DImg buffer(*this, dw, dh);
 
-    if (sixteenBit())
-    {
-        if (hasAlpha())
-        {
-            dimgScaleAARGBA16(scaleinfo, reinterpret_cast<ullong*>(buffer.bits()),
-                              ((sx * dw) / sw),
-                              ((sy * dh) / sh),
-                              dw, dh,
-                              dw, w);
-        }
-        else
-        {
-            dimgScaleAARGB16(scaleinfo, reinterpret_cast<ullong*>(buffer.bits()),
-                             ((sx * dw) / sw),
-                             ((sy * dh) / sh),
-                             dw, dh,
-                             dw, w);
-        }
-    }
-    else
-    {
-        if (hasAlpha())
-        {
-            dimgScaleAARGBA(scaleinfo,
-                            reinterpret_cast<uint*>(buffer.bits()),
-                            ((sx * dw) / sw),
-                            ((sy * dh) / sh),
-                            dw, dh,
-                            dw, w);
-        }
-        else
-        {
-            dimgScaleAARGB(scaleinfo,
-                           reinterpret_cast<uint*>(buffer.bits()),
-                           ((sx * dw) / sw),
-                           ((sy * dh) / sh),
-                           dw, dh,
-                           dw, w);
-        }
-    }
+    dimgScaleAA(scaleinfo, buffer.bits(), sixteenBit(), hasAlpha(),
+                ((sx * dw) / sw),
+                ((sy * dh) / sh),
+                dw, dh,
+                dw, w,
+                0, 0, dw, dh);
 
     delete scaleinfo;
 
@@ -554,6 +509,165 @@ DImgScaleInfo* DImgScale::dimgCalcScaleInfo(const DImg& img,
     return isi;
 }
 
+// ------------------------------------------------------------------------------------------
+
+static DImgScale::Kernel& currentKernel()
+{
+    static DImgScale::Kernel kernel = DImgScale::bestSupportedKernel();
+    return kernel;
+}
+
+DImgScale::Kernel DImgScale::bestSupportedKernel()
+{
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+
+    if (dimgScaleAAAVX2Compiled() && __builtin_cpu_supports("avx2"))
+    {
+        return AVX2Kernel;
+    }
+
+    if (dimgScaleAASSE41Compiled() && __builtin_cpu_supports("sse4.1"))
+    {
+        return SSE41Kernel;
+    }
+
+#endif
+
+    return GenericKernel;
+}
+
+void DImgScale::setKernel(Kernel kernel)
+{
+    Kernel best = bestSupportedKernel();
+
+    if (kernel > best)
+    {
+        qCDebug(DIGIKAM_DIMG_LOG) << "Scaling kernel" << kernel << "not supported, using" << best;
+        kernel = best;
+    }
+
+    currentKernel() = kernel;
+}
+
+DImgScale::Kernel DImgScale::kernel()
+{
+    return currentKernel();
+}
+
+/** Scale a band of rows, on the SIMD kernel if selected, else on the generic kernels.
+ */
+static void dimgScaleAABand(DImgScaleInfo* const isi, DImgScaleAAParams params, DImgScale::Kernel kernel)
+{
+    if (kernel == DImgScale::AVX2Kernel && dimgScaleAAAVX2(params))
+    {
+        return;
+    }
+
+    if (kernel >= DImgScale::SSE41Kernel && dimgScaleAASSE41(params))
+    {
+        return;
+    }
+
+    if (params.sixteenBit)
+    {
+        if (params.hasAlpha)
+        {
+            dimgScaleAARGBA16(isi, static_cast<ullong*>(params.dest),
+                              params.dxx, params.dyy, params.dw, params.dh, params.dow, params.sow,
+                              params.clip_dx, params.clip_dy, params.clip_dw, params.clip_dh);
+        }
+        else
+        {
+            dimgScaleAARGB16(isi, static_cast<ullong*>(params.dest),
+                             params.dxx, params.dyy, params.dw, params.dh, params.dow, params.sow,
+                             params.clip_dx, params.clip_dy, params.clip_dw, params.clip_dh);
+        }
+    }
+    else
+    {
+        if (params.hasAlpha)
+        {
+            dimgScaleAARGBA(isi, static_cast<uint*>(params.dest),
+                            params.dxx, params.dyy, params.dw, params.dh, params.dow, params.sow,
+                            params.clip_dx, params.clip_dy, params.clip_dw, params.clip_dh);
+        }
+        else
+        {
+            dimgScaleAARGB(isi, static_cast<uint*>(params.dest),
+                           params.dxx, params.dyy, params.dw, params.dh, params.dow, params.sow,
+                           params.clip_dx, params.clip_dy, params.clip_dw, params.clip_dh);
+        }
+    }
+}
+
+/** The destination rows are independent, so large images are scaled by bands of rows
+ *  in parallel on the global thread pool. The result does not depend on the bands.
+ */
+void DImgScale::dimgScaleAA(DImgScaleInfo* const isi, uchar* const dest,
+                            bool sixteenBit, bool hasAlpha,
+                            int dxx, int dyy, int dw, int dh,
+                            int dow, int sow,
+                            int clip_dx, int clip_dy, int clip_dw, int clip_dh)
+{
+    DImgScaleAAParams params;
+    params.xpoints        = isi->xpoints;
+    params.ypoints        = isi->ypoints;
+    params.ypoints16      = isi->ypoints16;
+    params.xapoints       = isi->xapoints;
+    params.yapoints       = isi->yapoints;
+    params.xup_yup        = isi->xup_yup;
+    params.dxx            = dxx;
+    params.dyy            = dyy;
+    params.dw             = dw;
+    params.dh             = dh;
+    params.dow            = dow;
+    params.sow            = sow;
+    params.clip_dx        = clip_dx;
+    params.clip_dw        = clip_dw;
+    params.sixteenBit     = sixteenBit;
+    params.hasAlpha       = hasAlpha;
+
+    const Kernel kernel   = currentKernel();
+    const int bytesDepth  = sixteenBit ? 8 : 4;
+    int workers           = 1;
+
+    if ((qint64)clip_dw * clip_dh >= 256 * 256)
+    {
+        workers = qBound(1, QThreadPool::globalInstance()->maxThreadCount(), clip_dh);
+    }
+
+    QList<QFuture<void> > tasks;
+
+    for (int i = 0 ; i < workers ; ++i)
+    {
+        const int start = (qint64)clip_dh * i       / workers;
+        const int stop  = (qint64)clip_dh * (i + 1) / workers;
+
+        if (start == stop)
+        {
+            continue;
+        }
+
+        params.dest     = dest + (qint64)start * dow * bytesDepth;
+        params.clip_dy  = clip_dy + start;
+        params.clip_dh  = stop - start;
+
+        if (workers == 1)
+        {
+            dimgScaleAABand(isi, params, kernel);
+        }
+        else
+        {
+            tasks.append(QtConcurrent::run(dimgScaleAABand, isi, params, kernel));
+        }
+    }
+
+    foreach (QFuture<void> t, tasks)
+    {
+        t.waitForFinished();
+    }
+}
+
 /** scale by pixel sampling only */
 void DImgScale::dimgSampleRGBA(DImgScaleInfo* const isi, uint* const dest,
                                int dxx, int dyy, int dw, int dh, int dow)
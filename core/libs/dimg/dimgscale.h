@@ -0,0 +1,63 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-18
+ * Description : Selection of the anti-aliased scaling kernels
+ *               used by DImg::smoothScale()
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_DIMG_SCALE_H
+#define DIGIKAM_DIMG_SCALE_H
+
+// Local includes
+
+#include "digikam_export.h"
+
+namespace Digikam
+{
+
+namespace DImgScale
+{
+
+/**
+ * The kernels computing the anti-aliased scaling of DImg::smoothScale(),
+ * DImg::smoothScaleClipped() and DImg::smoothScaleSection().
+ * All kernels give the same pixels, bit for bit. The best kernel
+ * supported by the CPU is selected at runtime, and is used by default.
+ */
+enum Kernel
+{
+    GenericKernel = 0,
+    SSE41Kernel,
+    AVX2Kernel
+};
+
+/**
+ * Set the kernel used from now. If the kernel is not supported,
+ * the best supported kernel is used instead. Used by unit tests.
+ */
+DIGIKAM_EXPORT void   setKernel(Kernel kernel);
+DIGIKAM_EXPORT Kernel kernel();
+DIGIKAM_EXPORT Kernel bestSupportedKernel();
+
+} // namespace DImgScale
+
+} // namespace Digikam
+
+#endif // DIGIKAM_DIMG_SCALE_H
@@ -0,0 +1,72 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-18
+ * Description : AVX2 anti-aliased scaling kernels.
+ *               This file is compiled with the AVX2 flags.
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+// Do not include Qt or other shared headers here: their inline functions
+// would be compiled with the AVX2 flags and could be used by any caller.
+
+#include "dimgscale_p.h"
+
+namespace Digikam
+{
+
+namespace DImgScale
+{
+
+bool dimgScaleAAAVX2Compiled()
+{
+#if defined(__AVX2__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool dimgScaleAAAVX2(const DImgScaleAAParams& params)
+{
+#if defined(__AVX2__)
+
+    if (params.sixteenBit)
+    {
+        dimgScaleAAKernel<DImgScaleOps16AVX2>(params);
+    }
+    else
+    {
+        // An 8 bits pixel fits in 128 bits, the SSE4.1 operations are used with the AVX encoding.
+        dimgScaleAAKernel<DImgScaleOps8SSE41>(params);
+    }
+
+    return true;
+
+#else
+
+    (void)params;
+
+    return false;
+
+#endif
+}
+
+} // namespace DImgScale
+
+} // namespace Digikam
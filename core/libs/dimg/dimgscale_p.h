@@ -0,0 +1,491 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-18
+ * Description : Anti-aliased scaling kernels shared with the SIMD
+ *               translation units. This header must stay free of Qt
+ *               and of any inline code shared with other units, as it
+ *               is compiled with CPU specific flags.
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_DIMG_SCALE_P_H
+#define DIGIKAM_DIMG_SCALE_P_H
+
+// C ANSI includes
+
+extern "C"
+{
+#include <stdint.h>
+}
+
+// SIMD includes
+
+#if defined(__SSE4_1__)
+#   include <smmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#   include <immintrin.h>
+#endif
+
+namespace Digikam
+{
+
+namespace DImgScale
+{
+
+/** The parameters of an anti-aliased scaling of a band of destination rows.
+ *  The points are the ones computed by dimgCalcScaleInfo(), the other values
+ *  are the arguments of dimgScaleAARGBA() and friends.
+ */
+class DImgScaleAAParams
+{
+public:
+
+    DImgScaleAAParams()
+      : xpoints(0),
+        ypoints(0),
+        ypoints16(0),
+        xapoints(0),
+        yapoints(0),
+        xup_yup(0),
+        dest(0),
+        dxx(0),
+        dyy(0),
+        dw(0),
+        dh(0),
+        dow(0),
+        sow(0),
+        clip_dx(0),
+        clip_dy(0),
+        clip_dw(0),
+        clip_dh(0),
+        sixteenBit(false),
+        hasAlpha(false)
+    {
+    }
+
+    int*        xpoints;
+    uint32_t**  ypoints;
+    uint64_t**  ypoints16;
+    int*        xapoints;
+    int*        yapoints;
+    int         xup_yup;
+
+    void*       dest;       // first pixel of the band in the destination
+    int         dxx;
+    int         dyy;
+    int         dw;
+    int         dh;
+    int         dow;
+    int         sow;
+    int         clip_dx;
+    int         clip_dy;    // first row of the band
+    int         clip_dw;
+    int         clip_dh;    // number of rows of the band
+
+    bool        sixteenBit;
+    bool        hasAlpha;
+};
+
+/**
+ * SIMD kernels, defined in their own translation units compiled with the CPU flags.
+ * The compiled() functions return false if the compiler or the platform do not
+ * support the instruction set, the kernels then return false without scaling.
+ * Both kernels give the same results as the generic kernels, bit for bit.
+ */
+bool dimgScaleAASSE41Compiled();
+bool dimgScaleAASSE41(const DImgScaleAAParams& params);
+
+bool dimgScaleAAAVX2Compiled();
+bool dimgScaleAAAVX2(const DImgScaleAAParams& params);
+
+// ------------------------------------------------------------------------------------------
+
+#if defined(__SSE4_1__)
+
+namespace
+{
+
+/// Sum of the pixels covered by a destination pixel along one direction, weighted by 1 << 14.
+template <class Ops, int Shift>
+inline typename Ops::Vec dimgScaleAASum(const typename Ops::Pixel* pix, int step, int ap, int C)
+{
+    typename Ops::Vec v = Ops::template shr<Shift>(Ops::mul(Ops::load(pix), ap));
+    int j;
+
+    for (j = (1 << 14) - ap ; j > C ; j -= C)
+    {
+        pix += step;
+        v    = Ops::add(v, Ops::template shr<Shift>(Ops::mul(Ops::load(pix), C)));
+    }
+
+    if (j > 0)
+    {
+        pix += step;
+        v    = Ops::add(v, Ops::template shr<Shift>(Ops::mul(Ops::load(pix), j)));
+    }
+
+    return v;
+}
+
+/// 8 bits pixels, the 4 channels in 32 bits lanes.
+class DImgScaleOps8SSE41
+{
+public:
+
+    typedef uint32_t Pixel;
+    typedef __m128i  Vec;
+
+    static inline Pixel** ypoints(const DImgScaleAAParams& p)
+    {
+        return p.ypoints;
+    }
+
+    static inline Vec load(const Pixel* const pix)
+    {
+        return _mm_cvtepu8_epi32(_mm_cvtsi32_si128((int)*pix));
+    }
+
+    static inline Vec mul(const Vec& v, int c)
+    {
+        return _mm_mullo_epi32(v, _mm_set1_epi32(c));
+    }
+
+    static inline Vec add(const Vec& a, const Vec& b)
+    {
+        return _mm_add_epi32(a, b);
+    }
+
+    template <int N>
+    static inline Vec shr(const Vec& v)
+    {
+        return _mm_srli_epi32(v, N);
+    }
+
+    static inline void store(Pixel* const dptr, const Vec& v, bool opaque)
+    {
+        const __m128i low = _mm_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+        Pixel pixel       = (Pixel)_mm_cvtsi128_si32(_mm_shuffle_epi8(v, low));
+        *dptr             = opaque ? (pixel | 0xFF000000) : pixel;
+    }
+};
+
+/** 16 bits pixels, the 4 channels in 64 bits lanes, blue and green in the first vector,
+ *  red and alpha in the second one. The products are computed from the low 32 bits of the
+ *  lanes: the values of the generic kernels stay below 65535 << 8 before a product.
+ */
+class DImgScaleOps16SSE41
+{
+public:
+
+    typedef uint64_t Pixel;
+
+    class Vec
+    {
+    public:
+
+        __m128i bg;
+        __m128i ra;
+    };
+
+    static inline Pixel** ypoints(const DImgScaleAAParams& p)
+    {
+        return p.ypoints16;
+    }
+
+    static inline Vec load(const Pixel* const pix)
+    {
+        const __m128i p = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pix));
+        Vec v;
+        v.bg            = _mm_cvtepu16_epi64(p);
+        v.ra            = _mm_cvtepu16_epi64(_mm_srli_si128(p, 4));
+
+        return v;
+    }
+
+    static inline Vec mul(const Vec& v, int c)
+    {
+        const __m128i m = _mm_set1_epi32(c);
+        Vec r;
+        r.bg            = _mm_mul_epu32(v.bg, m);
+        r.ra            = _mm_mul_epu32(v.ra, m);
+
+        return r;
+    }
+
+    static inline Vec add(const Vec& a, const Vec& b)
+    {
+        Vec r;
+        r.bg = _mm_add_epi64(a.bg, b.bg);
+        r.ra = _mm_add_epi64(a.ra, b.ra);
+
+        return r;
+    }
+
+    template <int N>
+    static inline Vec shr(const Vec& v)
+    {
+        Vec r;
+        r.bg = _mm_srli_epi64(v.bg, N);
+        r.ra = _mm_srli_epi64(v.ra, N);
+
+        return r;
+    }
+
+    static inline void store(Pixel* const dptr, const Vec& v, bool opaque)
+    {
+        store(dptr, v.bg, v.ra, opaque);
+    }
+
+    static inline void store(Pixel* const dptr, const __m128i& bg, const __m128i& ra, bool opaque)
+    {
+        const __m128i lowBG = _mm_setr_epi8(0, 1, 8, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+        const __m128i lowRA = _mm_setr_epi8(-1, -1, -1, -1, 0, 1, 8, 9, -1, -1, -1, -1, -1, -1, -1, -1);
+        __m128i pixel       = _mm_or_si128(_mm_shuffle_epi8(bg, lowBG), _mm_shuffle_epi8(ra, lowRA));
+
+        if (opaque)
+        {
+            pixel = _mm_insert_epi16(pixel, 0xFFFF, 3);
+        }
+
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dptr), pixel);
+    }
+};
+
+#if defined(__AVX2__)
+
+/// 16 bits pixels, the 4 channels in the 64 bits lanes of one vector.
+class DImgScaleOps16AVX2
+{
+public:
+
+    typedef uint64_t Pixel;
+    typedef __m256i  Vec;
+
+    static inline Pixel** ypoints(const DImgScaleAAParams& p)
+    {
+        return p.ypoints16;
+    }
+
+    static inline Vec load(const Pixel* const pix)
+    {
+        return _mm256_cvtepu16_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pix)));
+    }
+
+    static inline Vec mul(const Vec& v, int c)
+    {
+        return _mm256_mul_epu32(v, _mm256_set1_epi32(c));
+    }
+
+    static inline Vec add(const Vec& a, const Vec& b)
+    {
+        return _mm256_add_epi64(a, b);
+    }
+
+    template <int N>
+    static inline Vec shr(const Vec& v)
+    {
+        return _mm256_srli_epi64(v, N);
+    }
+
+    static inline void store(Pixel* const dptr, const Vec& v, bool opaque)
+    {
+        DImgScaleOps16SSE41::store(dptr, _mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1), opaque);
+    }
+};
+
+#endif // __AVX2__
+
+/** The kernel follows the generic kernels, with all channels of a pixel in one vector:
+ *  each channel gets the same integer operations, in the same order, with the same shifts.
+ *  Ops provides the load of a pixel, the operations and the store of a pixel, which
+ *  keeps the low bits of each channel, like the assignment of an int to a channel.
+ */
+template <class Ops>
+void dimgScaleAAKernel(const DImgScaleAAParams& p)
+{
+    typedef typename Ops::Pixel Pixel;
+    typedef typename Ops::Vec   Vec;
+
+    Pixel** const ypoints     = Ops::ypoints(p);
+    const int* const xpoints  = p.xpoints;
+    const int* const xapoints = p.xapoints;
+    const int* const yapoints = p.yapoints;
+    Pixel* const dest         = static_cast<Pixel*>(p.dest);
+    const int sow             = p.sow;
+    const int dyy             = p.dyy;
+    const bool opaque         = !p.hasAlpha;
+
+    const int x_begin         = p.dxx + p.clip_dx;     // no clip set = dxx
+    const int x_end           = x_begin + p.clip_dw;   // no clip set = dxx + dw
+    const int y_begin         = p.clip_dy;             // no clip set = 0
+    const int y_end           = p.clip_dy + p.clip_dh; // no clip set = dh
+
+    /* scaling up both ways */
+    if (p.xup_yup == 3)
+    {
+        for (int y = y_begin ; y < y_end ; ++y)
+        {
+            Pixel* dptr       = dest + (y - y_begin) * p.dow;
+            Pixel* const sptr = ypoints[dyy + y];
+            const int yap     = yapoints[dyy + y];
+
+            for (int x = x_begin ; x < x_end ; ++x, ++dptr)
+            {
+                const int xap    = xapoints[x];
+                const Pixel* pix = sptr + xpoints[x];
+
+                if (yap > 0)
+                {
+                    if (xap > 0)
+                    {
+                        Vec v  = Ops::add(Ops::mul(Ops::load(pix), 256 - xap),
+                                          Ops::mul(Ops::load(pix + 1), xap));
+                        Vec vv = Ops::add(Ops::mul(Ops::load(pix + sow + 1), xap),
+                                          Ops::mul(Ops::load(pix + sow), 256 - xap));
+                        v      = Ops::template shr<16>(Ops::add(Ops::mul(vv, yap), Ops::mul(v, 256 - yap)));
+                        Ops::store(dptr, v, opaque);
+                    }
+                    else
+                    {
+                        Vec v = Ops::add(Ops::mul(Ops::load(pix), 256 - yap),
+                                         Ops::mul(Ops::load(pix + sow), yap));
+                        Ops::store(dptr, Ops::template shr<8>(v), opaque);
+                    }
+                }
+                else
+                {
+                    if (xap > 0)
+                    {
+                        Vec v = Ops::add(Ops::mul(Ops::load(pix), 256 - xap),
+                                         Ops::mul(Ops::load(pix + 1), xap));
+                        Ops::store(dptr, Ops::template shr<8>(v), opaque);
+                    }
+                    else
+                    {
+                        *dptr = *pix;
+                    }
+                }
+            }
+        }
+    }
+    /* if we're scaling down vertically */
+    else if (p.xup_yup == 1)
+    {
+        for (int y = y_begin ; y < y_end ; ++y)
+        {
+            Pixel* dptr       = dest + (y - y_begin) * p.dow;
+            Pixel* const sptr = ypoints[dyy + y];
+            const int Cy      = yapoints[dyy + y] >> 16;
+            const int yap     = yapoints[dyy + y] & 0xffff;
+
+            for (int x = x_begin ; x < x_end ; ++x, ++dptr)
+            {
+                const int xap = xapoints[x];
+                Vec v         = dimgScaleAASum<Ops, 10>(sptr + xpoints[x], sow, yap, Cy);
+
+                if (xap > 0)
+                {
+                    Vec vv = dimgScaleAASum<Ops, 10>(sptr + xpoints[x] + 1, sow, yap, Cy);
+                    v      = Ops::template shr<12>(Ops::add(Ops::mul(v, 256 - xap), Ops::mul(vv, xap)));
+                }
+                else
+                {
+                    v      = Ops::template shr<4>(v);
+                }
+
+                Ops::store(dptr, v, opaque);
+            }
+        }
+    }
+    /* if we're scaling down horizontally */
+    else if (p.xup_yup == 2)
+    {
+        for (int y = y_begin ; y < y_end ; ++y)
+        {
+            Pixel* dptr       = dest + (y - y_begin) * p.dow;
+            Pixel* const sptr = ypoints[dyy + y];
+            const int yap     = yapoints[dyy + y];
+
+            for (int x = x_begin ; x < x_end ; ++x, ++dptr)
+            {
+                const int Cx  = xapoints[x] >> 16;
+                const int xap = xapoints[x] & 0xffff;
+                Vec v         = dimgScaleAASum<Ops, 10>(sptr + xpoints[x], 1, xap, Cx);
+
+                if (yap > 0)
+                {
+                    Vec vv = dimgScaleAASum<Ops, 10>(sptr + xpoints[x] + sow, 1, xap, Cx);
+                    v      = Ops::template shr<12>(Ops::add(Ops::mul(v, 256 - yap), Ops::mul(vv, yap)));
+                }
+                else
+                {
+                    v      = Ops::template shr<4>(v);
+                }
+
+                Ops::store(dptr, v, opaque);
+            }
+        }
+    }
+    /* if we're scaling down horizontally & vertically */
+    else
+    {
+        for (int y = y_begin ; y < y_end ; ++y)
+        {
+            Pixel* dptr   = dest + (y - y_begin) * p.dow;
+            const int Cy  = yapoints[dyy + y] >> 16;
+            const int yap = yapoints[dyy + y] & 0xffff;
+
+            for (int x = x_begin ; x < x_end ; ++x, ++dptr)
+            {
+                const int Cx     = xapoints[x] >> 16;
+                const int xap    = xapoints[x] & 0xffff;
+                const Pixel* row = ypoints[dyy + y] + xpoints[x];
+
+                Vec v            = Ops::template shr<14>(Ops::mul(dimgScaleAASum<Ops, 9>(row, 1, xap, Cx), yap));
+                int j;
+
+                for (j = (1 << 14) - yap ; j > Cy ; j -= Cy)
+                {
+                    row += sow;
+                    v    = Ops::add(v, Ops::template shr<14>(Ops::mul(dimgScaleAASum<Ops, 9>(row, 1, xap, Cx), Cy)));
+                }
+
+                if (j > 0)
+                {
+                    row += sow;
+                    v    = Ops::add(v, Ops::template shr<14>(Ops::mul(dimgScaleAASum<Ops, 9>(row, 1, xap, Cx), j)));
+                }
+
+                Ops::store(dptr, Ops::template shr<5>(v), opaque);
+            }
+        }
+    }
+}
+
+} // namespace
+
+#endif // __SSE4_1__
+
+} // namespace DImgScale
+
+} // namespace Digikam
+
+#endif // DIGIKAM_DIMG_SCALE_P_H
@@ -29,9 +29,16 @@
 // Qt includes
 
 #include <QDataStream>
+#include <QDateTime>
 #include <QFile>
+#include <QFileInfo>
+#include <QFuture>
 #include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QThreadPool>
 #include <QVarLengthArray>
+#include <QtConcurrent>    // krazy:exclude=includes
 
 // KDE includes
 
@@ -57,6 +64,7 @@ public:
         intent         = INTENT_PERCEPTUAL;
         transformFlags = 0;
         proofIntent    = INTENT_ABSOLUTE_COLORIMETRIC;
+        gamutAlarm     = 0;
     }
 
     bool operator==(const TransformDescription& other) const
@@ -81,8 +89,295 @@ public:
     int        transformFlags;
     IccProfile proofProfile;
     int        proofIntent;
+    QRgb       gamutAlarm;
 };
 
+// ---------------------------------------------------------------------------------------
+
+/** Process-wide cache of LittleCMS transforms, keyed by the transform description:
+ *  profiles, formats (and thus depth), intents and flags. Profiles are compared by
+ *  file path, so the modification dates of the profile files are part of the key too:
+ *  a profile edited in place gets a new transform. Building a transform is
+ *  expensive compared to applying it to a thumbnail or a preview, and the same
+ *  profile pairs are used again and again. Transforms in use are never deleted,
+ *  the least recently used unused transforms are deleted beyond MaxUnusedTransforms.
+ *  All transforms are created with cmsFLAGS_NOCACHE, so a handle can be applied
+ *  by several threads at once.
+ */
+class Q_DECL_HIDDEN TransformCache
+{
+public:
+
+    enum
+    {
+        MaxUnusedTransforms = 8
+    };
+
+    class Entry
+    {
+    public:
+
+        TransformDescription description;
+        QList<QDateTime>     profileDates;
+        cmsHTRANSFORM        handle;
+        int                  users;
+    };
+
+public:
+
+    ~TransformCache()
+    {
+        // Called at application exit, when no other thread uses LittleCMS anymore.
+
+        foreach (const Entry& entry, entries)
+        {
+            dkCmsDeleteTransform(entry.handle);
+        }
+    }
+
+    cmsHTRANSFORM acquire(const TransformDescription& description)
+    {
+        const QList<QDateTime> dates = QList<QDateTime>() << profileDate(description.inputProfile)
+                                                          << profileDate(description.outputProfile)
+                                                          << profileDate(description.proofProfile);
+
+        QMutexLocker locker(&mutex);
+
+        for (int i = 0 ; i < entries.size() ; ++i)
+        {
+            if (entries.at(i).description == description && entries.at(i).profileDates == dates)
+            {
+                Entry entry = entries.takeAt(i);
+                entry.users++;
+                entries.prepend(entry);
+
+                return entry.handle;
+            }
+        }
+
+        cmsHTRANSFORM handle = 0;
+
+        {
+            LcmsLock lock;
+
+            if (description.proofProfile.isNull())
+            {
+                handle = dkCmsCreateTransform(description.inputProfile,
+                                              description.inputFormat,
+                                              description.outputProfile,
+                                              description.outputFormat,
+                                              description.intent,
+                                              description.transformFlags);
+            }
+            else
+            {
+                handle = dkCmsCreateProofingTransform(description.inputProfile,
+                                                      description.inputFormat,
+                                                      description.outputProfile,
+                                                      description.outputFormat,
+                                                      description.proofProfile,
+                                                      description.intent,
+                                                      description.proofIntent,
+                                                      description.transformFlags);
+            }
+        }
+
+        if (!handle)
+        {
+            return 0;
+        }
+
+        Entry entry;
+        entry.description  = description;
+        entry.profileDates = dates;
+        entry.handle       = handle;
+        entry.users       = 1;
+        entries.prepend(entry);
+
+        purge();
+
+        return handle;
+    }
+
+    void release(cmsHTRANSFORM handle)
+    {
+        QMutexLocker locker(&mutex);
+
+        for (int i = 0 ; i < entries.size() ; ++i)
+        {
+            if (entries.at(i).handle == handle)
+            {
+                entries[i].users--;
+                break;
+            }
+        }
+
+        purge();
+    }
+
+private:
+
+    static QDateTime profileDate(const IccProfile& profile)
+    {
+        const QString filePath = profile.filePath();
+
+        return (filePath.isEmpty() ? QDateTime() : QFileInfo(filePath).lastModified());
+    }
+
+    void purge()
+    {
+        int unused = 0;
+
+        for (int i = 0 ; i < entries.size() ; ++i)
+        {
+            if (entries.at(i).users > 0 || ++unused <= MaxUnusedTransforms)
+            {
+                continue;
+            }
+
+            LcmsLock lock;
+            dkCmsDeleteTransform(entries.at(i).handle);
+            entries.removeAt(i);
+            --i;
+        }
+    }
+
+private:
+
+    QMutex       mutex;
+    QList<Entry> entries;
+};
+
+Q_GLOBAL_STATIC(TransformCache, transformCache)
+
+// ---------------------------------------------------------------------------------------
+
+/** LittleCMS reads the gamut alarm codes from its context when a proofing transform is applied,
+ *  not when it is created. The codes are set just before a gamut check transform is applied,
+ *  and these transforms are applied one at a time, so each one uses its own alarm color.
+ */
+class Q_DECL_HIDDEN GamutAlarmLocker
+{
+public:
+
+    explicit GamutAlarmLocker(const TransformDescription& description)
+        : checkGamut(description.transformFlags & cmsFLAGS_GAMUTCHECK)
+    {
+        if (checkGamut)
+        {
+            mutex()->lock();
+            dkCmsSetAlarmCodes(qRed(description.gamutAlarm),
+                               qGreen(description.gamutAlarm),
+                               qBlue(description.gamutAlarm));
+        }
+    }
+
+    ~GamutAlarmLocker()
+    {
+        if (checkGamut)
+        {
+            mutex()->unlock();
+        }
+    }
+
+private:
+
+    static QMutex* mutex()
+    {
+        static QMutex gamutAlarmMutex;
+        return &gamutAlarmMutex;
+    }
+
+private:
+
+    const bool checkGamut;
+};
+
+// ---------------------------------------------------------------------------------------
+
+/// Transform the pixels of one band of rows. The handle is created with cmsFLAGS_NOCACHE.
+static void transformBand(cmsHTRANSFORM handle, uchar* data, int pixels, int bytesDepth, bool inPlace)
+{
+    // convert by batches of 4096 pixels
+    const int pixelsPerStep = qMin(pixels, 4096);
+
+    if (inPlace)
+    {
+        for (int p = pixels ; p > 0 ; p -= pixelsPerStep)
+        {
+            int pixelsThisStep = qMin(p, pixelsPerStep);
+            dkCmsDoTransform(handle, data, data, pixelsThisStep);
+            data              += pixelsThisStep * bytesDepth;
+        }
+    }
+    else
+    {
+        QVarLengthArray<uchar> buffer(pixelsPerStep * bytesDepth);
+
+        for (int p = pixels ; p > 0 ; p -= pixelsPerStep)
+        {
+            int pixelsThisStep = qMin(p, pixelsPerStep);
+            int size           = pixelsThisStep * bytesDepth;
+            memcpy(buffer.data(), data, size);
+            dkCmsDoTransform(handle, buffer.data(), data, pixelsThisStep);
+            data              += size;
+        }
+    }
+}
+
+/** Transform the image by bands of rows, in parallel on the global thread pool for large images.
+ *  The image is split in more bands than threads, so that progress is reported regularly.
+ */
+static void transformRows(cmsHTRANSFORM handle, uchar* const bits, int width, int height, int bytesDepth,
+                          bool inPlace, DImg* const image, DImgLoaderObserver* const observer)
+{
+    const qint64 pixels = (qint64)width * height;
+    int workers         = 1;
+
+    if (pixels >= 512 * 512)
+    {
+        workers = qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+    }
+
+    const int steps = qMax(1, qMin(height, qMax(20, workers * 4)));
+
+    for (int step = 0 ; step < steps ; step += workers)
+    {
+        QList<QFuture<void> > tasks;
+
+        for (int i = 0 ; (i < workers) && (step + i < steps) ; ++i)
+        {
+            const int start  = (qint64)height * (step + i)     / steps;
+            const int stop   = (qint64)height * (step + i + 1) / steps;
+            uchar* const row = bits + (qint64)start * width * bytesDepth;
+
+            if (start == stop)
+            {
+                continue;
+            }
+
+            if (workers == 1)
+            {
+                transformBand(handle, row, (stop - start) * width, bytesDepth, inPlace);
+            }
+            else
+            {
+                tasks.append(QtConcurrent::run(transformBand, handle, row, (stop - start) * width, bytesDepth, inPlace));
+            }
+        }
+
+        foreach (QFuture<void> t, tasks)
+        {
+            t.waitForFinished();
+        }
+
+        if (observer)
+        {
+            observer->progressInfo(image, 0.1 + 0.9 * (float)qMin(step + workers, steps) / (float)steps);
+        }
+    }
+}
+
 class Q_DECL_HIDDEN IccTransform::Private : public QSharedData
 {
 public:
@@ -139,8 +434,7 @@ public:
         if (handle)
         {
             currentDescription = TransformDescription();
-            LcmsLock lock;
-            dkCmsDeleteTransform(handle);
+            transformCache->release(handle);
             handle = 0;
         }
     }
@@ -441,6 +735,9 @@ TransformDescription IccTransform::getDescription(const DImg& image)
         description.transformFlags |= cmsFLAGS_WHITEBLACKCOMPENSATION;
     }
 
+    // Transforms are shared between threads, see TransformCache.
+    description.transformFlags |= cmsFLAGS_NOCACHE;
+
     LcmsLock lock;
 
     // Do not use TYPE_BGR_ - this implies 3 bytes per pixel, but even if !image.hasAlpha(),
@@ -487,6 +784,9 @@ TransformDescription IccTransform::getDescription(const QImage&)
         description.transformFlags |= cmsFLAGS_WHITEBLACKCOMPENSATION;
     }
 
+    // Transforms are shared between threads, see TransformCache.
+    description.transformFlags |= cmsFLAGS_NOCACHE;
+
     description.inputFormat  = TYPE_BGRA_8;
     description.outputFormat = TYPE_BGRA_8;
 
@@ -504,7 +804,7 @@ TransformDescription IccTransform::getProofingDescription(const DImg& image)
 
     if (d->checkGamut)
     {
-        dkCmsSetAlarmCodes(d->checkGamutColor.red(), d->checkGamutColor.green(), d->checkGamutColor.blue());
+        description.gamutAlarm      = d->checkGamutColor.rgb();
         description.transformFlags |= cmsFLAGS_GAMUTCHECK;
     }
 
@@ -526,14 +826,7 @@ bool IccTransform::open(TransformDescription& description)
     }
 
     d->currentDescription = description;
-
-    LcmsLock lock;
-    d->handle = dkCmsCreateTransform(description.inputProfile,
-                                     description.inputFormat,
-                                     description.outputProfile,
-                                     description.outputFormat,
-                                     description.intent,
-                                     description.transformFlags);
+    d->handle             = transformCache->acquire(description);
 
     if (!d->handle)
     {
@@ -559,16 +852,7 @@ bool IccTransform::openProofing(TransformDescription& description)
     }
 
     d->currentDescription = description;
-
-    LcmsLock lock;
-    d->handle = dkCmsCreateProofingTransform(description.inputProfile,
-                                             description.inputFormat,
-                                             description.outputProfile,
-                                             description.outputFormat,
-                                             description.proofProfile,
-                                             description.intent,
-                                             description.proofIntent,
-                                             description.transformFlags);
+    d->handle             = transformCache->acquire(description);
 
     if (!d->handle)
     {
@@ -696,78 +980,18 @@ bool IccTransform::apply(QImage& qimage)
 
 void IccTransform::transform(DImg& image, const TransformDescription& description, DImgLoaderObserver* const observer)
 {
-    const int bytesDepth    = image.bytesDepth();
-    const int pixels        = image.width() * image.height();
-    // convert ten scanlines in a batch
-    const int pixelsPerStep = image.width() * 10;
-    uchar* data             = image.bits();
-
-    // see dimgloader.cpp, granularity().
-    int granularity         = 1;
-
-    if (observer)
-    {
-        granularity = (int)((pixels / (20 * 0.9)) / observer->granularity());
-    }
-
-    int checkPoint = pixels;
+    GamutAlarmLocker alarm(description);
 
     // it is safe to use the same input and output buffer if the format is the same
-    if (description.inputFormat == description.outputFormat)
-    {
-        for (int p = pixels; p > 0; p -= pixelsPerStep)
-        {
-            int pixelsThisStep =  qMin(p, pixelsPerStep);
-            int size           =  pixelsThisStep * bytesDepth;
-            LcmsLock lock;
-            dkCmsDoTransform(d->handle, data, data, pixelsThisStep);
-            data               += size;
-
-            if (observer && p <= checkPoint)
-            {
-                checkPoint -= granularity;
-                observer->progressInfo(&image, 0.1 + 0.9 * (1.0 - float(p) / float(pixels)));
-            }
-        }
-    }
-    else
-    {
-        QVarLengthArray<uchar> buffer(pixelsPerStep * bytesDepth);
-
-        for (int p = pixels; p > 0; p -= pixelsPerStep)
-        {
-            int pixelsThisStep  = qMin(p, pixelsPerStep);
-            int size            = pixelsThisStep * bytesDepth;
-            LcmsLock lock;
-            memcpy(buffer.data(), data, size);
-            dkCmsDoTransform(d->handle, buffer.data(), data, pixelsThisStep);
-            data               += size;
-
-            if (observer && p <= checkPoint)
-            {
-                checkPoint -= granularity;
-                observer->progressInfo(&image, 0.1 + 0.9 * (1.0 - float(p) / float(pixels)));
-            }
-        }
-    }
+    transformRows(d->handle, image.bits(), image.width(), image.height(), image.bytesDepth(),
+                  description.inputFormat == description.outputFormat, &image, observer);
 }
 
-void IccTransform::transform(QImage& image, const TransformDescription&)
+void IccTransform::transform(QImage& image, const TransformDescription& description)
 {
-    const int bytesDepth    = 4;
-    const int pixels        = image.width() * image.height();
-    // convert ten scanlines in a batch
-    const int pixelsPerStep = image.width() * 10;
-    uchar* data             = image.bits();
+    GamutAlarmLocker alarm(description);
 
-    for (int p = pixels; p > 0; p -= pixelsPerStep)
-    {
-        int pixelsThisStep =  qMin(p, pixelsPerStep);
-        int size           =  pixelsThisStep * bytesDepth;
-        LcmsLock lock;
-        dkCmsDoTransform(d->handle, data, data, pixelsThisStep);
-        data               += size;
-    }
+    transformRows(d->handle, image.bits(), image.width(), image.height(), 4, true, 0, 0);
 }
 
 void IccTransform::close()
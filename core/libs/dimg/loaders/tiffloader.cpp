@@ -53,6 +53,13 @@ extern "C"
 
 #include <QFile>
 #include <QByteArray>
+#include <QAtomicInt>
+#include <QFuture>
+#include <QRect>
+#include <QThreadPool>
+#include <QVector>
+#include <QtConcurrent>    // krazy:exclude=includes
+#include <QtMath>
 
 // Local includes
 
@@ -281,6 +288,61 @@ bool TIFFLoader::load(const QString& filePath, DImgLoaderObserver* const observe
         }
     }
 
+    // -------------------------------------------------------------------
+    // Use a reduced-resolution directory of a pyramidal TIFF if a scaled image is requested,
+    // and restrict decoding to the region of interest if one is given, in original image coordinates.
+
+    const uint32 originalWidth  = w;
+    const uint32 originalHeight = h;
+    QRect region(0, 0, w, h);
+
+    if (m_loadFlags & LoadImageData)
+    {
+        QVariant attribute = imageGetAttribute(QLatin1String("scaledLoadingSize"));
+
+        if (attribute.isValid() && attribute.toInt() > 0 &&
+            selectReducedDirectory(tif, attribute.toInt(), bits_per_sample, samples_per_pixel, photometric))
+        {
+            TIFFGetFieldDefaulted(tif, TIFFTAG_IMAGEWIDTH,   &w);
+            TIFFGetFieldDefaulted(tif, TIFFTAG_IMAGELENGTH,  &h);
+            TIFFGetFieldDefaulted(tif, TIFFTAG_PLANARCONFIG, &planar_config);
+
+            if (TIFFGetFieldDefaulted(tif, TIFFTAG_ROWSPERSTRIP, &rows_per_strip) == 0 ||
+                rows_per_strip == 0 || rows_per_strip > h)
+            {
+                rows_per_strip = h;
+            }
+
+            region = QRect(0, 0, w, h);
+
+            qCDebug(DIGIKAM_DIMG_LOG_TIFF) << "Loading reduced resolution directory" << w << "x" << h
+                                           << "of" << filePath;
+        }
+
+        attribute = imageGetAttribute(QLatin1String("loadingRegion"));
+
+        // 32 bits images are normalized on the whole image and are always loaded entirely.
+        if (attribute.isValid() && bits_per_sample != 32)
+        {
+            QRect roi = attribute.toRect();
+
+            if (w != originalWidth || h != originalHeight)
+            {
+                const double sx = (double)w / originalWidth;
+                const double sy = (double)h / originalHeight;
+                roi             = QRect(QPoint(qFloor(roi.left()  * sx), qFloor(roi.top()    * sy)),
+                                        QPoint(qCeil(roi.right()  * sx), qCeil(roi.bottom()  * sy)));
+            }
+
+            roi &= region;
+
+            if (!roi.isEmpty())
+            {
+                region = roi;
+            }
+        }
+    }
+
     // -------------------------------------------------------------------
     // Get image data.
 
@@ -298,10 +360,9 @@ bool TIFFLoader::load(const QString& filePath, DImgLoaderObserver* const observe
 
         if (bits_per_sample == 16)          // 16 bits image.
         {
-            data.reset(new_failureTolerant(w, h, 8));
-            QScopedArrayPointer<uchar> strip(new_failureTolerant(strip_size));
+            data.reset(new_failureTolerant(region.width(), region.height(), 8));
 
-            if (!data || strip.isNull())
+            if (!data)
             {
                 qCWarning(DIGIKAM_DIMG_LOG_TIFF) << "Failed to allocate memory for TIFF image" << filePath;
                 TIFFClose(tif);
@@ -309,154 +370,13 @@ bool TIFFLoader::load(const QString& filePath, DImgLoaderObserver* const observe
                 return false;
             }
 
-            long offset     = 0;
-            long bytesRead  = 0;
-            uint checkpoint = 0;
+            DecodingUnits units(tif, region, data.data());
 
-            for (tstrip_t st = 0 ; st < num_of_strips ; ++st)
+            if (!decodeInParallel(tif, filePath, &units, false, observer))
             {
-                if (observer && st == checkpoint)
-                {
-                    checkpoint += granularity(observer, num_of_strips, 0.8F);
-
-                    if (!observer->continueQuery(m_image))
-                    {
-                        TIFFClose(tif);
-                        loadingFailed();
-                        return false;
-                    }
-
-                    observer->progressInfo(m_image, 0.1 + (0.8 * (((float)st) / ((float)num_of_strips))));
-                }
-
-                bytesRead = TIFFReadEncodedStrip(tif, st, strip.data(), strip_size);
-
-                if (bytesRead == -1)
-                {
-                    qCWarning(DIGIKAM_DIMG_LOG_TIFF) << "Failed to read strip";
-                    TIFFClose(tif);
-                    loadingFailed();
-                    return false;
-                }
-
-                if ((planar_config == PLANARCONFIG_SEPARATE) &&
-                    (st % (num_of_strips / samples_per_pixel)) == 0)
-                {
-                    offset = 0;
-                }
-
-                ushort* stripPtr = reinterpret_cast<ushort*>(strip.data());
-                ushort* dataPtr  = reinterpret_cast<ushort*>(data.data() + offset);
-                ushort* p;
-
-                // tiff data is read as BGR or ABGR or Greyscale
-
-                if (samples_per_pixel == 1)   // See bug #148400: Greyscale pictures only have _one_ sample per pixel
-                {
-                    for (int i = 0 ; i < bytesRead / 2 ; ++i)
-                    {
-                        // We have to read two bytes for one pixel
-                        p = dataPtr;
-
-                        p[0] = *stripPtr;      // RGB have to be set to the _same_ value
-                        p[1] = *stripPtr;
-                        p[2] = *stripPtr++;
-                        p[3] = 0xFFFF;         // set alpha to 100%
-
-                        dataPtr += 4;
-                    }
-
-                    offset += bytesRead * 4;       // The _byte_offset in the data array is, of course, four times bytesRead
-                }
-                else if ((samples_per_pixel == 3) && (planar_config == PLANARCONFIG_CONTIG))
-                {
-                    for (int i = 0 ; i < bytesRead / 6 ; ++i)
-                    {
-                        p = dataPtr;
-
-                        p[2] = *stripPtr++;
-                        p[1] = *stripPtr++;
-                        p[0] = *stripPtr++;
-                        p[3] = 0xFFFF;
-
-                        dataPtr += 4;
-                    }
-
-                    offset += bytesRead / 6 * 8;
-                }
-                else if ((samples_per_pixel == 3) && (planar_config == PLANARCONFIG_SEPARATE))
-                {
-                    for (int i = 0 ; i < bytesRead / 2 ; ++i)
-                    {
-                        p = dataPtr;
-
-                        switch ((st / (num_of_strips / samples_per_pixel)))
-                        {
-                            case 0:
-                                p[2] = *stripPtr++;
-                                p[3] = 0xFFFF;
-                                break;
-
-                            case 1:
-                                p[1] = *stripPtr++;
-                                break;
-
-                            case 2:
-                                p[0] = *stripPtr++;
-                                break;
-                        }
-
-                        dataPtr += 4;
-                    }
-
-                    offset += bytesRead / 2 * 8;
-                }
-                else if ((samples_per_pixel == 4) && (planar_config == PLANARCONFIG_CONTIG))
-                {
-                    for (int i = 0 ; i < bytesRead / 8 ; ++i)
-                    {
-                        p = dataPtr;
-
-                        p[2] = *stripPtr++;
-                        p[1] = *stripPtr++;
-                        p[0] = *stripPtr++;
-                        p[3] = *stripPtr++;
-
-                        dataPtr += 4;
-                    }
-
-                    offset += bytesRead;
-                }
-                else if ((samples_per_pixel == 4) && (planar_config == PLANARCONFIG_SEPARATE))
-                {
-                    for (int i = 0 ; i < bytesRead / 2 ; ++i)
-                    {
-                        p = dataPtr;
-
-                        switch ((st / (num_of_strips / samples_per_pixel)))
-                        {
-                            case 0:
-                                p[2] = *stripPtr++;
-                                break;
-
-                            case 1:
-                                p[1] = *stripPtr++;
-                                break;
-
-                            case 2:
-                                p[0] = *stripPtr++;
-                                break;
-
-                            case 3:
-                                p[3] = *stripPtr++;
-                                break;
-                        }
-
-                        dataPtr += 4;
-                    }
-
-                    offset += bytesRead / 2 * 8;
-                }
+                TIFFClose(tif);
+                loadingFailed();
+                return false;
             }
         }
         else if (bits_per_sample == 32)          // 32 bits image.
@@ -641,10 +561,9 @@ bool TIFFLoader::load(const QString& filePath, DImgLoaderObserver* const observe
         }
         else       // Non 16 or 32 bits images ==> get it on BGRA 8 bits.
         {
-            data.reset(new_failureTolerant(w, h, 4));
-            QScopedArrayPointer<uchar> strip(new_failureTolerant(w, rows_per_strip, 4));
+            data.reset(new_failureTolerant(region.width(), region.height(), 4));
 
-            if (!data || strip.isNull())
+            if (!data)
             {
                 qCWarning(DIGIKAM_DIMG_LOG_TIFF) << "Failed to allocate memory for TIFF image" << filePath;
                 TIFFClose(tif);
@@ -652,19 +571,11 @@ bool TIFFLoader::load(const QString& filePath, DImgLoaderObserver* const observe
                 return false;
             }
 
-            long offset              = 0;
-            long pixelsRead          = 0;
-
-            // this is inspired by TIFFReadRGBAStrip, tif_getimage.c
-            char          emsg[1024] = "";
-            TIFFRGBAImage img;
-            uint32        rows_to_read;
+            // test whether libtiff can read format
 
-            uint checkpoint          = 0;
+            char emsg[1024] = "";
 
-            // test whether libtiff can read format and initiate reading
-
-            if (!TIFFRGBAImageOK(tif, emsg) || !TIFFRGBAImageBegin(&img, tif, 0, emsg))
+            if (!TIFFRGBAImageOK(tif, emsg))
             {
                 qCWarning(DIGIKAM_DIMG_LOG_TIFF) << "Failed to set up RGBA reading of image, filename "
                                                  << TIFFFileName(tif) <<  " error message from Libtiff: " << emsg;
@@ -673,94 +584,471 @@ bool TIFFLoader::load(const QString& filePath, DImgLoaderObserver* const observe
                 return false;
             }
 
-            // libtiff cannot handle all possible orientations, it give weird results.
-            // We rotate ourselves. (Bug 274865)
-            img.req_orientation = img.orientation;
+            DecodingUnits units(tif, region, data.data());
 
-            // read strips from image: read rows_per_strip, so always start at beginning of a strip
-            for (uint row = 0 ; row < h ; row += rows_per_strip)
+            if (!decodeInParallel(tif, filePath, &units, true, observer))
             {
-                if (observer && row >= checkpoint)
-                {
-                    checkpoint += granularity(observer, h, 0.8F);
+                TIFFClose(tif);
+                loadingFailed();
+                return false;
+            }
+        }
+    }
 
-                    if (!observer->continueQuery(m_image))
-                    {
-                        TIFFClose(tif);
-                        loadingFailed();
-                        return false;
-                    }
+    // -------------------------------------------------------------------
 
-                    observer->progressInfo(m_image, 0.1 + (0.8 * (((float)row) / ((float)h))));
-                }
+    TIFFClose(tif);
+
+    if (observer)
+    {
+        observer->progressInfo(m_image, 1.0);
+    }
+
+    imageWidth()  = region.width();
+    imageHeight() = region.height();
+    imageData()   = data.take();
+    imageSetAttribute(QLatin1String("format"),             QLatin1String("TIFF"));
+    imageSetAttribute(QLatin1String("originalColorModel"), colorModel);
+    imageSetAttribute(QLatin1String("originalBitDepth"),   bits_per_sample);
+    imageSetAttribute(QLatin1String("originalSize"),       QSize(originalWidth, originalHeight));
+
+    return true;
+}
+
+// -------------------------------------------------------------------
+
+/** Layout of the strips or tiles of the current directory, and destination of the decoded region.
+ *  Strips and tiles are both handled as units, numbered as libtiff does, plane after plane
+ *  for separate planar configuration.
+ */
+class Q_DECL_HIDDEN TIFFLoader::DecodingUnits
+{
+public:
+
+    explicit DecodingUnits(TIFF* const tif, const QRect& rect, uchar* const dest)
+        : region(rect),
+          data(dest),
+          failed(0)
+    {
+        uint16 planar = PLANARCONFIG_CONTIG;
 
-                img.row_offset  = row;
-                img.col_offset  = 0;
+        TIFFGetFieldDefaulted(tif, TIFFTAG_IMAGEWIDTH,      &width);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_IMAGELENGTH,     &height);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLESPERPIXEL, &samples);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_PLANARCONFIG,    &planar);
 
-                if (row + rows_per_strip > img.height)
+        tiled    = TIFFIsTiled(tif);
+        separate = (planar == PLANARCONFIG_SEPARATE) && (samples > 1);
+
+        if (tiled)
+        {
+            TIFFGetFieldDefaulted(tif, TIFFTAG_TILEWIDTH,  &unitWidth);
+            TIFFGetFieldDefaulted(tif, TIFFTAG_TILELENGTH, &unitHeight);
+        }
+        else
+        {
+            unitWidth = width;
+
+            if (TIFFGetFieldDefaulted(tif, TIFFTAG_ROWSPERSTRIP, &unitHeight) == 0 ||
+                unitHeight == 0 || unitHeight > height)
+            {
+                unitHeight = height;
+            }
+        }
+
+        unitWidth  = qMax(unitWidth,  (uint32)1);
+        unitHeight = qMax(unitHeight, (uint32)1);
+        across     = (width  + unitWidth  - 1) / unitWidth;
+        down       = (height + unitHeight - 1) / unitHeight;
+        firstChunk = region.top()    / unitHeight;
+        lastChunk  = region.bottom() / unitHeight;
+    }
+
+    uint count() const
+    {
+        return (across * down * (separate ? samples : 1));
+    }
+
+    /// Rectangle of the unit in the image, and the sample stored in it for separate planes, else -1.
+    QRect unitRect(uint unit, int* const channel) const
+    {
+        const uint perPlane = across * down;
+        const uint index    = unit % perPlane;
+        const uint x        = (index % across) * unitWidth;
+        const uint y        = (index / across) * unitHeight;
+
+        *channel            = separate ? (int)(unit / perPlane) : -1;
+
+        return QRect(x, y, qMin(unitWidth, width - x), qMin(unitHeight, height - y));
+    }
+
+    /// Rows of the region are read by chunks aligned on strips or tiles.
+    uint chunkCount() const
+    {
+        return (lastChunk - firstChunk + 1);
+    }
+
+    int chunkRow(uint chunk) const
+    {
+        return qBound(region.top(), (int)((firstChunk + chunk) * unitHeight), region.bottom() + 1);
+    }
+
+public:
+
+    bool       tiled;
+    bool       separate;
+    uint32     width;
+    uint32     height;
+    uint32     unitWidth;
+    uint32     unitHeight;
+    uint32     across;
+    uint32     down;
+    uint16     samples;
+    uint       firstChunk;
+    uint       lastChunk;
+
+    QRect      region;
+    uchar*     data;
+    QAtomicInt failed;
+};
+
+bool TIFFLoader::selectReducedDirectory(TIFF* const tif, int scaledLoadingSize,
+                                        uint16 bitsPerSample, uint16 samplesPerPixel, uint16 photometric)
+{
+    // Candidates are the SubIFDs of the main image and the next directories of the file,
+    // flagged as reduced-resolution versions of the main image.
+
+    QVector<toff_t> candidates;
+    uint16          subIfdCount = 0;
+    toff_t*         subIfds     = 0;
+
+    if (TIFFGetField(tif, TIFFTAG_SUBIFD, &subIfdCount, &subIfds) && subIfds)
+    {
+        for (uint16 i = 0 ; i < subIfdCount ; ++i)
+        {
+            candidates << subIfds[i];
+        }
+    }
+
+    while (TIFFReadDirectory(tif))
+    {
+        candidates << TIFFCurrentDirOffset(tif);
+    }
+
+    toff_t bestOffset = 0;
+    uint32 bestSize   = 0;
+
+    foreach (const toff_t offset, candidates)
+    {
+        if (!TIFFSetSubDirectory(tif, offset))
+        {
+            continue;
+        }
+
+        uint32 subFileType = 0;
+        uint32 w           = 0;
+        uint32 h           = 0;
+        uint16 bits        = 0;
+        uint16 samples     = 0;
+        uint16 photo       = 0;
+
+        TIFFGetFieldDefaulted(tif, TIFFTAG_SUBFILETYPE,     &subFileType);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_IMAGEWIDTH,      &w);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_IMAGELENGTH,     &h);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_BITSPERSAMPLE,   &bits);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLESPERPIXEL, &samples);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_PHOTOMETRIC,     &photo);
+
+        const uint32 size = qMax(w, h);
+
+        if ((subFileType & FILETYPE_REDUCEDIMAGE) &&
+            bits    == bitsPerSample              &&
+            samples == samplesPerPixel            &&
+            photo   == photometric                &&
+            size    >= (uint32)scaledLoadingSize  &&
+            (!bestOffset || size < bestSize))
+        {
+            bestOffset = offset;
+            bestSize   = size;
+        }
+    }
+
+    if (bestOffset && TIFFSetSubDirectory(tif, bestOffset))
+    {
+        return true;
+    }
+
+    TIFFSetDirectory(tif, 0);
+
+    return false;
+}
+
+bool TIFFLoader::decodeInParallel(TIFF* const tif, const QString& filePath, DecodingUnits* const units,
+                                  bool rgba, DImgLoaderObserver* const observer)
+{
+    // 16 bits images are decoded strip by strip or tile by tile.
+    // Other images are read through TIFFRGBAImage by chunks of rows aligned on strips or tiles.
+
+    void (*decode)(TIFF* const, DecodingUnits* const, uint, uint) = rgba ? &TIFFLoader::decodeRowsRGBA
+                                                                         : &TIFFLoader::decodeUnits16;
+    const uint total = rgba ? units->chunkCount() : units->count();
+    int workers      = qMin(QThreadPool::globalInstance()->maxThreadCount(), (int)total);
+
+    if ((qint64)units->region.width() * units->region.height() < 512 * 512)
+    {
+        workers = 1;
+    }
+
+    // A libtiff handle cannot be shared between threads: open one per worker on the same directory.
+
+    QVector<TIFF*> handles;
+    handles << tif;
+
+    for (int i = 1 ; i < workers ; ++i)
+    {
+        TIFF* const handle = TIFFOpen(QFile::encodeName(filePath).constData(), "r");
+
+        if (!handle || !TIFFSetSubDirectory(handle, TIFFCurrentDirOffset(tif)))
+        {
+            if (handle)
+            {
+                TIFFClose(handle);
+            }
+
+            break;
+        }
+
+        handles << handle;
+    }
+
+    workers = handles.size();
+
+    // Work is split in more steps than workers, to report progress and check cancellation between them.
+
+    const int steps = (workers > 1) ? workers * 8 : 10;
+    bool ok         = true;
+
+    for (int step = 0 ; ok && step < steps ; step += workers)
+    {
+        QList<QFuture<void> > tasks;
+
+        for (int i = 0 ; (i < workers) && (step + i < steps) ; ++i)
+        {
+            const uint start = (quint64)total * (step + i)     / steps;
+            const uint stop  = (quint64)total * (step + i + 1) / steps;
+
+            if (start == stop)
+            {
+                continue;
+            }
+
+            if (workers == 1)
+            {
+                decode(handles[i], units, start, stop);
+            }
+            else
+            {
+                tasks.append(QtConcurrent::run(decode, handles[i], units, start, stop));
+            }
+        }
+
+        foreach (QFuture<void> t, tasks)
+        {
+            t.waitForFinished();
+        }
+
+        if (units->failed.load())
+        {
+            qCWarning(DIGIKAM_DIMG_LOG_TIFF) << "Failed to read image data" << filePath;
+            ok = false;
+        }
+
+        if (observer)
+        {
+            if (!observer->continueQuery(m_image))
+            {
+                ok = false;
+            }
+
+            observer->progressInfo(m_image, 0.1 + (0.8 * ((float)qMin(step + workers, steps) / (float)steps)));
+        }
+    }
+
+    for (int i = 1 ; i < handles.size() ; ++i)
+    {
+        TIFFClose(handles[i]);
+    }
+
+    return ok;
+}
+
+void TIFFLoader::decodeUnits16(TIFF* const tif, DecodingUnits* const units, uint start, uint stop)
+{
+    const tsize_t bufferSize = units->tiled ? TIFFTileSize(tif) : TIFFStripSize(tif);
+    QScopedArrayPointer<uchar> buffer(new_failureTolerant(bufferSize));
+
+    if (buffer.isNull())
+    {
+        units->failed.store(1);
+        return;
+    }
+
+    const QRect& region = units->region;
+
+    for (uint unit = start ; unit < stop && !units->failed.load() ; ++unit)
+    {
+        int         channel = -1;
+        const QRect full    = units->unitRect(unit, &channel);
+        const QRect rect    = full & region;
+
+        if (rect.isEmpty())
+        {
+            continue;
+        }
+
+        const tsize_t bytesRead = units->tiled ? TIFFReadEncodedTile(tif, unit, buffer.data(), bufferSize)
+                                               : TIFFReadEncodedStrip(tif, unit, buffer.data(), bufferSize);
+
+        if (bytesRead == -1)
+        {
+            units->failed.store(1);
+            return;
+        }
+
+        // Samples by pixel in the unit, and samples by row, tiles being padded to the full tile width.
+        const int pixelSamples = units->separate ? 1 : units->samples;
+        const int rowSamples   = units->unitWidth * pixelSamples;
+
+        for (int y = rect.top() ; y <= rect.bottom() ; ++y)
+        {
+            if ((qint64)(y - full.top() + 1) * rowSamples * 2 > bytesRead)
+            {
+                break;
+            }
+
+            const ushort* src = reinterpret_cast<ushort*>(buffer.data()) +
+                                (y - full.top()) * rowSamples + (rect.left() - full.left()) * pixelSamples;
+            ushort* p         = reinterpret_cast<ushort*>(units->data) +
+                                ((qint64)(y - region.top()) * region.width() + (rect.left() - region.left())) * 4;
+
+            // tiff data is read as BGR or ABGR or Greyscale
+
+            for (int x = 0 ; x < rect.width() ; ++x, p += 4)
+            {
+                if (channel == -1)
                 {
-                    rows_to_read = img.height - row;
+                    if (units->samples == 1)    // See bug #148400: Greyscale pictures only have _one_ sample per pixel
+                    {
+                        p[0] = *src;            // RGB have to be set to the _same_ value
+                        p[1] = *src;
+                        p[2] = *src++;
+                        p[3] = 0xFFFF;          // set alpha to 100%
+                    }
+                    else if (units->samples == 3)
+                    {
+                        p[2] = *src++;
+                        p[1] = *src++;
+                        p[0] = *src++;
+                        p[3] = 0xFFFF;
+                    }
+                    else if (units->samples == 4)
+                    {
+                        p[2] = *src++;
+                        p[1] = *src++;
+                        p[0] = *src++;
+                        p[3] = *src++;
+                    }
                 }
                 else
                 {
-                    rows_to_read = rows_per_strip;
-                }
+                    switch (channel)
+                    {
+                        case 0:
+                            p[2] = *src++;
 
-                // Read data
+                            if (units->samples == 3)
+                            {
+                                p[3] = 0xFFFF;
+                            }
 
-                if (TIFFRGBAImageGet(&img, reinterpret_cast<uint32*>(strip.data()), img.width, rows_to_read) == -1)
-                {
-                    qCWarning(DIGIKAM_DIMG_LOG_TIFF) << "Failed to read image data";
-                    TIFFClose(tif);
-                    loadingFailed();
-                    return false;
+                            break;
+
+                        case 1:
+                            p[1] = *src++;
+                            break;
+
+                        case 2:
+                            p[0] = *src++;
+                            break;
+
+                        case 3:
+                            p[3] = *src++;
+                            break;
+                    }
                 }
+            }
+        }
+    }
+}
 
-                pixelsRead = rows_to_read * img.width;
+void TIFFLoader::decodeRowsRGBA(TIFF* const tif, DecodingUnits* const units, uint start, uint stop)
+{
+    // this is inspired by TIFFReadRGBAStrip, tif_getimage.c
+    char          emsg[1024] = "";
+    TIFFRGBAImage img;
 
-                uchar* stripPtr = (uchar*)(strip.data());
-                uchar* dataPtr  = (uchar*)(data.data() + offset);
-                uchar* p;
+    if (!TIFFRGBAImageBegin(&img, tif, 0, emsg))
+    {
+        qCWarning(DIGIKAM_DIMG_LOG_TIFF) << "Failed to set up RGBA reading of image, filename "
+                                         << TIFFFileName(tif) <<  " error message from Libtiff: " << emsg;
+        units->failed.store(1);
+        return;
+    }
 
-                // Reverse red and blue
+    // libtiff cannot handle all possible orientations, it give weird results.
+    // We rotate ourselves. (Bug 274865)
+    img.req_orientation = img.orientation;
 
-                for (int i = 0 ; i < pixelsRead ; ++i)
-                {
-                    p = dataPtr;
+    const QRect& region = units->region;
+    QScopedArrayPointer<uchar> strip(new_failureTolerant(region.width(), units->unitHeight, 4));
 
-                    p[2] = *stripPtr++;
-                    p[1] = *stripPtr++;
-                    p[0] = *stripPtr++;
-                    p[3] = *stripPtr++;
+    if (strip.isNull())
+    {
+        TIFFRGBAImageEnd(&img);
+        units->failed.store(1);
+        return;
+    }
 
-                    dataPtr += 4;
-                }
+    for (uint chunk = start ; chunk < stop && !units->failed.load() ; ++chunk)
+    {
+        const int row          = units->chunkRow(chunk);
+        const int rows_to_read = units->chunkRow(chunk + 1) - row;
 
-                offset += pixelsRead * 4;
-            }
+        img.row_offset         = row;
+        img.col_offset         = region.left();
 
-            TIFFRGBAImageEnd(&img);
+        if (TIFFRGBAImageGet(&img, reinterpret_cast<uint32*>(strip.data()), region.width(), rows_to_read) == -1)
+        {
+            units->failed.store(1);
+            break;
         }
-    }
 
-    // -------------------------------------------------------------------
+        const qint64 pixelsRead = (qint64)rows_to_read * region.width();
+        uchar* stripPtr         = strip.data();
+        uchar* p                = units->data + (qint64)(row - region.top()) * region.width() * 4;
 
-    TIFFClose(tif);
+        // Reverse red and blue
 
-    if (observer)
-    {
-        observer->progressInfo(m_image, 1.0);
+        for (qint64 i = 0 ; i < pixelsRead ; ++i, p += 4)
+        {
+            p[2] = *stripPtr++;
+            p[1] = *stripPtr++;
+            p[0] = *stripPtr++;
+            p[3] = *stripPtr++;
+        }
     }
 
-    imageWidth()  = w;
-    imageHeight() = h;
-    imageData()   = data.take();
-    imageSetAttribute(QLatin1String("format"),             QLatin1String("TIFF"));
-    imageSetAttribute(QLatin1String("originalColorModel"), colorModel);
-    imageSetAttribute(QLatin1String("originalBitDepth"),   bits_per_sample);
-    imageSetAttribute(QLatin1String("originalSize"),       QSize(w, h));
-
-    return true;
+    TIFFRGBAImageEnd(&img);
 }
 
 bool TIFFLoader::save(const QString& filePath, DImgLoaderObserver* const observer)
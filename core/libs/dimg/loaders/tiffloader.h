@@ -67,6 +67,19 @@ private:
     static void dimg_tiff_warning(const char* module, const char* format, va_list warnings);
     static void dimg_tiff_error(const char* module, const char* format, va_list errors);
 
+private:
+
+    class DecodingUnits;
+
+    bool selectReducedDirectory(TIFF* const tif, int scaledLoadingSize,
+                                uint16 bitsPerSample, uint16 samplesPerPixel, uint16 photometric);
+
+    bool decodeInParallel(TIFF* const tif, const QString& filePath, DecodingUnits* const units,
+                          bool rgba, DImgLoaderObserver* const observer);
+
+    static void decodeUnits16(TIFF* const tif, DecodingUnits* const units, uint start, uint stop);
+    static void decodeRowsRGBA(TIFF* const tif, DecodingUnits* const units, uint start, uint stop);
+
 private:
 
     bool m_sixteenBit;
@@ -35,6 +35,8 @@
 #include <QFile>
 #include <QDataStream>
 #include <QStandardPaths>
+#include <QMutex>
+#include <QMutexLocker>
 
 // Local includes
 
@@ -95,63 +97,159 @@ using anet_type = loss_metric<fc_no_bias<128,avg_pool_everything<
 using namespace Digikam;
 using namespace Digikam::redeye;
 
+/** The DNN face kernel holds the face recognition network, the shape predictor and the face detector.
+ *  Loading the models from disk is costly, so they are loaded only once, on first use, and shared
+ *  by all threads of the process through instance(). Face alignment and network forward passes are
+ *  serialized separately, so one thread can align its faces while another one runs the network.
+ */
 class DNNFaceKernel
 {
 public:
 
-    explicit DNNFaceKernel()
+    /**
+     * Return the process-wide kernel, loading the models at the first call.
+     */
+    static DNNFaceKernel* instance()
     {
+        static DNNFaceKernel kernel;
+        return &kernel;
     };
 
-    void getFaceVector(cv::Mat tmp_mat, std::vector<float>& vecdata)
+    /**
+     * Return true if the models have been loaded successfully.
+     */
+    bool isLoaded() const
     {
-        anet_type net;
-        frontal_face_detector detector = get_frontal_face_detector();
+        return m_loaded;
+    };
 
-        QString path1 = QStandardPaths::locate(QStandardPaths::GenericDataLocation,
-                                               QLatin1String("digikam/facesengine/dlib_face_recognition_resnet_model_v1.dat")); 
-        deserialize(path1.toStdString()) >> net;
+    /**
+     * Compute the face vector of one face image.
+     */
+    void getFaceVector(const cv::Mat& tmp_mat, std::vector<float>& vecdata)
+    {
+        std::vector<std::vector<float>> vecdataList;
+        getFaceVectors(std::vector<cv::Mat>(1, tmp_mat), vecdataList);
+
+        if (!vecdataList.empty())
+        {
+            vecdata = vecdataList[0];
+        }
+    };
+
+    /**
+     * Compute the face vectors of a list of face images. All faces are aligned and
+     * then run through the network in one forward pass.
+     * vecdataList receives one vector per image, in the same order.
+     * If the models cannot be loaded, vecdataList is left empty.
+     */
+    void getFaceVectors(const std::vector<cv::Mat>& mats, std::vector<std::vector<float>>& vecdataList)
+    {
+        vecdataList.clear();
+
+        if (!m_loaded || mats.empty())
+        {
+            return;
+        }
+
+        std::vector<matrix<rgb_pixel>> faces;
+        faces.reserve(mats.size());
+
+        {
+            QMutexLocker lock(&m_detectorMutex);
+
+            for (size_t i = 0 ; i < mats.size() ; i++)
+            {
+                faces.push_back(alignFace(mats[i]));
+            }
+        }
+
+        qCDebug(DIGIKAM_FACEDB_LOG) << "Start neural network with" << faces.size() << "faces";
+
+        std::vector<matrix<float,0,1>> face_descriptors;
+
+        {
+            QMutexLocker lock(&m_netMutex);
+            face_descriptors = m_net(faces);
+        }
+
+        qCDebug(DIGIKAM_FACEDB_LOG) << "Face descriptors size:" << face_descriptors.size();
+
+        vecdataList.resize(face_descriptors.size());
+
+        for (size_t k = 0 ; k < face_descriptors.size() ; k++)
+        {
+            std::vector<float>& vecdata = vecdataList[k];
+            vecdata.reserve(face_descriptors[k].size());
+
+            for (int i = 0 ; i < face_descriptors[k].nr() ; i++)
+            {
+                for (int j = 0 ; j < face_descriptors[k].nc() ; j++)
+                {
+                    vecdata.push_back(face_descriptors[k](i, j));
+                }
+            }
+        }
+    };
 
-        redeye::ShapePredictor sp;
+private:
+
+    explicit DNNFaceKernel()
+        : m_loaded(false)
+    {
+        QString path1 = QStandardPaths::locate(QStandardPaths::GenericDataLocation,
+                                               QLatin1String("digikam/facesengine/dlib_face_recognition_resnet_model_v1.dat"));
         QString path2 = QStandardPaths::locate(QStandardPaths::GenericDataLocation,
                                                QLatin1String("digikam/facesengine/shapepredictor.dat"));
         QFile model(path2);
-        redeye::ShapePredictor* const temp = new redeye::ShapePredictor();
 
         qCDebug(DIGIKAM_FACEDB_LOG) << "Start reading shape predictor file";
 
-        if (model.open(QIODevice::ReadOnly))
+        if (!model.open(QIODevice::ReadOnly))
+        {
+            qCDebug(DIGIKAM_FACEDB_LOG) << "Error open file shapepredictor.dat";
+            return;
+        }
+
+        QDataStream dataStream(&model);
+        dataStream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+        dataStream >> m_sp;
+
+        qCDebug(DIGIKAM_FACEDB_LOG) << "Start reading model file";
+
+        try
         {
-            QDataStream dataStream(&model);
-            dataStream.setFloatingPointPrecision(QDataStream::SinglePrecision);
-            dataStream >> *temp;
-            sp = *temp;
+            deserialize(path1.toStdString()) >> m_net;
         }
-        else
+        catch (...)
         {
-            qCDebug(DIGIKAM_FACEDB_LOG) << "Error open file shapepredictor.dat\n";
+            qCDebug(DIGIKAM_FACEDB_LOG) << "Error reading file dlib_face_recognition_resnet_model_v1.dat";
             return;
         }
 
-        delete temp;
-
-        matrix<rgb_pixel> img;
-        std::vector<matrix<rgb_pixel>> faces;
+        m_detector = get_frontal_face_detector();
+        m_loaded   = true;
+    };
 
-        std::cout << "tmp_mat channels: " << tmp_mat.channels() << std::endl;
+    DNNFaceKernel(const DNNFaceKernel&); // Disable
 
+    /**
+     * Return the 150x150 face chip of the image, aligned with the shape predictor
+     * if a face is detected, else the image resized.
+     */
+    matrix<rgb_pixel> alignFace(const cv::Mat& tmp_mat)
+    {
+        matrix<rgb_pixel> img;
         assign_image(img, cv_image<rgb_pixel>(tmp_mat));
-        bool face_flag = false;
 
-        for (auto face : detector(img))
-        {
-            qCDebug(DIGIKAM_FACEDB_LOG) << "Detected face";
+        auto dets = m_detector(img);
 
-            face_flag = true;
+        if (!dets.empty())
+        {
+            const auto& face = dets.front();
             cv::Mat gray;
 
             int type = tmp_mat.type();
-            qCDebug(DIGIKAM_FACEDB_LOG) << "type: " << type;
 
             if (type == CV_8UC3 || type == CV_16UC3)
             {
@@ -168,43 +266,30 @@ public:
             }
 
             cv::Rect new_rect(face.left(), face.top(), face.right()-face.left(), face.bottom()-face.top());
-            FullObjectDetection object = sp(gray,new_rect);
-            qCDebug(DIGIKAM_FACEDB_LOG) << "Full object detection finished";
+            FullObjectDetection object = m_sp(gray, new_rect);
             matrix<rgb_pixel> face_chip;
-            extract_image_chip(img, get_face_chip_details(object,150,0.25), face_chip);
-            qCDebug(DIGIKAM_FACEDB_LOG) << "Extract image chip finished";
-            faces.push_back(move(face_chip));
-            break;
-        }
+            extract_image_chip(img, get_face_chip_details(object, 150, 0.25), face_chip);
 
-        if (!face_flag)
-        {
-            cv::resize(tmp_mat, tmp_mat, cv::Size(150, 150));
-            assign_image(img, cv_image<rgb_pixel>(tmp_mat));
-            faces.push_back(img);
+            return face_chip;
         }
 
-        qCDebug(DIGIKAM_FACEDB_LOG) << "Start neural network";
-        std::vector<matrix<float,0,1>> face_descriptors = net(faces);
-        qCDebug(DIGIKAM_FACEDB_LOG) << "Face descriptors size:" << face_descriptors.size();
-
-        if (face_descriptors.size() != 0)
-        {
-            vecdata.clear();
+        cv::Mat resized;
+        cv::resize(tmp_mat, resized, cv::Size(150, 150));
+        assign_image(img, cv_image<rgb_pixel>(resized));
 
-            for(int i = 0 ; i < face_descriptors[0].nr() ; i++)
-            {
-                for(int j = 0 ; j < face_descriptors[0].nc() ; j++)
-                {
-                    vecdata.push_back(face_descriptors[0](i, j));
-                }
-            }
-        }
-        /*else
-        {
-            qCDebug(DIGIKAM_FACEDB_LOG) << "Error calculate face vector";
-        }*/
+        return img;
     };
+
+private:
+
+    bool                   m_loaded;
+
+    anet_type              m_net;
+    redeye::ShapePredictor m_sp;
+    frontal_face_detector  m_detector;
+
+    QMutex                 m_netMutex;
+    QMutex                 m_detectorMutex;
 };
 
 #endif // DIGIKAM_DNN_FACE_H
@@ -44,6 +44,13 @@
 #include "interpolation.h"
 #include "frontal_face_detector.h"
 
+// Qt includes
+
+#include <QDir>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+
 // Local includes
 
 #include "eigenfacemodel.h"
@@ -51,6 +58,8 @@
 #include "lbphfacemodel.h"
 #include "dnnfacemodel.h"
 #include "dnn_face.h"
+#include "dnnfaceindex.h"
+#include "facedbaccess.h"
 #include "facedb.h"                    // krazy:exclude=includes
 #include "digikam_debug.h"
 
@@ -66,18 +75,34 @@ public:
     {
     }
 
+    /**
+     * Return the path of the DNN face index file: next to the database file for SQLite,
+     * else in the application data directory.
+     */
+    QString dnnFaceIndexPath() const
+    {
+        DbEngineParameters params = FaceDbAccess::parameters();
+
+        if (params.isSQLite())
+        {
+            return params.databaseNameFace + QLatin1String(".dnnindex");
+        }
+
+        QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QLatin1String("/facesengine");
+        QDir().mkpath(dir);
+
+        return dir + QLatin1Char('/') + params.hostName + QLatin1Char('-') + params.databaseNameFace + QLatin1String(".dnnindex");
+    }
+
+    /**
+     * Fill the model with the vectors of the index file and the vectors of the database
+     * which are not in the file. Return true if the index differs from the file.
+     */
+    bool loadDNNFaceModel(DNNFaceModel& model) const;
+
     FaceDbBackend* db;
 };
 
-/*
- * NOTE: This constructor is only used in facerec_dnnborrowed.cpp.
- * Create an object of FaceDb to invoke the method getFaceVector
- */
-FaceDb::FaceDb()
-    : d(new Private)
-{
-}
-
 FaceDb::FaceDb(FaceDbBackend* const db)
     : d(new Private)
 {
@@ -393,10 +418,14 @@ void FaceDb::clearLBPHTraining(const QList<int>& identities, const QString& cont
     }
 }
 
-void FaceDb::getFaceVector(cv::Mat data, std::vector<float>& vecdata)
+void FaceDb::getFaceVector(const cv::Mat& data, std::vector<float>& vecdata)
+{
+    DNNFaceKernel::instance()->getFaceVector(data, vecdata);
+}
+
+void FaceDb::getFaceVectors(const std::vector<cv::Mat>& data, std::vector<std::vector<float>>& vecdata)
 {
-    DNNFaceKernel dnnface_kernel;
-    dnnface_kernel.getFaceVector(data, vecdata);
+    DNNFaceKernel::instance()->getFaceVectors(data, vecdata);
 }
 
 void FaceDb::updateEIGENFaceModel(EigenFaceModel& model, const std::vector<cv::Mat>& images_rgb)
@@ -584,64 +613,265 @@ FisherFaceModel FaceDb::fisherFaceModel() const
     return model;
 }
 
-DNNFaceModel FaceDb::dnnFaceModel() const
+bool FaceDb::Private::loadDNNFaceModel(DNNFaceModel& model) const
 {
     qCDebug(DIGIKAM_FACEDB_LOG) << "Loading DNN model";
-    DbEngineSqlQuery query = d->db->execQuery(QLatin1String("SELECT id, identity, `context`, `type`, `rows`, `cols`, `data`, vecdata "
-                                                            "FROM FaceMatrices;"));
 
-    DNNFaceModel model = DNNFaceModel();
-    QList<std::vector<float>> mats;
-    QList<DNNFaceVecMetadata> matMetadata;
+    DNNFaceIndex& index = model.index();
+    bool changed        = !index.load(dnnFaceIndexPath());
+
+    // Only the vectors which are not yet in the index file are loaded from the database.
+
+    DbEngineSqlQuery query = db->execQuery(QLatin1String("SELECT id, identity, `context` FROM FaceMatrices;"));
+
+    QSet<int>                      databaseIds;
+    QHash<int, DNNFaceVecMetadata> missing;
 
     while (query.next())
     {
         DNNFaceVecMetadata metadata;
-        std::vector<float> vecdata;
 
         metadata.databaseId    = query.value(0).toInt();
         metadata.identity      = query.value(1).toInt();
         metadata.context       = query.value(2).toString();
         metadata.storageStatus = DNNFaceVecMetadata::InDatabase;
-        QByteArray cData       = query.value(7).toByteArray();
+        databaseIds << metadata.databaseId;
 
-        if (!cData.isEmpty())
+        if (index.label(metadata.databaseId) != metadata.identity)
+        {
+            missing.insert(metadata.databaseId, metadata);
+        }
+    }
+
+    foreach (int id, index.ids())
+    {
+        if (!databaseIds.contains(id))
         {
+            index.remove(id);
+            changed = true;
+        }
+    }
+
+    QList<int> missingIds = missing.keys();
+
+    for (int i = 0 ; i < missingIds.size() ; i += 500)
+    {
+        QList<int> chunk = missingIds.mid(i, 500);
+        QStringList placeholders;
+        QList<QVariant> boundValues;
+
+        foreach (int id, chunk)
+        {
+            placeholders << QLatin1String("?");
+            boundValues  << id;
+        }
+
+        query = db->execQuery(QString::fromUtf8("SELECT id, vecdata FROM FaceMatrices WHERE id IN (%1);")
+                              .arg(placeholders.join(QLatin1String(","))), boundValues);
+
+        QList<std::vector<float>> mats;
+        QList<DNNFaceVecMetadata> matMetadata;
+
+        while (query.next())
+        {
+            const DNNFaceVecMetadata& metadata = missing[query.value(0).toInt()];
+            QByteArray cData                   = query.value(1).toByteArray();
+
+            if (cData.isEmpty())
+            {
+                qCWarning(DIGIKAM_FACEDB_LOG) << "Mat data to checkout from database are empty for Identity " << metadata.identity;
+                continue;
+            }
+
             QByteArray new_vec = qUncompress(cData);
 
-            if (new_vec.isEmpty())
+            if (new_vec.size() < (int)(DNNFaceIndex::Dimension * sizeof(float)))
             {
                 qCWarning(DIGIKAM_FACEDB_LOG) << "Cannot uncompress mat data to checkout from database for Identity " << metadata.identity;
+                continue;
             }
-            else
-            {
-                qCDebug(DIGIKAM_FACEDB_LOG) << "Checkout compressed histogram " << metadata.databaseId << " for identity "
-                                            << metadata.identity << " with size " << cData.size();
-
-                float* const it = (float *)new_vec.data();
 
-                for (int i = 0; i < 128; i++)
-                {
-                    vecdata.push_back(*(it+i));
-                }
+            const float* const it = (const float*)new_vec.constData();
 
-                mats        << vecdata;
-                matMetadata << metadata;
-            }
+            mats        << std::vector<float>(it, it + DNNFaceIndex::Dimension);
+            matMetadata << metadata;
         }
-        else
+
+        if (!mats.isEmpty())
         {
-            qCWarning(DIGIKAM_FACEDB_LOG) << "Mat data to checkout from database are empty for Identity " << metadata.identity;
+            model.setMats(mats, matMetadata);
+            changed = true;
         }
     }
 
-    model.setMats(mats, matMetadata);
+    qCDebug(DIGIKAM_FACEDB_LOG) << "DNN model has" << index.count() << "face vectors," << missingIds.size() << "loaded from database";
+
+    return changed;
+}
+
+DNNFaceModel FaceDb::dnnFaceModel() const
+{
+    DNNFaceModel model;
+    d->loadDNNFaceModel(model);
 
     return model;
 }
 
+DNNFaceModel FaceDb::updateDNNFaceModel()
+{
+    DNNFaceModel model;
+
+    if (d->loadDNNFaceModel(model))
+    {
+        model.index().save(d->dnnFaceIndexPath());
+    }
+
+    return model;
+}
+
+static QString faceRegionKey(const QRect& region)
+{
+    return QString::fromLatin1("%1,%2,%3,%4").arg(region.x()).arg(region.y())
+                                             .arg(region.width()).arg(region.height());
+}
+
+bool FaceDb::detectedFaces(const QString& uniqueHash, const QString& detector,
+                           QList<QRectF>* const faces, QSize* const originalSize) const
+{
+    QList<QVariant> values;
+    d->db->execSql(QLatin1String("SELECT width, height, faces FROM FaceDetectionCache "
+                                 "WHERE uniqueHash=? AND detector=?;"),
+                   uniqueHash, detector, &values);
+
+    if (values.size() != 3)
+    {
+        return false;
+    }
+
+    QByteArray    data = values.at(2).toByteArray();
+    QDataStream   stream(&data, QIODevice::ReadOnly);
+    QList<QRectF> cachedFaces;
+    stream >> cachedFaces;
+
+    if (stream.status() != QDataStream::Ok)
+    {
+        qCWarning(DIGIKAM_FACEDB_LOG) << "Cannot read cached faces of" << uniqueHash;
+        return false;
+    }
+
+    *faces        = cachedFaces;
+    *originalSize = QSize(values.at(0).toInt(), values.at(1).toInt());
+
+    return true;
+}
+
+void FaceDb::setDetectedFaces(const QString& uniqueHash, const QString& detector,
+                              const QList<QRectF>& faces, const QSize& originalSize)
+{
+    QByteArray  data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << faces;
+
+    d->db->execSql(QLatin1String("REPLACE INTO FaceDetectionCache (uniqueHash, detector, width, height, faces) "
+                                 "VALUES (?,?,?,?,?);"),
+                   QList<QVariant>() << uniqueHash << detector
+                                     << originalSize.width() << originalSize.height() << data);
+}
+
+QList<std::vector<float> > FaceDb::faceVectors(const QString& uniqueHash, const QString& model,
+                                               const QList<QRect>& regions) const
+{
+    QList<QVariant> values;
+    d->db->execSql(QLatin1String("SELECT region, vecdata FROM FaceVectorCache "
+                                 "WHERE uniqueHash=? AND model=?;"),
+                   uniqueHash, model, &values);
+
+    QHash<QString, QByteArray> cached;
+
+    for (QList<QVariant>::const_iterator it = values.constBegin() ; it != values.constEnd() ; )
+    {
+        QString region = it->toString();
+        ++it;
+        cached[region] = it->toByteArray();
+        ++it;
+    }
+
+    QList<std::vector<float> > vectors;
+
+    foreach (const QRect& region, regions)
+    {
+        QByteArray data = cached.value(faceRegionKey(region));
+
+        if (data.size() != (int)(DNNFaceIndex::Dimension * sizeof(float)))
+        {
+            vectors << std::vector<float>();
+            continue;
+        }
+
+        const float* const it = (const float*)data.constData();
+        vectors << std::vector<float>(it, it + DNNFaceIndex::Dimension);
+    }
+
+    return vectors;
+}
+
+void FaceDb::setFaceVector(const QString& uniqueHash, const QString& model,
+                           const QRect& region, const std::vector<float>& vecdata)
+{
+    if (vecdata.size() != (size_t)DNNFaceIndex::Dimension)
+    {
+        return;
+    }
+
+    QByteArray data((const char*)vecdata.data(), (int)(vecdata.size() * sizeof(float)));
+
+    d->db->execSql(QLatin1String("REPLACE INTO FaceVectorCache (uniqueHash, model, region, vecdata) "
+                                 "VALUES (?,?,?,?);"),
+                   uniqueHash, model, faceRegionKey(region), data);
+}
+
+int FaceDb::removeUnusedFaceCaches(const QSet<QString>& usedHashes)
+{
+    QList<QVariant> values;
+    d->db->execSql(QLatin1String("SELECT uniqueHash FROM FaceDetectionCache "
+                                 "UNION SELECT uniqueHash FROM FaceVectorCache;"),
+                   &values);
+
+    QStringList staleHashes;
+
+    foreach (const QVariant& value, values)
+    {
+        const QString uniqueHash = value.toString();
+
+        if (!usedHashes.contains(uniqueHash))
+        {
+            staleHashes << uniqueHash;
+        }
+    }
+
+    if (staleHashes.isEmpty())
+    {
+        return 0;
+    }
+
+    d->db->beginTransaction();
+
+    foreach (const QString& uniqueHash, staleHashes)
+    {
+        d->db->execSql(QLatin1String("DELETE FROM FaceDetectionCache WHERE uniqueHash=?;"), uniqueHash);
+        d->db->execSql(QLatin1String("DELETE FROM FaceVectorCache WHERE uniqueHash=?;"),    uniqueHash);
+    }
+
+    d->db->commitTransaction();
+
+    return staleHashes.size();
+}
+
 void FaceDb::clearEIGENTraining(const QString& context)
 {
+    // Face matrices ids can be reused after deletion, so the DNN face index is rebuilt at next load.
+    QFile::remove(d->dnnFaceIndexPath());
+
     if (context.isNull())
     {
         d->db->execSql(QLatin1String("DELETE FROM FaceMatrices;"));
@@ -654,6 +884,8 @@ void FaceDb::clearEIGENTraining(const QString& context)
 
 void FaceDb::clearEIGENTraining(const QList<int>& identities, const QString& context)
 {
+    QFile::remove(d->dnnFaceIndexPath());
+
     foreach (int id, identities)
     {
         if (context.isNull())
@@ -34,6 +34,10 @@
 #include <QFile>
 #include <QDataStream>
 #include <QStandardPaths>
+#include <QRect>
+#include <QRectF>
+#include <QSet>
+#include <QSize>
 
 // Local includes
 
@@ -53,7 +57,6 @@ class FaceDb
 {
 public:
 
-    FaceDb();
     explicit FaceDb(FaceDbBackend* const db);
     ~FaceDb();
 
@@ -85,9 +88,50 @@ public:
     FisherFaceModel fisherFaceModel() const;
 
     /// DNN
-    void getFaceVector(cv::Mat data, std::vector<float>& vecdata);
+    /// The DNN model is loaded once and shared by all threads of the process.
+    static void getFaceVector(const cv::Mat& data, std::vector<float>& vecdata);
+    static void getFaceVectors(const std::vector<cv::Mat>& data, std::vector<std::vector<float>>& vecdata);
+
+    /**
+     * Returns the DNN model, loaded from the index file next to the database and completed
+     * with the face vectors of the database which are not in the file. The file is not written.
+     */
     DNNFaceModel dnnFaceModel() const;
 
+    /**
+     * Same as dnnFaceModel(), and saves the index file if it was missing or out of date,
+     * so that the next loads read less vectors from the database.
+     */
+    DNNFaceModel updateDNNFaceModel();
+
+    // ----------- Detection and face vector cache ----------
+
+    /**
+     * The faces detected in an image file, keyed by the uniqueHash of the file and by the
+     * identifier of the detector and its parameters. Faces are in relative coordinates,
+     * originalSize is the size of the full image. Returns false if not cached.
+     */
+    bool detectedFaces(const QString& uniqueHash, const QString& detector,
+                       QList<QRectF>* const faces, QSize* const originalSize) const;
+    void setDetectedFaces(const QString& uniqueHash, const QString& detector,
+                          const QList<QRectF>& faces, const QSize& originalSize);
+
+    /**
+     * The DNN face vectors of the faces of an image file, keyed by the uniqueHash of the file,
+     * by the version of the network and by the face region, in full size coordinates.
+     * faceVectors() returns one vector per region, empty if not cached.
+     */
+    QList<std::vector<float> > faceVectors(const QString& uniqueHash, const QString& model,
+                                           const QList<QRect>& regions) const;
+    void setFaceVector(const QString& uniqueHash, const QString& model,
+                       const QRect& region, const std::vector<float>& vecdata);
+
+    /**
+     * Removes the cached detections and face vectors of the image files whose uniqueHash
+     * is not in usedHashes. Returns the number of removed image files.
+     */
+    int removeUnusedFaceCaches(const QSet<QString>& usedHashes);
+
     // ----------- Database shrinking methods ----------
 
     /**
@@ -40,7 +40,7 @@ namespace Digikam
 
 int FaceDbSchemaUpdater::schemaVersion()
 {
-    return 3;
+    return 4;
 }
 
 // -------------------------------------------------------------------------------------
@@ -211,10 +211,29 @@ bool FaceDbSchemaUpdater::makeUpdates()
         {
             updateV1ToV2();
         }
-        else if (d->currentVersion == 2)
+
+        if (d->currentVersion == 2)
         {
             updateV2ToV3();
         }
+
+        if (d->currentVersion == 3)
+        {
+            if (!updateV3ToV4())
+            {
+                QString errorMsg = i18n("Failed to update the database schema from version %1 to version %2.\n%3",
+                                        3, 4, d->dbAccess->backend()->lastError());
+                d->dbAccess->setLastError(errorMsg);
+
+                if (d->observer)
+                {
+                    d->observer->error(errorMsg);
+                    d->observer->finishedSchemaUpdate(InitializationObserver::UpdateErrorMustAbort);
+                }
+
+                return false;
+            }
+        }
     }
 
     return true;
@@ -239,7 +258,8 @@ bool FaceDbSchemaUpdater::createTables()
 {
     return d->dbAccess->backend()->execDBAction(d->dbAccess->backend()->getDBAction(QLatin1String("CreateFaceDB"))) &&
            d->dbAccess->backend()->execDBAction(d->dbAccess->backend()->getDBAction(QLatin1String("CreateFaceDBOpenCVLBPH"))) &&
-           d->dbAccess->backend()->execDBAction(d->dbAccess->backend()->getDBAction(QLatin1String("CreateFaceDBFaceMatrices")));
+           d->dbAccess->backend()->execDBAction(d->dbAccess->backend()->getDBAction(QLatin1String("CreateFaceDBFaceMatrices"))) &&
+           d->dbAccess->backend()->execDBAction(d->dbAccess->backend()->getDBAction(QLatin1String("CreateFaceDBCache")));
 }
 
 bool FaceDbSchemaUpdater::createIndices()
@@ -276,4 +296,21 @@ bool FaceDbSchemaUpdater::updateV2ToV3()
     return true;
 }
 
+bool FaceDbSchemaUpdater::updateV3ToV4()
+{
+    // The detection and face vector cache tables are not used by older versions,
+    // which can still open the database.
+    if (!d->dbAccess->backend()->execDBAction(d->dbAccess->backend()->getDBAction(QLatin1String("CreateFaceDBCache"))))
+    {
+        // Stay at version 3: the update is tried again at next start.
+        qCWarning(DIGIKAM_FACEDB_LOG) << "Face database: failed to create the cache tables of version 4";
+        return false;
+    }
+
+    d->currentVersion         = 4;
+    d->currentRequiredVersion = 3;
+
+    return true;
+}
+
 } // namespace Digikam
@@ -136,6 +136,19 @@ QString FaceDetector::backendIdentifier() const
     return QLatin1String("OpenCV Cascades");
 }
 
+QString FaceDetector::cacheIdentifier() const
+{
+    // Change the version with the cascades or the detection code.
+    QString identifier = QLatin1String("opencv-cascades-1");
+
+    for (QVariantMap::const_iterator it = d->m_parameters.constBegin() ; it != d->m_parameters.constEnd() ; ++it)
+    {
+        identifier += QString::fromLatin1(";%1=%2").arg(it.key()).arg(it.value().toString());
+    }
+
+    return identifier;
+}
+
 QList<QRectF> FaceDetector::detectFaces(const QImage& image, const QSize& originalSize)
 {
     QList<QRectF> result;
@@ -60,6 +60,12 @@ public:
 
     QString backendIdentifier() const;
 
+    /**
+     * Identifies the backend, its version and the parameters in use.
+     * Cached detection results are only reused for the same identifier.
+     */
+    QString cacheIdentifier()   const;
+
     FaceDetector& operator=(const FaceDetector& other);
 
     /**
@@ -0,0 +1,632 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam
+ *
+ * Date        : 2018-06-10
+ * Description : Approximate nearest neighbors index of DNN face vectors
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "dnnfaceindex.h"
+
+// C++ includes
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#ifdef __SSE2__
+#   include <emmintrin.h>
+#endif
+
+// Qt includes
+
+#include <QDataStream>
+#include <QFile>
+#include <QHash>
+#include <QPair>
+#include <QSaveFile>
+#include <QVector>
+
+// Local includes
+
+#include "digikam_debug.h"
+
+namespace Digikam
+{
+
+namespace
+{
+
+enum
+{
+    IndexFileMagic   = 0x444e4e49,  // "DNNI"
+    IndexFileVersion = 1,
+    MaxListCount     = 1024,
+    SamplesPerList   = 32,
+    KMeansIterations = 6
+};
+
+/** Squared euclidean distance of two face vectors.
+ */
+inline float distanceSquared(const float* const a, const float* const b)
+{
+#ifdef __SSE2__
+
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+
+    for (int i = 0 ; i < DNNFaceIndex::Dimension ; i += 8)
+    {
+        __m128 d0 = _mm_sub_ps(_mm_loadu_ps(a + i),     _mm_loadu_ps(b + i));
+        __m128 d1 = _mm_sub_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4));
+        acc0      = _mm_add_ps(acc0, _mm_mul_ps(d0, d0));
+        acc1      = _mm_add_ps(acc1, _mm_mul_ps(d1, d1));
+    }
+
+    float sum[4];
+    _mm_storeu_ps(sum, _mm_add_ps(acc0, acc1));
+
+    return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+
+#else
+
+    float sum[4] = { 0.0F, 0.0F, 0.0F, 0.0F };
+
+    for (int i = 0 ; i < DNNFaceIndex::Dimension ; i += 4)
+    {
+        for (int j = 0 ; j < 4 ; j++)
+        {
+            float diff = a[i + j] - b[i + j];
+            sum[j]    += diff * diff;
+        }
+    }
+
+    return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+
+#endif
+}
+
+/** The vectors of one list of the index, stored one after the other.
+ */
+class IndexList
+{
+public:
+
+    QVector<float> data;
+    QVector<int>   ids;
+    QVector<int>   labels;
+};
+
+QDataStream& operator<<(QDataStream& stream, const IndexList& list)
+{
+    return stream << list.ids << list.labels << list.data;
+}
+
+QDataStream& operator>>(QDataStream& stream, IndexList& list)
+{
+    return stream >> list.ids >> list.labels >> list.data;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------------------------
+
+class Q_DECL_HIDDEN DNNFaceIndex::Private
+{
+public:
+
+    typedef IndexList         List;
+    typedef QPair<int, int>   Position;     // list, entry in list
+    typedef QPair<float, int> Probe;        // distance to centroid, list
+
+public:
+
+    explicit Private()
+        : trainedCount(0),
+          nextInternalId(-1)
+    {
+        lists.resize(1);
+    }
+
+    int listCount() const
+    {
+        return lists.size();
+    }
+
+    int count() const
+    {
+        return positions.size();
+    }
+
+    int nearestList(const float* const vec) const
+    {
+        int   best     = 0;
+        float bestDist = FLT_MAX;
+
+        for (int l = 0 ; l < centroids.size() / Dimension ; l++)
+        {
+            float dist = distanceSquared(vec, centroids.constData() + l * Dimension);
+
+            if (dist < bestDist)
+            {
+                best     = l;
+                bestDist = dist;
+            }
+        }
+
+        return best;
+    }
+
+    void append(int list, int id, int label, const float* const vec)
+    {
+        List& l = lists[list];
+        positions.insert(id, Position(list, l.ids.size()));
+        l.ids    << id;
+        l.labels << label;
+
+        for (int i = 0 ; i < Dimension ; i++)
+        {
+            l.data << vec[i];
+        }
+    }
+
+    void removeAt(const Position pos)
+    {
+        List& l  = lists[pos.first];
+        int last = l.ids.size() - 1;
+
+        positions.remove(l.ids.at(pos.second));
+
+        // Move the last entry of the list to the free place
+
+        if (pos.second != last)
+        {
+            l.ids[pos.second]    = l.ids.at(last);
+            l.labels[pos.second] = l.labels.at(last);
+            std::copy(l.data.constBegin() + last * Dimension,
+                      l.data.constBegin() + (last + 1) * Dimension,
+                      l.data.begin() + pos.second * Dimension);
+            positions[l.ids.at(pos.second)] = pos;
+        }
+
+        l.ids.removeLast();
+        l.labels.removeLast();
+        l.data.resize(last * Dimension);
+    }
+
+    /**
+     * Compute new centroids with k-means over a sample of the vectors, and distribute
+     * all vectors again in the lists of the new centroids.
+     */
+    void partition()
+    {
+        const int total = count();
+        const int k     = qBound(1, (int)std::sqrt((double)total), (int)MaxListCount);
+
+        // Sample the vectors evenly, in a deterministic way
+
+        const int sampleCount = qMin(total, k * (int)SamplesPerList);
+        const int step        = qMax(1, total / sampleCount);
+        QVector<float> samples;
+        samples.reserve(sampleCount * Dimension);
+        int index             = 0;
+
+        foreach (const List& l, lists)
+        {
+            for (int e = 0 ; e < l.ids.size() ; e++, index++)
+            {
+                if ((index % step) == 0 && samples.size() < sampleCount * Dimension)
+                {
+                    samples << l.data.mid(e * Dimension, Dimension);
+                }
+            }
+        }
+
+        const int n = samples.size() / Dimension;
+
+        QVector<float> newCentroids(k * Dimension);
+        QVector<int>   assignment(n, 0);
+
+        for (int c = 0 ; c < k ; c++)
+        {
+            std::copy(samples.constBegin() + ((qint64)c * n / k) * Dimension,
+                      samples.constBegin() + ((qint64)c * n / k + 1) * Dimension,
+                      newCentroids.begin() + c * Dimension);
+        }
+
+        for (int it = 0 ; it < KMeansIterations ; it++)
+        {
+            for (int s = 0 ; s < n ; s++)
+            {
+                int   best     = 0;
+                float bestDist = FLT_MAX;
+
+                for (int c = 0 ; c < k ; c++)
+                {
+                    float dist = distanceSquared(samples.constData() + s * Dimension,
+                                                 newCentroids.constData() + c * Dimension);
+
+                    if (dist < bestDist)
+                    {
+                        best     = c;
+                        bestDist = dist;
+                    }
+                }
+
+                assignment[s] = best;
+            }
+
+            QVector<double> sums(k * Dimension, 0.0);
+            QVector<int>    sizes(k, 0);
+
+            for (int s = 0 ; s < n ; s++)
+            {
+                const float* const vec = samples.constData() + s * Dimension;
+                double* const sum      = sums.data() + assignment.at(s) * Dimension;
+
+                for (int i = 0 ; i < Dimension ; i++)
+                {
+                    sum[i] += vec[i];
+                }
+
+                sizes[assignment.at(s)]++;
+            }
+
+            for (int c = 0 ; c < k ; c++)
+            {
+                if (sizes.at(c) == 0)
+                {
+                    // Empty cluster: keep its centroid, it may catch vectors at the next iteration.
+                    continue;
+                }
+
+                for (int i = 0 ; i < Dimension ; i++)
+                {
+                    newCentroids[c * Dimension + i] = sums.at(c * Dimension + i) / sizes.at(c);
+                }
+            }
+        }
+
+        // Distribute all vectors in the new lists
+
+        QVector<List> oldLists = lists;
+        centroids              = newCentroids;
+        lists                  = QVector<List>(k);
+        positions.clear();
+
+        foreach (const List& l, oldLists)
+        {
+            for (int e = 0 ; e < l.ids.size() ; e++)
+            {
+                const float* const vec = l.data.constData() + e * Dimension;
+                append(nearestList(vec), l.ids.at(e), l.labels.at(e), vec);
+            }
+        }
+
+        trainedCount = total;
+
+        qCDebug(DIGIKAM_FACESENGINE_LOG) << "DNN face index partitioned in" << k << "lists for" << total << "vectors";
+    }
+
+public:
+
+    QVector<float>          centroids;
+    QVector<List>           lists;
+    QHash<int, Position>    positions;
+
+    int                     trainedCount;
+    int                     nextInternalId;
+};
+
+DNNFaceIndex::DNNFaceIndex()
+    : d(new Private)
+{
+}
+
+DNNFaceIndex::~DNNFaceIndex()
+{
+    delete d;
+}
+
+void DNNFaceIndex::clear()
+{
+    d->centroids.clear();
+    d->lists.clear();
+    d->lists.resize(1);
+    d->positions.clear();
+    d->trainedCount   = 0;
+    d->nextInternalId = -1;
+}
+
+int DNNFaceIndex::count() const
+{
+    return d->count();
+}
+
+bool DNNFaceIndex::contains(int id) const
+{
+    return d->positions.contains(id);
+}
+
+int DNNFaceIndex::label(int id) const
+{
+    QHash<int, Private::Position>::const_iterator it = d->positions.constFind(id);
+
+    if (it == d->positions.constEnd())
+    {
+        return -1;
+    }
+
+    return d->lists.at(it->first).labels.at(it->second);
+}
+
+QList<int> DNNFaceIndex::ids() const
+{
+    return d->positions.keys();
+}
+
+void DNNFaceIndex::add(int id, int label, const std::vector<float>& vec)
+{
+    if (vec.size() != (size_t)Dimension)
+    {
+        qCWarning(DIGIKAM_FACESENGINE_LOG) << "Face vector of size" << vec.size() << "cannot be indexed";
+        return;
+    }
+
+    if (id < 0)
+    {
+        id = d->nextInternalId--;
+    }
+    else
+    {
+        remove(id);
+    }
+
+    d->append(d->nearestList(&vec[0]), id, label, &vec[0]);
+
+    if (d->count() >= MinTrainingCount && d->count() >= 2 * d->trainedCount)
+    {
+        d->partition();
+    }
+}
+
+void DNNFaceIndex::remove(int id)
+{
+    QHash<int, Private::Position>::const_iterator it = d->positions.constFind(id);
+
+    if (it != d->positions.constEnd())
+    {
+        d->removeAt(*it);
+    }
+}
+
+void DNNFaceIndex::predict(const std::vector<float>& query, int k, double maxDistance, int& label, double& dist) const
+{
+    label = -1;
+    dist  = DBL_MAX;
+
+    if (query.size() != (size_t)Dimension || d->count() == 0)
+    {
+        return;
+    }
+
+    const float* const q = &query[0];
+    k                    = qMax(1, k);
+
+    // Select the lists to scan
+
+    QVector<Private::Probe> probes;
+
+    if (d->centroids.isEmpty())
+    {
+        probes << qMakePair(0.0F, 0);
+    }
+    else
+    {
+        for (int l = 0 ; l < d->listCount() ; l++)
+        {
+            probes << qMakePair(distanceSquared(q, d->centroids.constData() + l * Dimension), l);
+        }
+
+        int probeCount = qMin((int)ProbeCount, probes.size());
+        std::partial_sort(probes.begin(), probes.begin() + probeCount, probes.end());
+        probes.resize(probeCount);
+    }
+
+    // Keep the k nearest neighbors, sorted by distance
+
+    const double maxDist2 = (maxDistance < std::sqrt(DBL_MAX)) ? maxDistance * maxDistance : DBL_MAX;
+    QVector<QPair<float, int> > neighbors;  // distance, label
+    neighbors.reserve(k + 1);
+
+    foreach (const Private::Probe& probe, probes)
+    {
+        const Private::List& l = d->lists.at(probe.second);
+
+        for (int e = 0 ; e < l.ids.size() ; e++)
+        {
+            float dist2 = distanceSquared(q, l.data.constData() + e * Dimension);
+
+            if (dist2 >= maxDist2 || (neighbors.size() == k && dist2 >= neighbors.last().first))
+            {
+                continue;
+            }
+
+            QPair<float, int> neighbor(dist2, l.labels.at(e));
+            neighbors.insert(std::upper_bound(neighbors.begin(), neighbors.end(), neighbor), neighbor);
+
+            if (neighbors.size() > k)
+            {
+                neighbors.removeLast();
+            }
+        }
+    }
+
+    // Vote, each neighbor weighing the inverse of its distance
+
+    QHash<int, double> votes;
+    double bestVote = 0.0;
+
+    for (int i = 0 ; i < neighbors.size() ; i++)
+    {
+        double neighborDist = std::sqrt((double)neighbors.at(i).first);
+        double& vote        = votes[neighbors.at(i).second];
+        vote               += 1.0 / (neighborDist + 1e-3);
+
+        if (vote > bestVote)
+        {
+            bestVote = vote;
+            label    = neighbors.at(i).second;
+        }
+    }
+
+    for (int i = 0 ; i < neighbors.size() ; i++)
+    {
+        if (neighbors.at(i).second == label)
+        {
+            dist = std::sqrt((double)neighbors.at(i).first);
+            break;
+        }
+    }
+}
+
+std::vector<std::vector<float> > DNNFaceIndex::vectors() const
+{
+    std::vector<std::vector<float> > vecs;
+    vecs.reserve(d->count());
+
+    foreach (const Private::List& l, d->lists)
+    {
+        for (int e = 0 ; e < l.ids.size() ; e++)
+        {
+            vecs.push_back(std::vector<float>(l.data.constBegin() + e * Dimension,
+                                              l.data.constBegin() + (e + 1) * Dimension));
+        }
+    }
+
+    return vecs;
+}
+
+std::vector<int> DNNFaceIndex::labels() const
+{
+    std::vector<int> lbls;
+    lbls.reserve(d->count());
+
+    foreach (const Private::List& l, d->lists)
+    {
+        lbls.insert(lbls.end(), l.labels.constBegin(), l.labels.constEnd());
+    }
+
+    return lbls;
+}
+
+bool DNNFaceIndex::load(const QString& filePath)
+{
+    QFile file(filePath);
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    quint32 magic, version, dimension;
+    stream >> magic >> version >> dimension;
+
+    if (magic != IndexFileMagic || version != IndexFileVersion || dimension != Dimension)
+    {
+        qCWarning(DIGIKAM_FACESENGINE_LOG) << "DNN face index file" << filePath << "has an unknown format";
+        return false;
+    }
+
+    clear();
+
+    qint32 trainedCount;
+    stream >> trainedCount >> d->centroids >> d->lists;
+
+    for (int list = 0 ; list < d->lists.size() ; list++)
+    {
+        const Private::List& l = d->lists.at(list);
+
+        if (l.labels.size() != l.ids.size() || l.data.size() != l.ids.size() * Dimension)
+        {
+            stream.setStatus(QDataStream::ReadCorruptData);
+            break;
+        }
+
+        for (int e = 0 ; e < l.ids.size() ; e++)
+        {
+            d->positions.insert(l.ids.at(e), Private::Position(list, e));
+        }
+    }
+
+    if (stream.status() != QDataStream::Ok || d->lists.isEmpty() ||
+        d->centroids.size() != (d->centroids.isEmpty() ? 0 : d->lists.size() * Dimension))
+    {
+        qCWarning(DIGIKAM_FACESENGINE_LOG) << "DNN face index file" << filePath << "is corrupted";
+        clear();
+        return false;
+    }
+
+    d->trainedCount = trainedCount;
+
+    qCDebug(DIGIKAM_FACESENGINE_LOG) << "Loaded DNN face index with" << d->count() << "vectors";
+
+    return true;
+}
+
+bool DNNFaceIndex::save(const QString& filePath) const
+{
+    QSaveFile file(filePath);
+
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qCWarning(DIGIKAM_FACESENGINE_LOG) << "Cannot write DNN face index file" << filePath;
+        return false;
+    }
+
+    // Internal ids are not related to the database and are not saved.
+
+    QVector<Private::List> lists = d->lists;
+
+    for (int list = 0 ; list < lists.size() ; list++)
+    {
+        Private::List& l = lists[list];
+
+        for (int e = l.ids.size() - 1 ; e >= 0 ; e--)
+        {
+            if (l.ids.at(e) < 0)
+            {
+                l.ids.remove(e);
+                l.labels.remove(e);
+                l.data.remove(e * Dimension, Dimension);
+            }
+        }
+    }
+
+    QDataStream stream(&file);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    stream << (quint32)IndexFileMagic << (quint32)IndexFileVersion << (quint32)Dimension;
+    stream << (qint32)d->trainedCount << d->centroids << lists;
+
+    return (stream.status() == QDataStream::Ok && file.commit());
+}
+
+} // namespace Digikam
@@ -0,0 +1,108 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam
+ *
+ * Date        : 2018-06-10
+ * Description : Approximate nearest neighbors index of DNN face vectors
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_DNN_FACE_INDEX_H
+#define DIGIKAM_DNN_FACE_INDEX_H
+
+// C++ includes
+
+#include <vector>
+
+// Qt includes
+
+#include <QList>
+#include <QString>
+
+namespace Digikam
+{
+
+/** This class is an inverted file index of face vectors (IVF-flat).
+ *  The vectors are partitioned in lists around centroids computed by k-means.
+ *  A query only scans the lists of the nearest centroids, instead of all vectors.
+ *  Below MinTrainingCount vectors, there is one list only and the search is exhaustive.
+ *  The centroids are computed again each time the number of vectors doubles,
+ *  so that adding vectors one by one stays cheap.
+ *  Each vector has an id, the face database id, and a label, the identity.
+ *  The index can be saved to and loaded from a file, to avoid loading all vectors from the database.
+ */
+class DNNFaceIndex
+{
+public:
+
+    enum
+    {
+        Dimension        = 128,     /// Size of the face vectors
+        MinTrainingCount = 4096,    /// Number of vectors before partitioning the index
+        ProbeCount       = 16       /// Number of lists scanned by a query
+    };
+
+public:
+
+    explicit DNNFaceIndex();
+    ~DNNFaceIndex();
+
+    void clear();
+    int  count()                            const;
+
+    /// Return true if the id is in the index.
+    bool contains(int id)                   const;
+
+    /// Return the label of the id, or -1 if the id is not in the index.
+    int  label(int id)                      const;
+
+    /// Return all ids in the index, including internal negative ids.
+    QList<int> ids()                        const;
+
+    /**
+     * Add a vector with its id and label. If the id is already in the index, the vector is replaced.
+     * If id is negative, an internal id is allocated: such vectors are not saved to file.
+     */
+    void add(int id, int label, const std::vector<float>& vec);
+
+    void remove(int id);
+
+    /**
+     * Find the k nearest neighbors of the query which are closer than maxDistance,
+     * and return in label the identity with the most weight among them, each neighbor
+     * weighing the inverse of its distance. dist receives the distance of the nearest
+     * neighbor of this identity. If no neighbor is found, label is -1 and dist is DBL_MAX.
+     */
+    void predict(const std::vector<float>& query, int k, double maxDistance, int& label, double& dist) const;
+
+    /// All vectors and their labels, in the same order.
+    std::vector<std::vector<float> > vectors() const;
+    std::vector<int>                 labels()  const;
+
+    bool load(const QString& filePath);
+    bool save(const QString& filePath)      const;
+
+private:
+
+    DNNFaceIndex(const DNNFaceIndex&); // Disable
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace Digikam
+
+#endif // DIGIKAM_DNN_FACE_INDEX_H
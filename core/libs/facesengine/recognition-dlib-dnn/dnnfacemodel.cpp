@@ -83,19 +83,14 @@ std::vector<std::vector<float> > DNNFaceModel::getSrc() const
     return ptr()->getSrc();
 }
 
-void DNNFaceModel::setSrc(std::vector<std::vector<float> > new_src)
-{
-    ptr()->setSrc(new_src);
-}
-
 cv::Mat DNNFaceModel::getLabels() const
 {
     return ptr()->getLabels();
 }
 
-void DNNFaceModel::setLabels(cv::Mat new_labels)
+DNNFaceIndex& DNNFaceModel::index()
 {
-    ptr()->setLabels(new_labels);
+    return ptr()->index();
 }
 
 /*
@@ -118,41 +113,18 @@ void DNNFaceModel::setWrittenToDatabase(int index, int id)
 
 void DNNFaceModel::setMats(const QList<std::vector<float> >& mats, const QList<DNNFaceVecMetadata>& matMetadata)
 {
-    /*
-     * Does not work with standard OpenCV, as these two params are declared read-only in OpenCV.
-     * One reason why we copied the code.
-     */
-    std::vector<std::vector<float> > newSrc;
-    cv::Mat newLabels;
-    newSrc.reserve(mats.size());
-    newLabels.reserve(matMetadata.size());
-
-    foreach (const std::vector<float>& mat, mats)
+    if (mats.size() != matMetadata.size())
     {
-        newSrc.push_back(mat);
+        qCWarning(DIGIKAM_FACESENGINE_LOG) << "DNN face vectors and metadata do not match";
+        return;
     }
 
-    m_vecMetadata.clear();
-
-    foreach (const DNNFaceVecMetadata& metadata, matMetadata)
+    for (int i = 0 ; i < mats.size() ; i++)
     {
-        newLabels.push_back(metadata.identity);
-        m_vecMetadata << metadata;
-    }
+        const DNNFaceVecMetadata& metadata = matMetadata.at(i);
 
-    std::vector<std::vector<float> > currentSrcs = ptr()->getSrc();
-    cv::Mat currentLabels                        = ptr()->getLabels();
-
-    currentSrcs.insert(currentSrcs.end(), newSrc.begin(), newSrc.end());
-    currentLabels.push_back(newLabels);
-
-    //ptr()->setSrc(currentSrcs);
-    //ptr()->setLabels(currentLabels);
-
-    //make sure that there exits traing data
-    if (currentSrcs.size() > 0)
-    {
-        ptr()->train(currentSrcs, currentLabels);
+        ptr()->index().add(metadata.databaseId, metadata.identity, mats.at(i));
+        m_vecMetadata << metadata;
     }
 }
 
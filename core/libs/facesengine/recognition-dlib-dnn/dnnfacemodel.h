@@ -78,16 +78,20 @@ public:
 
     //Getter function
     std::vector<std::vector<float> > getSrc() const;
-    void setSrc(std::vector<std::vector<float> > new_src);
-
     cv::Mat getLabels() const;
-    void setLabels(cv::Mat new_labels);
+
+    /// The index of the face vectors, to be loaded from and saved to file.
+    DNNFaceIndex& index();
 
     QList<DNNFaceVecMetadata> matMetadata() const;
     //OpenCVMatData             matData(int index) const;
 
     void setWrittenToDatabase(int index, int databaseId);
 
+    /**
+     * Adds the face vectors to the model. The vectors are added to the index incrementally,
+     * with the database id and identity of their metadata.
+     */
     void setMats(const QList<std::vector<float> >& mats, const QList<DNNFaceVecMetadata>& matMetadata);
 
 //public:
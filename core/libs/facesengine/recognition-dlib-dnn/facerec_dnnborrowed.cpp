@@ -74,22 +74,20 @@ void DNNFaceRecognizer::train(std::vector<std::vector<float> > _in_src, InputArr
     // check if data is well- aligned
     if (labels.total() != src.size())
     {
-        String error_message = format("The number of samples (src) must equal the number of labels (labels). Was len(samples)=%d, len(labels)=%d.", src.size(), m_labels.total());
+        String error_message = format("The number of samples (src) must equal the number of labels (labels). Was len(samples)=%d, len(labels)=%d.", src.size(), labels.total());
         CV_Error(CV_StsBadArg, error_message);
     }
 
     // if this model should be trained without preserving old data, delete old model data
     if (!preserveData)
     {
-        m_labels.release();
-        m_src.clear();
+        m_index.clear();
     }
 
-    // append labels to m_labels matrix
+    // add the vectors to the index, without database id
     for (size_t labelIdx = 0 ; labelIdx < labels.total() ; labelIdx++)
     {
-        m_labels.push_back(labels.at<int>((int)labelIdx));
-        m_src.push_back(src[(int)labelIdx]);
+        m_index.add(-1, labels.at<int>((int)labelIdx), src[(int)labelIdx]);
     }
 
     return ;
@@ -189,36 +187,48 @@ void DNNFaceRecognizer::getFaceVector(cv::Mat data, std::vector<float>& vecdata)
 */
 void DNNFaceRecognizer::predict(cv::InputArray _src, int& minClass, double& minDist) const
 {
-    qCWarning(DIGIKAM_FACESENGINE_LOG) << "Predicting face image";
-
-    cv::Mat src              = _src.getMat();//254*254
     std::vector<float> vecdata;
-    FaceDb* const tmp_facedb = new FaceDb();
-    tmp_facedb->getFaceVector(src, vecdata);
-    qCWarning(DIGIKAM_FACESENGINE_LOG) << "vecdata: " << vecdata[vecdata.size()-2] << " " << vecdata[vecdata.size()-1];
+    FaceDb::getFaceVector(_src.getMat(), vecdata);
+    nearest(vecdata, minClass, minDist);
+}
 
-    minDist  = DBL_MAX;
-    minClass = -1;
+void DNNFaceRecognizer::predict(const std::vector<cv::Mat>& src, std::vector<int>& labels, std::vector<double>& dists) const
+{
+    std::vector<std::vector<float> > vecdataList;
+    FaceDb::getFaceVectors(src, vecdataList);
 
-    // find nearest neighbor
+    labels.assign(src.size(), -1);
+    dists.assign(src.size(), DBL_MAX);
 
-    for (size_t sampleIdx = 0 ; sampleIdx < m_src.size() ; sampleIdx++)
+    for (size_t i = 0 ; i < vecdataList.size() && i < src.size() ; i++)
     {
-        double dist = 0;
+        nearest(vecdataList[i], labels[i], dists[i]);
+    }
+}
 
-        for (size_t i = 0 ; i < m_src[sampleIdx].size() ; i++)
-        {
-            dist += (vecdata[i]-m_src[sampleIdx][i])*(vecdata[i]-m_src[sampleIdx][i]);
-        }
+void DNNFaceRecognizer::predictFaceVectors(const std::vector<std::vector<float> >& vecdataList,
+                                           std::vector<int>& labels, std::vector<double>& dists) const
+{
+    labels.assign(vecdataList.size(), -1);
+    dists.assign(vecdataList.size(), DBL_MAX);
 
-        dist = std::sqrt(dist);
+    for (size_t i = 0 ; i < vecdataList.size() ; i++)
+    {
+        nearest(vecdataList[i], labels[i], dists[i]);
+    }
+}
 
-        if ((dist < minDist) && (dist < m_threshold))
-        {
-            minDist  = dist;
-            minClass = m_labels.at<int>((int) sampleIdx);
-        }
+void DNNFaceRecognizer::nearest(const std::vector<float>& vecdata, int& minClass, double& minDist) const
+{
+    if (vecdata.empty())
+    {
+        qCWarning(DIGIKAM_FACESENGINE_LOG) << "Cannot compute face vector";
+        minDist  = DBL_MAX;
+        minClass = -1;
+        return;
     }
+
+    m_index.predict(vecdata, m_neighbors, m_threshold, minClass, minDist);
 }
 
 int DNNFaceRecognizer::predict(InputArray _src) const
@@ -29,6 +29,7 @@
 #include "digikam_opencv.h"
 #include "facedb.h"
 #include "face.hpp"
+#include "dnnfaceindex.h"
 
 // C++ includes
 
@@ -43,7 +44,8 @@ public:
 
     /// Initializes this DNNFace Model.
     explicit DNNFaceRecognizer(double threshold = DBL_MAX)
-        : m_threshold(threshold)
+        : m_threshold(threshold),
+          m_neighbors(1)
     {
     }
 
@@ -51,7 +53,8 @@ public:
     DNNFaceRecognizer(const std::vector<std::vector<float>>& src,
                       cv::InputArray labels,
                       double threshold = DBL_MAX)
-        : m_threshold(threshold)
+        : m_threshold(threshold),
+          m_neighbors(1)
     {
         train(src, labels);
     }
@@ -86,17 +89,34 @@ public:
      */
     void predict(cv::InputArray _src, int& label, double& dist) const;
 
+    /**
+     * Predicts the labels and distances for a list of samples.
+     * The face vectors of all samples are computed in one pass of the network.
+     */
+    void predict(const std::vector<cv::Mat>& src, std::vector<int>& labels, std::vector<double>& dists) const;
+
+    /**
+     * Predicts the labels and distances for a list of face vectors, computed before by the network.
+     */
+    void predictFaceVectors(const std::vector<std::vector<float> >& vecdataList,
+                            std::vector<int>& labels, std::vector<double>& dists) const;
+
     /**
      * Getter and setter functions.
      */
     double getThreshold() const                            { return m_threshold;                  }
     void   setThreshold(double _threshold)                 { m_threshold = _threshold;            }
 
-    std::vector<std::vector<float>> getSrc() const         { return m_src;                        }
-    void setSrc(std::vector<std::vector<float>> _src)      { m_src = _src;                        }
+    /// Number of nearest neighbors voting for the identity of a sample. Default is 1, the nearest neighbor.
+    int    getNeighbors() const                            { return m_neighbors;                  }
+    void   setNeighbors(int _neighbors)                    { m_neighbors = _neighbors;            }
+
+    std::vector<std::vector<float>> getSrc() const         { return m_index.vectors();            }
+    cv::Mat getLabels() const                              { return cv::Mat(m_index.labels(), true); }
 
-    cv::Mat getLabels() const                              { return m_labels;                     }
-    void setLabels(cv::Mat _labels)                        { m_labels = _labels;                  }
+    /// The index of the face vectors of this model.
+    DNNFaceIndex&       index()                            { return m_index;                      }
+    const DNNFaceIndex& index() const                      { return m_index;                      }
 
 private:
 
@@ -107,13 +127,17 @@ private:
      */
     void train(std::vector<std::vector<float>> src, cv::InputArray labels, bool preserveData);
 
+    /**
+     * Finds the identity of vecdata by k-NN voting among the stored face vectors under the threshold.
+     */
+    void nearest(const std::vector<float>& vecdata, int& label, double& dist) const;
+
 private:
 
-    // NOTE: Do not use a d private internal container here, this will crash OpenCV in cv::Algorithm::set()
     double                          m_threshold;
+    int                             m_neighbors;
 
-    std::vector<std::vector<float>> m_src;
-    cv::Mat                         m_labels;
+    DNNFaceIndex                    m_index;
 };
 
 } // namespace Digikam
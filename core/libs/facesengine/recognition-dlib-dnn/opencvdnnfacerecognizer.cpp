@@ -40,6 +40,7 @@ public:
 
     explicit Private()
         : threshold(15000.0),
+          neighbors(1),
           loaded(false)
     {
     }
@@ -50,16 +51,20 @@ public:
     {
         if (!loaded)
         {
-            m_dnn  = FaceDbAccess().db()->dnnFaceModel();
+            m_dnn  = FaceDbAccess().db()->updateDNNFaceModel();
             loaded = true;
         }
 
+        // The parameters can be set before the model is loaded.
+        m_dnn->setNeighbors(neighbors);
+
         return m_dnn;
     }
 
 public:
 
     float        threshold;
+    int          neighbors;
 
 private:
 
@@ -83,6 +88,11 @@ void OpenCVDNNFaceRecognizer::setThreshold(float threshold) const
     d->threshold = threshold;
 }
 
+void OpenCVDNNFaceRecognizer::setNeighbors(int neighbors) const
+{
+    d->neighbors = qMax(1, neighbors);
+}
+
 namespace
 {
     enum
@@ -114,7 +124,7 @@ cv::Mat OpenCVDNNFaceRecognizer::prepareForRecognition(const QImage& inputImage)
             break;
         default:
             image          = image.convertToFormat(QImage::Format_RGB888);
-            cvImage        = cv::Mat(image.height(), image.width(), CV_8UC3, image.scanLine(0), image.bytesPerLine());
+            cvImage        = cv::Mat(image.height(), image.width(), CV_8UC3, image.scanLine(0), image.bytesPerLine()).clone();
             //cvtColor(cvImageWrapper, cvImage, CV_RGB2GRAY);
             break;
     }
@@ -139,4 +149,43 @@ int OpenCVDNNFaceRecognizer::recognize(const cv::Mat& inputImage)
     return predictedLabel;
 }
 
+QList<int> OpenCVDNNFaceRecognizer::recognize(const std::vector<cv::Mat>& inputImages)
+{
+    std::vector<int>    predictedLabels;
+    std::vector<double> confidences;
+    d->dnn()->predict(inputImages, predictedLabels, confidences);
+
+    QList<int> ids;
+
+    for (size_t i = 0 ; i < predictedLabels.size() ; i++)
+    {
+        qCDebug(DIGIKAM_FACESENGINE_LOG) << predictedLabels[i] << confidences[i];
+        ids << ((confidences[i] > d->threshold) ? -1 : predictedLabels[i]);
+    }
+
+    return ids;
+}
+
+QList<int> OpenCVDNNFaceRecognizer::recognize(const std::vector<std::vector<float> >& faceVectors)
+{
+    std::vector<int>    predictedLabels;
+    std::vector<double> confidences;
+    d->dnn()->predictFaceVectors(faceVectors, predictedLabels, confidences);
+
+    QList<int> ids;
+
+    for (size_t i = 0 ; i < predictedLabels.size() ; i++)
+    {
+        ids << ((confidences[i] > d->threshold) ? -1 : predictedLabels[i]);
+    }
+
+    return ids;
+}
+
+QString OpenCVDNNFaceRecognizer::faceVectorModel()
+{
+    // Change it with the network or the shape predictor files.
+    return QLatin1String("dlib-resnet-v1");
+}
+
 } // namespace Digikam
@@ -31,6 +31,8 @@
 // Qt include
 
 #include <QImage>
+#include <QList>
+#include <QString>
 
 namespace Digikam
 {
@@ -48,6 +50,11 @@ public:
 
     void setThreshold(float threshold) const;
 
+    /**
+     *  Sets the number of nearest face vectors voting for the identity, see DNNFaceRecognizer::setNeighbors().
+     */
+    void setNeighbors(int neighbors) const;
+
     /**
      *  Returns a cvMat created from the inputImage, optimized for recognition
      */
@@ -60,6 +67,25 @@ public:
      */
     int recognize(const cv::Mat& inputImage);
 
+    /**
+     *  Try to recognize the given images, running the network once for all of them.
+     *  Returns the identity ids, in the same order.
+     *  If an identity cannot be recognized, its id is -1.
+     */
+    QList<int> recognize(const std::vector<cv::Mat>& inputImages);
+
+    /**
+     *  Try to recognize the faces of the given face vectors, computed before by the network.
+     *  Returns the identity ids, in the same order.
+     */
+    QList<int> recognize(const std::vector<std::vector<float> >& faceVectors);
+
+    /**
+     *  Identifies the version of the network computing the face vectors.
+     *  Cached face vectors are only used for the same version.
+     */
+    static QString faceVectorModel();
+
     /**
      *  Trains the given images, representing faces of the given matched identities.
      */
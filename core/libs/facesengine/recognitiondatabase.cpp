@@ -387,6 +387,13 @@ void RecognitionDatabase::Private::applyParameters()
                     qCCritical(DIGIKAM_FACESENGINE_LOG) << "No obvious recognize algorithm";
                 }
             }
+            else if (it.key() == QLatin1String("neighbors"))
+            {
+                if (recognizeAlgorithm == RecognitionDatabase::RecognizeAlgorithm::DNN)
+                {
+                    dnn()->setNeighbors(it.value().toInt());
+                }
+            }
         }
     }
 }
@@ -864,6 +871,48 @@ QList<Identity> RecognitionDatabase::recognizeFaces(ImageListProvider* const ima
 
     QList<Identity> result;
 
+    if (d->recognizeAlgorithm == RecognizeAlgorithm::DNN)
+    {
+        // The DNN recognizer computes the face vectors of all images in one pass of the network.
+
+        std::vector<cv::Mat> cvImages;
+        QList<int>           ids;
+
+        for (; !images->atEnd(); images->proceed())
+        {
+            cvImages.push_back(d->preprocessingChainRGB(images->image()));
+        }
+
+        try
+        {
+            ids = d->dnn()->recognize(cvImages);
+        }
+        catch (cv::Exception& e)
+        {
+            qCCritical(DIGIKAM_FACESENGINE_LOG) << "cv::Exception:" << e.what();
+        }
+        catch (...)
+        {
+            qCCritical(DIGIKAM_FACESENGINE_LOG) << "Default exception from OpenCV";
+        }
+
+        for (size_t i = 0 ; i < cvImages.size() ; i++)
+        {
+            int id = ((int)i < ids.size()) ? ids.at(i) : -1;
+
+            if (id == -1)
+            {
+                result << Identity();
+            }
+            else
+            {
+                result << d->identityCache.value(id);
+            }
+        }
+
+        return result;
+    }
+
     for (; !images->atEnd(); images->proceed())
     {
         int id = -1;
@@ -882,10 +931,6 @@ QList<Identity> RecognitionDatabase::recognizeFaces(ImageListProvider* const ima
             {
                 id = d->fisher()->recognize(d->preprocessingChain(images->image()));
             }
-            else if (d->recognizeAlgorithm == RecognizeAlgorithm::DNN)
-            {
-                id = d->dnn()->recognize(d->preprocessingChainRGB(images->image()));
-            }
             else
             {
                 qCCritical(DIGIKAM_FACESENGINE_LOG) << "No obvious recognize algorithm";
@@ -913,6 +958,142 @@ QList<Identity> RecognitionDatabase::recognizeFaces(ImageListProvider* const ima
     return result;
 }
 
+QList<Identity> RecognitionDatabase::recognizeFaces(const QString& uniqueHash, const QList<QRect>& regions,
+                                                    const QList<QImage>& images)
+{
+    if (!d || !d->dbAvailable)
+    {
+        return QList<Identity>();
+    }
+
+    if (d->recognizeAlgorithm != RecognizeAlgorithm::DNN || uniqueHash.isEmpty())
+    {
+        return recognizeFaces(images);
+    }
+
+    QMutexLocker lock(&d->mutex);
+
+    const QString model                = OpenCVDNNFaceRecognizer::faceVectorModel();
+    QList<std::vector<float> > vectors = FaceDbAccess().db()->faceVectors(uniqueHash, model, regions);
+    QList<int>                 ids;
+
+    try
+    {
+        // Run the network only for the faces without cached vector.
+
+        std::vector<cv::Mat> cvImages;
+        QList<int>           missing;
+
+        for (int i = 0 ; i < vectors.size() ; ++i)
+        {
+            if (vectors.at(i).empty() && i < images.size())
+            {
+                cvImages.push_back(d->preprocessingChainRGB(images.at(i)));
+                missing << i;
+            }
+        }
+
+        if (!cvImages.empty())
+        {
+            std::vector<std::vector<float> > computed;
+            FaceDb::getFaceVectors(cvImages, computed);
+
+            FaceDbAccess access;
+
+            for (size_t j = 0 ; j < computed.size() && (int)j < missing.size() ; j++)
+            {
+                vectors[missing.at(j)] = computed[j];
+                access.db()->setFaceVector(uniqueHash, model, regions.at(missing.at(j)), computed[j]);
+            }
+        }
+
+        qCDebug(DIGIKAM_FACESENGINE_LOG) << "Recognize" << regions.size() << "faces of" << uniqueHash
+                                         << "with" << missing.size() << "face vectors computed";
+
+        ids = d->dnn()->recognize(vectors.toVector().toStdVector());
+    }
+    catch (cv::Exception& e)
+    {
+        qCCritical(DIGIKAM_FACESENGINE_LOG) << "cv::Exception:" << e.what();
+    }
+    catch (...)
+    {
+        qCCritical(DIGIKAM_FACESENGINE_LOG) << "Default exception from OpenCV";
+    }
+
+    QList<Identity> result;
+
+    for (int i = 0 ; i < regions.size() ; ++i)
+    {
+        int id = (i < ids.size()) ? ids.at(i) : -1;
+
+        if (id == -1)
+        {
+            result << Identity();
+        }
+        else
+        {
+            result << d->identityCache.value(id);
+        }
+    }
+
+    return result;
+}
+
+bool RecognitionDatabase::hasCachedFaceVectors(const QString& uniqueHash, const QList<QRect>& regions) const
+{
+    if (!d || !d->dbAvailable || d->recognizeAlgorithm != RecognizeAlgorithm::DNN || uniqueHash.isEmpty())
+    {
+        return false;
+    }
+
+    QList<std::vector<float> > vectors = FaceDbAccess().db()->faceVectors(uniqueHash,
+                                                                          OpenCVDNNFaceRecognizer::faceVectorModel(),
+                                                                          regions);
+
+    foreach (const std::vector<float>& vector, vectors)
+    {
+        if (vector.empty())
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool RecognitionDatabase::cachedDetection(const QString& uniqueHash, const QString& detector,
+                                          QList<QRectF>* const faces, QSize* const originalSize) const
+{
+    if (!d || !d->dbAvailable || uniqueHash.isEmpty())
+    {
+        return false;
+    }
+
+    return FaceDbAccess().db()->detectedFaces(uniqueHash, detector, faces, originalSize);
+}
+
+void RecognitionDatabase::cacheDetection(const QString& uniqueHash, const QString& detector,
+                                         const QList<QRectF>& faces, const QSize& originalSize)
+{
+    if (!d || !d->dbAvailable || uniqueHash.isEmpty())
+    {
+        return;
+    }
+
+    FaceDbAccess().db()->setDetectedFaces(uniqueHash, detector, faces, originalSize);
+}
+
+int RecognitionDatabase::removeUnusedFaceCaches(const QSet<QString>& usedHashes)
+{
+    if (!d || !d->dbAvailable)
+    {
+        return 0;
+    }
+
+    return FaceDbAccess().db()->removeUnusedFaceCaches(usedHashes);
+}
+
 RecognitionDatabase::TrainingCostHint RecognitionDatabase::trainingCostHint() const
 {
     return TrainingIsCheap;
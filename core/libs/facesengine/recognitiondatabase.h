@@ -31,6 +31,11 @@
 #include <QImage>
 #include <QList>
 #include <QMap>
+#include <QRect>
+#include <QRectF>
+#include <QSet>
+#include <QSize>
+#include <QString>
 #include <QVariant>
 
 // Local includes
@@ -135,6 +140,8 @@ public:
      * Available parameters:
      * "accuracy", synonymous: "threshold", range: 0-1, type: float
      * Determines recognition threshold, 0->accept very unsecure recognitions, 1-> be very sure about a recognition.
+     * "neighbors", range: 1-n, type: int, DNN only
+     * Number of nearest known faces voting for the identity. Default is 1, the nearest face.
      */
     void        setParameter(const QString& parameter, const QVariant& value);
     void        setParameters(const QVariantMap& parameters);
@@ -163,6 +170,36 @@ public:
     QList<Identity> recognizeFaces(const QList<QImage>& images);
     Identity        recognizeFace(const QImage& image);
 
+    /**
+     * Performs recognition of the faces of an image file, identified by its uniqueHash,
+     * at the given regions in full size coordinates.
+     * With the DNN recognizer, the face vectors are cached in the face database, keyed by
+     * the uniqueHash, the region and the version of the network. Cached faces are matched
+     * against the trained identities without running the network again.
+     * Pass one image per region, or no image if hasCachedFaceVectors() returned true.
+     * With other recognizers, this is the same as recognizeFaces(images).
+     */
+    QList<Identity> recognizeFaces(const QString& uniqueHash, const QList<QRect>& regions,
+                                   const QList<QImage>& images);
+    bool            hasCachedFaceVectors(const QString& uniqueHash, const QList<QRect>& regions) const;
+
+    /**
+     * Reads and writes the faces detected in an image file, keyed by its uniqueHash and by
+     * FaceDetector::cacheIdentifier(). Faces are in relative coordinates, originalSize is the
+     * size of the full image. Returns false if the image was not detected with this identifier.
+     */
+    bool cachedDetection(const QString& uniqueHash, const QString& detector,
+                         QList<QRectF>* const faces, QSize* const originalSize) const;
+    void cacheDetection(const QString& uniqueHash, const QString& detector,
+                        const QList<QRectF>& faces, const QSize& originalSize);
+
+    /**
+     * Removes the cached detections and face vectors of the image files whose uniqueHash is
+     * not in usedHashes, ie. the files removed from the collections. Returns the number of
+     * removed image files.
+     */
+    int removeUnusedFaceCaches(const QSet<QString>& usedHashes);
+
     /**
      * Gives a hint about the complexity of training for the current backend.
      */
@@ -32,7 +32,6 @@
 #include "digikam_debug.h"
 #include "collectionscanner.h"
 #include "coredboperationgroup.h"
-#include "imageinfotasksplitter.h"
 #include "fileactionmngr_p.h"
 #include "scancontroller.h"
 #include "disjointmetadata.h"
@@ -83,7 +82,7 @@ void FileActionMngrDatabaseWorker::changeTags(FileActionImageInfoList infos,
 
             hub.write(info, DisjointMetadata::PartialWrite);
 
-            if (hub.willWriteMetadata(DisjointMetadata::FullWriteIfChanged) && d->shallSendForWriting(info.id()))
+            if (hub.willWriteMetadata(DisjointMetadata::FullWriteIfChanged))
             {
                 forWriting << info;
             }
@@ -98,13 +97,7 @@ void FileActionMngrDatabaseWorker::changeTags(FileActionImageInfoList infos,
     {
         FileActionImageInfoList forWritingTaskList = FileActionImageInfoList::continueTask(forWriting, infos.progress());
         forWritingTaskList.schedulingForWrite(i18n("Writing metadata to files"), d->fileProgressCreator());
-
-        qCDebug(DIGIKAM_GENERAL_LOG) << "Scheduled to write";
-
-        for (ImageInfoTaskSplitter splitter(forWritingTaskList) ; splitter.hasNext() ; )
-        {
-            emit writeMetadata(FileActionImageInfoList(splitter.next()), MetadataHub::WRITE_TAGS);
-        }
+        d->queueForWriting(forWritingTaskList, MetadataHub::WRITE_TAGS);
     }
 
     infos.dbFinished();
@@ -130,7 +123,7 @@ void FileActionMngrDatabaseWorker::assignPickLabel(FileActionImageInfoList infos
             hub.setPickLabel(pickId);
             hub.write(info, DisjointMetadata::PartialWrite);
 
-            if (hub.willWriteMetadata(DisjointMetadata::FullWriteIfChanged) && d->shallSendForWriting(info.id()))
+            if (hub.willWriteMetadata(DisjointMetadata::FullWriteIfChanged))
             {
                 forWriting << info;
             }
@@ -145,11 +138,7 @@ void FileActionMngrDatabaseWorker::assignPickLabel(FileActionImageInfoList infos
     {
         FileActionImageInfoList forWritingTaskList = FileActionImageInfoList::continueTask(forWriting, infos.progress());
         forWritingTaskList.schedulingForWrite(i18n("Writing metadata to files"), d->fileProgressCreator());
-
-        for (ImageInfoTaskSplitter splitter(forWritingTaskList) ; splitter.hasNext() ; )
-        {
-            emit writeMetadata(FileActionImageInfoList(splitter.next()), MetadataHub::WRITE_PICKLABEL);
-        }
+        d->queueForWriting(forWritingTaskList, MetadataHub::WRITE_PICKLABEL);
     }
 
     infos.dbFinished();
@@ -175,7 +164,7 @@ void FileActionMngrDatabaseWorker::assignColorLabel(FileActionImageInfoList info
             hub.setColorLabel(colorId);
             hub.write(info, DisjointMetadata::PartialWrite);
 
-            if (hub.willWriteMetadata(DisjointMetadata::FullWriteIfChanged) && d->shallSendForWriting(info.id()))
+            if (hub.willWriteMetadata(DisjointMetadata::FullWriteIfChanged))
             {
                 forWriting << info;
             }
@@ -190,11 +179,7 @@ void FileActionMngrDatabaseWorker::assignColorLabel(FileActionImageInfoList info
     {
         FileActionImageInfoList forWritingTaskList = FileActionImageInfoList::continueTask(forWriting, infos.progress());
         forWritingTaskList.schedulingForWrite(i18n("Writing metadata to files"), d->fileProgressCreator());
-
-        for (ImageInfoTaskSplitter splitter(forWritingTaskList) ; splitter.hasNext() ; )
-        {
-            emit writeMetadata(FileActionImageInfoList(splitter.next()), MetadataHub::WRITE_COLORLABEL);
-        }
+        d->queueForWriting(forWritingTaskList, MetadataHub::WRITE_COLORLABEL);
     }
 
     infos.dbFinished();
@@ -221,7 +206,7 @@ void FileActionMngrDatabaseWorker::assignRating(FileActionImageInfoList infos, i
             hub.setRating(rating);
             hub.write(info, DisjointMetadata::PartialWrite);
 
-            if (hub.willWriteMetadata(DisjointMetadata::FullWriteIfChanged) && d->shallSendForWriting(info.id()))
+            if (hub.willWriteMetadata(DisjointMetadata::FullWriteIfChanged))
             {
                 forWriting << info;
             }
@@ -236,11 +221,7 @@ void FileActionMngrDatabaseWorker::assignRating(FileActionImageInfoList infos, i
     {
         FileActionImageInfoList forWritingTaskList = FileActionImageInfoList::continueTask(forWriting, infos.progress());
         forWritingTaskList.schedulingForWrite(i18n("Writing metadata to files"), d->fileProgressCreator());
-
-        for (ImageInfoTaskSplitter splitter(forWritingTaskList) ; splitter.hasNext() ; )
-        {
-            emit writeMetadata(FileActionImageInfoList(splitter.next()), MetadataHub::WRITE_RATING);
-        }
+        d->queueForWriting(forWritingTaskList, MetadataHub::WRITE_RATING);
     }
 
     infos.dbFinished();
@@ -301,11 +282,7 @@ void FileActionMngrDatabaseWorker::setExifOrientation(FileActionImageInfoList in
 
     infos.dbProcessed(infos.count());
     infos.schedulingForWrite(infos.count(), i18n("Revising Exif Orientation tags"), d->fileProgressCreator());
-
-    for (ImageInfoTaskSplitter splitter(infos) ; splitter.hasNext() ; )
-    {
-        emit writeOrientationToFiles(FileActionImageInfoList(splitter.next()), orientation);
-    }
+    d->queueOrientationForWriting(infos, orientation);
 
     infos.dbFinished();
 }
@@ -333,13 +310,8 @@ void FileActionMngrDatabaseWorker::applyMetadata(FileActionImageInfoList infos,
     if (hub->willWriteMetadata(DisjointMetadata::FullWriteIfChanged), Qt::DirectConnection)
     {
         int flags = hub->changedFlags();
-        // don't filter by shallSendForWriting here; we write from the hub, not from freshly loaded data
         infos.schedulingForWrite(infos.size(), i18n("Writing metadata to files"), d->fileProgressCreator());
-
-        for (ImageInfoTaskSplitter splitter(infos) ; splitter.hasNext() ; )
-        {
-            emit writeMetadata(FileActionImageInfoList(splitter.next()), flags);
-        }
+        d->queueForWriting(infos, flags);
     }
 
     delete hub;
@@ -59,8 +59,6 @@ public Q_SLOTS:
 Q_SIGNALS:
 
     void writeMetadataToFiles(FileActionImageInfoList infos);
-    void writeOrientationToFiles(FileActionImageInfoList infos, int orientation);
-    void writeMetadata(FileActionImageInfoList infos, int flag);
 };
 
 // ------------------------------------------------------------------------------------
@@ -111,6 +111,16 @@ void FileActionProgressItemContainer::finishedWriting()
 //    checkFinish(secondItem);
 }
 
+void FileActionProgressItemContainer::setWriteStatus(const QString& status)
+{
+    ProgressItem* const item = secondItem.load();
+
+    if (item)
+    {
+        item->setStatus(status);
+    }
+}
+
 FileActionImageInfoList FileActionImageInfoList::create(const QList<ImageInfo>& infos)
 {
     FileActionImageInfoList list;
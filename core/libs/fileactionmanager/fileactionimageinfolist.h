@@ -81,6 +81,9 @@ public:
     void written(int numberOfInfos);
     void finishedWriting();
 
+    /// shows the state of the write-behind queue on the file writing progress item
+    void setWriteStatus(const QString& status);
+
 Q_SIGNALS:
 
     void signalWrittingDone();
@@ -101,6 +101,7 @@ bool FileActionMngr::requestShutDown()
 
 void FileActionMngr::shutDown()
 {
+    d->clearWriteQueue();
     d->dbWorker->deactivate();
     d->fileWorker->deactivate();
     d->dbWorker->wait();
@@ -112,6 +113,16 @@ bool FileActionMngr::isActive()
     return d->isActive();
 }
 
+int FileActionMngr::writeQueueDepth() const
+{
+    return d->writeQueueDepth();
+}
+
+double FileActionMngr::writeThroughput() const
+{
+    return d->writeThroughput();
+}
+
 void FileActionMngr::assignTags(const QList<qlonglong>& ids, const QList<int>& tagIDs)
 {
     assignTags(ImageInfoList(ids), tagIDs);
@@ -59,6 +59,14 @@ public:
     void shutDown();
     bool isActive();
 
+    /** Number of images waiting in the metadata write-behind queue or being written to files.
+     */
+    int    writeQueueDepth() const;
+
+    /** Files written per second since the write-behind queue started its current run of writes.
+     */
+    double writeThroughput() const;
+
 Q_SIGNALS:
 
     void signalImageChangeFailed(const QString& message, const QStringList& fileNames);
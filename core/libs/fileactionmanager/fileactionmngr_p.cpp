@@ -28,9 +28,14 @@
 
 #include <klocalizedstring.h>
 
+// Qt includes
+
+#include <QMap>
+
 // Local includes
 
 #include "digikam_debug.h"
+#include "imageinfotasksplitter.h"
 #include "thumbnailloadthread.h"
 #include "loadingcacheinterface.h"
 
@@ -38,7 +43,11 @@ namespace Digikam
 {
 
 FileActionMngr::Private::Private(FileActionMngr* const qq)
-    : q(qq)
+    : metadataWrites(FileWriteQueue::MergeFlags),
+      orientationWrites(FileWriteQueue::ReplaceValue),
+      writesInProgress(0),
+      writtenFiles(0),
+      q(qq)
 {
     qRegisterMetaType<MetadataHub*>("MetadataHub*");
     qRegisterMetaType<FileActionImageInfoList>("FileActionImageInfoList");
@@ -57,6 +66,11 @@ FileActionMngr::Private::Private(FileActionMngr* const qq)
     sleepTimer->setSingleShot(true);
     sleepTimer->setInterval(1000);
 
+    // Changes done on the same images within this delay are merged in one file write.
+    writeTimer = new QTimer(this);
+    writeTimer->setSingleShot(true);
+    writeTimer->setInterval(1000);
+
     connectToDatabaseWorker();
 
     connectDatabaseToFileWorker();
@@ -79,6 +93,12 @@ FileActionMngr::Private::Private(FileActionMngr* const qq)
 
     connect(sleepTimer, SIGNAL(timeout()),
             this, SLOT(slotSleepTimer()));
+
+    connect(this, SIGNAL(signalWriteQueued()),
+            this, SLOT(slotWriteQueued()));
+
+    connect(writeTimer, SIGNAL(timeout()),
+            this, SLOT(flushWriteQueue()));
 }
 
 void FileActionMngr::Private::connectToDatabaseWorker()
@@ -118,14 +138,15 @@ void FileActionMngr::Private::connectDatabaseToFileWorker()
             fileWorker, SLOT(writeMetadataToFiles(FileActionImageInfoList)),
             Qt::DirectConnection);
 
-    connect(dbWorker, SIGNAL(writeMetadata(FileActionImageInfoList,int)),
-            fileWorker, SLOT(writeMetadata(FileActionImageInfoList,int)),
-            Qt::DirectConnection);
+    // Metadata and orientation writes go through the write-behind queue, see flushWriteQueue()
 
-    connect(dbWorker, SIGNAL(writeOrientationToFiles(FileActionImageInfoList,int)),
-            fileWorker, SLOT(writeOrientationToFiles(FileActionImageInfoList,int)),
+    connect(this, SIGNAL(signalWriteMetadata(FileActionImageInfoList)),
+            fileWorker, SLOT(writeMetadata(FileActionImageInfoList)),
             Qt::DirectConnection);
 
+    connect(this, SIGNAL(signalWriteOrientation(FileActionImageInfoList)),
+            fileWorker, SLOT(writeOrientationToFiles(FileActionImageInfoList)),
+            Qt::DirectConnection);
 }
 
 FileActionMngr::Private::~Private()
@@ -139,27 +160,196 @@ bool FileActionMngr::Private::isActive() const
     return dbProgress.activeProgressItems || fileProgress.activeProgressItems;
 }
 
-bool FileActionMngr::Private::shallSendForWriting(qlonglong id)
+/** Queues the images of a task. Images still pending are merged with the new value
+ *  and reported as written for this task.
+ */
+static void queueTask(FileWriteQueue& queue, const FileActionImageInfoList& infos, int value)
+{
+    int merged = 0;
+
+    foreach(const ImageInfo& info, infos)
+    {
+        if (queue.enqueue(info.id(), info, value, infos.progress()))
+        {
+            ++merged;
+        }
+    }
+
+    if (merged)
+    {
+        infos.progress()->written(merged);
+    }
+}
+
+void FileActionMngr::Private::queueForWriting(const FileActionImageInfoList& infos, int flags)
+{
+    queueTask(metadataWrites, infos, flags);
+
+    emit signalWriteQueued();
+}
+
+void FileActionMngr::Private::queueOrientationForWriting(const FileActionImageInfoList& infos, int orientation)
 {
+    queueTask(orientationWrites, infos, orientation);
+
+    emit signalWriteQueued();
+}
+
+void FileActionMngr::Private::slotWriteQueued()
+{
+    // Do not restart a running timer: continuous editing must not delay writes forever.
+    if (!writeTimer->isActive())
+    {
+        writeTimer->start();
+    }
+}
+
+/** Sort the scheduled writes per task, then by album root and album to write
+ *  the files of a directory together, and split them over the file workers.
+ *  The value to write is read from the queue when the worker takes each image.
+ */
+static QList<FileActionImageInfoList> groupPendingWrites(const QList<PendingFileWrite>& writes)
+{
+    QMap<FileActionProgressItemContainer*, QMap<QPair<int, int>, QList<ImageInfo> > > tasks;
+
+    foreach(const PendingFileWrite& write, writes)
+    {
+        tasks[write.progress.data()][qMakePair(write.info.albumRootId(), write.info.albumId())] << write.info;
+    }
+
+    QList<FileActionImageInfoList> lists;
+
+    for (QMap<FileActionProgressItemContainer*, QMap<QPair<int, int>, QList<ImageInfo> > >::const_iterator it = tasks.constBegin() ;
+         it != tasks.constEnd() ; ++it)
+    {
+        QList<ImageInfo> infos;
+
+        foreach(const QList<ImageInfo>& album, it.value())
+        {
+            infos << album;
+        }
+
+        FileActionImageInfoList task = FileActionImageInfoList::continueTask(infos, it.key());
+
+        for (ImageInfoTaskSplitter splitter(task) ; splitter.hasNext() ; )
+        {
+            lists << splitter.next();
+        }
+    }
+
+    return lists;
+}
+
+void FileActionMngr::Private::flushWriteQueue()
+{
+    QList<PendingFileWrite> metadata    = metadataWrites.schedule();
+    QList<PendingFileWrite> orientation = orientationWrites.schedule();
+
+    if (metadata.isEmpty() && orientation.isEmpty())
+    {
+        return;
+    }
+
+    {
+        QMutexLocker lock(&mutex);
+
+        // Measure the throughput from the first write of an idle queue.
+        if (!writesInProgress &&
+            metadataWrites.scheduledCount()    == metadata.size() &&
+            orientationWrites.scheduledCount() == orientation.size())
+        {
+            writtenFiles = 0;
+            writeClock.start();
+        }
+    }
+
+    QList<FileActionImageInfoList> metadataLists    = groupPendingWrites(metadata);
+    QList<FileActionImageInfoList> orientationLists = groupPendingWrites(orientation);
+
+    qCDebug(DIGIKAM_GENERAL_LOG) << "Write-behind queue: scheduling" << metadata.size() << "metadata and"
+                                 << orientation.size() << "orientation writes, throughput"
+                                 << writeThroughput() << "files/s";
+
+    foreach(const FileActionImageInfoList& infos, metadataLists)
+    {
+        emit signalWriteMetadata(infos);
+    }
+
+    foreach(const FileActionImageInfoList& infos, orientationLists)
+    {
+        emit signalWriteOrientation(infos);
+    }
+}
+
+void FileActionMngr::Private::clearWriteQueue()
+{
+    writeTimer->stop();
+
+    metadataWrites.clear();
+    orientationWrites.clear();
+
+    QMutexLocker lock(&mutex);
+    writesInProgress = 0;
+}
+
+bool FileActionMngr::Private::takeMetadataWrite(const ImageInfo& info, int* const flags)
+{
+    if (!metadataWrites.take(info.id(), flags))
+    {
+        return false;
+    }
+
     QMutexLocker lock(&mutex);
+    ++writesInProgress;
+
+    return true;
+}
 
-    if (scheduledToWrite.contains(id))
+bool FileActionMngr::Private::takeOrientationWrite(const ImageInfo& info, int* const orientation)
+{
+    if (!orientationWrites.take(info.id(), orientation))
     {
         return false;
     }
 
-    scheduledToWrite << id;
+    QMutexLocker lock(&mutex);
+    ++writesInProgress;
+
     return true;
 }
 
-void FileActionMngr::Private::startingToWrite(const QList<ImageInfo>& infos)
+void FileActionMngr::Private::writtenToFile(const FileActionImageInfoList& infos)
 {
+    {
+        QMutexLocker lock(&mutex);
+
+        writesInProgress = qMax(0, writesInProgress - 1);
+        ++writtenFiles;
+    }
+
+    infos.progress()->setWriteStatus(i18nc("@info: progress status", "%1 files queued, %2 files/s",
+                                           writeQueueDepth(), QString::number(writeThroughput(), 'f', 1)));
+}
+
+int FileActionMngr::Private::writeQueueDepth() const
+{
+    int depth = metadataWrites.count() + orientationWrites.count();
+
     QMutexLocker lock(&mutex);
 
-    foreach(const ImageInfo& info, infos)
+    return depth + writesInProgress;
+}
+
+double FileActionMngr::Private::writeThroughput() const
+{
+    QMutexLocker lock(&mutex);
+
+    if (!writeClock.isValid() || writeClock.elapsed() <= 0)
     {
-        scheduledToWrite.remove(info.id());
+        return 0.0;
     }
+
+    return (double)writtenFiles * 1000.0 / (double)writeClock.elapsed();
 }
 
 void FileActionMngr::Private::slotSleepTimer()
@@ -27,8 +27,8 @@
 
 // Qt includes
 
+#include <QElapsedTimer>
 #include <QMutex>
-#include <QSet>
 #include <QTimer>
 
 // Local includes
@@ -37,6 +37,7 @@
 #include "fileactionmngr.h"
 #include "fileworkeriface.h"
 #include "fileactionimageinfolist.h"
+#include "filewritequeue.h"
 #include "metadatahub.h"
 #include "parallelworkers.h"
 
@@ -100,6 +101,12 @@ Q_SIGNALS:
 
     void signalTransformFinished();
 
+    void signalWriteQueued();
+
+    // Inter-thread signals: connected to file worker slots
+    void signalWriteMetadata(const FileActionImageInfoList& infos);
+    void signalWriteOrientation(const FileActionImageInfoList& infos);
+
 public:
 
     // -- Signal-emitter glue code --
@@ -160,11 +167,24 @@ public:
 
     bool isActive() const;
 
-    /// db worker will send info to file worker if returns true
-    bool shallSendForWriting(qlonglong id);
+    /// db worker queues images already scheduled for writing. Images still pending are merged
+    /// with the new flags and reported as written for this task.
+    void queueForWriting(const FileActionImageInfoList& infos, int flags);
+
+    /// db worker queues images already scheduled for orientation writing. The last orientation wins.
+    void queueOrientationForWriting(const FileActionImageInfoList& infos, int orientation);
+
+    void clearWriteQueue();
 
-    /// file worker calls this when receiving a task
-    void startingToWrite(const QList<ImageInfo>& infos);
+    /// file worker calls this before writing an image: returns false if the write was dropped
+    bool takeMetadataWrite(const ImageInfo& info, int* const flags);
+    bool takeOrientationWrite(const ImageInfo& info, int* const orientation);
+
+    /// file worker calls this when a file has been written
+    void writtenToFile(const FileActionImageInfoList& infos);
+
+    int    writeQueueDepth() const;
+    double writeThroughput() const;
 
     void connectToDatabaseWorker();
     void connectDatabaseToFileWorker();
@@ -177,13 +197,21 @@ public Q_SLOTS:
     void slotImageDataChanged(const QString& path, bool removeThumbnails, bool notifyCache);
     void slotSleepTimer();
     void slotLastProgressItemCompleted();
+    void slotWriteQueued();
+
+    /// hands the pending writes to the file worker, grouped by album root and album
+    void flushWriteQueue();
 
 public:
 
-    QSet<qlonglong>                       scheduledToWrite;
+    FileWriteQueue                        metadataWrites;
+    FileWriteQueue                        orientationWrites;
+    int                                   writesInProgress;
+    int                                   writtenFiles;
+    QElapsedTimer                         writeClock;
     QString                               dbMessage;
     QString                               writerMessage;
-    QMutex                                mutex;
+    mutable QMutex                        mutex;
 
     FileActionMngr*                       q;
 
@@ -191,6 +219,7 @@ public:
     ParallelAdapter<FileWorkerInterface>* fileWorker;
 
     QTimer*                               sleepTimer;
+    QTimer*                               writeTimer;
 
     PrivateProgressItemCreator            dbProgress;
     PrivateProgressItemCreator            fileProgress;
@@ -43,17 +43,26 @@
 namespace Digikam
 {
 
-void FileActionMngrFileWorker::writeOrientationToFiles(FileActionImageInfoList infos, int orientation)
+void FileActionMngrFileWorker::writeOrientationToFiles(FileActionImageInfoList infos)
 {
     QStringList failedItems;
 
     foreach(const ImageInfo& info, infos)
     {
+        int orientation;
+
         if (state() == WorkerObject::Deactivating)
         {
             break;
         }
 
+        // The write-behind queue was cleared while shutting down.
+        if (!d->takeOrientationWrite(info, &orientation))
+        {
+            infos.writtenToOne();
+            continue;
+        }
+
         QString path                  = info.filePath();
         DMetadata metadata(path);
         DMetadata::ImageOrientation o = (DMetadata::ImageOrientation)orientation;
@@ -70,6 +79,7 @@ void FileActionMngrFileWorker::writeOrientationToFiles(FileActionImageInfoList i
             ImageAttributesWatch::instance()->fileMetadataChanged(url);
         }
 
+        d->writtenToFile(infos);
         infos.writtenToOne();
     }
 
@@ -83,8 +93,6 @@ void FileActionMngrFileWorker::writeOrientationToFiles(FileActionImageInfoList i
 
 void FileActionMngrFileWorker::writeMetadataToFiles(FileActionImageInfoList infos)
 {
-    d->startingToWrite(infos);
-
     ScanController::instance()->suspendCollectionScan();
 
     foreach(const ImageInfo& info, infos)
@@ -118,21 +126,27 @@ void FileActionMngrFileWorker::writeMetadataToFiles(FileActionImageInfoList info
     infos.finishedWriting();
 }
 
-void FileActionMngrFileWorker::writeMetadata(FileActionImageInfoList infos, int flags)
+void FileActionMngrFileWorker::writeMetadata(FileActionImageInfoList infos)
 {
-    d->startingToWrite(infos);
-
     ScanController::instance()->suspendCollectionScan();
 
     foreach(const ImageInfo& info, infos)
     {
         MetadataHub hub;
+        int         flags;
 
         if (state() == WorkerObject::Deactivating)
         {
             break;
         }
 
+        // The flags merged until now are written; later changes queue a new write.
+        if (!d->takeMetadataWrite(info, &flags))
+        {
+            infos.writtenToOne();
+            continue;
+        }
+
         hub.load(info);
         // apply to file metadata
         if (MetadataSettings::instance()->settings().useLazySync)
@@ -146,6 +160,7 @@ void FileActionMngrFileWorker::writeMetadata(FileActionImageInfoList infos, int
         }
 
         // hub emits fileMetadataChanged
+        d->writtenToFile(infos);
         infos.writtenToOne();
     }
 
@@ -156,8 +171,6 @@ void FileActionMngrFileWorker::writeMetadata(FileActionImageInfoList infos, int
 
 void FileActionMngrFileWorker::transform(FileActionImageInfoList infos, int action)
 {
-    d->startingToWrite(infos);
-
     QStringList failedItems;
     ScanController::instance()->suspendCollectionScan();
 
@@ -42,9 +42,9 @@ class FileWorkerInterface : public WorkerObject
 
 public Q_SLOTS:
 
-    virtual void writeOrientationToFiles(FileActionImageInfoList, int){};
+    virtual void writeOrientationToFiles(FileActionImageInfoList)     {};
     virtual void writeMetadataToFiles(FileActionImageInfoList)        {};
-    virtual void writeMetadata(FileActionImageInfoList, int)          {};
+    virtual void writeMetadata(FileActionImageInfoList)               {};
     virtual void transform(FileActionImageInfoList, int)              {};
 
 Q_SIGNALS:
@@ -67,9 +67,9 @@ public:
 
 public:
 
-    void writeOrientationToFiles(FileActionImageInfoList infos, int orientation);
+    void writeOrientationToFiles(FileActionImageInfoList infos);
     void writeMetadataToFiles(FileActionImageInfoList infos);
-    void writeMetadata(FileActionImageInfoList infos, int flags);
+    void writeMetadata(FileActionImageInfoList infos);
     void transform(FileActionImageInfoList infos, int orientation);
     void ajustFaceRectangles(const ImageInfo& info, int action);
 
@@ -0,0 +1,130 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-27
+ * Description : write-behind queue of pending file writes
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "filewritequeue.h"
+
+namespace Digikam
+{
+
+FileWriteQueue::FileWriteQueue(MergeMode mode)
+    : m_mode(mode),
+      m_scheduled(0)
+{
+}
+
+bool FileWriteQueue::enqueue(qlonglong id, const ImageInfo& info, int value,
+                             FileActionProgressItemContainer* const progress)
+{
+    QMutexLocker lock(&m_mutex);
+
+    QHash<qlonglong, PendingFileWrite>::iterator it = m_pending.find(id);
+
+    if (it != m_pending.end())
+    {
+        // The file will be written once, with the current database values.
+        if (m_mode == MergeFlags)
+        {
+            it->value |= value;
+        }
+        else
+        {
+            it->value = value;
+        }
+
+        return true;
+    }
+
+    PendingFileWrite write;
+    write.info     = info;
+    write.value    = value;
+    write.progress = progress;
+    m_pending.insert(id, write);
+
+    return false;
+}
+
+QList<PendingFileWrite> FileWriteQueue::schedule()
+{
+    QMutexLocker lock(&m_mutex);
+
+    QList<PendingFileWrite> writes;
+
+    for (QHash<qlonglong, PendingFileWrite>::iterator it = m_pending.begin() ; it != m_pending.end() ; ++it)
+    {
+        if (!it->scheduled)
+        {
+            it->scheduled = true;
+            writes << it.value();
+        }
+    }
+
+    m_scheduled += writes.size();
+
+    return writes;
+}
+
+bool FileWriteQueue::take(qlonglong id, int* const value)
+{
+    QMutexLocker lock(&m_mutex);
+
+    QHash<qlonglong, PendingFileWrite>::iterator it = m_pending.find(id);
+
+    if (it == m_pending.end())
+    {
+        return false;
+    }
+
+    if (it->scheduled)
+    {
+        --m_scheduled;
+    }
+
+    *value = it->value;
+    m_pending.erase(it);
+
+    return true;
+}
+
+int FileWriteQueue::count() const
+{
+    QMutexLocker lock(&m_mutex);
+
+    return m_pending.size();
+}
+
+int FileWriteQueue::scheduledCount() const
+{
+    QMutexLocker lock(&m_mutex);
+
+    return m_scheduled;
+}
+
+void FileWriteQueue::clear()
+{
+    QMutexLocker lock(&m_mutex);
+
+    m_pending.clear();
+    m_scheduled = 0;
+}
+
+} // namespace Digikam
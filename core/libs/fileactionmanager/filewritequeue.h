@@ -0,0 +1,114 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-27
+ * Description : write-behind queue of pending file writes
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_FILE_WRITE_QUEUE_H
+#define DIGIKAM_FILE_WRITE_QUEUE_H
+
+// Qt includes
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+
+// Local includes
+
+#include "fileactionimageinfolist.h"
+
+namespace Digikam
+{
+
+/** An image waiting in the write-behind queue. Value is the MetadataHub::WriteComponents flags
+ *  for a metadata write, or the Exif orientation for an orientation write.
+ */
+class PendingFileWrite
+{
+public:
+
+    PendingFileWrite()
+        : value(0),
+          scheduled(false)
+    {
+    }
+
+    ImageInfo                                                     info;
+    int                                                           value;
+
+    /// true once the image has been handed to a file worker, which has not started writing it yet
+    bool                                                          scheduled;
+    QExplicitlySharedDataPointer<FileActionProgressItemContainer> progress;
+};
+
+// -----------------------------------------------------------------------------------------------------------
+
+/** Thread-safe map of the images waiting to be written, keyed by image id.
+ *  An image stays in the queue until a file worker takes it to write the file,
+ *  so changes arriving in the meantime are merged into the single pending write.
+ */
+class FileWriteQueue
+{
+public:
+
+    enum MergeMode
+    {
+        /// Values are OR'ed together (metadata write flags)
+        MergeFlags,
+        /// The last value wins (orientation)
+        ReplaceValue
+    };
+
+public:
+
+    explicit FileWriteQueue(MergeMode mode);
+
+    /** Queues an image. Returns true if the image was already pending and the value
+     *  has been merged into the pending write: the caller's task is then done for this image.
+     */
+    bool enqueue(qlonglong id, const ImageInfo& info, int value,
+                 FileActionProgressItemContainer* const progress);
+
+    /** Returns the pending writes not yet handed to a file worker and marks them as scheduled.
+     *  They stay in the queue, and mergeable, until take() is called.
+     */
+    QList<PendingFileWrite> schedule();
+
+    /** Called by a file worker just before writing an image. Removes the image from the queue
+     *  and returns its merged value. Returns false if the image is not queued anymore.
+     */
+    bool take(qlonglong id, int* const value);
+
+    /// Number of images in the queue, scheduled or not.
+    int  count()          const;
+    int  scheduledCount() const;
+    void clear();
+
+private:
+
+    const MergeMode                    m_mode;
+    QHash<qlonglong, PendingFileWrite> m_pending;
+    int                                m_scheduled;
+    mutable QMutex                     m_mutex;
+};
+
+} // namespace Digikam
+
+#endif // DIGIKAM_FILE_WRITE_QUEUE_H
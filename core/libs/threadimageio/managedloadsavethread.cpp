@@ -449,6 +449,69 @@ void ManagedLoadSaveThread::prependThumbnailGroup(const QList<LoadingDescription
     start(lock);
 }
 
+void ManagedLoadSaveThread::replaceThumbnailGroup(const QList<LoadingDescription>& descriptions)
+{
+    // This method is meant to replace all loading tasks by a group of loading tasks, in the order
+    // they are given here. Waiting tasks which are part of the group are reused, the others are removed.
+    // The current task is stopped if it is not part of the group.
+
+    QMutexLocker lock(threadMutex());
+
+    LoadingTask* const currentTask = checkLoadingTask(m_currentTask, LoadingTaskFilterAll);
+    bool keepCurrentTask           = false;
+    QList<LoadSaveTask*> todo;
+
+    foreach(const LoadingDescription& description, descriptions)
+    {
+        if (currentTask && currentTask->loadingDescription() == description)
+        {
+            keepCurrentTask = true;
+            continue;
+        }
+
+        LoadingTask* existingTask = 0;
+
+        for (int i = 0; i < m_todo.size(); ++i)
+        {
+            LoadingTask* const loadingTask = checkLoadingTask(m_todo.at(i), LoadingTaskFilterAll);
+
+            if (loadingTask && loadingTask->loadingDescription() == description)
+            {
+                existingTask = loadingTask;
+                m_todo.removeAt(i);
+                break;
+            }
+        }
+
+        todo << (existingTask ? existingTask : new ThumbnailLoadingTask(this, description));
+    }
+
+    if (currentTask && !keepCurrentTask)
+    {
+        currentTask->setStatus(LoadingTask::LoadingTaskStatusStopping);
+    }
+
+    // remove stale loading tasks, saving tasks are kept in front
+    for (int i = 0; i < m_todo.size(); )
+    {
+        if (checkLoadingTask(m_todo.at(i), LoadingTaskFilterAll))
+        {
+            delete m_todo.takeAt(i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    m_todo << todo;
+
+    if (!m_todo.isEmpty())
+    {
+        start(lock);
+    }
+}
+
 LoadingTask* ManagedLoadSaveThread::createLoadingTask(const LoadingDescription& description,
                                                       bool preloading, LoadingMode loadingMode,
                                                       AccessMode accessMode)
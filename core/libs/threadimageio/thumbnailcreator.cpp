@@ -60,6 +60,7 @@
 #include "thumbsdbaccess.h"
 #include "thumbsdb.h"
 #include "thumbsdbbackend.h"
+#include "thumbnailpack.h"
 #include "thumbnailsize.h"
 
 namespace Digikam
@@ -241,6 +242,33 @@ QImage ThumbnailCreator::load(const ThumbnailIdentifier& identifier, const QRect
                 image = loadFromDatabase(info);
             }
 
+            break;
+        case ThumbnailPackStorage:
+
+            if (pregenerate)
+            {
+                if (isInPack(info) ||
+                    (ThumbnailPack::instance()->isMigrationPending() && isInDatabase(info)))
+                {
+                    return QImage();
+                }
+            }
+            else
+            {
+                image = loadFromPack(info);
+
+                // Not yet copied by ThumbnailPackMigrator: take it from the database.
+                if (image.isNull() && ThumbnailPack::instance()->isMigrationPending())
+                {
+                    image = loadFromDatabase(info);
+
+                    if (!image.isNull())
+                    {
+                        storeInPack(info, image);
+                    }
+                }
+            }
+
             break;
         case FreeDesktopStandard:
             image = loadFreedesktop(info);
@@ -265,6 +293,9 @@ QImage ThumbnailCreator::load(const ThumbnailIdentifier& identifier, const QRect
                 case ThumbnailDatabase:
                     storeInDatabase(info, image);
                     break;
+                case ThumbnailPackStorage:
+                    storeInPack(info, image);
+                    break;
                 case FreeDesktopStandard:
 
                     // image is stored rotated
@@ -296,7 +327,7 @@ QImage ThumbnailCreator::load(const ThumbnailIdentifier& identifier, const QRect
     image.qimage = image.qimage.scaled(d->thumbnailSize, d->thumbnailSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
     image.qimage = handleAlphaChannel(image.qimage);
 
-    if (d->thumbnailStorage == ThumbnailDatabase)
+    if (d->thumbnailStorage == ThumbnailDatabase || d->thumbnailStorage == ThumbnailPackStorage)
     {
         // image is stored, or created, unrotated, and is now rotated for display
         // detail thumbnails are stored readily rotated
@@ -414,6 +445,14 @@ void ThumbnailCreator::store(const QString& path, const QImage& i, const QRect&
                 storeInDatabase(info, image);
             }
 
+            break;
+        case ThumbnailPackStorage:
+
+            if (!isInPack(info))
+            {
+                storeInPack(info, image);
+            }
+
             break;
         case FreeDesktopStandard:
             storeFreedesktop(info, image);
@@ -429,6 +468,7 @@ void ThumbnailCreator::deleteThumbnailsFromDisk(const QString& filePath) const
             deleteFromDiskFreedesktop(filePath);
             break;
         case ThumbnailDatabase:
+        case ThumbnailPackStorage:
         {
             ThumbnailInfo info;
 
@@ -441,7 +481,15 @@ void ThumbnailCreator::deleteThumbnailsFromDisk(const QString& filePath) const
                 info = fileThumbnailInfo(filePath);
             }
 
-            deleteFromDatabase(info);
+            if (d->thumbnailStorage == ThumbnailDatabase)
+            {
+                deleteFromDatabase(info);
+            }
+            else
+            {
+                ThumbnailPack::instance()->remove(info);
+            }
+
             break;
         }
     }
@@ -974,22 +1022,29 @@ ThumbnailImage ThumbnailCreator::loadFromDatabase(const ThumbnailInfo& info) con
         }
     }
 
+    image.exifOrientation = storedOrientation(info, dbInfo.orientationHint);
+
+    return image;
+}
+
+int ThumbnailCreator::storedOrientation(const ThumbnailInfo& info, int storedHint) const
+{
     // Give priority to main database's rotation flag
     // NOTE: Breaks rotation of RAWs which do not contain JPEG previews
-    image.exifOrientation = info.orientationHint;
+    int orientation = info.orientationHint;
 
-    if (image.exifOrientation == DMetadata::ORIENTATION_UNSPECIFIED &&
+    if (orientation == DMetadata::ORIENTATION_UNSPECIFIED &&
         !info.filePath.isEmpty() && LoadSaveThread::infoProvider())
     {
-        image.exifOrientation = LoadSaveThread::infoProvider()->orientationHint(info.filePath);
+        orientation = LoadSaveThread::infoProvider()->orientationHint(info.filePath);
     }
 
-    if (image.exifOrientation == DMetadata::ORIENTATION_UNSPECIFIED)
+    if (orientation == DMetadata::ORIENTATION_UNSPECIFIED)
     {
-        image.exifOrientation = dbInfo.orientationHint;
+        orientation = storedHint;
     }
 
-    return image;
+    return orientation;
 }
 
 void ThumbnailCreator::deleteFromDatabase(const ThumbnailInfo& info) const
@@ -1035,6 +1090,51 @@ void ThumbnailCreator::deleteFromDatabase(const ThumbnailInfo& info) const
     }
 }
 
+// --------------- Memory-mapped thumbnail pack storage -----------------------
+
+void ThumbnailCreator::storeInPack(const ThumbnailInfo& info, const ThumbnailImage& image) const
+{
+    if (!ThumbnailPack::instance()->insert(info, image.qimage, image.exifOrientation))
+    {
+        qCWarning(DIGIKAM_GENERAL_LOG) << "Cannot save thumb in pack for" << info.filePath;
+    }
+}
+
+bool ThumbnailCreator::isInPack(const ThumbnailInfo& info) const
+{
+    ThumbnailPackInfo packInfo;
+
+    if (!ThumbnailPack::instance()->find(info, &packInfo, false))
+    {
+        return false;
+    }
+
+    // check modification date
+    return (packInfo.modificationDate >= info.modificationDate);
+}
+
+ThumbnailImage ThumbnailCreator::loadFromPack(const ThumbnailInfo& info) const
+{
+    ThumbnailPackInfo packInfo;
+    ThumbnailImage    image;
+
+    if (!ThumbnailPack::instance()->find(info, &packInfo))
+    {
+        return ThumbnailImage();
+    }
+
+    // check modification date
+    if (packInfo.modificationDate < info.modificationDate)
+    {
+        return ThumbnailImage();
+    }
+
+    image.qimage          = packInfo.image;
+    image.exifOrientation = storedOrientation(info, packInfo.orientationHint);
+
+    return image;
+}
+
 // --------------- Freedesktop.org standard implementation -----------------------
 
 
@@ -54,7 +54,8 @@ public:
     enum StorageMethod
     {
         FreeDesktopStandard,
-        ThumbnailDatabase
+        ThumbnailDatabase,
+        ThumbnailPackStorage
     };
 
 public:
@@ -199,6 +200,12 @@ private:
     bool isInDatabase(const ThumbnailInfo& info) const;
     void deleteFromDatabase(const ThumbnailInfo& info) const;
 
+    void storeInPack(const ThumbnailInfo& info, const ThumbnailImage& image) const;
+    ThumbnailImage loadFromPack(const ThumbnailInfo& info) const;
+    bool isInPack(const ThumbnailInfo& info) const;
+
+    int  storedOrientation(const ThumbnailInfo& info, int storedHint) const;
+
     void storeFreedesktop(const ThumbnailInfo& info, const ThumbnailImage& image) const;
     ThumbnailImage loadFreedesktop(const ThumbnailInfo& info) const;
     void deleteFromDiskFreedesktop(const QString& filePath) const;
@@ -50,9 +50,11 @@
 #include "iccsettings.h"
 #include "metadatasettings.h"
 #include "thumbsdbaccess.h"
+#include "thumbsdb.h"
 #include "thumbnailsize.h"
 #include "thumbnailtask.h"
 #include "thumbnailcreator.h"
+#include "thumbnailpack.h"
 
 #ifdef HAVE_MEDIAPLAYER
 #   include "videothumbnailerjob.h"
@@ -259,6 +261,50 @@ void ThumbnailLoadThread::initializeThumbnailDatabase(const DbEngineParameters&
     }
 }
 
+void ThumbnailLoadThread::initializeThumbnailPack(const QString& dirPath, ThumbnailInfoProvider* const provider)
+{
+    if (static_d->firstThreadCreated)
+    {
+        qCDebug(DIGIKAM_GENERAL_LOG) << "Call initializeThumbnailPack at application start. "
+                                        "There are already thumbnail loading threads created, "
+                                        "and these will not be switched to use the pack. ";
+    }
+
+    ThumbnailPack* const pack = ThumbnailPack::instance();
+
+    if (!pack->open(dirPath))
+    {
+        QMessageBox::information(qApp->activeWindow(), i18n("Failed to initialize thumbnails pack"),
+                                 i18n("Cannot open the thumbnails pack in %1", dirPath));
+        return;
+    }
+
+    qCDebug(DIGIKAM_GENERAL_LOG) << "Thumbnails pack ready for use";
+
+    if (provider && provider != static_d->provider)
+    {
+        delete static_d->provider;
+        static_d->provider  = provider;
+    }
+
+    static_d->storageMethod = ThumbnailCreator::ThumbnailPackStorage;
+}
+
+QSet<QString> ThumbnailLoadThread::filePathsWithThumbnail()
+{
+    if (static_d->storageMethod == ThumbnailCreator::ThumbnailPackStorage)
+    {
+        return ThumbnailPack::instance()->filePaths();
+    }
+
+    if (ThumbsDbAccess::isInitialized())
+    {
+        return ThumbsDbAccess().db()->getFilePathsWithThumbnail().keys().toSet();
+    }
+
+    return QSet<QString>();
+}
+
 void ThumbnailLoadThread::setDisplayingWidget(QWidget* const widget)
 {
     static_d->profile = IccManager::displayProfile(widget);
@@ -651,6 +697,37 @@ void ThumbnailLoadThread::preloadGroup(QList<ThumbnailIdentifier>& identifiers,
     ManagedLoadSaveThread::preloadThumbnailGroup(descriptions);
 }
 
+void ThumbnailLoadThread::prefetchGroup(const QList<ThumbnailIdentifier>& identifiers, int size)
+{
+    if (!checkSize(size))
+    {
+        return;
+    }
+
+    QList<LoadingDescription> descriptions = d->makeDescriptions(identifiers, size);
+
+    {
+        // thumbnails already loaded by any thread do not need a task
+        LoadingCache* const cache = LoadingCache::cache();
+        LoadingCache::CacheLock lock(cache);
+        QList<LoadingDescription>::iterator it = descriptions.begin();
+
+        while (it != descriptions.end())
+        {
+            if (cache->retrieveThumbnail(it->cacheKey()))
+            {
+                it = descriptions.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    ManagedLoadSaveThread::replaceThumbnailGroup(descriptions);
+}
+
 void ThumbnailLoadThread::pregenerateGroup(const QList<ThumbnailIdentifier>& identifiers)
 {
     pregenerateGroup(identifiers, d->size);
@@ -915,6 +992,11 @@ void ThumbnailLoadThread::storeDetailThumbnail(const QString& filePath, const QR
     d->creator->storeDetailThumbnail(filePath, detailRect, image);
 }
 
+void ThumbnailLoadThread::storeThumbnail(const QString& filePath, const QImage& image)
+{
+    d->creator->store(filePath, image);
+}
+
 int ThumbnailLoadThread::storedSize() const
 {
     return d->creator->storedSize();
@@ -29,6 +29,7 @@
 
 #include <QPixmap>
 #include <QImage>
+#include <QSet>
 
 // Local includes
 
@@ -70,6 +71,20 @@ public:
      */
     static void initializeThumbnailDatabase(const DbEngineParameters& params, ThumbnailInfoProvider* const provider = 0);
 
+    /**
+     * Enable loading of thumbnails from memory-mapped pack files in the directory,
+     * instead of the thumbnail database. This shall be called once at application startup,
+     * after initializeThumbnailDatabase() if the existing thumbnails shall be migrated
+     * with ThumbnailPackMigrator.
+     */
+    static void initializeThumbnailPack(const QString& dirPath, ThumbnailInfoProvider* const provider = 0);
+
+    /**
+     * Returns the file paths which have a stored thumbnail, in the thumbnails pack if used,
+     * else in the thumbnail database. Used to generate only the missing thumbnails.
+     */
+    static QSet<QString> filePathsWithThumbnail();
+
     /**
      * For color management, this sets the widget the thumbnails will be color managed for.
      * (currently it is only possible to set one global widget)
@@ -129,6 +144,13 @@ public:
     void preloadGroup(QList<ThumbnailIdentifier>& identifiers);
     void preloadGroup(QList<ThumbnailIdentifier>& identifiers, int size);
 
+    /**
+     * Load the thumbnail group in the given order, replacing all loading tasks of this thread.
+     * Tasks for thumbnails which are not in the group are canceled. No signals will be emitted
+     * if pixmaps are not requested, but the thumbnails will be found in the cache by other threads.
+     */
+    void prefetchGroup(const QList<ThumbnailIdentifier>& identifiers, int size);
+
     /**
      * Pregenerate the thumbnail group.
      * No signals will be emitted when these are loaded.
@@ -218,6 +240,14 @@ public:
      * The image should at least have storedSize().
      */
     void storeDetailThumbnail(const QString& filePath, const QRect& detailRect, const QImage& image, bool isFace = false);
+
+    /**
+     * Stores the given image as thumbnail of the file, for ex. if the image
+     * was already decoded for another purpose. The image must not be Exif rotated,
+     * the orientation is applied when the thumbnail is loaded.
+     * The image should at least have storedSize().
+     */
+    void storeThumbnail(const QString& filePath, const QImage& image);
     int  storedSize() const;
 
     /**
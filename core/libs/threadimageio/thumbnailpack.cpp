@@ -0,0 +1,1172 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-14
+ * Description : Memory-mapped thumbnail pack storage
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "thumbnailpack.h"
+
+// C++ includes
+
+#include <algorithm>
+#include <cstring>
+
+// Qt includes
+
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QSaveFile>
+#include <QSet>
+
+// Local includes
+
+#include "digikam_debug.h"
+#include "pgfutils.h"
+#include "thumbsdbaccess.h"
+#include "thumbsdb.h"
+
+namespace Digikam
+{
+
+namespace
+{
+
+/**
+ * Pack and index files start with a magic, a version and a generation. Integers are stored in native byte order.
+ * compact() increments the generation of the pack. An index of another generation than its pack is rebuilt
+ * from the keys stored in the records.
+ */
+struct FileHeader
+{
+    char    magic[8];
+    quint32 version;
+    quint32 generation;
+};
+
+struct RecordHeader
+{
+    quint32 magic;
+    quint8  tileFormat;             // compressedTile, other values are reserved
+    quint8  alpha;
+    quint16 reserved;
+    qint64  modificationDate;       // msecs since epoch, or -1
+    qint32  orientationHint;
+    quint16 width;
+    quint16 height;
+    quint32 keysLength;             // UTF-8 keys separated by '\0'
+    quint32 dataLength;
+};
+
+/// Offset 0 is the file header, so an entry with this offset removes the key.
+struct IndexEntry
+{
+    quint64 key;
+    quint64 offset;
+};
+
+const char    packMagic[8]  = { 'D', 'K', 'T', 'P', 'A', 'C', 'K', '1' };
+const char    indexMagic[8] = { 'D', 'K', 'T', 'I', 'N', 'D', 'X', '1' };
+const quint32 packVersion   = 1;
+const quint32 recordMagic   = 0x44545052; // "DTPR"
+const quint8  compressedTile = 1;         // ARGB32/RGB32 pixels compressed with the fastest zlib level
+
+} // namespace
+
+class Q_DECL_HIDDEN ThumbnailPack::Private
+{
+public:
+
+    explicit Private()
+      : map(0),
+        mapSize(0),
+        packSize(0),
+        generation(0),
+        opened(false),
+        migrationPending(false)
+    {
+    }
+
+    static quint64     keyHash(const QString& key);
+    static QStringList keysForInfo(const ThumbnailInfo& info);
+    static QString     hashKey(const QString& uniqueHash, qlonglong fileSize);
+    static QString     pathKey(const QString& filePath);
+    static QString     customKey(const QString& customIdentifier);
+
+    static QByteArray fileHeader(const char* const magic, quint32 generation);
+
+    bool    openFile(QFile& file, const char* const magic, quint32* const fileGeneration);
+    bool    openFiles();
+    void    closeFiles();
+    void    remap();
+    void    mapAppended();
+    void    loadIndex();
+    void    rebuildIndex();
+
+    bool    readRecord(quint64 offset, RecordHeader* const header, QStringList* const keys) const;
+    quint64 recordSize(quint64 offset)                                                      const;
+    quint64 findRecord(const QString& key, RecordHeader* const header, QStringList* const keys) const;
+    QImage  readTile(quint64 offset, const RecordHeader& header)                            const;
+
+    quint64 appendRecord(const QStringList& keys, const QImage& image,
+                         const QDateTime& modificationDate, int orientationHint);
+    void    appendIndex(const QStringList& keys, quint64 offset);
+
+public:
+
+    QString                   packPath;
+    QString                   indexPath;
+    QFile                     packFile;
+    QFile                     indexFile;
+
+    uchar*                    map;
+    qint64                    mapSize;
+
+    /// End of the pack file. The records appended after the last remap() are not mapped yet.
+    qint64                    packSize;
+
+    QHash<quint64, quint64>   index;
+    quint32                   generation;
+    bool                      opened;
+    bool                      migrationPending;
+
+    mutable QReadWriteLock    lock;
+};
+
+quint64 ThumbnailPack::Private::keyHash(const QString& key)
+{
+    // FNV-1a, stable between sessions unlike qHash()
+
+    const QByteArray utf8 = key.toUtf8();
+    quint64 hash          = Q_UINT64_C(14695981039346656037);
+
+    for (int i = 0 ; i < utf8.size() ; ++i)
+    {
+        hash ^= (uchar)utf8.at(i);
+        hash *= Q_UINT64_C(1099511628211);
+    }
+
+    return hash;
+}
+
+QString ThumbnailPack::Private::hashKey(const QString& uniqueHash, qlonglong fileSize)
+{
+    return QString::fromLatin1("h:%1:%2").arg(uniqueHash).arg(fileSize);
+}
+
+QString ThumbnailPack::Private::pathKey(const QString& filePath)
+{
+    return QLatin1String("p:") + filePath;
+}
+
+QString ThumbnailPack::Private::customKey(const QString& customIdentifier)
+{
+    return QLatin1String("c:") + customIdentifier;
+}
+
+QStringList ThumbnailPack::Private::keysForInfo(const ThumbnailInfo& info)
+{
+    QStringList keys;
+
+    // Custom identifier takes precedence, as in the thumbnail database
+    if (!info.customIdentifier.isEmpty())
+    {
+        keys << customKey(info.customIdentifier);
+        return keys;
+    }
+
+    if (!info.uniqueHash.isEmpty())
+    {
+        keys << hashKey(info.uniqueHash, info.fileSize);
+    }
+
+    if (!info.filePath.isEmpty())
+    {
+        keys << pathKey(info.filePath);
+    }
+
+    return keys;
+}
+
+QByteArray ThumbnailPack::Private::fileHeader(const char* const magic, quint32 generation)
+{
+    FileHeader header;
+    memcpy(header.magic, magic, sizeof(header.magic));
+    header.version    = packVersion;
+    header.generation = generation;
+
+    return QByteArray((const char*)&header, sizeof(FileHeader));
+}
+
+bool ThumbnailPack::Private::openFile(QFile& file, const char* const magic, quint32* const fileGeneration)
+{
+    if (!file.open(QIODevice::ReadWrite))
+    {
+        qCWarning(DIGIKAM_GENERAL_LOG) << "Cannot open thumbnail pack file" << file.fileName();
+        return false;
+    }
+
+    FileHeader header;
+
+    if (file.size() >= (qint64)sizeof(FileHeader)                           &&
+        file.read((char*)&header, sizeof(FileHeader)) == sizeof(FileHeader) &&
+        memcmp(header.magic, magic, sizeof(header.magic)) == 0              &&
+        header.version == packVersion)
+    {
+        *fileGeneration = header.generation;
+        return true;
+    }
+
+    if (file.size() > 0)
+    {
+        qCWarning(DIGIKAM_GENERAL_LOG) << "Thumbnail pack file" << file.fileName()
+                                       << "has an unknown format. It is reset.";
+    }
+
+    const QByteArray data = fileHeader(magic, 0);
+    *fileGeneration       = 0;
+
+    return (file.resize(0)                  &&
+            file.seek(0)                    &&
+            file.write(data) == data.size() &&
+            file.flush());
+}
+
+bool ThumbnailPack::Private::openFiles()
+{
+    packFile.setFileName(packPath);
+    indexFile.setFileName(indexPath);
+
+    quint32 indexGeneration = 0;
+
+    if (!openFile(packFile, packMagic, &generation) || !openFile(indexFile, indexMagic, &indexGeneration))
+    {
+        closeFiles();
+        return false;
+    }
+
+    packSize = packFile.size();
+    remap();
+
+    if (!map)
+    {
+        closeFiles();
+        return false;
+    }
+
+    const bool indexLost = (indexFile.size() == (qint64)sizeof(FileHeader) && mapSize > (qint64)sizeof(FileHeader));
+
+    if (indexGeneration == generation && !indexLost)
+    {
+        loadIndex();
+    }
+    else
+    {
+        // compact() was interrupted after the pack was replaced, or the index was lost.
+        qCWarning(DIGIKAM_GENERAL_LOG) << "Thumbnail pack index" << indexPath
+                                       << "does not match its pack. It is rebuilt.";
+        rebuildIndex();
+    }
+
+    opened = true;
+
+    return true;
+}
+
+void ThumbnailPack::Private::closeFiles()
+{
+    if (map)
+    {
+        packFile.unmap(map);
+        map     = 0;
+        mapSize = 0;
+    }
+
+    packSize = 0;
+    packFile.close();
+    indexFile.close();
+    index.clear();
+    opened = false;
+}
+
+void ThumbnailPack::Private::remap()
+{
+    const qint64 size = packSize;
+
+    if (map && size == mapSize)
+    {
+        return;
+    }
+
+    if (map)
+    {
+        packFile.unmap(map);
+        map     = 0;
+        mapSize = 0;
+    }
+
+    map = packFile.map(0, size);
+
+    if (map)
+    {
+        mapSize = size;
+    }
+    else
+    {
+        qCWarning(DIGIKAM_GENERAL_LOG) << "Cannot map thumbnail pack" << packPath << packFile.errorString();
+    }
+}
+
+void ThumbnailPack::Private::mapAppended()
+{
+    // The pack is not remapped after each append, which would cost one mmap for each
+    // thumbnail written, ie. while migrating. The readers remap it when they need to.
+
+    {
+        QReadLocker locker(&lock);
+
+        if (!opened || mapSize == packSize)
+        {
+            return;
+        }
+    }
+
+    QWriteLocker locker(&lock);
+
+    if (opened)
+    {
+        remap();
+    }
+}
+
+void ThumbnailPack::Private::loadIndex()
+{
+    index.clear();
+
+    const qint64 entries = (indexFile.size() - (qint64)sizeof(FileHeader)) / (qint64)sizeof(IndexEntry);
+    const qint64 end     = sizeof(FileHeader) + entries * sizeof(IndexEntry);
+
+    if (indexFile.size() != end)
+    {
+        // An entry was partially written: drop it.
+        indexFile.resize(end);
+    }
+
+    if (entries <= 0)
+    {
+        return;
+    }
+
+    uchar* const indexMap = indexFile.map(0, end);
+
+    if (!indexMap)
+    {
+        qCWarning(DIGIKAM_GENERAL_LOG) << "Cannot map thumbnail pack index" << indexPath;
+        return;
+    }
+
+    index.reserve(entries);
+
+    IndexEntry entry;
+
+    for (qint64 i = 0 ; i < entries ; ++i)
+    {
+        memcpy(&entry, indexMap + sizeof(FileHeader) + i * sizeof(IndexEntry), sizeof(IndexEntry));
+
+        if (entry.offset == 0)
+        {
+            index.remove(entry.key);
+        }
+        else if ((qint64)(entry.offset + sizeof(RecordHeader)) <= mapSize)
+        {
+            index.insert(entry.key, entry.offset);
+        }
+    }
+
+    indexFile.unmap(indexMap);
+}
+
+void ThumbnailPack::Private::rebuildIndex()
+{
+    index.clear();
+
+    // Records are appended in order, so a key replaced later in the pack wins.
+    // Removals recorded in the index only are lost, the next cleanup removes them again.
+
+    RecordHeader header;
+    QStringList  keys;
+    quint64      offset = sizeof(FileHeader);
+    QByteArray   entries(fileHeader(indexMagic, generation));
+
+    while (readRecord(offset, &header, &keys))
+    {
+        foreach (const QString& key, keys)
+        {
+            IndexEntry entry;
+            entry.key    = keyHash(key);
+            entry.offset = offset;
+            entries.append((const char*)&entry, sizeof(IndexEntry));
+            index.insert(entry.key, offset);
+        }
+
+        offset += sizeof(RecordHeader) + header.keysLength + header.dataLength;
+    }
+
+    if (!indexFile.resize(0) || !indexFile.seek(0) ||
+        indexFile.write(entries) != entries.size() || !indexFile.flush())
+    {
+        qCWarning(DIGIKAM_GENERAL_LOG) << "Cannot write thumbnail pack index" << indexPath << indexFile.errorString();
+    }
+}
+
+bool ThumbnailPack::Private::readRecord(quint64 offset, RecordHeader* const header, QStringList* const keys) const
+{
+    if (!map || (qint64)(offset + sizeof(RecordHeader)) > mapSize)
+    {
+        return false;
+    }
+
+    memcpy(header, map + offset, sizeof(RecordHeader));
+
+    if (header->magic != recordMagic ||
+        (qint64)(offset + sizeof(RecordHeader) + header->keysLength + header->dataLength) > mapSize)
+    {
+        return false;
+    }
+
+    if (keys)
+    {
+        *keys = QString::fromUtf8((const char*)(map + offset + sizeof(RecordHeader)), header->keysLength)
+                    .split(QLatin1Char('\0'), QString::SkipEmptyParts);
+    }
+
+    return true;
+}
+
+quint64 ThumbnailPack::Private::recordSize(quint64 offset) const
+{
+    RecordHeader header;
+
+    if (!readRecord(offset, &header, 0))
+    {
+        return 0;
+    }
+
+    return (sizeof(RecordHeader) + header.keysLength + header.dataLength);
+}
+
+quint64 ThumbnailPack::Private::findRecord(const QString& key, RecordHeader* const header, QStringList* const keys) const
+{
+    QHash<quint64, quint64>::const_iterator it = index.constFind(keyHash(key));
+
+    if (it == index.constEnd())
+    {
+        return 0;
+    }
+
+    // The keys stored in the record resolve hash collisions.
+    if (!readRecord(it.value(), header, keys) || !keys->contains(key))
+    {
+        return 0;
+    }
+
+    return it.value();
+}
+
+QImage ThumbnailPack::Private::readTile(quint64 offset, const RecordHeader& header) const
+{
+    const uchar* const data   = map + offset + sizeof(RecordHeader) + header.keysLength;
+    const int bytesPerLine    = header.width * 4;
+    const int byteCount       = bytesPerLine * header.height;
+    const QImage::Format fmt  = header.alpha ? QImage::Format_ARGB32 : QImage::Format_RGB32;
+
+    if (header.tileFormat != compressedTile)
+    {
+        return QImage();
+    }
+
+    const QByteArray pixels = qUncompress(data, header.dataLength);
+
+    if (pixels.size() != byteCount)
+    {
+        return QImage();
+    }
+
+    QImage image(header.width, header.height, fmt);
+
+    if (image.isNull())
+    {
+        return QImage();
+    }
+
+    memcpy(image.bits(), pixels.constData(), byteCount);
+
+    return image;
+}
+
+quint64 ThumbnailPack::Private::appendRecord(const QStringList& keys, const QImage& image,
+                                             const QDateTime& modificationDate, int orientationHint)
+{
+    QImage tile = image;
+
+    if (tile.format() != QImage::Format_RGB32 && tile.format() != QImage::Format_ARGB32)
+    {
+        tile = tile.convertToFormat(tile.hasAlphaChannel() ? QImage::Format_ARGB32 : QImage::Format_RGB32);
+    }
+
+    if (tile.isNull() || tile.width() > 0xFFFF || tile.height() > 0xFFFF)
+    {
+        return 0;
+    }
+
+    const QByteArray keysData = keys.join(QLatin1Char('\0')).toUtf8();
+    const QByteArray pixels   = QByteArray::fromRawData((const char*)tile.constBits(), tile.byteCount());
+    const QByteArray data     = qCompress(pixels, 1);
+
+    RecordHeader header;
+    header.magic              = recordMagic;
+    header.tileFormat         = compressedTile;
+    header.alpha              = (tile.format() == QImage::Format_ARGB32) ? 1 : 0;
+    header.reserved           = 0;
+    header.modificationDate   = modificationDate.isValid() ? modificationDate.toMSecsSinceEpoch() : -1;
+    header.orientationHint    = orientationHint;
+    header.width              = tile.width();
+    header.height             = tile.height();
+    header.keysLength         = keysData.size();
+    header.dataLength         = data.size();
+
+    QByteArray record;
+    record.reserve(sizeof(RecordHeader) + keysData.size() + data.size());
+    record.append((const char*)&header, sizeof(RecordHeader));
+    record.append(keysData);
+    record.append(data);
+
+    const qint64 offset = packSize;
+
+    if (!packFile.seek(offset) || packFile.write(record) != record.size() || !packFile.flush())
+    {
+        qCWarning(DIGIKAM_GENERAL_LOG) << "Cannot write to thumbnail pack" << packPath << packFile.errorString();
+        return 0;
+    }
+
+    packSize += record.size();
+
+    return offset;
+}
+
+void ThumbnailPack::Private::appendIndex(const QStringList& keys, quint64 offset)
+{
+    QByteArray entries;
+
+    foreach (const QString& key, keys)
+    {
+        IndexEntry entry;
+        entry.key    = keyHash(key);
+        entry.offset = offset;
+        entries.append((const char*)&entry, sizeof(IndexEntry));
+
+        if (offset)
+        {
+            index.insert(entry.key, offset);
+        }
+        else
+        {
+            index.remove(entry.key);
+        }
+    }
+
+    // The record is written before the index entries, so that a crash leaves an unreferenced record only.
+    if (!indexFile.seek(indexFile.size()) || indexFile.write(entries) != entries.size() || !indexFile.flush())
+    {
+        qCWarning(DIGIKAM_GENERAL_LOG) << "Cannot write to thumbnail pack index" << indexPath << indexFile.errorString();
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+class Q_DECL_HIDDEN ThumbnailPackCreator
+{
+public:
+
+    ThumbnailPack object;
+};
+
+Q_GLOBAL_STATIC(ThumbnailPackCreator, creator)
+
+// -----------------------------------------------------------------------------------------------
+
+ThumbnailPack* ThumbnailPack::instance()
+{
+    return &creator->object;
+}
+
+ThumbnailPack::ThumbnailPack()
+    : d(new Private)
+{
+}
+
+ThumbnailPack::~ThumbnailPack()
+{
+    close();
+    delete d;
+}
+
+bool ThumbnailPack::open(const QString& dirPath)
+{
+    QWriteLocker locker(&d->lock);
+
+    d->closeFiles();
+
+    if (!QDir().mkpath(dirPath))
+    {
+        qCWarning(DIGIKAM_GENERAL_LOG) << "Cannot create thumbnail pack directory" << dirPath;
+        return false;
+    }
+
+    QDir dir(dirPath);
+    d->packPath  = dir.filePath(QLatin1String("thumbnails-digikam.pack"));
+    d->indexPath = dir.filePath(QLatin1String("thumbnails-digikam.idx"));
+
+    if (!d->openFiles())
+    {
+        return false;
+    }
+
+    qCDebug(DIGIKAM_GENERAL_LOG) << "Thumbnail pack" << d->packPath << "opened with"
+                                 << d->index.count() << "keys";
+
+    return true;
+}
+
+void ThumbnailPack::close()
+{
+    QWriteLocker locker(&d->lock);
+    d->closeFiles();
+}
+
+bool ThumbnailPack::isOpen() const
+{
+    QReadLocker locker(&d->lock);
+    return d->opened;
+}
+
+int ThumbnailPack::count() const
+{
+    QReadLocker locker(&d->lock);
+    return d->index.count();
+}
+
+bool ThumbnailPack::isEmpty() const
+{
+    QReadLocker locker(&d->lock);
+    return d->index.isEmpty();
+}
+
+qint64 ThumbnailPack::size() const
+{
+    QReadLocker locker(&d->lock);
+    return d->packSize;
+}
+
+qint64 ThumbnailPack::wastedSize() const
+{
+    d->mapAppended();
+
+    QReadLocker locker(&d->lock);
+
+    if (!d->opened)
+    {
+        return 0;
+    }
+
+    qint64 used = sizeof(FileHeader);
+
+    foreach (const quint64 offset, d->index.values().toSet())
+    {
+        used += d->recordSize(offset);
+    }
+
+    return (d->packSize - used);
+}
+
+bool ThumbnailPack::find(const ThumbnailInfo& info, ThumbnailPackInfo* const packInfo, bool withImage) const
+{
+    d->mapAppended();
+
+    QReadLocker locker(&d->lock);
+
+    if (!d->opened)
+    {
+        return false;
+    }
+
+    RecordHeader header;
+    QStringList  keys;
+    quint64      offset = 0;
+
+    if (!info.customIdentifier.isEmpty())
+    {
+        offset = d->findRecord(Private::customKey(info.customIdentifier), &header, &keys);
+    }
+    else
+    {
+        if (!info.uniqueHash.isEmpty())
+        {
+            offset = d->findRecord(Private::hashKey(info.uniqueHash, info.fileSize), &header, &keys);
+        }
+
+        if (!offset && !info.filePath.isEmpty())
+        {
+            offset = d->findRecord(Private::pathKey(info.filePath), &header, &keys);
+
+            // As ThumbsDb::findByFilePath(): the thumbnail must not be referenced by a different hash.
+            if (offset && !info.uniqueHash.isEmpty())
+            {
+                const QString hashPrefix = QString::fromLatin1("h:%1:").arg(info.uniqueHash);
+                bool hasHash             = false;
+                bool sameHash            = false;
+
+                foreach (const QString& key, keys)
+                {
+                    if (key.startsWith(QLatin1String("h:")))
+                    {
+                        hasHash  = true;
+                        sameHash = sameHash || key.startsWith(hashPrefix);
+                    }
+                }
+
+                if (hasHash && !sameHash)
+                {
+                    offset = 0;
+                }
+            }
+        }
+    }
+
+    if (!offset)
+    {
+        return false;
+    }
+
+    packInfo->modificationDate = (header.modificationDate == -1) ? QDateTime()
+                                                                 : QDateTime::fromMSecsSinceEpoch(header.modificationDate);
+    packInfo->orientationHint  = header.orientationHint;
+
+    if (withImage)
+    {
+        packInfo->image = d->readTile(offset, header);
+
+        if (packInfo->image.isNull())
+        {
+            qCWarning(DIGIKAM_GENERAL_LOG) << "Cannot read thumbnail tile from pack at offset" << offset;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ThumbnailPack::insert(const ThumbnailInfo& info, const QImage& image, int orientationHint)
+{
+    const QStringList keys = Private::keysForInfo(info);
+
+    if (keys.isEmpty() || image.isNull())
+    {
+        return false;
+    }
+
+    QWriteLocker locker(&d->lock);
+
+    if (!d->opened)
+    {
+        return false;
+    }
+
+    const quint64 offset = d->appendRecord(keys, image, info.modificationDate, orientationHint);
+
+    if (!offset)
+    {
+        return false;
+    }
+
+    d->appendIndex(keys, offset);
+
+    return true;
+}
+
+void ThumbnailPack::remove(const ThumbnailInfo& info)
+{
+    const QStringList keys = Private::keysForInfo(info);
+
+    QWriteLocker locker(&d->lock);
+
+    if (!d->opened)
+    {
+        return;
+    }
+
+    d->remap();
+
+    QStringList removed;
+    RecordHeader header;
+    QStringList  recordKeys;
+
+    foreach (const QString& key, keys)
+    {
+        if (d->findRecord(key, &header, &recordKeys))
+        {
+            removed << key;
+        }
+    }
+
+    if (!removed.isEmpty())
+    {
+        d->appendIndex(removed, 0);
+    }
+}
+
+QSet<QString> ThumbnailPack::filePaths() const
+{
+    d->mapAppended();
+
+    QReadLocker locker(&d->lock);
+
+    QSet<QString> paths;
+
+    if (!d->opened)
+    {
+        return paths;
+    }
+
+    RecordHeader header;
+    QStringList  keys;
+
+    foreach (const quint64 offset, d->index.values().toSet())
+    {
+        if (!d->readRecord(offset, &header, &keys))
+        {
+            continue;
+        }
+
+        foreach (const QString& key, keys)
+        {
+            // The key may have been replaced by a later record or removed.
+            if (key.startsWith(QLatin1String("p:")) && d->index.value(Private::keyHash(key)) == offset)
+            {
+                paths << key.mid(2);
+            }
+        }
+    }
+
+    return paths;
+}
+
+int ThumbnailPack::removeUnused(const QList<ThumbnailInfo>& usedInfos)
+{
+    QSet<quint64> used;
+
+    foreach (const ThumbnailInfo& info, usedInfos)
+    {
+        foreach (const QString& key, Private::keysForInfo(info))
+        {
+            used << Private::keyHash(key);
+        }
+    }
+
+    QWriteLocker locker(&d->lock);
+
+    if (!d->opened)
+    {
+        return 0;
+    }
+
+    QByteArray entries;
+
+    for (QHash<quint64, quint64>::iterator it = d->index.begin() ; it != d->index.end() ; )
+    {
+        if (used.contains(it.key()))
+        {
+            ++it;
+            continue;
+        }
+
+        IndexEntry entry;
+        entry.key    = it.key();
+        entry.offset = 0;
+        entries.append((const char*)&entry, sizeof(IndexEntry));
+        it           = d->index.erase(it);
+    }
+
+    if (!entries.isEmpty() &&
+        (!d->indexFile.seek(d->indexFile.size()) || d->indexFile.write(entries) != entries.size() || !d->indexFile.flush()))
+    {
+        qCWarning(DIGIKAM_GENERAL_LOG) << "Cannot write to thumbnail pack index" << d->indexPath << d->indexFile.errorString();
+    }
+
+    const int removed = entries.size() / sizeof(IndexEntry);
+
+    qCDebug(DIGIKAM_GENERAL_LOG) << "Removed" << removed << "unused keys from thumbnail pack";
+
+    return removed;
+}
+
+bool ThumbnailPack::compact()
+{
+    QWriteLocker locker(&d->lock);
+
+    if (!d->opened)
+    {
+        return false;
+    }
+
+    d->remap();
+
+    QList<quint64> offsets = d->index.values().toSet().toList();
+    std::sort(offsets.begin(), offsets.end());
+
+    // The new files are written completely aside, and replace the live files only when committed.
+
+    QSaveFile newPack(d->packPath);
+    QSaveFile newIndex(d->indexPath);
+
+    const quint32    newGeneration = d->generation + 1;
+    const QByteArray packHeader    = Private::fileHeader(packMagic,  newGeneration);
+    QByteArray       entries       = Private::fileHeader(indexMagic, newGeneration);
+
+    bool ok = newPack.open(QIODevice::WriteOnly)  &&
+              newIndex.open(QIODevice::WriteOnly) &&
+              newPack.write(packHeader) == packHeader.size();
+
+    QHash<quint64, quint64> newOffsets;
+
+    foreach (const quint64 offset, offsets)
+    {
+        if (!ok)
+        {
+            break;
+        }
+
+        const quint64 size = d->recordSize(offset);
+
+        if (!size)
+        {
+            continue;
+        }
+
+        newOffsets.insert(offset, newPack.pos());
+        ok = (newPack.write((const char*)(d->map + offset), size) == (qint64)size);
+    }
+
+    for (QHash<quint64, quint64>::const_iterator it = d->index.constBegin() ; ok && it != d->index.constEnd() ; ++it)
+    {
+        QHash<quint64, quint64>::const_iterator newOffset = newOffsets.constFind(it.value());
+
+        if (newOffset == newOffsets.constEnd())
+        {
+            continue;
+        }
+
+        IndexEntry entry;
+        entry.key    = it.key();
+        entry.offset = newOffset.value();
+        entries.append((const char*)&entry, sizeof(IndexEntry));
+    }
+
+    ok = ok && newIndex.write(entries) == entries.size() && newPack.flush() && newIndex.flush();
+
+    if (!ok)
+    {
+        qCWarning(DIGIKAM_GENERAL_LOG) << "Cannot write compacted thumbnail pack" << d->packPath
+                                       << newPack.errorString() << newIndex.errorString();
+
+        // Uncommitted files are discarded, the live pack is unchanged.
+        return false;
+    }
+
+    const qint64 oldSize = d->packSize;
+
+    // The live files must be unmapped and closed to be replaced on all platforms.
+    d->closeFiles();
+
+    // The pack is replaced first. If the index cannot be replaced, its generation does
+    // not match the new pack anymore, and it is rebuilt from the pack when opened.
+
+    if (!newPack.commit() || !newIndex.commit())
+    {
+        qCWarning(DIGIKAM_GENERAL_LOG) << "Cannot replace thumbnail pack" << d->packPath
+                                       << newPack.errorString() << newIndex.errorString();
+    }
+
+    if (!d->openFiles())
+    {
+        return false;
+    }
+
+    qCDebug(DIGIKAM_GENERAL_LOG) << "Thumbnail pack compacted from" << oldSize << "to" << d->packSize << "bytes";
+
+    return (d->generation == newGeneration);
+}
+
+void ThumbnailPack::setMigrationPending(bool pending)
+{
+    QWriteLocker locker(&d->lock);
+    d->migrationPending = pending;
+}
+
+bool ThumbnailPack::isMigrationPending() const
+{
+    QReadLocker locker(&d->lock);
+    return d->migrationPending;
+}
+
+int ThumbnailPack::migrateFromThumbsDb()
+{
+    if (!isOpen())
+    {
+        return 0;
+    }
+
+    QList<int> ids;
+
+    {
+        ThumbsDbAccess access;
+        ids = access.db()->findAll();
+    }
+
+    int count = 0;
+
+    foreach (int id, ids)
+    {
+        if (migrateFromThumbsDb(id))
+        {
+            ++count;
+        }
+    }
+
+    qCDebug(DIGIKAM_GENERAL_LOG) << "Migrated" << count << "thumbnails from thumbnail database to" << d->packPath;
+
+    return count;
+}
+
+bool ThumbnailPack::migrateFromThumbsDb(int thumbId)
+{
+    ThumbsDbInfo                      dbInfo;
+    QList<QPair<QString, qlonglong> > uniqueHashes;
+    QStringList                       filePaths;
+    QStringList                       customIdentifiers;
+
+    {
+        // The database is only locked while this thumbnail is read.
+        ThumbsDbAccess access;
+        dbInfo = access.db()->findById(thumbId);
+
+        if (dbInfo.data.isNull())
+        {
+            return false;
+        }
+
+        access.db()->findReferences(thumbId, uniqueHashes, filePaths, customIdentifiers);
+    }
+
+    QImage image;
+
+    switch (dbInfo.type)
+    {
+        case DatabaseThumbnail::PGF:
+            PGFUtils::readPGFImageData(dbInfo.data, image);
+            break;
+        case DatabaseThumbnail::JPEG:
+            image.loadFromData(dbInfo.data, "JPEG");
+            break;
+        case DatabaseThumbnail::JPEG2000:
+            image.loadFromData(dbInfo.data, "JP2");
+            break;
+        case DatabaseThumbnail::PNG:
+            image.loadFromData(dbInfo.data, "PNG");
+            break;
+        default:
+            break;
+    }
+
+    if (image.isNull())
+    {
+        qCWarning(DIGIKAM_GENERAL_LOG) << "Cannot decode thumbnail" << thumbId << "from thumbnail database";
+        return false;
+    }
+
+    QStringList keys;
+
+    foreach (const QString& identifier, customIdentifiers)
+    {
+        keys << Private::customKey(identifier);
+    }
+
+    for (int i = 0 ; i < uniqueHashes.size() ; ++i)
+    {
+        keys << Private::hashKey(uniqueHashes.at(i).first, uniqueHashes.at(i).second);
+    }
+
+    foreach (const QString& path, filePaths)
+    {
+        keys << Private::pathKey(path);
+    }
+
+    QWriteLocker locker(&d->lock);
+
+    if (!d->opened)
+    {
+        return false;
+    }
+
+    // A thumbnail stored in the pack meanwhile is newer than the one of the database.
+
+    QStringList::iterator it = keys.begin();
+
+    while (it != keys.end())
+    {
+        if (d->index.contains(Private::keyHash(*it)))
+        {
+            it = keys.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    if (keys.isEmpty())
+    {
+        return false;
+    }
+
+    const quint64 offset = d->appendRecord(keys, image, dbInfo.modificationDate, dbInfo.orientationHint);
+
+    if (!offset)
+    {
+        return false;
+    }
+
+    d->appendIndex(keys, offset);
+
+    return true;
+}
+
+} // namespace Digikam
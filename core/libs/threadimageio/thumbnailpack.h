@@ -0,0 +1,154 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-14
+ * Description : Memory-mapped thumbnail pack storage
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_THUMBNAIL_PACK_H
+#define DIGIKAM_THUMBNAIL_PACK_H
+
+// Qt includes
+
+#include <QDateTime>
+#include <QImage>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+// Local includes
+
+#include "digikam_export.h"
+#include "thumbnailinfo.h"
+
+namespace Digikam
+{
+
+class DIGIKAM_EXPORT ThumbnailPackInfo
+{
+public:
+
+    explicit ThumbnailPackInfo()
+        : orientationHint(0)
+    {
+    }
+
+    QImage    image;
+    QDateTime modificationDate;
+    int       orientationHint;
+};
+
+// ------------------------------------------------------------------------------------------
+
+/** This class stores thumbnails in two append-only files, memory-mapped for reading.
+ *  The pack file contains the records: a small header, the keys of the thumbnail,
+ *  and the tile pixels, zlib compressed with the fastest level.
+ *  The index file contains fixed-size entries mapping a 64 bits hash of a key
+ *  (uniqueHash + fileSize, file path or custom identifier) to the offset of a record.
+ *  A lookup is a hash table access and a copy from the mapped pack, without any SQL query.
+ *  Replaced and removed thumbnails stay in the pack until compact() is called.
+ *  The application-wide pack is returned by instance() and is thread safe.
+ */
+class DIGIKAM_EXPORT ThumbnailPack
+{
+public:
+
+    static ThumbnailPack* instance();
+
+    /**
+     * Open the pack in the directory, creating the files if necessary.
+     * The index is loaded in memory and the pack is mapped.
+     */
+    bool open(const QString& dirPath);
+    void close();
+    bool isOpen()                                           const;
+
+    /// Number of indexed keys. A thumbnail is usually indexed by its uniqueHash and its file path.
+    int    count()                                          const;
+    bool   isEmpty()                                        const;
+
+    /// Size of the pack file, and size used by replaced or removed thumbnails.
+    qint64 size()                                           const;
+    qint64 wastedSize()                                     const;
+
+    /**
+     * Find the thumbnail, looking up the custom identifier, or the uniqueHash + fileSize,
+     * then the file path, like the thumbnail database does.
+     * If withImage is false, only the modification date and orientation are read.
+     * Returns false if not found.
+     */
+    bool find(const ThumbnailInfo& info, ThumbnailPackInfo* const packInfo, bool withImage = true) const;
+
+    /**
+     * Append the thumbnail to the pack, replacing any thumbnail with the same keys.
+     */
+    bool insert(const ThumbnailInfo& info, const QImage& image, int orientationHint);
+
+    void remove(const ThumbnailInfo& info);
+
+    /// The file paths which have a thumbnail in the pack, as ThumbsDb::getFilePathsWithThumbnail().
+    QSet<QString> filePaths()                               const;
+
+    /**
+     * Remove the keys which do not match any of the given thumbnails, as the database cleaner
+     * does with the thumbnail database. Returns the number of removed keys.
+     * The space is reclaimed by compact().
+     */
+    int removeUnused(const QList<ThumbnailInfo>& usedInfos);
+
+    /**
+     * Rewrite the pack without replaced and removed thumbnails.
+     * The new files are written aside and atomically replace the live files.
+     * Returns false if the new files cannot be written, the pack is then unchanged.
+     */
+    bool compact();
+
+    /**
+     * Copy all thumbnails of the thumbnail database to the pack, or only the given one.
+     * Keys already in the pack are not replaced, so the migration can be resumed.
+     * The thumbnail database must be initialized. Returns the number of thumbnails copied,
+     * or if the thumbnail was copied. Do not call it from the GUI thread, see ThumbnailPackMigrator.
+     */
+    int  migrateFromThumbsDb();
+    bool migrateFromThumbsDb(int thumbId);
+
+    /**
+     * While the thumbnail database is being migrated, thumbnails missing in the pack
+     * are read from the database and copied to the pack when loaded.
+     */
+    void setMigrationPending(bool pending);
+    bool isMigrationPending()                               const;
+
+private:
+
+    explicit ThumbnailPack();
+    ~ThumbnailPack();
+
+    ThumbnailPack(const ThumbnailPack&); // Disable
+
+    friend class ThumbnailPackCreator;
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace Digikam
+
+#endif // DIGIKAM_THUMBNAIL_PACK_H
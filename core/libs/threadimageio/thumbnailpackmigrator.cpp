@@ -0,0 +1,162 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-27
+ * Description : Background migration of the thumbnail database to the thumbnail pack
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "thumbnailpackmigrator.h"
+
+// Qt includes
+
+#include <QAtomicInt>
+#include <QIcon>
+#include <QList>
+#include <QThread>
+
+// KDE includes
+
+#include <klocalizedstring.h>
+
+// Local includes
+
+#include "digikam_debug.h"
+#include "thumbnailpack.h"
+#include "thumbsdbaccess.h"
+#include "thumbsdb.h"
+
+namespace Digikam
+{
+
+class Q_DECL_HIDDEN ThumbnailPackMigrator::Private : public QThread
+{
+public:
+
+    explicit Private(ThumbnailPackMigrator* const q)
+      : copied(0),
+        q(q)
+    {
+    }
+
+    void run();
+
+public:
+
+    QList<int>                   ids;
+    QAtomicInt                   cancel;
+    int                          copied;
+
+    ThumbnailPackMigrator* const q;
+};
+
+void ThumbnailPackMigrator::Private::run()
+{
+    ThumbnailPack* const pack = ThumbnailPack::instance();
+    const int chunk           = 50;
+    int done                  = 0;
+
+    foreach (int id, ids)
+    {
+        if (cancel.load())
+        {
+            break;
+        }
+
+        if (pack->migrateFromThumbsDb(id))
+        {
+            ++copied;
+        }
+
+        if (++done == chunk)
+        {
+            QMetaObject::invokeMethod(q, "slotAdvance", Qt::QueuedConnection, Q_ARG(int, done));
+            done = 0;
+        }
+    }
+
+    if (done)
+    {
+        QMetaObject::invokeMethod(q, "slotAdvance", Qt::QueuedConnection, Q_ARG(int, done));
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+ThumbnailPackMigrator::ThumbnailPackMigrator()
+    : ProgressItem(0, QLatin1String("ThumbnailPackMigrator"), QString(), QString(), true, true),
+      d(new Private(this))
+{
+    setLabel(i18n("Migrating thumbnails"));
+    setThumbnail(QIcon::fromTheme(QLatin1String("view-preview")));
+
+    connect(this, SIGNAL(progressItemCanceled(ProgressItem*)),
+            this, SLOT(slotCancel()));
+
+    connect(d, SIGNAL(finished()),
+            this, SLOT(slotThreadFinished()));
+}
+
+ThumbnailPackMigrator::~ThumbnailPackMigrator()
+{
+    d->cancel = 1;
+    d->wait();
+    delete d;
+}
+
+void ThumbnailPackMigrator::start()
+{
+    if (ThumbnailPack::instance()->isOpen() && ThumbsDbAccess::isInitialized())
+    {
+        ThumbsDbAccess access;
+        d->ids = access.db()->findAll();
+    }
+
+    ThumbnailPack::instance()->setMigrationPending(true);
+    ProgressManager::addProgressItem(this);
+    setTotalItems(d->ids.count());
+
+    qCDebug(DIGIKAM_GENERAL_LOG) << "Migrating" << d->ids.count() << "thumbnails from thumbnail database to thumbnails pack";
+
+    d->start(QThread::LowPriority);
+}
+
+void ThumbnailPackMigrator::slotAdvance(int count)
+{
+    advance(count);
+}
+
+void ThumbnailPackMigrator::slotCancel()
+{
+    d->cancel = 1;
+}
+
+void ThumbnailPackMigrator::slotThreadFinished()
+{
+    qCDebug(DIGIKAM_GENERAL_LOG) << "Migrated" << d->copied << "thumbnails from thumbnail database to thumbnails pack";
+
+    if (!d->cancel.load())
+    {
+        ThumbnailPack::instance()->setMigrationPending(false);
+        emit signalMigrated();
+    }
+
+    setComplete();
+}
+
+} // namespace Digikam
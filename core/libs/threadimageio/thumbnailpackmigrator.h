@@ -0,0 +1,70 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-27
+ * Description : Background migration of the thumbnail database to the thumbnail pack
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_THUMBNAIL_PACK_MIGRATOR_H
+#define DIGIKAM_THUMBNAIL_PACK_MIGRATOR_H
+
+// Local includes
+
+#include "digikam_export.h"
+#include "progressmanager.h"
+
+namespace Digikam
+{
+
+/** Copies the thumbnail database to the opened ThumbnailPack in a background thread,
+ *  reporting to the progress manager. While it runs, the pack reads the thumbnails
+ *  not yet copied from the database. A canceled migration is resumed by the next one.
+ *  The object deletes itself when completed.
+ */
+class DIGIKAM_EXPORT ThumbnailPackMigrator : public ProgressItem
+{
+    Q_OBJECT
+
+public:
+
+    explicit ThumbnailPackMigrator();
+    ~ThumbnailPackMigrator();
+
+    void start();
+
+Q_SIGNALS:
+
+    /// Emitted when all thumbnails were copied, not if canceled.
+    void signalMigrated();
+
+private Q_SLOTS:
+
+    void slotAdvance(int count);
+    void slotThreadFinished();
+    void slotCancel();
+
+private:
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace Digikam
+
+#endif // DIGIKAM_THUMBNAIL_PACK_MIGRATOR_H
@@ -0,0 +1,103 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-22
+ * Description : Thumbnail prefetching on several loading threads
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "thumbnailprefetcher.h"
+
+// Qt includes
+
+#include <QThread>
+#include <QVector>
+
+// Local includes
+
+#include "thumbnailloadthread.h"
+
+namespace Digikam
+{
+
+class Q_DECL_HIDDEN ThumbnailPrefetcher::Private
+{
+public:
+
+    explicit Private()
+    {
+    }
+
+    QList<ThumbnailLoadThread*> workers;
+};
+
+ThumbnailPrefetcher::ThumbnailPrefetcher()
+    : d(new Private)
+{
+    // Keep one core for the GUI and the view loading thread.
+    const int count = qBound(1, QThread::idealThreadCount() - 1, 4);
+
+    for (int i = 0 ; i < count ; ++i)
+    {
+        ThumbnailLoadThread* const worker = new ThumbnailLoadThread;
+        worker->setPixmapRequested(false);
+        worker->setSendSurrogatePixmap(false);
+        worker->setPriority(QThread::LowPriority);
+        d->workers << worker;
+    }
+}
+
+ThumbnailPrefetcher::~ThumbnailPrefetcher()
+{
+    cancel();
+    qDeleteAll(d->workers);
+    delete d;
+}
+
+int ThumbnailPrefetcher::workerCount() const
+{
+    return d->workers.count();
+}
+
+void ThumbnailPrefetcher::prefetch(const QList<ThumbnailIdentifier>& identifiers, int size)
+{
+    // Spread the identifiers round-robin, so that each worker loads in the order of priority.
+
+    const int count = d->workers.count();
+    QVector<QList<ThumbnailIdentifier> > groups(count);
+
+    for (int i = 0 ; i < identifiers.size() ; ++i)
+    {
+        groups[i % count] << identifiers.at(i);
+    }
+
+    for (int i = 0 ; i < count ; ++i)
+    {
+        d->workers.at(i)->prefetchGroup(groups.at(i), size);
+    }
+}
+
+void ThumbnailPrefetcher::cancel()
+{
+    foreach(ThumbnailLoadThread* const worker, d->workers)
+    {
+        worker->stopAllTasks();
+    }
+}
+
+} // namespace Digikam
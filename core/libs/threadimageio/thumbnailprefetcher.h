@@ -0,0 +1,72 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-22
+ * Description : Thumbnail prefetching on several loading threads
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_THUMBNAIL_PREFETCHER_H
+#define DIGIKAM_THUMBNAIL_PREFETCHER_H
+
+// Qt includes
+
+#include <QList>
+
+// Local includes
+
+#include "digikam_export.h"
+#include "thumbnailinfo.h"
+
+namespace Digikam
+{
+
+/** This class loads thumbnails in advance into the loading cache, using several
+ *  ThumbnailLoadThread workers. A ThumbnailLoadThread requesting a prefetched thumbnail
+ *  finds it in the cache, or waits for the worker currently loading it, instead of loading it again.
+ *  Each request replaces the previous one: thumbnails no longer requested are not loaded.
+ */
+class DIGIKAM_EXPORT ThumbnailPrefetcher
+{
+public:
+
+    explicit ThumbnailPrefetcher();
+    ~ThumbnailPrefetcher();
+
+    /// Number of worker threads, depending on the number of processor cores.
+    int  workerCount() const;
+
+    /** Load the thumbnails in the given size, in order of priority: the first identifiers
+     *  are loaded first, spread over all workers.
+     */
+    void prefetch(const QList<ThumbnailIdentifier>& identifiers, int size);
+
+    /// Cancel all prefetching.
+    void cancel();
+
+private:
+
+    ThumbnailPrefetcher(const ThumbnailPrefetcher&); // Disable
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace Digikam
+
+#endif // DIGIKAM_THUMBNAIL_PREFETCHER_H
@@ -26,10 +26,6 @@
 #include "dcategorizedview.h"
 #include "dcategorizedview_p.h"
 
-// C++ includes
-
-#include <cmath>
-
 // Qt includes
 
 #include <QPainter>
@@ -59,6 +55,7 @@ DCategorizedView::Private::Private(DCategorizedView* const lv)
       dragLeftViewport(false),
       drawItemsWhileDragging(true),
       forcedSelectionPosition(0),
+      layoutValid(false),
       proxyModel(0)
 {
 }
@@ -139,7 +136,6 @@ QRect DCategorizedView::Private::visualRectInViewport(const QModelIndex& index)
     }
 
     QRect      retRect;
-    QString    curCategory     = elementsInfo[index.row()].category;
     const bool leftToRightFlow = (listView->flow() == QListView::LeftToRight);
 
     if (leftToRightFlow)
@@ -229,34 +225,8 @@ QRect DCategorizedView::Private::visualRectInViewport(const QModelIndex& index)
         row            = elementsInfo[index.row()].relativeOffsetToCategory / elementsPerRow;
     }
 
-    foreach(const QString& category, categories)
-    {
-        if (category == curCategory)
-        {
-            break;
-        }
-
-        float rows  = (float) ((float) categoriesIndexes[category].count() /
-                               (float) elementsPerRow);
-
-        int rowsInt = categoriesIndexes[category].count() / elementsPerRow;
-
-        if (rows - trunc(rows))
-        {
-            ++rowsInt;
-        }
-
-        retRect.setTop(retRect.top() +
-                       (rowsInt * itemHeight) +
-                       categoryDrawer->categoryHeight(index, listView->viewOptions()) +
-                       listView->spacing() * 2);
-
-        if (listView->gridSize().isEmpty())
-        {
-            retRect.setTop(retRect.top() +
-                           (rowsInt * listView->spacing()));
-        }
-    }
+    updateCategoriesLayout();
+    retRect.setTop(retRect.top() + categoriesLayout.at(elementsInfo[index.row()].categoryPosition).top);
 
     if (listView->gridSize().isEmpty())
     {
@@ -300,71 +270,122 @@ QRect DCategorizedView::Private::visualCategoryRectInViewport(const QString& cat
                   0);
 
     if (!proxyModel || !categoryDrawer || !proxyModel->isCategorizedModel() ||
-        !proxyModel->rowCount() || !categories.contains(category))
+        !proxyModel->rowCount())
     {
         return QRect();
     }
 
-    QModelIndex index         = proxyModel->index(0, 0, QModelIndex());
-    int         viewportWidth = listView->viewport()->width() - listView->spacing();
-    int         itemHeight;
-    int         itemWidth;
+    QHash<QString, int>::const_iterator it = categoriesPositions.constFind(category);
 
-    if (listView->gridSize().isEmpty())
+    if (it == categoriesPositions.constEnd())
     {
-        itemHeight = biggestItemSize.height();
-        itemWidth  = biggestItemSize.width();
-    }
-    else
-    {
-        itemHeight = listView->gridSize().height();
-        itemWidth  = listView->gridSize().width();
+        return QRect();
     }
 
-    int itemWidthPlusSeparation = listView->spacing() + itemWidth;
-    int elementsPerRow          = viewportWidth / itemWidthPlusSeparation;
+    updateCategoriesLayout();
 
-    if (!elementsPerRow)
+    retRect.setTop(retRect.top() + categoriesLayout.at(*it).top);
+    retRect.setHeight(layoutParameters.categoryHeight);
+
+    return retRect;
+}
+
+void DCategorizedView::Private::updateCategoriesLayout() const
+{
+    LayoutParameters params;
+
+    if (!categoriesLayout.isEmpty())
     {
-        ++elementsPerRow;
+        const bool leftToRightFlow = (listView->flow() == QListView::LeftToRight);
+        const int  viewportWidth   = listView->viewport()->width() - listView->spacing();
+        int        itemWidth;
+
+        params.spacing        = listView->spacing();
+        params.gridEmpty      = listView->gridSize().isEmpty();
+        params.categoryHeight = categoryDrawer->categoryHeight(proxyModel->index(0, 0), listView->viewOptions());
+
+        if (params.gridEmpty)
+        {
+            params.itemHeight = biggestItemSize.height();
+            itemWidth         = biggestItemSize.width();
+        }
+        else
+        {
+            params.itemHeight = listView->gridSize().height();
+            itemWidth         = listView->gridSize().width();
+        }
+
+        int itemWidthPlusSeparation = params.spacing + itemWidth;
+
+        if (!itemWidthPlusSeparation)
+        {
+            ++itemWidthPlusSeparation;
+        }
+
+        params.elementsPerRow = leftToRightFlow ? qMax(viewportWidth / itemWidthPlusSeparation, 1) : 1;
     }
 
-    if (listView->flow() == QListView::TopToBottom)
+    if (layoutValid && params == layoutParameters)
     {
-        elementsPerRow = 1;
+        return;
     }
 
-    foreach(const QString& itCategory, categories)
+    // Each category takes its header, the rows of its items and the spacing around them.
+
+    int top = 0;
+
+    for (int i = 0 ; i < categoriesLayout.size() ; ++i)
     {
-        if (itCategory == category)
-        {
-            break;
-        }
+        CategoryLayout& layout = categoriesLayout[i];
+        layout.top             = top;
 
-        float rows  = (float) ((float) categoriesIndexes[itCategory].count() /
-                               (float) elementsPerRow);
-        int rowsInt = categoriesIndexes[itCategory].count() / elementsPerRow;
+        const int rows         = (layout.count + params.elementsPerRow - 1) / params.elementsPerRow;
 
-        if (rows - trunc(rows))
+        top += rows * params.itemHeight + params.categoryHeight + params.spacing * 2;
+
+        if (params.gridEmpty)
         {
-            ++rowsInt;
+            top += rows * params.spacing;
         }
+    }
 
-        retRect.setTop(retRect.top() +
-                       (rowsInt * itemHeight) +
-                       categoryDrawer->categoryHeight(index, listView->viewOptions()) +
-                       listView->spacing() * 2);
+    layoutParameters = params;
+    layoutValid      = true;
+}
 
-        if (listView->gridSize().isEmpty())
+int DCategorizedView::Private::categoryPositionAt(int y) const
+{
+    // Binary search of the last category with a top not below y
+    int bottom = 0;
+    int top    = categoriesLayout.size() - 1;
+    int found  = 0;
+
+    while (bottom <= top)
+    {
+        const int middle = (bottom + top) / 2;
+
+        if (categoriesLayout.at(middle).top <= y)
+        {
+            found  = middle;
+            bottom = middle + 1;
+        }
+        else
         {
-            retRect.setTop(retRect.top() +
-                           (rowsInt * listView->spacing()));
+            top    = middle - 1;
         }
     }
 
-    retRect.setHeight(categoryDrawer->categoryHeight(index, listView->viewOptions()));
+    return found;
+}
 
-    return retRect;
+void DCategorizedView::Private::clearCategories()
+{
+    categoriesIndexes.clear();
+    categoriesPosition.clear();
+    categories.clear();
+    categoriesPositions.clear();
+    categoriesLayout.clear();
+    layoutValid = false;
 }
 
 // We're sure elementsPosition doesn't contain index
@@ -575,9 +596,7 @@ void DCategorizedView::setModel(QAbstractItemModel* model)
     d->rightMouseButtonPressed = false;
     d->elementsInfo.clear();
     d->elementsPosition.clear();
-    d->categoriesIndexes.clear();
-    d->categoriesPosition.clear();
-    d->categories.clear();
+    d->clearCategories();
     d->intersectedIndexes.clear();
 
     if (d->proxyModel)
@@ -646,31 +665,22 @@ QModelIndex DCategorizedView::categoryAt(const QPoint& point) const
         return QModelIndex();
     }
 
-    // We traverse the categories and find the first where point.y() is below the visualRect
-    int     y = 0, lastY = 0;
-    QString lastCategory;
-
-    foreach(const QString& category, d->categories)
+    if (d->categories.isEmpty())
     {
-        y = d->categoryVisualRect(category).top();
+        return QModelIndex();
+    }
 
-        if (point.y() >= lastY && point.y() < y)
-        {
-            break;
-        }
+    // We look for the last category with a visualRect top above point.y()
+    d->updateCategoriesLayout();
 
-        lastY = y;
-        y     = 0;
-        lastCategory = category;
-    }
+    const int position = d->categoryPositionAt(point.y() + verticalOffset() - spacing());
 
-    // if lastCategory is the last one in the list y will be 0
-    if (!lastCategory.isNull() && point.y() >= lastY && (point.y() < y || !y))
+    if (d->categoryVisualRect(d->categories.at(position)).top() > point.y())
     {
-        return d->proxyModel->index(d->categoriesIndexes[lastCategory][0], d->proxyModel->sortColumn());
+        return QModelIndex();
     }
 
-    return QModelIndex();
+    return d->proxyModel->index(d->categoriesLayout.at(position).firstRow, d->proxyModel->sortColumn());
 }
 
 QItemSelectionRange DCategorizedView::categoryRange(const QModelIndex& index) const
@@ -705,9 +715,7 @@ void DCategorizedView::setCategoryDrawer(DCategoryDrawer* categoryDrawer)
     d->rightMouseButtonPressed = false;
     d->elementsInfo.clear();
     d->elementsPosition.clear();
-    d->categoriesIndexes.clear();
-    d->categoriesPosition.clear();
-    d->categories.clear();
+    d->clearCategories();
     d->intersectedIndexes.clear();
     d->categoryDrawer = categoryDrawer;
 
@@ -773,9 +781,7 @@ void DCategorizedView::reset()
     d->rightMouseButtonPressed = false;
     d->elementsInfo.clear();
     d->elementsPosition.clear();
-    d->categoriesIndexes.clear();
-    d->categoriesPosition.clear();
-    d->categories.clear();
+    d->clearCategories();
     d->intersectedIndexes.clear();
 }
 
@@ -876,8 +882,13 @@ void DCategorizedView::paintEvent(QPaintEvent* event)
     QStyleOptionViewItem otherOption;
     bool                   intersectedInThePast = false;
 
-    foreach(const QString& category, d->categories)
+    // Categories above the first one starting above the area can not intersect it
+    d->updateCategoriesLayout();
+    const int firstPosition = d->categories.isEmpty() ? 0 : d->categoryPositionAt(area.top() + verticalOffset() - spacing());
+
+    for (int i = firstPosition ; i < d->categories.size() ; ++i)
     {
+        const QString& category = d->categories.at(i);
         otherOption       = option;
         otherOption.rect  = d->categoryVisualRect(category);
         otherOption.state &= ~QStyle::State_MouseOver;
@@ -1244,19 +1255,22 @@ void DCategorizedView::mouseMoveEvent(QMouseEvent* event)
 
     d->hoveredCategory.clear();
 
-    // Redraw categories
-    foreach(const QString& category, d->categories)
+    // Redraw categories. Only the category starting above the mouse can be hovered.
+    if (!d->categories.isEmpty())
     {
+        d->updateCategoriesLayout();
+        const QString& category = d->categories.at(d->categoryPositionAt(event->pos().y() + verticalOffset() - spacing()));
+
         if (d->categoryVisualRect(category).intersects(QRect(event->pos(), event->pos())))
         {
             d->hoveredCategory = category;
             viewport()->update(d->categoryVisualRect(category));
         }
-        else if ((category == previousHoveredCategory) &&
-                 (!d->categoryVisualRect(previousHoveredCategory).intersects(QRect(event->pos(), event->pos()))))
-        {
-            viewport()->update(d->categoryVisualRect(category));
-        }
+    }
+
+    if (!previousHoveredCategory.isNull() && (previousHoveredCategory != d->hoveredCategory))
+    {
+        viewport()->update(d->categoryVisualRect(previousHoveredCategory));
     }
 
     QRect rect;
@@ -1333,27 +1347,25 @@ void DCategorizedView::mouseReleaseEvent(QMouseEvent* event)
     initialPressPosition.setX(initialPressPosition.x() + horizontalOffset());
 
     if ((selectionMode() != SingleSelection) && (selectionMode() != NoSelection) &&
-        (initialPressPosition == d->initialPressPosition))
+        (initialPressPosition == d->initialPressPosition) && !d->categories.isEmpty())
     {
-        foreach(const QString& category, d->categories)
-        {
-            if (d->categoryVisualRect(category).contains(event->pos()) &&
-                selectionModel())
-            {
-                QItemSelection selection      = selectionModel()->selection();
-                const QVector<int> &indexList = d->categoriesIndexes[category];
-
-                foreach(int row, indexList)
-                {
-                    QModelIndex selectIndex = d->proxyModel->index(row, 0);
+        d->updateCategoriesLayout();
+        const QString& category = d->categories.at(d->categoryPositionAt(event->pos().y() + verticalOffset() - spacing()));
 
-                    selection << QItemSelectionRange(selectIndex);
-                }
+        if (d->categoryVisualRect(category).contains(event->pos()) &&
+            selectionModel())
+        {
+            QItemSelection selection      = selectionModel()->selection();
+            const QVector<int> &indexList = d->categoriesIndexes[category];
 
-                selectionModel()->select(selection, QItemSelectionModel::SelectCurrent);
+            foreach(int row, indexList)
+            {
+                QModelIndex selectIndex = d->proxyModel->index(row, 0);
 
-                break;
+                selection << QItemSelectionRange(selectIndex);
             }
+
+            selectionModel()->select(selection, QItemSelectionModel::SelectCurrent);
         }
     }
 
@@ -1698,9 +1710,7 @@ void DCategorizedView::rowsInserted(const QModelIndex& parent, int start, int en
         d->rightMouseButtonPressed = false;
         d->elementsInfo.clear();
         d->elementsPosition.clear();
-        d->categoriesIndexes.clear();
-        d->categoriesPosition.clear();
-        d->categories.clear();
+        d->clearCategories();
         d->intersectedIndexes.clear();
 
         return;
@@ -1793,9 +1803,7 @@ void DCategorizedView::rowsInsertedArtifficial(const QModelIndex& parent, int st
     d->rightMouseButtonPressed = false;
     d->elementsInfo.clear();
     d->elementsPosition.clear();
-    d->categoriesIndexes.clear();
-    d->categoriesPosition.clear();
-    d->categories.clear();
+    d->clearCategories();
     d->intersectedIndexes.clear();
 
     if (start > end || end < 0 || start < 0 || !d->proxyModel->rowCount())
@@ -1849,11 +1857,19 @@ void DCategorizedView::rowsInsertedArtifficial(const QModelIndex& parent, int st
             rows[offset]                             = i;
             struct Private::ElementInfo& elementInfo = d->elementsInfo[i];
             elementInfo.category                     = lastCategory;
+            elementInfo.categoryPosition             = d->categories.size();
             elementInfo.relativeOffsetToCategory     = offset;
         }
 
+        struct Private::CategoryLayout layout;
+        layout.firstRow = k;
+        layout.count    = upperBound - k;
+        layout.top      = 0;
+
         k = upperBound;
 
+        d->categoriesPositions.insert(lastCategory, d->categories.size());
+        d->categoriesLayout << layout;
         d->categoriesIndexes.insert(lastCategory, rows);
         d->categories << lastCategory;
     }
@@ -100,6 +100,24 @@ public:
       */
     QRect visualCategoryRectInViewport(const QString& category) const;
 
+    /**
+      * Computes again the vertical offsets of the categories if the layout parameters
+      * (elements per row, item height, category height, spacing) changed since the last call
+      */
+    void updateCategoriesLayout() const;
+
+    /**
+      * Returns the position in categories of the last category starting at or above @p y,
+      * in contents coordinates. Returns 0 if @p y is above the first category.
+      * @note updateCategoriesLayout() must have been called before
+      */
+    int categoryPositionAt(int y) const;
+
+    /**
+      * Clears the categories and their layout
+      */
+    void clearCategories();
+
     /**
       * Caches and returns the rect that corresponds to @p index
       */
@@ -184,9 +202,44 @@ public:
     struct ElementInfo
     {
         QString category;
+        int     categoryPosition;
         int     relativeOffsetToCategory;
     };
 
+    struct CategoryLayout
+    {
+        int firstRow;
+        int count;
+        int top;        ///< Vertical offset of the category, relative to the first category
+    };
+
+    struct LayoutParameters
+    {
+        LayoutParameters()
+            : elementsPerRow(0),
+              itemHeight(0),
+              categoryHeight(0),
+              spacing(0),
+              gridEmpty(true)
+        {
+        }
+
+        bool operator==(const LayoutParameters& other) const
+        {
+            return (elementsPerRow == other.elementsPerRow &&
+                    itemHeight     == other.itemHeight     &&
+                    categoryHeight == other.categoryHeight &&
+                    spacing        == other.spacing        &&
+                    gridEmpty      == other.gridEmpty);
+        }
+
+        int  elementsPerRow;
+        int  itemHeight;
+        int  categoryHeight;
+        int  spacing;
+        bool gridEmpty;
+    };
+
 public:
 
     // Basic data
@@ -213,6 +266,13 @@ public:
     QHash<QString, QVector<int> >     categoriesIndexes;
     QHash<QString, QRect>             categoriesPosition;
     QStringList                       categories;
+    QHash<QString, int>               categoriesPositions;
+
+    // Prefix sums of the categories heights, in the same order as categories,
+    // computed again only when the layout parameters change
+    mutable QVector<CategoryLayout>   categoriesLayout;
+    mutable LayoutParameters          layoutParameters;
+    mutable bool                      layoutValid;
     QModelIndexList                   intersectedIndexes;
     QRect                             lastDraggedItemsRect;
     QItemSelection                    lastSelection;
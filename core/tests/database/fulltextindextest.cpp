@@ -0,0 +1,307 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-27
+ * Description : Test the full text index of the core database
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "fulltextindextest.h"
+
+// Qt includes
+
+#include <QDateTime>
+#include <QDir>
+#include <QTest>
+
+// Local includes
+
+#include "coredb.h"
+#include "coredbaccess.h"
+#include "coredbbackend.h"
+#include "coredbconstants.h"
+#include "coredbsearchxml.h"
+#include "dbengineparameters.h"
+#include "imagequerybuilder.h"
+
+using namespace Digikam;
+
+QTEST_GUILESS_MAIN(FullTextIndexTest)
+
+FullTextIndexTest::FullTextIndexTest()
+    : m_fullTextIndexVersion(0),
+      m_beach(-1),
+      m_mountain(-1),
+      m_city(-1)
+{
+}
+
+void FullTextIndexTest::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+
+    const QString dbFile = QDir(m_dir.path()).filePath(QLatin1String("digikam4.db"));
+    DbEngineParameters params(QLatin1String("QSQLITE"), dbFile, QLatin1String("QSQLITE"), dbFile);
+    CoreDbAccess::setParameters(params, CoreDbAccess::MainApplication);
+    QVERIFY(CoreDbAccess::checkReadyForUse(0));
+
+    CoreDbAccess access;
+    m_fullTextIndexVersion = access.db()->getFullTextIndexVersion();
+
+    // The album names are searched too: keep them out of the searched words.
+    const int rootId  = access.db()->addAlbumRoot(AlbumRoot::VolumeHardWired, QLatin1String("volumeid:?path=/media"),
+                                                  QLatin1String("/"), QLatin1String("Collection"));
+    const int albumId = access.db()->addAlbum(rootId, QLatin1String("/2018"), QString(), QDate(2018, 6, 1), QString());
+    QVERIFY(albumId != -1);
+
+    const QDateTime date = QDateTime::currentDateTime();
+
+    m_beach    = access.db()->addItem(albumId, QLatin1String("beach.jpg"),    DatabaseItem::Visible, DatabaseItem::Image,
+                                      date, 1000, QLatin1String("hash-beach"));
+    m_mountain = access.db()->addItem(albumId, QLatin1String("mountain.jpg"), DatabaseItem::Visible, DatabaseItem::Image,
+                                      date, 2000, QLatin1String("hash-mountain"));
+    m_city     = access.db()->addItem(albumId, QLatin1String("city.jpg"),     DatabaseItem::Visible, DatabaseItem::Image,
+                                      date, 3000, QLatin1String("hash-city"));
+
+    QVERIFY(m_beach != -1 && m_mountain != -1 && m_city != -1);
+
+    if (m_fullTextIndexVersion == 0)
+    {
+        qWarning() << "SQLite is built without FTS5: only the LIKE conditions are tested";
+    }
+}
+
+void FullTextIndexTest::cleanupTestCase()
+{
+    CoreDbAccess::cleanUpDatabase();
+}
+
+QSet<qlonglong> FullTextIndexTest::search(const QString& text, bool useIndex)
+{
+    CoreDbAccess access;
+
+    // Without a version, the full text index is not used and not updated.
+    access.db()->setFullTextIndexVersion(useIndex ? m_fullTextIndexVersion : 0);
+
+    QList<QVariant>     boundValues;
+    ImageQueryBuilder   builder;
+    ImageQueryPostHooks hooks;
+
+    QString sql = QString::fromUtf8("SELECT DISTINCT Images.id FROM Images "
+                                    " INNER JOIN Albums ON Albums.id=Images.album "
+                                    "WHERE Images.status=1 AND ( ");
+    sql        += builder.buildQuery(SearchXmlWriter::keywordSearch(text), &boundValues, &hooks);
+    sql        += QString::fromUtf8(" );");
+
+    QList<QVariant> values;
+    const bool ok = access.backend()->execSql(sql, boundValues, &values);
+
+    access.db()->setFullTextIndexVersion(m_fullTextIndexVersion);
+
+    QSet<qlonglong> ids;
+
+    if (!ok)
+    {
+        qWarning() << "Search query failed:" << sql;
+        ids << -1;
+        return ids;
+    }
+
+    foreach (const QVariant& value, values)
+    {
+        ids << value.toLongLong();
+    }
+
+    return ids;
+}
+
+void FullTextIndexTest::verifySearch(const QString& text, const QSet<qlonglong>& expected)
+{
+    QCOMPARE(search(text, false), expected);
+
+    if (m_fullTextIndexVersion > 0)
+    {
+        QCOMPARE(search(text, true), expected);
+    }
+}
+
+void FullTextIndexTest::testFullTextCondition()
+{
+    CoreDbAccess access;
+    QList<QVariant> boundValues;
+
+    if (m_fullTextIndexVersion > 0)
+    {
+        QVERIFY(!access.db()->fullTextCondition(QLatin1String("beach"), CoreDB::FullTextAll, &boundValues).isNull());
+        QCOMPARE(boundValues.size(), 1);
+    }
+
+    // The fallback: no searchable word, no field, or no index.
+
+    boundValues.clear();
+    QVERIFY(access.db()->fullTextCondition(QLatin1String("--"), CoreDB::FullTextAll, &boundValues).isNull());
+    QVERIFY(access.db()->fullTextCondition(QLatin1String("beach"), 0, &boundValues).isNull());
+    QVERIFY(boundValues.isEmpty());
+
+    access.db()->setFullTextIndexVersion(0);
+    QVERIFY(access.db()->fullTextCondition(QLatin1String("beach"), CoreDB::FullTextAll, &boundValues).isNull());
+    access.db()->setFullTextIndexVersion(m_fullTextIndexVersion);
+}
+
+void FullTextIndexTest::testNames()
+{
+    verifySearch(QLatin1String("beach"),    QSet<qlonglong>() << m_beach);
+    verifySearch(QLatin1String("mountain"), QSet<qlonglong>() << m_mountain);
+    verifySearch(QLatin1String("forest"),   QSet<qlonglong>());
+
+    {
+        CoreDbAccess access;
+        access.db()->renameItem(m_city, QLatin1String("harbour.jpg"));
+    }
+
+    verifySearch(QLatin1String("harbour"), QSet<qlonglong>() << m_city);
+    verifySearch(QLatin1String("city"),    QSet<qlonglong>());
+
+    {
+        CoreDbAccess access;
+        access.db()->renameItem(m_city, QLatin1String("city.jpg"));
+    }
+
+    verifySearch(QLatin1String("city"), QSet<qlonglong>() << m_city);
+}
+
+void FullTextIndexTest::testComments()
+{
+    int commentId = -1;
+
+    {
+        CoreDbAccess access;
+        commentId = access.db()->setImageComment(m_mountain, QLatin1String("Snow covered peaks"), DatabaseComment::Comment,
+                                                 QLatin1String("x-default"), QString(), QDateTime());
+        access.db()->setImageComment(m_city, QLatin1String("Night lights"), DatabaseComment::Title,
+                                     QLatin1String("x-default"), QString(), QDateTime());
+    }
+
+    verifySearch(QLatin1String("peaks"),  QSet<qlonglong>() << m_mountain);
+    verifySearch(QLatin1String("lights"), QSet<qlonglong>() << m_city);
+
+    {
+        CoreDbAccess access;
+        access.db()->changeImageComment(commentId, m_mountain, QVariantList() << QLatin1String("Glacier"),
+                                        DatabaseFields::Comment);
+    }
+
+    verifySearch(QLatin1String("peaks"),   QSet<qlonglong>());
+    verifySearch(QLatin1String("glacier"), QSet<qlonglong>() << m_mountain);
+
+    {
+        CoreDbAccess access;
+        access.db()->removeImageComment(commentId, m_mountain);
+    }
+
+    verifySearch(QLatin1String("glacier"), QSet<qlonglong>());
+}
+
+void FullTextIndexTest::testTags()
+{
+    int sunset = -1;
+    int golden = -1;
+
+    {
+        CoreDbAccess access;
+        sunset = access.db()->addTag(0, QLatin1String("Sunset"), QString(), 0);
+        golden = access.db()->addTag(sunset, QLatin1String("Golden"), QString(), 0);
+        QVERIFY(sunset != -1 && golden != -1);
+
+        access.db()->addItemTag(m_beach, sunset);
+    }
+
+    verifySearch(QLatin1String("sunset"), QSet<qlonglong>() << m_beach);
+
+    {
+        CoreDbAccess access;
+        access.db()->addTagsToItems(QList<qlonglong>() << m_mountain << m_city, QList<int>() << sunset);
+    }
+
+    verifySearch(QLatin1String("sunset"), QSet<qlonglong>() << m_beach << m_mountain << m_city);
+
+    {
+        CoreDbAccess access;
+        access.db()->removeItemTag(m_beach, sunset);
+    }
+
+    verifySearch(QLatin1String("sunset"), QSet<qlonglong>() << m_mountain << m_city);
+
+    {
+        CoreDbAccess access;
+        access.db()->removeTagsFromItems(QList<qlonglong>() << m_mountain, QList<int>() << sunset);
+        access.db()->addItemTag(m_beach, golden);
+    }
+
+    verifySearch(QLatin1String("sunset"), QSet<qlonglong>() << m_city);
+    verifySearch(QLatin1String("golden"), QSet<qlonglong>() << m_beach);
+
+    {
+        CoreDbAccess access;
+        access.db()->setTagName(golden, QLatin1String("Amber"));
+    }
+
+    verifySearch(QLatin1String("golden"), QSet<qlonglong>());
+    verifySearch(QLatin1String("amber"),  QSet<qlonglong>() << m_beach);
+
+    // Deleting a tag deletes its children and removes both from the items.
+
+    {
+        CoreDbAccess access;
+        access.db()->deleteTag(sunset);
+    }
+
+    verifySearch(QLatin1String("sunset"), QSet<qlonglong>());
+    verifySearch(QLatin1String("amber"),  QSet<qlonglong>());
+}
+
+void FullTextIndexTest::testStaleIndex()
+{
+    if (m_fullTextIndexVersion == 0)
+    {
+        QSKIP("No full text index");
+    }
+
+    {
+        CoreDbAccess access;
+        access.db()->storeFullTextIndexState();
+        QVERIFY(!access.db()->isFullTextIndexStale());
+
+        // Written by an application not maintaining the index.
+        QVERIFY(access.backend()->execSql(QString::fromUtf8("INSERT INTO ImageComments (imageid, type, language, comment) "
+                                                            "VALUES (?, ?, 'x-default', 'Lighthouse');"),
+                                          m_beach, (int)DatabaseComment::Comment));
+        QVERIFY(access.db()->isFullTextIndexStale());
+    }
+
+    QCOMPARE(search(QLatin1String("lighthouse"), true), QSet<qlonglong>());
+
+    {
+        CoreDbAccess access;
+        access.db()->rebuildFullTextIndex();
+        access.db()->storeFullTextIndexState();
+        QVERIFY(!access.db()->isFullTextIndexStale());
+    }
+
+    verifySearch(QLatin1String("lighthouse"), QSet<qlonglong>() << m_beach);
+}
@@ -0,0 +1,70 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-27
+ * Description : Test the full text index of the core database
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_FULL_TEXT_INDEX_TEST_H
+#define DIGIKAM_FULL_TEXT_INDEX_TEST_H
+
+// Qt includes
+
+#include <QtTest>
+#include <QSet>
+#include <QTemporaryDir>
+
+class FullTextIndexTest : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    explicit FullTextIndexTest();
+
+private Q_SLOTS:
+
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testFullTextCondition();
+    void testNames();
+    void testComments();
+    void testTags();
+    void testStaleIndex();
+
+private:
+
+    /// Ids of the items found by a keyword search, with the index or with the LIKE conditions.
+    QSet<qlonglong> search(const QString& text, bool useIndex);
+
+    /// Both searches must find exactly the expected items.
+    void verifySearch(const QString& text, const QSet<qlonglong>& expected);
+
+private:
+
+    QTemporaryDir m_dir;
+    int           m_fullTextIndexVersion;
+
+    qlonglong     m_beach;
+    qlonglong     m_mountain;
+    qlonglong     m_city;
+};
+
+#endif // DIGIKAM_FULL_TEXT_INDEX_TEST_H
@@ -0,0 +1,180 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-02
+ * Description : Test the scoring kernels of the Haar signature arena
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "haarsignaturearenatest.h"
+
+// C++ includes
+
+#include <cmath>
+
+// Qt includes
+
+#include <QTest>
+#include <QVector>
+#include <QSet>
+
+// Local includes
+
+#include "haarsignaturearena.h"
+
+using namespace Digikam;
+
+QTEST_GUILESS_MAIN(HaarSignatureArenaTest)
+
+namespace
+{
+
+/// Pseudo random signature with distinct coefficients per channel, as computed by Haar::Calculator.
+Haar::SignatureData randomSignature(uint& seed)
+{
+    Haar::SignatureData sig;
+
+    for (int channel = 0 ; channel < 3 ; ++channel)
+    {
+        seed              = seed * 1103515245 + 12345;
+        sig.avg[channel]  = (double)(seed % 10000) / 10000.0;
+        QSet<int> used;
+
+        for (int coef = 0 ; coef < Haar::NumberOfCoefficients ; ++coef)
+        {
+            int x = 0;
+
+            // Use a small range of indexes to have many coefficients in common.
+            while ((x == 0) || used.contains(x))
+            {
+                seed = seed * 1103515245 + 12345;
+                x    = (int)((seed >> 8) % 401) - 200;
+            }
+
+            used << x;
+            sig.sig[channel][coef] = x;
+        }
+    }
+
+    return sig;
+}
+
+/// The scalar score of the original implementation, with one lookup per target coefficient.
+double referenceScore(Haar::SignatureData& query, Haar::SignatureData& target,
+                      const Haar::Weights& weights, const Haar::WeightBin& bin)
+{
+    double score = 0.0;
+
+    for (int channel = 0 ; channel < 3 ; ++channel)
+    {
+        score += weights.weightForAverage(channel) * fabs(query.avg[channel] - target.avg[channel]);
+    }
+
+    Haar::SignatureMap queryMap;
+
+    for (int channel = 0 ; channel < 3 ; ++channel)
+    {
+        queryMap.fill(query.sig[channel]);
+
+        for (int coef = 0 ; coef < Haar::NumberOfCoefficients ; ++coef)
+        {
+            int x = target.sig[channel][coef];
+
+            if (queryMap[x])
+            {
+                score -= weights.weight(bin.binAbs(x), channel);
+            }
+        }
+    }
+
+    return score;
+}
+
+} // namespace
+
+void HaarSignatureArenaTest::testArenaAccessors()
+{
+    Haar::SignatureArena arena;
+    uint seed = 42;
+    QVector<Haar::SignatureData> sigs;
+
+    for (int i = 0 ; i < 11 ; ++i)
+    {
+        sigs << randomSignature(seed);
+        QCOMPARE(arena.append(100 + i, i % 3, 1, sigs.last()), i);
+    }
+
+    QCOMPARE(arena.count(), 11);
+    QCOMPARE(arena.position(105), 5);
+    QCOMPARE(arena.position(1), -1);
+    QCOMPARE(arena.imageId(7), 107LL);
+    QCOMPARE(arena.albumId(7), 1);
+
+    Haar::SignatureData sig;
+    arena.signature(9, &sig);
+    QVERIFY(memcmp(&sig, &sigs[9], sizeof(Haar::SignatureData)) == 0);
+
+    arena.clear();
+    QVERIFY(arena.isEmpty());
+}
+
+void HaarSignatureArenaTest::testKernels()
+{
+    Haar::WeightBin      bin;
+    Haar::Weights        weights(Haar::Weights::ScannedSketch);
+    Haar::SignatureArena arena;
+    Haar::ScoreTable     table;
+    uint                 seed  = 1;
+    const int            count = 1003;   // not a multiple of the lanes
+    QVector<Haar::SignatureData> sigs;
+
+    for (int i = 0 ; i < count ; ++i)
+    {
+        sigs << randomSignature(seed);
+        arena.append(i + 1, 1, 1, sigs.last());
+    }
+
+    Haar::SignatureArena::Kernel best = Haar::SignatureArena::kernel();
+    QVector<double> scores(count);
+
+    for (int query = 0 ; query < count ; query += 97)
+    {
+        table.fill(sigs[query], weights, bin);
+
+        for (int kernel = Haar::SignatureArena::GenericKernel ;
+             kernel <= Haar::SignatureArena::bestSupportedKernel() ; ++kernel)
+        {
+            Haar::SignatureArena::setKernel((Haar::SignatureArena::Kernel)kernel);
+
+            // Use unaligned ranges to check partial blocks.
+            arena.scores(table, scores.data(), 3, count);
+            arena.scores(table, scores.data(), 0, 3);
+
+            for (int i = 0 ; i < count ; ++i)
+            {
+                double reference = referenceScore(sigs[query], sigs[i], weights, bin);
+
+                // All kernels must be bit-identical to the scalar implementation.
+                QVERIFY2(scores[i] == reference, qPrintable(QString::fromLatin1("kernel %1, position %2").arg(kernel).arg(i)));
+                QVERIFY(arena.score(table, i) == reference);
+            }
+        }
+    }
+
+    Haar::SignatureArena::setKernel(best);
+}
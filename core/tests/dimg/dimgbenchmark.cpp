@@ -0,0 +1,533 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-26
+ * Description : a benchmark for DImg loaders and core operations
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "dimgbenchmark.h"
+
+// Qt includes
+
+#include <QAtomicInt>
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QTest>
+#include <QThread>
+
+// System includes
+
+#if defined(Q_OS_WIN)
+#   include <windows.h>
+#   include <psapi.h>
+#elif defined(Q_OS_OSX)
+#   include <mach/mach.h>
+#else
+#   include <unistd.h>
+#endif
+
+// Local includes
+
+#include "dimg.h"
+#include "metaengine.h"
+#include "iccprofile.h"
+#include "icctransform.h"
+#include "digikam_version.h"
+
+using namespace Digikam;
+
+QTEST_GUILESS_MAIN(DImgBenchmark)
+
+DImgBenchmark::DImgBenchmark()
+    : m_baseRss(0),
+      m_maxRss(0),
+      m_sampler(0)
+{
+}
+
+DImgBenchmark::~DImgBenchmark()
+{
+    stopMemory();
+}
+
+static const uint corpusWidth  = 3000;
+static const uint corpusHeight = 2000;
+
+/// A gradient with deterministic pseudo-random noise, compressing like a photograph rather than like pure noise.
+static DImg syntheticImage(bool sixteenBit)
+{
+    DImg img(corpusWidth, corpusHeight, sixteenBit, false);
+    quint32 seed = sixteenBit ? 16 : 8;
+
+    for (uint y = 0 ; y < corpusHeight ; ++y)
+    {
+        for (uint x = 0 ; x < corpusWidth ; ++x)
+        {
+            seed        = seed * 1103515245 + 12345;
+            const int n = (int)((seed >> 16) % 17) - 8;
+            const int r = qBound(0, (int)(x * 255 / corpusWidth)  + n, 255);
+            const int g = qBound(0, (int)(y * 255 / corpusHeight) + n, 255);
+            const int b = qBound(0, (int)((x + y) * 255 / (corpusWidth + corpusHeight)) - n, 255);
+
+            if (sixteenBit)
+            {
+                img.setPixelColor(x, y, DColor(r * 257, g * 257, b * 257, 65535, true));
+            }
+            else
+            {
+                img.setPixelColor(x, y, DColor(r, g, b, 255, false));
+            }
+        }
+    }
+
+    return img;
+}
+
+/// Current resident set size of this process in bytes, or 0 if not available.
+static qint64 currentRss()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return (qint64)counters.WorkingSetSize;
+    }
+
+    return 0;
+#elif defined(Q_OS_OSX)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t      count = MACH_TASK_BASIC_INFO_COUNT;
+
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS)
+    {
+        return 0;
+    }
+
+    return (qint64)info.resident_size;
+#else
+    // The second field of statm is the number of resident pages.
+    QFile statm(QLatin1String("/proc/self/statm"));
+
+    if (!statm.open(QIODevice::ReadOnly))
+    {
+        return 0;
+    }
+
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+
+    if (fields.size() < 2)
+    {
+        return 0;
+    }
+
+    return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+#endif
+}
+
+#if defined(Q_OS_LINUX)
+
+/// Resets the peak resident set size of this process to the current one. Needs Linux 4.0 or later.
+static bool resetPeakRss()
+{
+    QFile clearRefs(QLatin1String("/proc/self/clear_refs"));
+
+    if (!clearRefs.open(QIODevice::WriteOnly | QIODevice::Unbuffered))
+    {
+        return false;
+    }
+
+    return (clearRefs.write("5") == 1);
+}
+
+/// Peak resident set size of this process in bytes since the last reset, or 0 if not available.
+static qint64 peakRss()
+{
+    QFile status(QLatin1String("/proc/self/status"));
+
+    if (!status.open(QIODevice::ReadOnly))
+    {
+        return 0;
+    }
+
+    foreach (const QByteArray& line, status.readAll().split('\n'))
+    {
+        // "VmHWM:     123456 kB"
+
+        if (line.startsWith("VmHWM:"))
+        {
+            return line.mid(6).simplified().split(' ').first().toLongLong() * 1024;
+        }
+    }
+
+    return 0;
+}
+
+#endif
+
+/**
+ * Samples the resident memory of the process every millisecond while an operation runs,
+ * where the system cannot report its peak.
+ */
+class MemorySampler : public QThread
+{
+public:
+
+    explicit MemorySampler()
+        : m_maxRss(currentRss())
+    {
+    }
+
+    /// Stops the sampling and returns the highest resident memory seen.
+    qint64 stop()
+    {
+        m_stop.storeRelease(1);
+        wait();
+
+        return qMax(m_maxRss, currentRss());
+    }
+
+protected:
+
+    void run() Q_DECL_OVERRIDE
+    {
+        while (!m_stop.loadAcquire())
+        {
+            m_maxRss = qMax(m_maxRss, currentRss());
+            QThread::msleep(1);
+        }
+    }
+
+private:
+
+    QAtomicInt m_stop;
+    qint64     m_maxRss;
+};
+
+// ----------------------------------------------------------------------------------
+
+void DImgBenchmark::initTestCase()
+{
+    MetaEngine::initializeExiv2();
+    IccTransform::init();
+
+    QVERIFY(m_corpus.isValid());
+
+    const DImg img8  = syntheticImage(false);
+    const DImg img16 = syntheticImage(true);
+
+    QVERIFY(DImg(img8).save(m_corpus.filePath(QLatin1String("corpus.jpg")),    QLatin1String("JPG")));
+    QVERIFY(DImg(img8).save(m_corpus.filePath(QLatin1String("corpus.png")),    QLatin1String("PNG")));
+    QVERIFY(DImg(img16).save(m_corpus.filePath(QLatin1String("corpus16.png")), QLatin1String("PNG")));
+    QVERIFY(DImg(img8).save(m_corpus.filePath(QLatin1String("corpus.tif")),    QLatin1String("TIFF")));
+    QVERIFY(DImg(img16).save(m_corpus.filePath(QLatin1String("corpus16.tif")), QLatin1String("TIFF")));
+    QVERIFY(DImg(img8).save(m_corpus.filePath(QLatin1String("corpus.pgf")),    QLatin1String("PGF")));
+}
+
+void DImgBenchmark::cleanupTestCase()
+{
+    QString path = QString::fromLocal8Bit(qgetenv("DIGIKAM_BENCHMARK_JSON"));
+
+    if (path.isEmpty())
+    {
+        path = QLatin1String("dimgbenchmark.json");
+    }
+
+    QJsonObject report;
+    report.insert(QLatin1String("digiKamVersion"), digiKamVersion());
+    report.insert(QLatin1String("gitVersion"),     QLatin1String(GITVERSION));
+    report.insert(QLatin1String("date"),           QDateTime::currentDateTime().toString(Qt::ISODate));
+    report.insert(QLatin1String("cpu"),            QSysInfo::currentCpuArchitecture());
+    report.insert(QLatin1String("threads"),        QThread::idealThreadCount());
+    report.insert(QLatin1String("results"),        m_results);
+
+    QFile file(path);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning() << "Cannot write benchmark report to" << path;
+    }
+    else
+    {
+        file.write(QJsonDocument(report).toJson());
+        qDebug() << "Benchmark report written to" << QFileInfo(file).absoluteFilePath();
+    }
+
+    MetaEngine::cleanupExiv2();
+}
+
+void DImgBenchmark::record(const QString& operation, qint64 pixels, int runs, qint64 nsecs)
+{
+    stopMemory();
+
+    if (runs <= 0 || nsecs <= 0)
+    {
+        return;
+    }
+
+    const double mpix    = pixels / 1000000.0;
+    const double msecs   = nsecs  / 1000000.0 / runs;
+    const double mpixSec = mpix * 1000.0 / msecs;
+    const qint64 rss     = qMax(Q_INT64_C(0), m_maxRss - m_baseRss);
+    const QString tag    = QString::fromLatin1(QTest::currentDataTag());
+
+    qDebug() << operation << tag << ":" << mpixSec << "MPix/s," << msecs << "ms/run, RSS increase"
+             << rss / (1024 * 1024) << "MiB";
+
+    QJsonObject result;
+    result.insert(QLatin1String("operation"),        operation);
+    result.insert(QLatin1String("variant"),          tag);
+    result.insert(QLatin1String("megapixels"),       mpix);
+    result.insert(QLatin1String("runs"),             runs);
+    result.insert(QLatin1String("msecsPerRun"),      msecs);
+    result.insert(QLatin1String("mpixPerSecond"),    mpixSec);
+    result.insert(QLatin1String("rssIncreaseBytes"), (double)rss);
+
+    m_results.append(result);
+}
+
+void DImgBenchmark::startMemory()
+{
+    // A failed verification skips record() and leaves the previous sampler running.
+
+    stopMemory();
+
+    m_baseRss = currentRss();
+    m_maxRss  = m_baseRss;
+
+#if defined(Q_OS_LINUX)
+    if (resetPeakRss() && (peakRss() > 0))
+    {
+        return;
+    }
+#endif
+
+    // No resettable high water mark: sample the memory while the operation runs.
+
+    m_sampler = new MemorySampler;
+    m_sampler->start();
+}
+
+void DImgBenchmark::stopMemory()
+{
+    if (m_sampler)
+    {
+        m_maxRss = qMax(m_maxRss, m_sampler->stop());
+        delete m_sampler;
+        m_sampler = 0;
+    }
+#if defined(Q_OS_LINUX)
+    else
+    {
+        m_maxRss = qMax(m_maxRss, peakRss());
+    }
+#endif
+}
+
+void DImgBenchmark::addDepthRows()
+{
+    QTest::addColumn<bool>("sixteenBit");
+
+    QTest::newRow("8 bits")  << false;
+    QTest::newRow("16 bits") << true;
+}
+
+// ----------------------------------------------------------------------------------
+
+void DImgBenchmark::benchmarkLoad_data()
+{
+    QTest::addColumn<QString>("filePath");
+
+    QTest::newRow("JPEG")         << m_corpus.filePath(QLatin1String("corpus.jpg"));
+    QTest::newRow("PNG 8 bits")   << m_corpus.filePath(QLatin1String("corpus.png"));
+    QTest::newRow("PNG 16 bits")  << m_corpus.filePath(QLatin1String("corpus16.png"));
+    QTest::newRow("TIFF 8 bits")  << m_corpus.filePath(QLatin1String("corpus.tif"));
+    QTest::newRow("TIFF 16 bits") << m_corpus.filePath(QLatin1String("corpus16.tif"));
+    QTest::newRow("PGF")          << m_corpus.filePath(QLatin1String("corpus.pgf"));
+    QTest::newRow("RAW")          << QString::fromLocal8Bit(qgetenv("DIGIKAM_BENCHMARK_RAW"));
+}
+
+void DImgBenchmark::benchmarkLoad()
+{
+    QFETCH(QString, filePath);
+
+    if (filePath.isEmpty())
+    {
+        QSKIP("Set DIGIKAM_BENCHMARK_RAW to a RAW file to measure the RAW loader");
+    }
+
+    QElapsedTimer timer;
+    qint64 nsecs  = 0;
+    qint64 pixels = 0;
+    int    runs   = 0;
+
+    startMemory();
+
+    QBENCHMARK
+    {
+        DImg img;
+        timer.start();
+        QVERIFY(img.load(filePath));
+        nsecs  += timer.nsecsElapsed();
+        pixels  = (qint64)img.width() * img.height();
+        ++runs;
+    }
+
+    record(QLatin1String("load"), pixels, runs, nsecs);
+}
+
+// ----------------------------------------------------------------------------------
+
+void DImgBenchmark::benchmarkSmoothScale_data()
+{
+    addDepthRows();
+}
+
+void DImgBenchmark::benchmarkSmoothScale()
+{
+    QFETCH(bool, sixteenBit);
+
+    const DImg img = syntheticImage(sixteenBit);
+    QElapsedTimer timer;
+    qint64 nsecs   = 0;
+    int    runs    = 0;
+
+    startMemory();
+
+    QBENCHMARK
+    {
+        timer.start();
+        DImg scaled = img.smoothScale(img.width() / 3, img.height() / 3);
+        nsecs      += timer.nsecsElapsed();
+        ++runs;
+        QVERIFY(!scaled.isNull());
+    }
+
+    record(QLatin1String("smoothScale"), (qint64)img.width() * img.height(), runs, nsecs);
+}
+
+// ----------------------------------------------------------------------------------
+
+void DImgBenchmark::benchmarkConvertDepth_data()
+{
+    addDepthRows();
+}
+
+void DImgBenchmark::benchmarkConvertDepth()
+{
+    QFETCH(bool, sixteenBit);
+
+    const DImg img  = syntheticImage(sixteenBit);
+    const int depth = sixteenBit ? 32 : 64;
+    QElapsedTimer timer;
+    qint64 nsecs    = 0;
+    int    runs     = 0;
+
+    startMemory();
+
+    QBENCHMARK
+    {
+        DImg copy = img.copy();
+        timer.start();
+        copy.convertDepth(depth);
+        nsecs    += timer.nsecsElapsed();
+        ++runs;
+    }
+
+    record(QLatin1String("convertDepth"), (qint64)img.width() * img.height(), runs, nsecs);
+}
+
+// ----------------------------------------------------------------------------------
+
+void DImgBenchmark::benchmarkRotate_data()
+{
+    addDepthRows();
+}
+
+void DImgBenchmark::benchmarkRotate()
+{
+    QFETCH(bool, sixteenBit);
+
+    const DImg img = syntheticImage(sixteenBit);
+    QElapsedTimer timer;
+    qint64 nsecs   = 0;
+    int    runs    = 0;
+
+    startMemory();
+
+    QBENCHMARK
+    {
+        DImg copy = img.copy();
+        timer.start();
+        copy.rotate(DImg::ROT90);
+        nsecs    += timer.nsecsElapsed();
+        ++runs;
+    }
+
+    record(QLatin1String("rotate"), (qint64)img.width() * img.height(), runs, nsecs);
+}
+
+// ----------------------------------------------------------------------------------
+
+void DImgBenchmark::benchmarkIccTransform_data()
+{
+    addDepthRows();
+}
+
+void DImgBenchmark::benchmarkIccTransform()
+{
+    QFETCH(bool, sixteenBit);
+
+    IccProfile input  = IccProfile::sRGB();
+    IccProfile output = IccProfile::proPhotoRGB();
+
+    if (!input.open() || !output.open())
+    {
+        QSKIP("Installed sRGB and ProPhoto RGB color profiles are required");
+    }
+
+    const DImg img = syntheticImage(sixteenBit);
+    QElapsedTimer timer;
+    qint64 nsecs   = 0;
+    int    runs    = 0;
+
+    IccTransform transform;
+    transform.setInputProfile(input);
+    transform.setOutputProfile(output);
+    transform.setDoNotEmbedOutputProfile(true);
+
+    startMemory();
+
+    QBENCHMARK
+    {
+        DImg copy = img.copy();
+        timer.start();
+        QVERIFY(transform.apply(copy));
+        nsecs    += timer.nsecsElapsed();
+        ++runs;
+    }
+
+    record(QLatin1String("iccTransform"), (qint64)img.width() * img.height(), runs, nsecs);
+}
@@ -0,0 +1,91 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-26
+ * Description : a benchmark for DImg loaders and core operations
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_DIMG_BENCHMARK_H
+#define DIGIKAM_DIMG_BENCHMARK_H
+
+// Qt includes
+
+#include <QObject>
+#include <QJsonArray>
+#include <QString>
+#include <QTemporaryDir>
+
+class MemorySampler;
+
+/**
+ * Measures DImg loaders and core operations on a synthetic image corpus written
+ * at start in a temporary directory. Each result is reported as MPix/s with the
+ * peak increase of the resident memory of the process while the operation runs,
+ * its result and working copies included, and written as JSON at end to compare
+ * releases. Environment variables:
+ *
+ * DIGIKAM_BENCHMARK_JSON : path of the JSON report (default: dimgbenchmark.json).
+ * DIGIKAM_BENCHMARK_RAW  : path of a RAW file to measure the RAW loader, skipped if unset.
+ */
+class DImgBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    explicit DImgBenchmark();
+    ~DImgBenchmark();
+
+private Q_SLOTS:
+
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmarkLoad();
+    void benchmarkLoad_data();
+    void benchmarkSmoothScale();
+    void benchmarkSmoothScale_data();
+    void benchmarkConvertDepth();
+    void benchmarkConvertDepth_data();
+    void benchmarkRotate();
+    void benchmarkRotate_data();
+    void benchmarkIccTransform();
+    void benchmarkIccTransform_data();
+
+private:
+
+    void addDepthRows();
+    void record(const QString& operation, qint64 pixels, int runs, qint64 nsecs);
+
+    /** Resident memory at the start of an operation, and peak one while it runs. On Linux the
+     *  peak is read from the kernel high water mark, elsewhere it is sampled from a helper thread.
+     */
+    void startMemory();
+    void stopMemory();
+
+private:
+
+    QTemporaryDir  m_corpus;
+    QJsonArray     m_results;
+    qint64         m_baseRss;
+    qint64         m_maxRss;
+    MemorySampler* m_sampler;
+};
+
+#endif // DIGIKAM_DIMG_BENCHMARK_H
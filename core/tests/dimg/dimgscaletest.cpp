@@ -0,0 +1,131 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-18
+ * Description : a test for the anti-aliased scaling kernels of DImg
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "dimgscaletest.h"
+
+// Qt includes
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QTest>
+
+// Local includes
+
+#include "dimg.h"
+#include "dimgscale.h"
+
+using namespace Digikam;
+
+QTEST_GUILESS_MAIN(DImgScaleTest)
+
+/// An image with deterministic pseudo-random pixels, including saturated values.
+static DImg randomImage(uint width, uint height, bool sixteenBit, bool alpha)
+{
+    DImg img(width, height, sixteenBit, alpha);
+    uchar* const bits = img.bits();
+    quint32 seed      = width * 7919 + height * 31 + (sixteenBit ? 2 : 0) + (alpha ? 1 : 0);
+
+    for (uint i = 0 ; i < img.numBytes() ; ++i)
+    {
+        seed    = seed * 1103515245 + 12345;
+        bits[i] = ((seed >> 16) % 11 == 0) ? 0xFF : (uchar)(seed >> 16);
+    }
+
+    return img;
+}
+
+static QByteArray imageBytes(const DImg& img)
+{
+    return QByteArray(reinterpret_cast<const char*>(img.bits()), img.numBytes());
+}
+
+void DImgScaleTest::testKernels_data()
+{
+    QTest::addColumn<bool>("sixteenBit");
+    QTest::addColumn<bool>("alpha");
+
+    QTest::newRow("8 bits RGB")   << false << false;
+    QTest::newRow("8 bits RGBA")  << false << true;
+    QTest::newRow("16 bits RGB")  << true  << false;
+    QTest::newRow("16 bits RGBA") << true  << true;
+}
+
+void DImgScaleTest::testKernels()
+{
+    QFETCH(bool, sixteenBit);
+    QFETCH(bool, alpha);
+
+    const DImg img               = randomImage(301, 207, sixteenBit, alpha);
+    const DImgScale::Kernel best = DImgScale::kernel();
+
+    // Scaling down and up in both directions, up in one direction only,
+    // large enough to be scaled by bands, clipped and on a section.
+
+    DImgScale::setKernel(DImgScale::GenericKernel);
+    QCOMPARE(DImgScale::kernel(), DImgScale::GenericKernel);
+
+    QList<QByteArray> references;
+    references << imageBytes(img.smoothScale(97, 61));
+    references << imageBytes(img.smoothScale(823, 611));
+    references << imageBytes(img.smoothScale(640, 53));
+    references << imageBytes(img.smoothScale(45, 480));
+    references << imageBytes(img.smoothScaleClipped(900, 700, 113, 71, 600, 500));
+    references << imageBytes(img.smoothScaleSection(37, 29, 150, 100, 350, 290));
+
+    for (int kernel = DImgScale::GenericKernel ;
+         kernel <= DImgScale::bestSupportedKernel() ; ++kernel)
+    {
+        DImgScale::setKernel((DImgScale::Kernel)kernel);
+        QCOMPARE((int)DImgScale::kernel(), kernel);
+
+        QList<QByteArray> results;
+        results << imageBytes(img.smoothScale(97, 61));
+        results << imageBytes(img.smoothScale(823, 611));
+        results << imageBytes(img.smoothScale(640, 53));
+        results << imageBytes(img.smoothScale(45, 480));
+        results << imageBytes(img.smoothScaleClipped(900, 700, 113, 71, 600, 500));
+        results << imageBytes(img.smoothScaleSection(37, 29, 150, 100, 350, 290));
+
+        for (int i = 0 ; i < references.size() ; ++i)
+        {
+            QVERIFY2(results.at(i) == references.at(i),
+                     qPrintable(QString::fromLatin1("kernel %1, scaling %2").arg(kernel).arg(i)));
+        }
+    }
+
+    DImgScale::setKernel(best);
+}
+
+void DImgScaleTest::testClipped()
+{
+    const DImg img     = randomImage(257, 193, false, true);
+    DImg scaled        = img.smoothScale(700, 520);
+    const DImg clipped = img.smoothScaleClipped(700, 520, 40, 300, 610, 220);
+
+    scaled.crop(40, 300, 610, 220);
+
+    QCOMPARE(clipped.width(),  scaled.width());
+    QCOMPARE(clipped.height(), scaled.height());
+    QVERIFY(imageBytes(clipped) == imageBytes(scaled));
+}
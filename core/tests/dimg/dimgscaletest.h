@@ -0,0 +1,42 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-18
+ * Description : a test for the anti-aliased scaling kernels of DImg
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_DIMG_SCALE_TEST_H
+#define DIGIKAM_DIMG_SCALE_TEST_H
+
+// Qt includes
+
+#include <QObject>
+
+class DImgScaleTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+
+    void testKernels();
+    void testKernels_data();
+    void testClipped();
+};
+
+#endif // DIGIKAM_DIMG_SCALE_TEST_H
@@ -0,0 +1,176 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-27
+ * Description : Test the tiled undo cache of the image editor
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "undocachetest.h"
+
+// Qt includes
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QTest>
+
+// Local includes
+
+#include "dimg.h"
+#include "undocache.h"
+
+using namespace Digikam;
+
+QTEST_MAIN(UndoCacheTest)
+
+/// An image with deterministic pseudo-random pixels, spanning partial tiles on the right and bottom.
+static DImg randomImage(uint width, uint height, bool sixteenBit, bool alpha)
+{
+    DImg img(width, height, sixteenBit, alpha);
+    uchar* const bits = img.bits();
+    quint32 seed      = width * 7919 + height * 31 + (sixteenBit ? 2 : 0) + (alpha ? 1 : 0);
+
+    for (uint i = 0 ; i < img.numBytes() ; ++i)
+    {
+        seed    = seed * 1103515245 + 12345;
+        bits[i] = (uchar)(seed >> 16);
+    }
+
+    return img;
+}
+
+static QByteArray imageBytes(const DImg& img)
+{
+    return QByteArray(reinterpret_cast<const char*>(img.bits()), img.numBytes());
+}
+
+static void compareImages(const DImg& result, const DImg& expected)
+{
+    QVERIFY(!result.isNull());
+    QCOMPARE(result.width(),      expected.width());
+    QCOMPARE(result.height(),     expected.height());
+    QCOMPARE(result.sixteenBit(), expected.sixteenBit());
+    QCOMPARE(result.hasAlpha(),   expected.hasAlpha());
+    QVERIFY(imageBytes(result) == imageBytes(expected));
+}
+
+/// Changes one byte of the pixel, which touches a single tile.
+static DImg modifiedImage(const DImg& img, uint x, uint y)
+{
+    DImg copy = img.copy();
+    copy.bits()[((quint64)y * copy.width() + x) * copy.bytesDepth()] ^= 0x5A;
+
+    return copy;
+}
+
+void UndoCacheTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QDir().mkpath(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+}
+
+void UndoCacheTest::testPutGet()
+{
+    UndoCache cache;
+    DImg img8  = randomImage(700, 300, false, false);
+    DImg img16 = randomImage(300, 520, true,  true);
+
+    QVERIFY(cache.putData(1, img8));
+    QVERIFY(cache.putData(2, img16));
+
+    // A level is stored only once.
+    QVERIFY(!cache.putData(2, img8));
+
+    compareImages(cache.getData(1), img8);
+    compareImages(cache.getData(2), img16);
+    QVERIFY(cache.getData(3).isNull());
+}
+
+void UndoCacheTest::testSharedTiles()
+{
+    UndoCache cache;
+    DImg level1 = randomImage(600, 600, false, true);
+    DImg level2 = modifiedImage(level1, 300, 300);
+    DImg level3 = modifiedImage(level2, 599, 599);
+
+    QVERIFY(cache.putData(1, level1));
+    QVERIFY(cache.putData(2, level2));
+    QVERIFY(cache.putData(3, level3));
+
+    // The unchanged tiles are shared, the changed ones belong to their own level.
+    compareImages(cache.getData(1), level1);
+    compareImages(cache.getData(2), level2);
+    compareImages(cache.getData(3), level3);
+}
+
+void UndoCacheTest::testClearFrom()
+{
+    UndoCache cache;
+    DImg level1 = randomImage(400, 400, false, false);
+    DImg level2 = modifiedImage(level1, 10, 10);
+    DImg level3 = modifiedImage(level1, 390, 390);
+
+    QVERIFY(cache.putData(1, level1));
+    QVERIFY(cache.putData(2, level2));
+
+    cache.clearFrom(2);
+    QVERIFY(cache.getData(2).isNull());
+
+    // The level can be stored again after a redo branch was dropped.
+    QVERIFY(cache.putData(2, level3));
+    compareImages(cache.getData(1), level1);
+    compareImages(cache.getData(2), level3);
+}
+
+void UndoCacheTest::testSpillAndReload()
+{
+    const QString cacheFile = QString::fromUtf8("%1/undocache-%2.bin")
+                              .arg(QStandardPaths::writableLocation(QStandardPaths::CacheLocation))
+                              .arg(QCoreApplication::applicationPid());
+
+    UndoCache cache;
+    DImg level1 = randomImage(800, 600, true, false);
+    DImg level2 = modifiedImage(level1, 100, 500);
+
+    QVERIFY(cache.putData(1, level1));
+    QVERIFY(cache.putData(2, level2));
+
+    // Move all compressed tiles to the cache file.
+    cache.setMemoryBudget(0);
+
+    if (!QFileInfo(cacheFile).exists())
+    {
+        QSKIP("Not enough free disk space to use the undo cache file");
+    }
+
+    QVERIFY(QFileInfo(cacheFile).size() > 0);
+
+    compareImages(cache.getData(1), level1);
+    compareImages(cache.getData(2), level2);
+
+    // New levels compare their unchanged tiles with the tiles in the file.
+    DImg level3 = modifiedImage(level2, 700, 50);
+    QVERIFY(cache.putData(3, level3));
+    compareImages(cache.getData(3), level3);
+
+    cache.clear();
+    QVERIFY(!QFileInfo(cacheFile).exists());
+}
@@ -0,0 +1,45 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-27
+ * Description : Test the tiled undo cache of the image editor
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_UNDO_CACHE_TEST_H
+#define DIGIKAM_UNDO_CACHE_TEST_H
+
+// Qt includes
+
+#include <QObject>
+
+class UndoCacheTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+
+    void initTestCase();
+
+    void testPutGet();
+    void testSharedTiles();
+    void testClearFrom();
+    void testSpillAndReload();
+};
+
+#endif // DIGIKAM_UNDO_CACHE_TEST_H
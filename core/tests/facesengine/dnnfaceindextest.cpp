@@ -0,0 +1,302 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-27
+ * Description : Test the nearest neighbors index of DNN face vectors
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "dnnfaceindextest.h"
+
+// C++ includes
+
+#include <cfloat>
+#include <vector>
+
+// Qt includes
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+// Local includes
+
+#include "dnnfaceindex.h"
+
+using namespace Digikam;
+
+QTEST_GUILESS_MAIN(DNNFaceIndexTest)
+
+namespace
+{
+
+/// Deterministic pseudo random numbers in [-1, 1], the same on all platforms.
+class RandomSource
+{
+public:
+
+    explicit RandomSource(quint32 seed)
+        : m_state(seed)
+    {
+    }
+
+    float next()
+    {
+        m_state = m_state * 1664525U + 1013904223U;
+
+        return (float)(m_state >> 8) / (float)(1U << 23) - 1.0F;
+    }
+
+private:
+
+    quint32 m_state;
+};
+
+std::vector<float> randomVector(RandomSource& random)
+{
+    std::vector<float> vec(DNNFaceIndex::Dimension);
+
+    for (int i = 0 ; i < DNNFaceIndex::Dimension ; i++)
+    {
+        vec[i] = random.next();
+    }
+
+    return vec;
+}
+
+/// A face vector close to the center, as another face of the same person.
+std::vector<float> nearVector(const std::vector<float>& center, RandomSource& random, float spread)
+{
+    std::vector<float> vec(center);
+
+    for (int i = 0 ; i < DNNFaceIndex::Dimension ; i++)
+    {
+        vec[i] += spread * random.next();
+    }
+
+    return vec;
+}
+
+/// A vector at the given distance of the origin.
+std::vector<float> vectorAt(float distance)
+{
+    std::vector<float> vec(DNNFaceIndex::Dimension, 0.0F);
+    vec[0] = distance;
+
+    return vec;
+}
+
+} // namespace
+
+void DNNFaceIndexTest::testAddRemove()
+{
+    DNNFaceIndex index;
+    RandomSource random(1);
+
+    index.add(10, 1, randomVector(random));
+    index.add(11, 2, randomVector(random));
+    index.add(-1, 3, randomVector(random));
+
+    QCOMPARE(index.count(), 3);
+    QVERIFY(index.contains(10));
+    QCOMPARE(index.label(11), 2);
+
+    // An internal id is allocated to negative ids.
+    QCOMPARE(index.ids().size(), 3);
+
+    // Adding an id again replaces its vector.
+    index.add(10, 4, randomVector(random));
+    QCOMPARE(index.count(), 3);
+    QCOMPARE(index.label(10), 4);
+
+    index.remove(10);
+    QVERIFY(!index.contains(10));
+    QCOMPARE(index.label(10), -1);
+    QCOMPARE(index.count(), 2);
+    QCOMPARE((int)index.vectors().size(), 2);
+    QCOMPARE((int)index.labels().size(), 2);
+
+    // Vectors of another size are not indexed.
+    index.add(12, 5, std::vector<float>(64, 0.0F));
+    QVERIFY(!index.contains(12));
+
+    index.clear();
+    QCOMPARE(index.count(), 0);
+}
+
+void DNNFaceIndexTest::testPredict()
+{
+    DNNFaceIndex index;
+    int          label = 0;
+    double       dist  = 0.0;
+
+    index.predict(vectorAt(0.0F), 1, DBL_MAX, label, dist);
+    QCOMPARE(label, -1);
+    QCOMPARE(dist,  DBL_MAX);
+
+    index.add(1, 100, vectorAt(1.0F));
+    index.add(2, 200, vectorAt(3.0F));
+
+    index.predict(vectorAt(1.5F), 1, DBL_MAX, label, dist);
+    QCOMPARE(label, 100);
+    QVERIFY(qAbs(dist - 0.5) < 1e-5);
+
+    index.predict(vectorAt(2.9F), 1, DBL_MAX, label, dist);
+    QCOMPARE(label, 200);
+
+    // No known face is closer than the maximum distance.
+    index.predict(vectorAt(-1.0F), 1, 1.5, label, dist);
+    QCOMPARE(label, -1);
+    QCOMPARE(dist,  DBL_MAX);
+}
+
+void DNNFaceIndexTest::testNeighborsVote()
+{
+    DNNFaceIndex index;
+    int          label = 0;
+    double       dist  = 0.0;
+
+    // One face of person 1 is the nearest, but person 2 has more faces around.
+    index.add(1, 1, vectorAt(1.0F));
+    index.add(2, 2, vectorAt(1.3F));
+    index.add(3, 2, vectorAt(1.35F));
+    index.add(4, 2, vectorAt(1.4F));
+
+    index.predict(vectorAt(1.1F), 1, DBL_MAX, label, dist);
+    QCOMPARE(label, 1);
+
+    index.predict(vectorAt(1.1F), 4, DBL_MAX, label, dist);
+    QCOMPARE(label, 2);
+
+    // The distance is the one of the nearest face of the chosen person.
+    QVERIFY(qAbs(dist - 0.2) < 1e-5);
+}
+
+void DNNFaceIndexTest::testPartitionedPredict()
+{
+    DNNFaceIndex index;
+    RandomSource random(2);
+
+    const int persons        = 64;
+    const int facesPerPerson = (int)DNNFaceIndex::MinTrainingCount / persons + 1;
+
+    std::vector<std::vector<float> > centers;
+
+    for (int p = 0 ; p < persons ; p++)
+    {
+        centers.push_back(randomVector(random));
+    }
+
+    for (int f = 0 ; f < facesPerPerson ; f++)
+    {
+        for (int p = 0 ; p < persons ; p++)
+        {
+            index.add(f * persons + p, p, nearVector(centers[p], random, 0.05F));
+        }
+    }
+
+    QVERIFY(index.count() >= DNNFaceIndex::MinTrainingCount);
+
+    // The search only scans some of the lists, it still finds the person of each face.
+
+    for (int p = 0 ; p < persons ; p++)
+    {
+        int    label = -1;
+        double dist  = 0.0;
+
+        index.predict(nearVector(centers[p], random, 0.05F), 1, DBL_MAX, label, dist);
+        QCOMPARE(label, p);
+    }
+}
+
+void DNNFaceIndexTest::testSaveLoad()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QString filePath = dir.path() + QLatin1String("/faces.dnnindex");
+
+    DNNFaceIndex index;
+    RandomSource random(3);
+
+    const int count = (int)DNNFaceIndex::MinTrainingCount + 100;
+
+    for (int id = 0 ; id < count ; id++)
+    {
+        index.add(id, id % 50, randomVector(random));
+    }
+
+    // Internal ids are not related to the database and are not saved.
+    index.add(-1, 7, randomVector(random));
+
+    QVERIFY(index.save(filePath));
+
+    DNNFaceIndex loaded;
+    QVERIFY(loaded.load(filePath));
+
+    QCOMPARE(loaded.count(), count);
+    QVERIFY(!loaded.contains(-1));
+
+    for (int id = 0 ; id < count ; id += 97)
+    {
+        QCOMPARE(loaded.label(id), id % 50);
+    }
+
+    // The loaded index finds the same neighbors.
+
+    index.remove(-1);
+
+    for (int i = 0 ; i < 20 ; i++)
+    {
+        const std::vector<float> query = randomVector(random);
+        int    label1 = -1;
+        int    label2 = -1;
+        double dist1  = 0.0;
+        double dist2  = 0.0;
+
+        index.predict(query, 3, DBL_MAX, label1, dist1);
+        loaded.predict(query, 3, DBL_MAX, label2, dist2);
+
+        QCOMPARE(label2, label1);
+        QCOMPARE(dist2,  dist1);
+    }
+}
+
+void DNNFaceIndexTest::testLoadCorrupted()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QString filePath = dir.path() + QLatin1String("/faces.dnnindex");
+
+    DNNFaceIndex index;
+    RandomSource random(4);
+    index.add(1, 1, randomVector(random));
+    QVERIFY(index.save(filePath));
+
+    // Truncate the file.
+    QFile file(filePath);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.resize(file.size() / 2));
+    file.close();
+
+    QVERIFY(!index.load(filePath));
+    QCOMPARE(index.count(), 0);
+
+    QVERIFY(!index.load(dir.path() + QLatin1String("/missing.dnnindex")));
+}
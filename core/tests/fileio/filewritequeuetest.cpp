@@ -0,0 +1,128 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-27
+ * Description : Test the merging of the metadata write-behind queue
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "filewritequeuetest.h"
+
+// Qt includes
+
+#include <QTest>
+
+// Local includes
+
+#include "filewritequeue.h"
+#include "metadatahub.h"
+
+using namespace Digikam;
+
+QTEST_GUILESS_MAIN(FileWriteQueueTest)
+
+void FileWriteQueueTest::testMergeFlags()
+{
+    FileWriteQueue queue(FileWriteQueue::MergeFlags);
+
+    QVERIFY(!queue.enqueue(1, ImageInfo(), MetadataHub::WRITE_TAGS,   0));
+    QVERIFY(!queue.enqueue(2, ImageInfo(), MetadataHub::WRITE_RATING, 0));
+    QVERIFY(queue.enqueue(1,  ImageInfo(), MetadataHub::WRITE_RATING, 0));
+    QCOMPARE(queue.count(), 2);
+
+    int flags = 0;
+    QVERIFY(queue.take(1, &flags));
+    QCOMPARE(flags, (int)(MetadataHub::WRITE_TAGS | MetadataHub::WRITE_RATING));
+
+    QVERIFY(queue.take(2, &flags));
+    QCOMPARE(flags, (int)MetadataHub::WRITE_RATING);
+
+    QVERIFY(!queue.take(1, &flags));
+    QCOMPARE(queue.count(), 0);
+}
+
+void FileWriteQueueTest::testMergeScheduled()
+{
+    FileWriteQueue queue(FileWriteQueue::MergeFlags);
+
+    queue.enqueue(1, ImageInfo(), MetadataHub::WRITE_TAGS, 0);
+    queue.enqueue(2, ImageInfo(), MetadataHub::WRITE_TAGS, 0);
+
+    QCOMPARE(queue.schedule().size(), 2);
+    QCOMPARE(queue.scheduledCount(),  2);
+
+    // A scheduled image not yet taken by a file worker is still merged.
+    QVERIFY(queue.enqueue(1, ImageInfo(), MetadataHub::WRITE_COLORLABEL, 0));
+    QVERIFY(queue.schedule().isEmpty());
+    QCOMPARE(queue.count(), 2);
+
+    int flags = 0;
+    QVERIFY(queue.take(1, &flags));
+    QCOMPARE(flags, (int)(MetadataHub::WRITE_TAGS | MetadataHub::WRITE_COLORLABEL));
+    QCOMPARE(queue.scheduledCount(), 1);
+}
+
+void FileWriteQueueTest::testQueueAfterTake()
+{
+    FileWriteQueue queue(FileWriteQueue::MergeFlags);
+
+    queue.enqueue(1, ImageInfo(), MetadataHub::WRITE_TAGS, 0);
+    queue.schedule();
+
+    int flags = 0;
+    QVERIFY(queue.take(1, &flags));
+
+    // The file is being written: a new change needs a new write.
+    QVERIFY(!queue.enqueue(1, ImageInfo(), MetadataHub::WRITE_PICKLABEL, 0));
+
+    QList<PendingFileWrite> writes = queue.schedule();
+    QCOMPARE(writes.size(), 1);
+    QCOMPARE(writes.first().value, (int)MetadataHub::WRITE_PICKLABEL);
+
+    QVERIFY(queue.take(1, &flags));
+    QCOMPARE(flags, (int)MetadataHub::WRITE_PICKLABEL);
+    QCOMPARE(queue.scheduledCount(), 0);
+}
+
+void FileWriteQueueTest::testReplaceValue()
+{
+    FileWriteQueue queue(FileWriteQueue::ReplaceValue);
+
+    QVERIFY(!queue.enqueue(1, ImageInfo(), 6, 0));
+    queue.schedule();
+    QVERIFY(queue.enqueue(1,  ImageInfo(), 8, 0));
+
+    int orientation = 0;
+    QVERIFY(queue.take(1, &orientation));
+    QCOMPARE(orientation, 8);
+}
+
+void FileWriteQueueTest::testClear()
+{
+    FileWriteQueue queue(FileWriteQueue::MergeFlags);
+
+    queue.enqueue(1, ImageInfo(), MetadataHub::WRITE_TAGS, 0);
+    queue.enqueue(2, ImageInfo(), MetadataHub::WRITE_TAGS, 0);
+    queue.schedule();
+    queue.clear();
+
+    int flags = 0;
+    QVERIFY(!queue.take(1, &flags));
+    QCOMPARE(queue.count(),          0);
+    QCOMPARE(queue.scheduledCount(), 0);
+}
@@ -0,0 +1,353 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-27
+ * Description : Test the memory-mapped thumbnail pack storage
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "thumbnailpacktest.h"
+
+// Qt includes
+
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QTest>
+#include <QVariant>
+
+// Local includes
+
+#include "dbengineparameters.h"
+#include "thumbnailpack.h"
+#include "thumbsdb.h"
+#include "thumbsdbaccess.h"
+
+using namespace Digikam;
+
+QTEST_GUILESS_MAIN(ThumbnailPackTest)
+
+namespace
+{
+
+/// Size of the file header of the pack and index files, which is the offset of the first record.
+const qint64 fileHeaderSize = 16;
+
+/// Hash of a key as stored in the index, see ThumbnailPack::Private::keyHash().
+quint64 keyHash(const QString& key)
+{
+    const QByteArray utf8 = key.toUtf8();
+    quint64 hash          = Q_UINT64_C(14695981039346656037);
+
+    for (int i = 0 ; i < utf8.size() ; ++i)
+    {
+        hash ^= (uchar)utf8.at(i);
+        hash *= Q_UINT64_C(1099511628211);
+    }
+
+    return hash;
+}
+
+ThumbnailInfo thumbnailInfo(const QString& filePath, const QString& uniqueHash = QString(), qlonglong fileSize = 0)
+{
+    ThumbnailInfo info;
+    info.filePath         = filePath;
+    info.uniqueHash       = uniqueHash;
+    info.fileSize         = fileSize;
+    info.modificationDate = QDateTime::fromMSecsSinceEpoch(Q_INT64_C(1529000000000));
+
+    return info;
+}
+
+QImage tile(int width, int height, QRgb color)
+{
+    QImage image(width, height, QImage::Format_RGB32);
+    image.fill(color);
+
+    return image;
+}
+
+} // namespace
+
+QString ThumbnailPackTest::indexPath() const
+{
+    return QDir(m_dir->path()).filePath(QLatin1String("thumbnails-digikam.idx"));
+}
+
+void ThumbnailPackTest::init()
+{
+    m_dir = new QTemporaryDir;
+
+    QVERIFY(m_dir->isValid());
+    QVERIFY(ThumbnailPack::instance()->open(m_dir->path()));
+    QVERIFY(ThumbnailPack::instance()->isEmpty());
+}
+
+void ThumbnailPackTest::cleanup()
+{
+    ThumbnailPack::instance()->close();
+    delete m_dir;
+    m_dir = 0;
+}
+
+void ThumbnailPackTest::testInsertFindRemove()
+{
+    ThumbnailPack* const pack = ThumbnailPack::instance();
+    const ThumbnailInfo info  = thumbnailInfo(QLatin1String("/photos/a.jpg"), QLatin1String("hash-a"), 1000);
+
+    QVERIFY(pack->insert(info, tile(64, 48, qRgb(200, 10, 10)), 6));
+    QCOMPARE(pack->count(), 2);
+
+    ThumbnailPackInfo packInfo;
+    QVERIFY(pack->find(info, &packInfo));
+    QCOMPARE(packInfo.image.size(),       QSize(64, 48));
+    QCOMPARE(packInfo.image.pixel(5, 5),  qRgb(200, 10, 10));
+    QCOMPARE(packInfo.orientationHint,    6);
+    QCOMPARE(packInfo.modificationDate,   info.modificationDate);
+
+    // Found by file path only, and by content after a move.
+
+    QVERIFY(pack->find(thumbnailInfo(info.filePath), &packInfo, false));
+    QVERIFY(pack->find(thumbnailInfo(QLatin1String("/moved/a.jpg"), info.uniqueHash, info.fileSize), &packInfo));
+    QVERIFY(!pack->find(thumbnailInfo(QLatin1String("/photos/b.jpg")), &packInfo));
+    QVERIFY(pack->filePaths().contains(info.filePath));
+
+    // Replacing keeps the last thumbnail.
+
+    QVERIFY(pack->insert(info, tile(32, 24, qRgb(10, 200, 10)), 1));
+    QVERIFY(pack->find(info, &packInfo));
+    QCOMPARE(packInfo.image.size(),      QSize(32, 24));
+    QCOMPARE(packInfo.image.pixel(5, 5), qRgb(10, 200, 10));
+
+    // The index is persistent.
+
+    pack->close();
+    QVERIFY(pack->open(m_dir->path()));
+    QVERIFY(pack->find(info, &packInfo));
+    QCOMPARE(packInfo.image.size(), QSize(32, 24));
+
+    pack->remove(info);
+    QVERIFY(!pack->find(info, &packInfo));
+    QVERIFY(!pack->find(thumbnailInfo(info.filePath), &packInfo));
+    QVERIFY(pack->isEmpty());
+
+    pack->close();
+    QVERIFY(pack->open(m_dir->path()));
+    QVERIFY(pack->isEmpty());
+}
+
+void ThumbnailPackTest::testKeyCollision()
+{
+    ThumbnailPack* const pack = ThumbnailPack::instance();
+    const ThumbnailInfo a     = thumbnailInfo(QLatin1String("/photos/a.jpg"));
+    const ThumbnailInfo b     = thumbnailInfo(QLatin1String("/photos/b.jpg"));
+
+    QVERIFY(pack->insert(a, tile(64, 48, qRgb(200, 10, 10)), 0));
+    pack->close();
+
+    // Map the hash of the key of b to the record of a, as a hash collision does.
+
+    QFile indexFile(indexPath());
+    QVERIFY(indexFile.open(QIODevice::Append));
+
+    const quint64 entry[2] = { keyHash(QLatin1String("p:") + b.filePath), (quint64)fileHeaderSize };
+    QCOMPARE(indexFile.write((const char*)entry, sizeof(entry)), (qint64)sizeof(entry));
+    indexFile.close();
+
+    QVERIFY(pack->open(m_dir->path()));
+    QCOMPARE(pack->count(), 2);
+
+    ThumbnailPackInfo packInfo;
+    QVERIFY(pack->find(a, &packInfo));
+    QVERIFY(!pack->find(b, &packInfo));
+    QVERIFY(!pack->filePaths().contains(b.filePath));
+}
+
+void ThumbnailPackTest::testTruncatedIndex()
+{
+    ThumbnailPack* const pack = ThumbnailPack::instance();
+    const ThumbnailInfo a     = thumbnailInfo(QLatin1String("/photos/a.jpg"), QLatin1String("hash-a"), 1000);
+    const ThumbnailInfo b     = thumbnailInfo(QLatin1String("/photos/b.jpg"), QLatin1String("hash-b"), 2000);
+
+    QVERIFY(pack->insert(a, tile(64, 48, qRgb(200, 10, 10)), 0));
+    QVERIFY(pack->insert(b, tile(64, 48, qRgb(10, 10, 200)), 0));
+    pack->close();
+
+    // A crash while the last index entry, the file path of b, was written.
+
+    QFile indexFile(indexPath());
+    const qint64 size = indexFile.size();
+    QVERIFY(indexFile.resize(size - 5));
+
+    QVERIFY(pack->open(m_dir->path()));
+    QCOMPARE(QFileInfo(indexPath()).size(), size - 16);
+    QCOMPARE(pack->count(), 3);
+
+    ThumbnailPackInfo packInfo;
+    QVERIFY(pack->find(a, &packInfo));
+    QVERIFY(pack->find(thumbnailInfo(a.filePath), &packInfo));
+    QVERIFY(pack->find(b, &packInfo));
+    QCOMPARE(packInfo.image.pixel(5, 5), qRgb(10, 10, 200));
+    QVERIFY(!pack->find(thumbnailInfo(b.filePath), &packInfo));
+
+    // Appending after the recovery keeps the index consistent.
+
+    QVERIFY(pack->insert(b, tile(32, 24, qRgb(10, 10, 200)), 0));
+    pack->close();
+    QVERIFY(pack->open(m_dir->path()));
+    QVERIFY(pack->find(thumbnailInfo(b.filePath), &packInfo));
+    QCOMPARE(packInfo.image.size(), QSize(32, 24));
+}
+
+void ThumbnailPackTest::testLostIndex()
+{
+    ThumbnailPack* const pack = ThumbnailPack::instance();
+    const ThumbnailInfo a     = thumbnailInfo(QLatin1String("/photos/a.jpg"), QLatin1String("hash-a"), 1000);
+    const ThumbnailInfo b     = thumbnailInfo(QLatin1String("/photos/b.jpg"), QLatin1String("hash-b"), 2000);
+
+    QVERIFY(pack->insert(a, tile(64, 48, qRgb(200, 10, 10)), 0));
+    QVERIFY(pack->insert(b, tile(64, 48, qRgb(10, 10, 200)), 0));
+    QVERIFY(pack->insert(a, tile(32, 24, qRgb(10, 200, 10)), 0));
+    pack->close();
+
+    // Only the header of the index is left: it is rebuilt from the records.
+
+    QFile indexFile(indexPath());
+    QVERIFY(indexFile.resize(fileHeaderSize));
+
+    QVERIFY(pack->open(m_dir->path()));
+    QCOMPARE(pack->count(), 4);
+
+    ThumbnailPackInfo packInfo;
+    QVERIFY(pack->find(thumbnailInfo(a.filePath), &packInfo));
+    QCOMPARE(packInfo.image.size(), QSize(32, 24));
+    QVERIFY(pack->find(b, &packInfo));
+    QCOMPARE(packInfo.image.pixel(5, 5), qRgb(10, 10, 200));
+}
+
+void ThumbnailPackTest::testCompact()
+{
+    ThumbnailPack* const pack = ThumbnailPack::instance();
+    const ThumbnailInfo a     = thumbnailInfo(QLatin1String("/photos/a.jpg"), QLatin1String("hash-a"), 1000);
+    const ThumbnailInfo b     = thumbnailInfo(QLatin1String("/photos/b.jpg"), QLatin1String("hash-b"), 2000);
+    const ThumbnailInfo c     = thumbnailInfo(QLatin1String("/photos/c.jpg"), QLatin1String("hash-c"), 3000);
+
+    QVERIFY(pack->insert(a, tile(64, 48, qRgb(200, 10, 10)), 0));
+    QVERIFY(pack->insert(b, tile(64, 48, qRgb(10, 10, 200)), 0));
+    QVERIFY(pack->insert(a, tile(32, 24, qRgb(10, 200, 10)), 3));
+    QVERIFY(pack->insert(c, tile(64, 48, qRgb(50, 50, 50)), 0));
+    pack->remove(b);
+
+    QVERIFY(pack->wastedSize() > 0);
+    const qint64 size = pack->size();
+
+    QVERIFY(pack->compact());
+    QCOMPARE(pack->wastedSize(), (qint64)0);
+    QVERIFY(pack->size() < size);
+    QCOMPARE(pack->count(), 4);
+
+    ThumbnailPackInfo packInfo;
+    QVERIFY(pack->find(a, &packInfo));
+    QCOMPARE(packInfo.image.size(),      QSize(32, 24));
+    QCOMPARE(packInfo.image.pixel(5, 5), qRgb(10, 200, 10));
+    QCOMPARE(packInfo.orientationHint,   3);
+    QVERIFY(pack->find(thumbnailInfo(c.filePath), &packInfo));
+    QCOMPARE(packInfo.image.pixel(5, 5), qRgb(50, 50, 50));
+    QVERIFY(!pack->find(b, &packInfo));
+    QVERIFY(!pack->find(thumbnailInfo(b.filePath), &packInfo));
+
+    // The compacted files are the live files.
+
+    pack->close();
+    QVERIFY(pack->open(m_dir->path()));
+    QCOMPARE(pack->count(), 4);
+    QCOMPARE(pack->wastedSize(), (qint64)0);
+    QVERIFY(pack->find(a, &packInfo));
+    QCOMPARE(packInfo.image.size(), QSize(32, 24));
+    QVERIFY(!pack->find(b, &packInfo));
+    QCOMPARE(QDir(m_dir->path()).entryList(QDir::Files).count(), 2);
+}
+
+void ThumbnailPackTest::testMigrateFromThumbsDb()
+{
+    DbEngineParameters params;
+    params.databaseType = DbEngineParameters::SQLiteDatabaseType();
+    params.setCoreDatabasePath(QDir(m_dir->path()).filePath(QLatin1String("digikam-core-test.db")));
+    params.setThumbsDatabasePath(QDir(m_dir->path()).filePath(QLatin1String("digikam-thumbs-test.db")));
+    params.legacyAndDefaultChecks();
+
+    ThumbsDbAccess::setParameters(params.thumbnailParameters());
+    QVERIFY(ThumbsDbAccess::checkReadyForUse(0));
+
+    ThumbnailPack* const pack    = ThumbnailPack::instance();
+    const ThumbnailInfo migrated = thumbnailInfo(QLatin1String("/photos/a.jpg"), QLatin1String("hash-a"), 1000);
+    const ThumbnailInfo kept     = thumbnailInfo(QLatin1String("/photos/kept.jpg"));
+    ThumbnailInfo detail         = thumbnailInfo(QString());
+    detail.customIdentifier      = QLatin1String("detail:///photos/a.jpg?rect=1,2,3,4");
+
+    // A thumbnail already stored in the pack is newer than the one of the database.
+
+    QVERIFY(pack->insert(kept, tile(16, 16, qRgb(1, 2, 3)), 0));
+
+    {
+        ThumbsDbAccess access;
+
+        QByteArray png;
+        QBuffer buffer(&png);
+        QVERIFY(tile(64, 48, qRgb(200, 10, 10)).save(&buffer, "PNG"));
+
+        ThumbsDbInfo dbInfo;
+        dbInfo.type             = DatabaseThumbnail::PNG;
+        dbInfo.modificationDate = migrated.modificationDate;
+        dbInfo.orientationHint  = 8;
+        dbInfo.data             = png;
+
+        QVariant id;
+        QVERIFY(access.db()->insertThumbnail(dbInfo, &id));
+        QVERIFY(access.db()->insertUniqueHash(migrated.uniqueHash, migrated.fileSize, id.toInt()));
+        QVERIFY(access.db()->insertFilePath(migrated.filePath, id.toInt()));
+
+        QVERIFY(access.db()->insertThumbnail(dbInfo, &id));
+        QVERIFY(access.db()->insertCustomIdentifier(detail.customIdentifier, id.toInt()));
+
+        QVERIFY(access.db()->insertThumbnail(dbInfo, &id));
+        QVERIFY(access.db()->insertFilePath(kept.filePath, id.toInt()));
+    }
+
+    QCOMPARE(pack->migrateFromThumbsDb(), 2);
+
+    ThumbnailPackInfo packInfo;
+    QVERIFY(pack->find(migrated, &packInfo));
+    QCOMPARE(packInfo.image.size(),      QSize(64, 48));
+    QCOMPARE(packInfo.image.pixel(5, 5), qRgb(200, 10, 10));
+    QCOMPARE(packInfo.orientationHint,   8);
+    QCOMPARE(packInfo.modificationDate,  migrated.modificationDate);
+    QVERIFY(pack->find(thumbnailInfo(migrated.filePath), &packInfo));
+    QVERIFY(pack->find(detail, &packInfo));
+    QVERIFY(pack->find(kept, &packInfo));
+    QCOMPARE(packInfo.image.size(), QSize(16, 16));
+
+    // A resumed migration copies nothing twice.
+
+    QCOMPARE(pack->migrateFromThumbsDb(), 0);
+    QCOMPARE(pack->count(), 4);
+
+    ThumbsDbAccess::cleanUpDatabase();
+}
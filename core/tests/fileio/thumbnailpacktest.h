@@ -0,0 +1,57 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-27
+ * Description : Test the memory-mapped thumbnail pack storage
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_THUMBNAIL_PACK_TEST_H
+#define DIGIKAM_THUMBNAIL_PACK_TEST_H
+
+// Qt includes
+
+#include <QtTest>
+#include <QTemporaryDir>
+
+class ThumbnailPackTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+
+    void init();
+    void cleanup();
+
+    void testInsertFindRemove();
+    void testKeyCollision();
+    void testTruncatedIndex();
+    void testLostIndex();
+    void testCompact();
+    void testMigrateFromThumbsDb();
+
+private:
+
+    QString indexPath() const;
+
+private:
+
+    QTemporaryDir* m_dir;
+};
+
+#endif // DIGIKAM_THUMBNAIL_PACK_TEST_H
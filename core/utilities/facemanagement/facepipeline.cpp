@@ -238,12 +238,65 @@ void ParallelPipes::process(FacePipelineExtendedPackage::Ptr package)
 
 ScanStateFilter::ScanStateFilter(FacePipeline::FilterMode mode, FacePipeline::Private* const d)
     : d(d),
-      mode(mode)
+      mode(mode),
+      detectorIdentifier(FaceDetector().cacheIdentifier())
 {
     connect(this, SIGNAL(infosToDispatch()),
             this, SLOT(dispatch()));
 }
 
+void ScanStateFilter::setAccuracy(double accuracy)
+{
+    FaceDetector detector;
+    detector.setParameters(DetectionWorker::detectionParameters(accuracy));
+
+    QMutexLocker lock(threadMutex());
+    detectorIdentifier = detector.cacheIdentifier();
+}
+
+void ScanStateFilter::readCachedDetection(FacePipelineExtendedPackage::Ptr package)
+{
+    if ((!d->detectionWorker && !d->parallelDetectors) || d->detectionBenchmarker)
+    {
+        return;
+    }
+
+    QString identifier;
+    {
+        QMutexLocker lock(threadMutex());
+        identifier = detectorIdentifier;
+    }
+
+    const QString uniqueHash = package->info.uniqueHash();
+    QList<QRectF> faces;
+    QSize         originalSize;
+
+    if (!database.cachedDetection(uniqueHash, identifier, &faces, &originalSize))
+    {
+        return;
+    }
+
+    package->detectedFaces  = faces;
+    package->originalSize   = originalSize;
+    package->processFlags  |= FacePipelinePackage::ProcessedByDetector;
+
+    if (d->recognitionWorker)
+    {
+        QList<QRect> regions;
+
+        foreach (const QRectF& face, faces)
+        {
+            regions << TagRegion::relativeToAbsolute(face, originalSize);
+        }
+
+        package->previewNeeded = !d->recognitionWorker->hasCachedFaceVectors(uniqueHash, regions);
+    }
+    else
+    {
+        package->previewNeeded = false;
+    }
+}
+
 FacePipelineExtendedPackage::Ptr ScanStateFilter::filter(const ImageInfo& info)
 {
     FaceUtils utils;
@@ -252,14 +305,20 @@ FacePipelineExtendedPackage::Ptr ScanStateFilter::filter(const ImageInfo& info)
     {
         case FacePipeline::ScanAll:
         {
-            return d->buildPackage(info);
+            FacePipelineExtendedPackage::Ptr package = d->buildPackage(info);
+            readCachedDetection(package);
+
+            return package;
         }
 
         case FacePipeline::SkipAlreadyScanned:
         {
             if (!utils.hasBeenScanned(info))
             {
-                return d->buildPackage(info);
+                FacePipelineExtendedPackage::Ptr package = d->buildPackage(info);
+                readCachedDetection(package);
+
+                return package;
             }
 
             break;
@@ -423,7 +482,7 @@ void PreviewLoader::cancel()
 
 void PreviewLoader::process(FacePipelineExtendedPackage::Ptr package)
 {
-    if (!package->image.isNull())
+    if (!package->image.isNull() || !package->previewNeeded)
     {
         emit processed(package);
         return;
@@ -489,8 +548,19 @@ DetectionWorker::DetectionWorker(FacePipeline::Private* const d)
 
 void DetectionWorker::process(FacePipelineExtendedPackage::Ptr package)
 {
+    if (package->processFlags & FacePipelinePackage::ProcessedByDetector)
+    {
+        // Faces read from the detection cache by the database filter.
+        emit processed(package);
+        return;
+    }
+
     QImage detectionImage  = scaleForDetection(package->image);
     package->detectedFaces = detector.detectFaces(detectionImage, package->image.originalSize());
+    package->originalSize  = package->image.originalSize();
+
+    database.cacheDetection(package->info.uniqueHash(), detector.cacheIdentifier(),
+                            package->detectedFaces, package->originalSize);
 
     qCDebug(DIGIKAM_GENERAL_LOG) << "Found" << package->detectedFaces.size() << "faces in"
                                  << package->info.name() << package->image.size()
@@ -513,12 +583,18 @@ QImage DetectionWorker::scaleForDetection(const DImg& image) const
     return image.copyQImage();
 }
 
-void DetectionWorker::setAccuracy(double accuracy)
+QVariantMap DetectionWorker::detectionParameters(double accuracy)
 {
     QVariantMap params;
     params[QLatin1String("accuracy")]    = accuracy;
     params[QLatin1String("specificity")] = 0.8; //TODO: add UI for sensitivity - specificity
-    detector.setParameters(params);
+
+    return params;
+}
+
+void DetectionWorker::setAccuracy(double accuracy)
+{
+    detector.setParameters(detectionParameters(accuracy));
 }
 
 // ----------------------------------------------------------------------------------------
@@ -594,22 +670,49 @@ void RecognitionWorker::activeFaceRecognizer(RecognitionDatabase::RecognizeAlgor
     database.activeFaceRecognizer(algorithmType);
 }
 
+bool RecognitionWorker::hasCachedFaceVectors(const QString& uniqueHash, const QList<QRect>& regions) const
+{
+    return database.hasCachedFaceVectors(uniqueHash, regions);
+}
+
 void RecognitionWorker::process(FacePipelineExtendedPackage::Ptr package)
 {
     FaceUtils     utils;
     QList<QImage> images;
+    QList<QRect>  regions;
+    QString       uniqueHash = package->info.uniqueHash();
+
+    // Images of the faces are only needed to compute the face vectors missing from the cache.
 
     if (package->processFlags & FacePipelinePackage::ProcessedByDetector)
     {
-        // assume we have an image
-        images = imageRetriever.getDetails(package->image, package->detectedFaces);
+        foreach (const QRectF& face, package->detectedFaces)
+        {
+            regions << TagRegion::relativeToAbsolute(face, package->originalSize);
+        }
+
+        if (!database.hasCachedFaceVectors(uniqueHash, regions))
+        {
+            // assume we have an image
+            images = imageRetriever.getDetails(package->image, package->detectedFaces);
+        }
     }
     else if (!package->databaseFaces.isEmpty())
     {
-        images = imageRetriever.getThumbnails(package->filePath, package->databaseFaces.toFaceTagsIfaceList());
+        QList<FaceTagsIface> faces = package->databaseFaces.toFaceTagsIfaceList();
+
+        foreach (const FaceTagsIface& face, faces)
+        {
+            regions << face.region().toRect();
+        }
+
+        if (!database.hasCachedFaceVectors(uniqueHash, regions))
+        {
+            images = imageRetriever.getThumbnails(package->filePath, faces);
+        }
     }
 
-    package->recognitionResults  = database.recognizeFaces(images);
+    package->recognitionResults  = database.recognizeFaces(uniqueHash, regions, images);
     package->processFlags       |= FacePipelinePackage::ProcessedByRecognizer;
 
     emit processed(package);
@@ -658,7 +761,7 @@ void DatabaseWriter::process(FacePipelineExtendedPackage::Ptr package)
             package->databaseFaces = utils.writeUnconfirmedResults(package->info.id(),
                                                                    package->detectedFaces,
                                                                    package->recognitionResults,
-                                                                   package->image.originalSize());
+                                                                   package->originalSize);
             package->databaseFaces.setRole(FacePipelineFaceTagsIface::DetectedFromImage);
 
             if (!package->image.isNull())
@@ -1453,6 +1556,9 @@ QString FacePipeline::benchmarkResult() const
 void FacePipeline::plugDatabaseFilter(FilterMode mode)
 {
     d->databaseFilter = new ScanStateFilter(mode, d);
+
+    connect(d, SIGNAL(accuracyChanged(double)),
+            d->databaseFilter, SLOT(setAccuracy(double)));
 }
 
 void FacePipeline::plugRerecognizingDatabaseFilter()
@@ -32,6 +32,7 @@
 #include <QMetaMethod>
 #include <QMutex>
 #include <QSharedData>
+#include <QSize>
 #include <QWaitCondition>
 
 // Local includes
@@ -48,10 +49,19 @@ namespace Digikam
 class Q_DECL_HIDDEN FacePipelineExtendedPackage : public FacePipelinePackage,
                                                   public QSharedData
 {
+public:
+
+    FacePipelineExtendedPackage()
+        : previewNeeded(true)
+    {
+    }
+
 public:
 
     QString                                                           filePath;
     DImg                                                              detectionImage; // image scaled to about 0.5 Mpx
+    QSize                                                             originalSize;   // full size of the detected image
+    bool                                                              previewNeeded;  // false if all results are cached
     typedef QExplicitlySharedDataPointer<FacePipelineExtendedPackage> Ptr;
 
 public:
@@ -126,12 +136,22 @@ public:
 
     FacePipelineExtendedPackage::Ptr filter(const ImageInfo& info);
 
+    /**
+     * Use the faces detected before in an unchanged file, with the same detector parameters.
+     * The preview is not loaded if the face vectors are cached too.
+     */
+    void readCachedDetection(FacePipelineExtendedPackage::Ptr package);
+
 public:
 
     FacePipeline::Private* const     d;
     FacePipeline::FilterMode         mode;
     FacePipelineFaceTagsIface::Roles tasks;
 
+public Q_SLOTS:
+
+    void setAccuracy(double accuracy);
+
 protected Q_SLOTS:
 
     void dispatch();
@@ -149,6 +169,9 @@ protected:
     QList<ImageInfo>                        toFilter;
     QList<FacePipelineExtendedPackage::Ptr> toSend;
     QList<ImageInfo>                        toBeSkipped;
+
+    RecognitionDatabase                     database;
+    QString                                 detectorIdentifier;
 };
 
 // ----------------------------------------------------------------------------------------
@@ -197,6 +220,8 @@ public:
 
     QImage scaleForDetection(const DImg& image) const;
 
+    static QVariantMap detectionParameters(double accuracy);
+
 public Q_SLOTS:
 
     void process(FacePipelineExtendedPackage::Ptr package);
@@ -209,6 +234,7 @@ Q_SIGNALS:
 protected:
 
     FaceDetector                 detector;
+    RecognitionDatabase          database;
     FacePipeline::Private* const d;
 };
 
@@ -254,6 +280,12 @@ public:
      */
     void activeFaceRecognizer(RecognitionDatabase::RecognizeAlgorithm  algorithmType);
 
+    /**
+     * Returns true if the face vectors of all regions are cached, the faces can then be recognized without image.
+     * This method is thread-safe.
+     */
+    bool hasCachedFaceVectors(const QString& uniqueHash, const QList<QRect>& regions) const;
+
 public Q_SLOTS:
 
     void process(FacePipelineExtendedPackage::Ptr package);
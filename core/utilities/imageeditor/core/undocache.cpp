@@ -25,6 +25,10 @@
 
 #include "undocache.h"
 
+// C++ includes
+
+#include <cstring>
+
 // Qt includes
 
 #include <QApplication>
@@ -32,10 +36,17 @@
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QFuture>
+#include <QMap>
+#include <QSet>
+#include <QSharedPointer>
 #include <QStringList>
 #include <QStandardPaths>
 #include <QStorageInfo>
 #include <QMessageBox>
+#include <QThread>
+#include <QVector>
+#include <QtConcurrent>    // krazy:exclude=includes
 
 // KDE includes
 
@@ -48,27 +59,382 @@
 namespace Digikam
 {
 
+namespace
+{
+
+enum
+{
+    TileSize         = 256,     // Width and height of a tile in pixels
+    CompressionLevel = 1        // Fastest zlib compression
+};
+
+/** One compressed tile of an image. A tile which did not change between levels
+ *  is shared by these levels.
+ */
+class UndoCacheTile
+{
+public:
+
+    UndoCacheTile()
+        : hash(0),
+          offset(-1),
+          size(0),
+          lastLevel(0)
+    {
+    }
+
+    quint64    hash;
+    QByteArray data;        // Compressed data, empty if the tile was moved to the cache file
+    qint64     offset;      // Position in the cache file, or -1
+    int        size;        // Size of the compressed data
+    int        lastLevel;   // Most recent level using this tile
+};
+
+typedef QSharedPointer<UndoCacheTile> UndoCacheTilePtr;
+
+/** The tiles of one level, in rows from top to bottom.
+ */
+class UndoCacheLevel
+{
+public:
+
+    UndoCacheLevel()
+        : width(0),
+          height(0),
+          bytesDepth(0),
+          sixteenBit(false),
+          hasAlpha(false)
+    {
+    }
+
+    int tilesX() const
+    {
+        return (width + TileSize - 1) / TileSize;
+    }
+
+    int tilesY() const
+    {
+        return (height + TileSize - 1) / TileSize;
+    }
+
+    bool sameFormat(const DImg& img) const
+    {
+        return (width      == img.width()      &&
+                height     == img.height()     &&
+                sixteenBit == img.sixteenBit() &&
+                hasAlpha   == img.hasAlpha());
+    }
+
+    /// The area of the tile in pixels.
+    void tileRect(int tile, uint& x, uint& y, uint& w, uint& h) const
+    {
+        x = (tile % tilesX()) * TileSize;
+        y = (tile / tilesX()) * TileSize;
+        w = qMin((uint)TileSize, width  - x);
+        h = qMin((uint)TileSize, height - y);
+    }
+
+public:
+
+    uint                      width;
+    uint                      height;
+    int                       bytesDepth;
+    bool                      sixteenBit;
+    bool                      hasAlpha;
+
+    QVector<UndoCacheTilePtr> tiles;
+};
+
+/** 64 bits hash of the pixels of a tile, to find the tiles which did not change.
+ */
+quint64 tileHash(const uchar* const bits, uint imageWidth, int bytesDepth, uint x, uint y, uint w, uint h)
+{
+    const quint64 prime1 = Q_UINT64_C(0x87c37b91114253d5);
+    const quint64 prime2 = Q_UINT64_C(0x4cf5ad432745937f);
+    const int rowBytes   = w * bytesDepth;
+    quint64 hash         = Q_UINT64_C(0x9e3779b97f4a7c15) ^ ((quint64)w << 32) ^ h;
+
+    for (uint row = 0 ; row < h ; ++row)
+    {
+        const uchar* p = bits + ((quint64)(y + row) * imageWidth + x) * bytesDepth;
+        int n          = rowBytes;
+
+        while (n > 0)
+        {
+            quint64 v = 0;
+            memcpy(&v, p, qMin(n, 8));
+            hash     ^= v * prime1;
+            hash      = ((hash << 31) | (hash >> 33)) * prime2;
+            p        += 8;
+            n        -= 8;
+        }
+    }
+
+    hash ^= hash >> 33;
+    hash *= prime1;
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+/** Data shared by the threads storing or restoring the tiles of one level.
+ */
+class UndoCacheJob
+{
+public:
+
+    const UndoCacheLevel*    level;
+    uchar*                   bits;
+    QVector<quint64>         hashes;
+    QVector<bool>            changed;
+    QVector<QByteArray>      data;
+};
+
+void hashTiles(UndoCacheJob* const job, int start, int end)
+{
+    for (int t = start ; t < end ; ++t)
+    {
+        uint x, y, w, h;
+        job->level->tileRect(t, x, y, w, h);
+        job->hashes[t] = tileHash(job->bits, job->level->width, job->level->bytesDepth, x, y, w, h);
+    }
+}
+
+/// The pixels of the tile, row after row.
+QByteArray tilePixels(const UndoCacheJob* const job, int t)
+{
+    uint x, y, w, h;
+    job->level->tileRect(t, x, y, w, h);
+
+    const int rowBytes = w * job->level->bytesDepth;
+    QByteArray raw(rowBytes * h, Qt::Uninitialized);
+
+    for (uint row = 0 ; row < h ; ++row)
+    {
+        memcpy(raw.data() + row * rowBytes,
+               job->bits + ((quint64)(y + row) * job->level->width + x) * job->level->bytesDepth,
+               rowBytes);
+    }
+
+    return raw;
+}
+
+/** A hash match does not prove that a tile did not change: compare the pixels
+ *  with the compressed data of the reference tile, stored in the job data.
+ */
+void verifyTiles(UndoCacheJob* const job, int start, int end)
+{
+    for (int t = start ; t < end ; ++t)
+    {
+        if (job->changed.at(t))
+        {
+            continue;
+        }
+
+        job->changed[t] = (qUncompress(job->data.at(t)) != tilePixels(job, t));
+        job->data[t].clear();
+    }
+}
+
+void compressTiles(UndoCacheJob* const job, int start, int end)
+{
+    for (int t = start ; t < end ; ++t)
+    {
+        if (!job->changed.at(t))
+        {
+            continue;
+        }
+
+        job->data[t] = qCompress(tilePixels(job, t), CompressionLevel);
+    }
+}
+
+void uncompressTiles(UndoCacheJob* const job, int start, int end)
+{
+    for (int t = start ; t < end ; ++t)
+    {
+        uint x, y, w, h;
+        job->level->tileRect(t, x, y, w, h);
+
+        const int rowBytes   = w * job->level->bytesDepth;
+        const QByteArray raw = qUncompress(job->data.at(t));
+
+        if (raw.size() != (int)(rowBytes * h))
+        {
+            job->changed[t] = false;    // Marks the failure
+            continue;
+        }
+
+        for (uint row = 0 ; row < h ; ++row)
+        {
+            memcpy(job->bits + ((quint64)(y + row) * job->level->width + x) * job->level->bytesDepth,
+                   raw.constData() + row * rowBytes,
+                   rowBytes);
+        }
+    }
+}
+
+/** Run the function over all tiles of the job, splitting them between the available cores.
+ */
+void runTileJob(void (*function)(UndoCacheJob* const, int, int), UndoCacheJob* const job, int tileCount)
+{
+    const int chunks = qMax(1, qMin(QThread::idealThreadCount(), tileCount));
+    QList<QFuture<void> > tasks;
+
+    for (int i = 0 ; i < chunks ; ++i)
+    {
+        tasks.append(QtConcurrent::run(function, job,
+                                       (int)((qint64)i       * tileCount / chunks),
+                                       (int)((qint64)(i + 1) * tileCount / chunks)));
+    }
+
+    foreach (QFuture<void> t, tasks)
+    {
+        t.waitForFinished();
+    }
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------------------------
+
 class Q_DECL_HIDDEN UndoCache::Private
 {
 public:
 
     explicit Private()
     {
-        cacheError = false;
+        cacheError   = false;
+        lastLevel    = -1;
+        memoryBudget = 256 * 1024 * 1024;
+        memoryUsed   = 0;
     }
 
-    QString cacheFile(int level) const
+    QString cacheFile() const
     {
-        return QString::fromUtf8("%1-%2.bin").arg(cachePrefix).arg(level);
+        return QString::fromUtf8("%1.bin").arg(cachePrefix);
     }
 
-    QString   cacheDir;
-    QString   cachePrefix;
-    QSet<int> cachedLevels;
+    bool checkDiskSpace();
+    void spillTiles();
+
+    QString                   cacheDir;
+    QString                   cachePrefix;
+    QMap<int, UndoCacheLevel> levels;
+    int                       lastLevel;
+
+    QFile                     file;
+    qint64                    memoryBudget;
+    qint64                    memoryUsed;
 
-    bool      cacheError;
+    bool                      cacheError;
 };
 
+bool UndoCache::Private::checkDiskSpace()
+{
+    if (cacheError)
+    {
+        return false;
+    }
+
+    QStorageInfo info(cacheDir);
+
+    qint64 fspace = (info.bytesAvailable() / 1024 / 1024);
+    qCDebug(DIGIKAM_GENERAL_LOG) << "Free space available in Editor cache [" << cacheDir << "] in Mbytes:" << fspace;
+
+    if (fspace < 2048) // Check if free space is over 2 GiB to put data in cache.
+    {
+        if (!qApp->activeWindow()) // Special case for the Jenkins build server.
+        {
+            return false;
+        }
+
+        QApplication::restoreOverrideCursor();
+
+        QMessageBox::critical(qApp->activeWindow(), qApp->applicationName(),
+                              i18n("The free disk space in the path \"%1\" for the undo "
+                                   "cache file is < 2 GiB! Undo cache is now disabled!",
+                                   QDir::toNativeSeparators(cacheDir)));
+        cacheError = true;
+
+        return false;
+    }
+
+    return true;
+}
+
+/** Move the compressed tiles to the cache file, the tiles used by the oldest levels first,
+ *  until the memory budget is respected.
+ */
+void UndoCache::Private::spillTiles()
+{
+    if (memoryUsed <= memoryBudget)
+    {
+        return;
+    }
+
+    QMap<int, QList<UndoCacheTilePtr> > candidates;
+
+    foreach (const UndoCacheLevel& level, levels)
+    {
+        foreach (const UndoCacheTilePtr& tile, level.tiles)
+        {
+            if (!tile->data.isEmpty())
+            {
+                candidates[tile->lastLevel] << tile;
+            }
+        }
+    }
+
+    if (!file.isOpen())
+    {
+        if (!checkDiskSpace())
+        {
+            return;
+        }
+
+        file.setFileName(cacheFile());
+
+        if (!file.open(QIODevice::ReadWrite | QIODevice::Truncate))
+        {
+            qCWarning(DIGIKAM_GENERAL_LOG) << "Cannot open undo cache file" << cacheFile();
+            return;
+        }
+    }
+
+    file.seek(file.size());
+
+    foreach (const QList<UndoCacheTilePtr>& tiles, candidates)
+    {
+        foreach (const UndoCacheTilePtr& tile, tiles)
+        {
+            if (memoryUsed <= memoryBudget)
+            {
+                return;
+            }
+
+            if (tile->data.isEmpty())
+            {
+                continue;   // Shared tile already moved
+            }
+
+            qint64 offset = file.pos();
+
+            if (file.write(tile->data) != tile->data.size())
+            {
+                qCWarning(DIGIKAM_GENERAL_LOG) << "Cannot write to undo cache file" << cacheFile();
+                return;
+            }
+
+            tile->offset = offset;
+            tile->data.clear();
+            memoryUsed  -= tile->size;
+        }
+    }
+}
+
 UndoCache::UndoCache()
     : d(new Private)
 {
@@ -95,138 +461,213 @@ UndoCache::~UndoCache()
 
 void UndoCache::clear()
 {
-    foreach (int level, d->cachedLevels)
+    d->levels.clear();
+    d->lastLevel  = -1;
+    d->memoryUsed = 0;
+
+    if (d->file.isOpen())
     {
-        QFile(d->cacheFile(level)).remove();
+        d->file.close();
     }
 
-    d->cachedLevels.clear();
+    QFile::remove(d->cacheFile());
 }
 
 void UndoCache::clearFrom(int fromLevel)
 {
-    foreach (int level, d->cachedLevels)
+    QMap<int, UndoCacheLevel>::iterator it = d->levels.lowerBound(fromLevel);
+
+    while (it != d->levels.end())
+    {
+        it = d->levels.erase(it);
+    }
+
+    if (d->lastLevel >= fromLevel)
+    {
+        d->lastLevel = -1;
+    }
+
+    // Recount the memory of the tiles still referenced.
+    // Space in the cache file is only reclaimed by clear().
+
+    QSet<UndoCacheTile*> counted;
+    d->memoryUsed = 0;
+
+    foreach (const UndoCacheLevel& level, d->levels)
     {
-        if (level >= fromLevel)
+        foreach (const UndoCacheTilePtr& tile, level.tiles)
         {
-            QFile(d->cacheFile(level)).remove();
-            d->cachedLevels.remove(level);
+            if (!tile->data.isEmpty() && !counted.contains(tile.data()))
+            {
+                counted << tile.data();
+                d->memoryUsed += tile->size;
+            }
         }
     }
 }
 
+void UndoCache::setMemoryBudget(qint64 bytes)
+{
+    d->memoryBudget = bytes;
+    d->spillTiles();
+}
+
 bool UndoCache::putData(int level, const DImg& img) const
 {
-    if (d->cacheError)
+    if (d->cacheError || img.isNull() || d->levels.contains(level))
     {
         return false;
     }
 
-    QStorageInfo info(d->cacheDir);
+    UndoCacheLevel cacheLevel;
+    cacheLevel.width      = img.width();
+    cacheLevel.height     = img.height();
+    cacheLevel.bytesDepth = img.bytesDepth();
+    cacheLevel.sixteenBit = img.sixteenBit();
+    cacheLevel.hasAlpha   = img.hasAlpha();
 
-    qint64 fspace = (info.bytesAvailable() / 1024 / 1024);
-    qCDebug(DIGIKAM_GENERAL_LOG) << "Free space available in Editor cache [" << d->cacheDir << "] in Mbytes:" << fspace;
+    const int tileCount   = cacheLevel.tilesX() * cacheLevel.tilesY();
 
-    if (fspace < 2048) // Check if free space is over 2 GiB to put data in cache.
+    // Find the tiles which changed since the last stored level
+
+    const UndoCacheLevel* reference = 0;
+
+    if (d->levels.contains(d->lastLevel) && d->levels[d->lastLevel].sameFormat(img))
     {
-        if (!qApp->activeWindow()) // Special case for the Jenkins build server.
-        {
-            return false;
-        }
+        reference = &d->levels[d->lastLevel];
+    }
 
-        QApplication::restoreOverrideCursor();
+    UndoCacheJob job;
+    job.level = &cacheLevel;
+    job.bits  = img.bits();
+    job.hashes.resize(tileCount);
+    job.changed.fill(true, tileCount);
+    job.data.resize(tileCount);
 
-        QMessageBox::critical(qApp->activeWindow(), qApp->applicationName(),
-                              i18n("The free disk space in the path \"%1\" for the undo "
-                                   "cache file is < 2 GiB! Undo cache is now disabled!",
-                                   QDir::toNativeSeparators(d->cacheDir)));
-        d->cacheError = true;
+    runTileJob(hashTiles, &job, tileCount);
 
-        return false;
+    if (reference)
+    {
+        for (int t = 0 ; t < tileCount ; ++t)
+        {
+            const UndoCacheTilePtr& tile = reference->tiles.at(t);
+
+            if (job.hashes.at(t) != tile->hash)
+            {
+                continue;
+            }
+
+            if (!tile->data.isEmpty())
+            {
+                job.data[t] = tile->data;
+            }
+            else if (d->file.isOpen() && d->file.seek(tile->offset))
+            {
+                job.data[t] = d->file.read(tile->size);
+            }
+
+            job.changed[t] = false;
+        }
+
+        runTileJob(verifyTiles, &job, tileCount);
     }
 
-    QFile file(d->cacheFile(level));
+    runTileJob(compressTiles, &job, tileCount);
 
-    if (file.exists() || !file.open(QIODevice::WriteOnly))
+    for (int t = 0 ; t < tileCount ; ++t)
     {
-        return false;
+        if (job.changed.at(t) && job.data.at(t).isEmpty())
+        {
+            return false;
+        }
     }
 
-    QDataStream ds(&file);
-    ds << img.width();
-    ds << img.height();
-    ds << img.numBytes();
-    ds << img.hasAlpha();
-    ds << img.sixteenBit();
+    int    changedTiles = 0;
+    qint64 storedBytes  = 0;
+    cacheLevel.tiles.resize(tileCount);
 
-    file.write((const char*)img.bits(), img.numBytes());
-
-    if (file.error() != QFileDevice::NoError)
+    for (int t = 0 ; t < tileCount ; ++t)
     {
-        file.close();
-        file.remove();
+        UndoCacheTilePtr tile;
 
-        return false;
+        if (job.changed.at(t))
+        {
+            tile         = UndoCacheTilePtr(new UndoCacheTile);
+            tile->hash   = job.hashes.at(t);
+            tile->data   = job.data.at(t);
+            tile->size   = tile->data.size();
+            storedBytes += tile->size;
+            changedTiles++;
+        }
+        else
+        {
+            tile = reference->tiles.at(t);
+        }
+
+        tile->lastLevel     = qMax(tile->lastLevel, level);
+        cacheLevel.tiles[t] = tile;
     }
 
-    d->cachedLevels << level;
+    d->memoryUsed += storedBytes;
+    d->levels.insert(level, cacheLevel);
+    d->lastLevel = level;
 
-    file.close();
+    qCDebug(DIGIKAM_GENERAL_LOG) << "Undo level" << level << ":" << changedTiles << "of" << tileCount
+                                 << "tiles stored, memory used:" << d->memoryUsed / 1024 << "KiB";
+
+    d->spillTiles();
 
     return true;
 }
 
 DImg UndoCache::getData(int level) const
 {
-    uint w          = 0;
-    uint h          = 0;
-    uint numBytes   = 0;
-    bool hasAlpha   = false;
-    bool sixteenBit = false;
-
-    QFile file(d->cacheFile(level));
-
-    if (!file.open(QIODevice::ReadOnly))
+    if (!d->levels.contains(level))
     {
         return DImg();
     }
 
-    QDataStream ds(&file);
-    ds >> w;
-    ds >> h;
-    ds >> numBytes;
-    ds >> hasAlpha;
-    ds >> sixteenBit;
+    const UndoCacheLevel& cacheLevel = d->levels[level];
+    const int tileCount              = cacheLevel.tiles.size();
 
-    if (ds.status() != QDataStream::Ok || ds.atEnd())
-    {
-        qCDebug(DIGIKAM_GENERAL_LOG) << "The undo cache file is corrupt";
-
-        file.close();
+    DImg img(cacheLevel.width, cacheLevel.height, cacheLevel.sixteenBit, cacheLevel.hasAlpha);
 
+    if (img.isNull())
+    {
         return DImg();
     }
 
-    DImg img(w, h, sixteenBit, hasAlpha);
+    UndoCacheJob job;
+    job.level = &cacheLevel;
+    job.bits  = img.bits();
+    job.changed.fill(true, tileCount);
+    job.data.resize(tileCount);
+
+    // Read the tiles moved to the cache file, then uncompress all tiles in parallel
 
-    if (img.isNull() || numBytes != img.numBytes())
+    for (int t = 0 ; t < tileCount ; ++t)
     {
-        file.close();
+        const UndoCacheTilePtr& tile = cacheLevel.tiles.at(t);
 
-        return DImg();
+        if (!tile->data.isEmpty())
+        {
+            job.data[t] = tile->data;
+        }
+        else if (d->file.isOpen() && d->file.seek(tile->offset))
+        {
+            job.data[t] = d->file.read(tile->size);
+        }
     }
 
-    qint64 readBytes = file.read((char*)img.bits(), numBytes);
+    runTileJob(uncompressTiles, &job, tileCount);
 
-    if (file.error() != QFileDevice::NoError || readBytes != numBytes)
+    if (job.changed.contains(false))
     {
-        file.close();
+        qCDebug(DIGIKAM_GENERAL_LOG) << "The undo cache data of level" << level << "is corrupt";
 
         return DImg();
     }
 
-    file.close();
-
     return img;
 }
 
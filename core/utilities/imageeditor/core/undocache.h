@@ -43,25 +43,32 @@ public:
     ~UndoCache();
 
     /**
-     * Delete all cache files
+     * Delete all cached levels and cache files
      */
     void clear();
 
     /**
-     * Delete all cache files starting from the given level upwards
+     * Delete all cached levels starting from the given level upwards
      */
     void clearFrom(int level);
 
     /**
-     * Write the image data into a cache file
+     * Store the image data of the level. Only the tiles which changed since the
+     * previously stored level are compressed and stored, the other tiles are shared.
      */
     bool putData(int level, const DImg& img) const;
 
     /**
-     * Get the image data from a cache file
+     * Get the image data of the level
      */
     DImg getData(int level) const;
 
+    /**
+     * Set the memory size used to keep compressed tiles, in bytes.
+     * Beyond this size, the tiles of the oldest levels are moved to a cache file.
+     */
+    void setMemoryBudget(qint64 bytes);
+
 private:
 
     UndoCache(const UndoCache&); // Disable
@@ -27,6 +27,7 @@
 
 #include <QWidget>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QIcon>
 #include <QApplication>
 
@@ -57,6 +58,7 @@ public:
     explicit Private()
       : initPreview(false),
         version(0),
+        timerDelay(500),
         view(0),
         timer(0),
         settings(0),
@@ -68,6 +70,7 @@ public:
     QString                helpAnchor;
     QString                name;
     int                    version;
+    int                    timerDelay;
 
     QWidget*               view;
     QIcon                  icon;
@@ -145,6 +148,11 @@ void EditorTool::setToolCategory(const FilterAction::Category category)
     d->category = category;
 }
 
+void EditorTool::setPreviewDelay(int msecs)
+{
+    d->timerDelay = msecs;
+}
+
 void EditorTool::setPreviewModeMask(int mask)
 {
     EditorToolIface::editorToolIface()->setPreviewModeMask(mask);
@@ -264,7 +272,7 @@ void EditorTool::slotResetSettings()
 void EditorTool::slotTimer()
 {
     d->timer->setSingleShot(true);
-    d->timer->start(500);
+    d->timer->start(d->timerDelay);
 }
 
 void EditorTool::slotOk()
@@ -372,14 +380,28 @@ public:
 
     explicit Private()
       : delFilter(true),
+        progressive(false),
+        coarsePass(false),
+        refineInBudget(false),
+        coarseScale(0.25),
         currentRenderingMode(EditorToolThreaded::NoneRendering),
         threadedFilter(0),
         threadedAnalyser(0)
     {
     }
 
+    /** Time budget in milliseconds to render the coarse progressive preview pass.
+     */
+    static const int                  frameBudget = 100;
+
     bool                              delFilter;
 
+    bool                              progressive;
+    bool                              coarsePass;
+    bool                              refineInBudget;
+    double                            coarseScale;
+    QElapsedTimer                     passTimer;
+
     EditorToolThreaded::RenderingMode currentRenderingMode;
 
     QString                           progressMess;
@@ -404,6 +426,45 @@ EditorToolThreaded::RenderingMode EditorToolThreaded::renderingMode() const
     return d->currentRenderingMode;
 }
 
+void EditorToolThreaded::setProgressivePreview(bool b)
+{
+    d->progressive = b;
+
+    // The coarse pass is fast enough to follow settings changes without waiting.
+    setPreviewDelay(b ? 100 : 500);
+}
+
+bool EditorToolThreaded::progressivePreview() const
+{
+    return d->progressive;
+}
+
+DImg EditorToolThreaded::previewRegionImage() const
+{
+    ImageRegionWidget* const view = dynamic_cast<ImageRegionWidget*>(toolView());
+
+    if (!view)
+    {
+        return DImg();
+    }
+
+    DImg image = view->getOriginalRegionImage();
+
+    if (d->progressive && d->coarsePass && !image.isNull())
+    {
+        uint w = qMax(1, qRound(image.width()  * d->coarseScale));
+        uint h = qMax(1, qRound(image.height() * d->coarseScale));
+        image  = image.smoothScale(w, h, Qt::IgnoreAspectRatio);
+    }
+
+    return image;
+}
+
+double EditorToolThreaded::previewRegionScale() const
+{
+    return ((d->progressive && d->coarsePass) ? d->coarseScale : 1.0);
+}
+
 void EditorToolThreaded::setProgressMessage(const QString& mess)
 {
     d->progressMess = mess;
@@ -536,12 +597,46 @@ void EditorToolThreaded::slotFilterStarted()
 
 void EditorToolThreaded::slotFilterFinished(bool success)
 {
+    // A progressive preview pass can be replaced before its queued signal is delivered, see retireFilter().
+    if (sender() && sender() != d->threadedFilter)
+    {
+        return;
+    }
+
     if (success)        // Computation Completed !
     {
         switch (d->currentRenderingMode)
         {
             case EditorToolThreaded::PreviewRendering:
             {
+                if (d->progressive && d->coarsePass)
+                {
+                    qint64 elapsed = d->passTimer.elapsed();
+                    qCDebug(DIGIKAM_GENERAL_LOG) << "Coarse preview " << toolName() << " completed in" << elapsed << "ms";
+
+                    // Adapt the coarse scale to stay in frame budget with the next settings change.
+
+                    if (elapsed > Private::frameBudget)
+                    {
+                        d->coarseScale = qMax(0.0625, d->coarseScale / 2.0);
+                    }
+                    else if (elapsed < Private::frameBudget / 4)
+                    {
+                        d->coarseScale = qMin(0.5, d->coarseScale * 2.0);
+                    }
+
+                    setPreviewImage();
+
+                    d->coarsePass = false;
+                    startPreviewPass();
+                    break;
+                }
+
+                if (d->progressive)
+                {
+                    d->refineInBudget = (d->passTimer.elapsed() <= Private::frameBudget);
+                }
+
                 qCDebug(DIGIKAM_GENERAL_LOG) << "Preview " << toolName() << " completed...";
                 setPreviewImage();
                 slotAbort();
@@ -638,6 +733,16 @@ void EditorToolThreaded::slotOk()
 
 void EditorToolThreaded::slotPreview()
 {
+    if (d->progressive && d->currentRenderingMode == EditorToolThreaded::PreviewRendering)
+    {
+        // Settings changed while a pass is running: drop it and restart from the coarse pass.
+        qCDebug(DIGIKAM_GENERAL_LOG) << "Preview " << toolName() << " restarted...";
+
+        d->coarsePass = !d->refineInBudget;
+        startPreviewPass();
+        return;
+    }
+
     // Computation already in process.
     if (d->currentRenderingMode != EditorToolThreaded::NoneRendering)
     {
@@ -652,20 +757,46 @@ void EditorToolThreaded::slotPreview()
     toolSettings()->enableButton(EditorToolSettings::Load,    false);
     toolSettings()->enableButton(EditorToolSettings::Default, false);
     toolSettings()->enableButton(EditorToolSettings::Try,     false);
-    toolView()->setEnabled(false);
+
+    // With progressive preview, tool view stay usable to be able to pan the region to refine.
+    toolView()->setEnabled(d->progressive);
 
     EditorToolIface::editorToolIface()->setToolStartProgress(d->progressMess.isEmpty() ? toolName() : d->progressMess);
     qApp->setOverrideCursor(Qt::WaitCursor);
 
+    // Skip the coarse pass if the last full preview already rendered in frame budget.
+    d->coarsePass = d->progressive && !d->refineInBudget;
+    startPreviewPass();
+}
+
+void EditorToolThreaded::startPreviewPass()
+{
     if (d->delFilter && d->threadedFilter)
     {
-        delete d->threadedFilter;
-        d->threadedFilter = 0;
+        retireFilter();
+    }
+    else if (filter())
+    {
+        filter()->cancelFilter();
     }
 
+    d->passTimer.start();
     preparePreview();
 }
 
+void EditorToolThreaded::retireFilter()
+{
+    // A canceled pass has already posted its finished() signal when cancelFilter() returns.
+    // The filter is disconnected first, so it posts nothing more, and it is deleted later:
+    // its pending signals are delivered before, while no new filter can take its address,
+    // and they are dropped by slotFilterFinished() because they come from a former pass.
+
+    disconnect(d->threadedFilter, 0, this, 0);
+    d->threadedFilter->cancelFilter();
+    d->threadedFilter->deleteLater();
+    d->threadedFilter = 0;
+}
+
 void EditorToolThreaded::slotCancel()
 {
     writeSettings();
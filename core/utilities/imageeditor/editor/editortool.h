@@ -35,6 +35,7 @@
 
 #include "digikam_export.h"
 #include "dcolor.h"
+#include "dimg.h"
 #include "previewtoolbar.h"
 #include "filteraction.h"
 
@@ -97,6 +98,10 @@ protected:
     void setPreviewModeMask(int mask);
     void setToolCategory(const FilterAction::Category category);
 
+    /** Set the delay in milliseconds used by slotTimer() before to call slotPreview(). Default is 500 ms.
+     */
+    void setPreviewDelay(int msecs);
+
     virtual void setToolView(QWidget* const view);
     virtual void setToolSettings(EditorToolSettings* const settings);
     virtual void setBusy(bool);
@@ -153,6 +158,15 @@ public:
      */
     RenderingMode renderingMode() const;
 
+    /** Set this option to on to render preview progressively with an ImageRegionWidget tool view.
+     *  A first pass processes a downscaled copy of the visible region, sized to fit in a frame budget,
+     *  and a second pass refines the visible region at full resolution. Changing settings while
+     *  a pass is running cancels it and restarts the preview instead of being ignored.
+     *  Tools must use previewRegionImage() in preparePreview() to take benefit of this mode.
+     */
+    void setProgressivePreview(bool b);
+    bool progressivePreview() const;
+
 public Q_SLOTS:
 
     virtual void slotAbort();
@@ -174,6 +188,16 @@ protected:
      */
     void deleteFilterInstance(bool b = true);
 
+    /** Return the visible original region from ImageRegionWidget tool view to process in preparePreview().
+     *  With progressive preview, the coarse pass returns a downscaled copy of this region.
+     */
+    DImg previewRegionImage() const;
+
+    /** Return the scale of previewRegionImage() relative to the original region: 1.0, or less with
+     *  the coarse progressive pass. Spatial settings, as a radius in pixels, must be multiplied by it.
+     */
+    double previewRegionScale() const;
+
     virtual void preparePreview()    {};
     virtual void prepareFinal()      {};
     virtual void setPreviewImage()   {};
@@ -206,6 +230,11 @@ private Q_SLOTS:
 
     void slotResized();
 
+private:
+
+    void startPreviewPass();
+    void retireFilter();
+
 private:
 
     class Private;
@@ -109,6 +109,7 @@ BlurTool::BlurTool(QObject* const parent)
     setPreviewModeMask(PreviewToolBar::AllPreviewModes);
     setToolSettings(d->gboxSettings);
     setToolView(d->previewWidget);
+    setProgressivePreview(true);
 
     // --------------------------------------------------------
 
@@ -145,8 +146,9 @@ void BlurTool::slotResetSettings()
 
 void BlurTool::preparePreview()
 {
-    DImg img = d->previewWidget->getOriginalRegionImage();
-    setFilter(new BlurFilter(&img, this, d->radiusInput->value()));
+    DImg img   = previewRegionImage();
+    int radius = qRound(d->radiusInput->value() * previewRegionScale());
+    setFilter(new BlurFilter(&img, this, radius));
 }
 
 void BlurTool::setPreviewImage()
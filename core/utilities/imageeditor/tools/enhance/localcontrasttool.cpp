@@ -90,6 +90,7 @@ LocalContrastTool::LocalContrastTool(QObject* const parent)
 
     d->previewWidget = new ImageRegionWidget;
     setToolView(d->previewWidget);
+    setProgressivePreview(true);
     setPreviewModeMask(PreviewToolBar::AllPreviewModes);
 
     // -------------------------------------------------------------
@@ -143,8 +144,8 @@ void LocalContrastTool::slotResetSettings()
 
 void LocalContrastTool::preparePreview()
 {
-    // See bug #235601 : we cannot use downscaled image to render preview. It will differs than final rendering.
-    DImg image = d->previewWidget->getOriginalRegionImage(false);
+    // See bug #235601 : downscaled image differs than final rendering. It is only used by the coarse progressive pass.
+    DImg image = previewRegionImage();
     setFilter(new LocalContrastFilter(&image, this, d->settingsView->settings()));
 }
 
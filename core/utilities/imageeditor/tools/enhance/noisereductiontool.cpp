@@ -89,6 +89,7 @@ NoiseReductionTool::NoiseReductionTool(QObject* const parent)
 
     setToolSettings(d->gboxSettings);
     setToolView(d->previewWidget);
+    setProgressivePreview(true);
     setPreviewModeMask(PreviewToolBar::AllPreviewModes);
 
     connect(d->nrSettings, SIGNAL(signalEstimateNoise()),
@@ -123,7 +124,7 @@ void NoiseReductionTool::slotResetSettings()
 
 void NoiseReductionTool::preparePreview()
 {
-    DImg image      = d->previewWidget->getOriginalRegionImage();
+    DImg image      = previewRegionImage();
     NRContainer prm = d->nrSettings->settings();
 
     setFilter(new NRFilter(&image, this, prm));
@@ -99,6 +99,7 @@ SharpenTool::SharpenTool(QObject* const parent)
     d->sharpSettings = new SharpSettings(d->gboxSettings->plainPage());
     setToolSettings(d->gboxSettings);
     setToolView(d->previewWidget);
+    setProgressivePreview(true);
     setPreviewModeMask(PreviewToolBar::AllPreviewModes);
 
     connect(d->sharpSettings, SIGNAL(signalSettingsChanged()),
@@ -161,8 +162,8 @@ void SharpenTool::preparePreview()
     {
         case SharpContainer::SimpleSharp:
         {
-            DImg img      = d->previewWidget->getOriginalRegionImage();
-            double radius = settings.ssRadius/10.0;
+            DImg img      = previewRegionImage();
+            double radius = settings.ssRadius/10.0 * previewRegionScale();
             double sigma;
 
             if (radius < 1.0)
@@ -180,8 +181,8 @@ void SharpenTool::preparePreview()
 
         case SharpContainer::UnsharpMask:
         {
-            DImg img  = d->previewWidget->getOriginalRegionImage();
-            double r  = settings.umRadius;
+            DImg img  = previewRegionImage();
+            double r  = settings.umRadius * previewRegionScale();
             double a  = settings.umAmount;
             double th = settings.umThreshold;
             bool l    = settings.umLumaOnly;
@@ -194,11 +195,11 @@ void SharpenTool::preparePreview()
         {
 
 #ifdef HAVE_EIGEN3
-            DImg   img = d->previewWidget->getOriginalRegionImage();
-            double r   = settings.rfRadius;
+            DImg   img = previewRegionImage();
+            double r   = settings.rfRadius * previewRegionScale();
             double c   = settings.rfCorrelation;
             double n   = settings.rfNoise;
-            double g   = settings.rfGauss;
+            double g   = settings.rfGauss  * previewRegionScale();
             int    ms  = settings.rfMatrix;
 
             setFilter(new RefocusFilter(&img, this, ms, r, g, c, n));
@@ -33,8 +33,10 @@
 #include "imageinfo.h"
 #include "thumbsdb.h"
 #include "thumbsdbaccess.h"
+#include "thumbnailpack.h"
 #include "coredb.h"
 #include "coredbaccess.h"
+#include "coredbbackend.h"
 #include "recognitiondatabase.h"
 #include "facetagseditor.h"
 #include "maintenancedata.h"
@@ -44,6 +46,34 @@
 namespace Digikam
 {
 
+/// The custom identifiers of the face thumbnails of an item, as generated by the face views.
+static QStringList faceThumbnailIdentifiers(const ImageInfo& info, FaceTagsEditor& editor)
+{
+    QStringList identifiers;
+    QUrl url;
+    url.setScheme(QLatin1String("detail"));
+    url.setPath(info.filePath());
+    QList<FaceTagsIface> faces = editor.databaseFaces(info.id());
+
+    foreach(const FaceTagsIface& face, faces)
+    {
+        QRect rect = face.region().toRect();
+        QString r  = QString::fromLatin1("%1,%2-%3x%4").arg(rect.x()).arg(rect.y()).arg(rect.width()).arg(rect.height());
+        QUrlQuery q(url);
+
+        // Remove the previous query if existent.
+        q.removeQueryItem(QLatin1String("rect"));
+        q.addQueryItem(QLatin1String("rect"), r);
+        url.setQuery(q);
+
+        //qCDebug(DIGIKAM_GENERAL_LOG) << "URL: " << url.toString(); 
+
+        identifiers << url.toString();
+    }
+
+    return identifiers;
+}
+
 class Q_DECL_HIDDEN DatabaseTask::Private
 {
 public:
@@ -114,6 +144,20 @@ void DatabaseTask::run()
     {
         qCDebug(DIGIKAM_GENERAL_LOG) << "Shrinking databases";
 
+        {
+            // Rebuilt from scratch, in case another application changed the core DB.
+            CoreDbAccess access;
+
+            if (access.db()->hasFullTextIndex())
+            {
+                qCDebug(DIGIKAM_DATABASE_LOG) << "Rebuilding the full text index of core DB";
+                access.backend()->beginTransaction();
+                access.db()->rebuildFullTextIndex();
+                access.backend()->commitTransaction();
+                access.db()->storeFullTextIndexState();
+            }
+        }
+
         if (CoreDbAccess().db()->integrityCheck())
         {
             CoreDbAccess().db()->vacuum();
@@ -317,26 +361,10 @@ void DatabaseTask::run()
 
                     // Add the custom identifier.
                     // get all faces for the image and generate the custom identifiers
-                    QUrl url;
-                    url.setScheme(QLatin1String("detail"));
-                    url.setPath(info.filePath());
-                    QList<FaceTagsIface> faces = editor.databaseFaces(item);
-
-                    foreach(const FaceTagsIface& face, faces)
+                    foreach(const QString& identifier, faceThumbnailIdentifiers(info, editor))
                     {
-                        QRect rect = face.region().toRect();
-                        QString r  = QString::fromLatin1("%1,%2-%3x%4").arg(rect.x()).arg(rect.y()).arg(rect.width()).arg(rect.height());
-                        QUrlQuery q(url);
-
-                        // Remove the previous query if existent.
-                        q.removeQueryItem(QLatin1String("rect"));
-                        q.addQueryItem(QLatin1String("rect"), r);
-                        url.setQuery(q);
-
-                        //qCDebug(DIGIKAM_GENERAL_LOG) << "URL: " << url.toString(); 
-
                         // Remove the id that is found by the custom identifyer. Finding the id -1 does no harm
-                        thumbIds.remove(ThumbsDbAccess().db()->findByCustomIdentifier(url.toString()).id);
+                        thumbIds.remove(ThumbsDbAccess().db()->findByCustomIdentifier(identifier).id);
                     }
                 }
 
@@ -495,6 +523,57 @@ void DatabaseTask::run()
                                             << " due to error ";
         }
     }
+    else if (d->mode == Mode::CleanThumbnailPack)
+    {
+        ThumbnailPack* const pack = ThumbnailPack::instance();
+
+        if (pack->isOpen())
+        {
+            // The thumbnails in use are found by file path, by unique hash and file size,
+            // and by the custom identifiers of the face thumbnails, as in the thumbnail database.
+
+            QList<ThumbnailInfo> usedInfos;
+            FaceTagsEditor       editor;
+
+            foreach(const qlonglong& item, CoreDbAccess().db()->getAllItems())
+            {
+                if (m_cancel)
+                {
+                    return;
+                }
+
+                ImageInfo info(item);
+
+                if (info.isNull())
+                {
+                    continue;
+                }
+
+                ThumbnailInfo thumbInfo;
+                thumbInfo.filePath   = info.filePath();
+                thumbInfo.uniqueHash = info.uniqueHash();
+                thumbInfo.fileSize   = info.fileSize();
+                usedInfos << thumbInfo;
+
+                foreach(const QString& identifier, faceThumbnailIdentifiers(info, editor))
+                {
+                    ThumbnailInfo faceInfo;
+                    faceInfo.customIdentifier = identifier;
+                    usedInfos << faceInfo;
+                }
+            }
+
+            pack->removeUnused(usedInfos);
+
+            // Removed and replaced thumbnails stay in the pack file until it is rewritten.
+            if (pack->wastedSize() > pack->size() / 4)
+            {
+                pack->compact();
+            }
+        }
+
+        emit signalFinished();
+    }
     else if (d->mode == Mode::CleanRecognitionDb)
     {
         // While we have data (using this as check for non-null)
@@ -516,6 +595,15 @@ void DatabaseTask::run()
             emit signalFinished();
         }
     }
+    else if (d->mode == Mode::CleanFaceCaches)
+    {
+        // The cached detections and face vectors are keyed by the uniqueHash of the files.
+        int removed = RecognitionDatabase().removeUnusedFaceCaches(CoreDbAccess().db()->getAllUniqueHashes());
+
+        qCDebug(DIGIKAM_GENERAL_LOG) << "Removed the cached faces of" << removed << "files.";
+
+        emit signalFinished();
+    }
     else if (d->mode == Mode::CleanSimilarityDb)
     {
         // While we have data (using this as check for non-null)
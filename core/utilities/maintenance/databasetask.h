@@ -51,7 +51,9 @@ public:
         ComputeDatabaseJunk,
         CleanCoreDb,
         CleanThumbsDb,
+        CleanThumbnailPack,
         CleanRecognitionDb,
+        CleanFaceCaches,
         CleanSimilarityDb,
         ShrinkDatabases
     };
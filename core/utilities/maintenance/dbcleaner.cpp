@@ -42,6 +42,7 @@
 #include "digikam_debug.h"
 #include "digikamapp.h"
 #include "maintenancethread.h"
+#include "thumbnailpack.h"
 
 namespace Digikam
 {
@@ -53,6 +54,7 @@ public:
     explicit Private()
       : thread(0),
         cleanThumbsDb(false),
+        cleanThumbnailPack(false),
         cleanFacesDb(false),
         cleanSimilarityDb(false),
         shrinkDatabases(false),
@@ -64,6 +66,7 @@ public:
 
     MaintenanceThread* thread;
     bool               cleanThumbsDb;
+    bool               cleanThumbnailPack;
     bool               cleanFacesDb;
     bool               cleanSimilarityDb;
     bool               shrinkDatabases;
@@ -90,7 +93,8 @@ DbCleaner::DbCleaner(bool cleanThumbsDb,
     // register the identity list as meta type to be able to use it in signal/slot connection
     qRegisterMetaType<QList<Identity>>("QList<Identity>");
 
-    d->cleanThumbsDb     = cleanThumbsDb;
+    d->cleanThumbsDb      = cleanThumbsDb;
+    d->cleanThumbnailPack = cleanThumbsDb && ThumbnailPack::instance()->isOpen();
 
     if (cleanThumbsDb)
     {
@@ -177,7 +181,8 @@ void DbCleaner::slotFetchedData(const QList<qlonglong>& staleImageIds,
     // If we have nothing to do, finish.
     // Signal done if no elements cleanup is necessary
 
-    if (d->imagesToRemove.isEmpty() && d->staleThumbnails.isEmpty() && d->staleIdentities.isEmpty())
+    if (d->imagesToRemove.isEmpty() && d->staleThumbnails.isEmpty() && d->staleIdentities.isEmpty() &&
+        !d->cleanThumbnailPack && !d->cleanFacesDb)
     {
         qCDebug(DIGIKAM_GENERAL_LOG) << "Nothing to do. Databases are clean.";
 
@@ -198,7 +203,8 @@ void DbCleaner::slotFetchedData(const QList<qlonglong>& staleImageIds,
         }
     }
 
-    setTotalItems(totalItems() + d->imagesToRemove.size() + d->staleThumbnails.size() + d->staleIdentities.size());
+    setTotalItems(totalItems() + d->imagesToRemove.size() + d->staleThumbnails.size() + d->staleIdentities.size() +
+                  (d->cleanThumbnailPack ? 1 : 0) + (d->cleanFacesDb ? 1 : 0));
     //qCDebug(DIGIKAM_GENERAL_LOG) << "Completed items after analysis: " << completedItems() << "/" << totalItems();
 }
 
@@ -240,13 +246,23 @@ void DbCleaner::slotCleanedItems()
 
     if (d->cleanThumbsDb)
     {
-        if (!d->staleThumbnails.isEmpty())
+        if (!d->staleThumbnails.isEmpty() || d->cleanThumbnailPack)
         {
-            qCDebug(DIGIKAM_GENERAL_LOG) << "Found " << d->staleThumbnails.size() << " stale thumbnails.";
             setLabel(i18n("Clean up the databases : ") + i18n("cleaning thumbnails db"));
 
+            if (!d->staleThumbnails.isEmpty())
+            {
+                qCDebug(DIGIKAM_GENERAL_LOG) << "Found " << d->staleThumbnails.size() << " stale thumbnails.";
+                d->thread->cleanThumbsDb(d->staleThumbnails);
+            }
+
+            // The thumbnails pack is cleaned and compacted by the same step.
+            if (d->cleanThumbnailPack)
+            {
+                d->thread->cleanThumbnailPack();
+            }
+
             // GO!
-            d->thread->cleanThumbsDb(d->staleThumbnails);
             d->thread->start();
         }
         else
@@ -269,24 +285,22 @@ void DbCleaner::slotCleanedThumbnails()
 
     if (d->cleanFacesDb)
     {
+        setLabel(i18n("Clean up the databases : ") + i18n("cleaning recognition db"));
+
+        // GO! and don't forget the signal!
+        connect(d->thread, SIGNAL(signalCompleted()),
+                this, SLOT(slotCleanedFaces()));
+
+        // We cleaned the thumbs db. Now clean the faces db.
         if (d->staleIdentities.count() > 0)
         {
             qCDebug(DIGIKAM_GENERAL_LOG) << "Found " << d->staleIdentities.size() << " stale face identities.";
-            setLabel(i18n("Clean up the databases : ") + i18n("cleaning recognition db"));
-
-            // GO! and don't forget the signal!
-            connect(d->thread, SIGNAL(signalCompleted()),
-                    this, SLOT(slotCleanedFaces()));
-
-            // We cleaned the thumbs db. Now clean the faces db.
             d->thread->cleanFacesDb(d->staleIdentities);
-            d->thread->start();
-        }
-        else
-        {
-            qCDebug(DIGIKAM_GENERAL_LOG) << "Faces DB is clean.";
-            slotCleanedFaces();
         }
+
+        // The cached detections and face vectors of the removed files are cleaned by the same step.
+        d->thread->cleanFaceCaches();
+        d->thread->start();
     }
     else
     {
@@ -85,6 +85,7 @@ public:
         scanThumbs(0),
         scanFingerPrints(0),
         useMutiCoreCPU(0),
+        singlePass(0),
         cleanThumbsDb(0),
         cleanFacesDb(0),
         shrinkDatabases(0),
@@ -109,6 +110,7 @@ public:
 
     static const QString configGroupName;
     static const QString configUseMutiCoreCPU;
+    static const QString configSinglePass;
     static const QString configNewItems;
     static const QString configThumbnails;
     static const QString configScanThumbs;
@@ -135,6 +137,7 @@ public:
     QCheckBox*           scanThumbs;
     QCheckBox*           scanFingerPrints;
     QCheckBox*           useMutiCoreCPU;
+    QCheckBox*           singlePass;
     QCheckBox*           cleanThumbsDb;
     QCheckBox*           cleanFacesDb;
     QCheckBox*           shrinkDatabases;
@@ -158,6 +161,7 @@ public:
 
 const QString MaintenanceDlg::Private::configGroupName(QLatin1String("MaintenanceDlg Settings"));
 const QString MaintenanceDlg::Private::configUseMutiCoreCPU(QLatin1String("UseMutiCoreCPU"));
+const QString MaintenanceDlg::Private::configSinglePass(QLatin1String("SinglePass"));
 const QString MaintenanceDlg::Private::configNewItems(QLatin1String("NewItems"));
 const QString MaintenanceDlg::Private::configThumbnails(QLatin1String("Thumbnails"));
 const QString MaintenanceDlg::Private::configScanThumbs(QLatin1String("ScanThumbs"));
@@ -209,6 +213,9 @@ MaintenanceDlg::MaintenanceDlg(QWidget* const parent)
     DVBox* const options       = new DVBox;
     d->albumSelectors          = new AlbumSelectors(i18nc("@label", "Process items from:"), d->configGroupName, options);
     d->useMutiCoreCPU          = new QCheckBox(i18nc("@option:check", "Work on all processor cores (when it possible)"), options);
+    d->singlePass              = new QCheckBox(i18nc("@option:check", "Load each item only once for thumbnails, finger-prints and image quality"), options);
+    d->singlePass->setWhatsThis(i18n("If this option is enabled, thumbnails, finger-prints and image quality "
+                                     "are computed together, with one decoding of each item."));
     d->expanderBox->insertItem(Private::Options, options, QIcon::fromTheme(QLatin1String("configure")), i18n("Common Options"), QLatin1String("Options"), true);
 
     // --------------------------------------------------------------------------------------
@@ -412,6 +419,7 @@ MaintenanceSettings MaintenanceDlg::settings() const
     prm.albums                              = d->albumSelectors->selectedAlbums();
     prm.tags                                = d->albumSelectors->selectedTags();
     prm.useMutiCoreCPU                      = d->useMutiCoreCPU->isChecked();
+    prm.singlePass                          = d->singlePass->isChecked();
     prm.newItems                            = d->expanderBox->isChecked(Private::NewItems);
     prm.databaseCleanup                     = d->expanderBox->isChecked(Private::DbCleanup);
     prm.cleanThumbDb                        = d->cleanThumbsDb->isChecked();
@@ -448,6 +456,7 @@ void MaintenanceDlg::readSettings()
     MaintenanceSettings prm;
 
     d->useMutiCoreCPU->setChecked(group.readEntry(d->configUseMutiCoreCPU,                               prm.useMutiCoreCPU));
+    d->singlePass->setChecked(group.readEntry(d->configSinglePass,                                       prm.singlePass));
     d->expanderBox->setChecked(Private::NewItems,           group.readEntry(d->configNewItems,           prm.newItems));
 
     d->expanderBox->setChecked(Private::DbCleanup,          group.readEntry(d->configCleanupDatabase,       prm.databaseCleanup));
@@ -497,6 +506,7 @@ void MaintenanceDlg::writeSettings()
     MaintenanceSettings prm   = settings();
 
     group.writeEntry(d->configUseMutiCoreCPU,        prm.useMutiCoreCPU);
+    group.writeEntry(d->configSinglePass,            prm.singlePass);
     group.writeEntry(d->configNewItems,              prm.newItems);
     group.writeEntry(d->configCleanupDatabase,       prm.databaseCleanup);
     group.writeEntry(d->configCleanupThumbDatabase,  prm.cleanThumbDb);
@@ -44,6 +44,7 @@
 #include "fingerprintsgenerator.h"
 #include "duplicatesfinder.h"
 #include "imagequalitysorter.h"
+#include "singlepassprocessor.h"
 #include "metadatasynchronizer.h"
 #include "dnotificationwrapper.h"
 #include "progressmanager.h"
@@ -68,6 +69,13 @@ public:
         imageQualitySorter    = 0;
         facesDetector         = 0;
         databaseCleaner       = 0;
+        singlePassProcessor   = 0;
+    }
+
+    /// Thumbnails, finger-prints and image quality are processed together in stage 3.
+    bool useSinglePass() const
+    {
+        return (settings.singlePass && SinglePassProcessor::operationsCount(settings) > 1);
     }
 
     bool                   running;
@@ -84,6 +92,7 @@ public:
     ImageQualitySorter*    imageQualitySorter;
     FacesDetector*         facesDetector;
     DbCleaner*             databaseCleaner;
+    SinglePassProcessor*   singlePassProcessor;
 };
 
 MaintenanceMngr::MaintenanceMngr(QObject* const parent)
@@ -137,6 +146,11 @@ void MaintenanceMngr::slotToolCompleted(ProgressItem* tool)
         d->thumbsGenerator = 0;
         stage4();
     }
+    else if (tool == dynamic_cast<ProgressItem*>(d->singlePassProcessor))
+    {
+        d->singlePassProcessor = 0;
+        stage4();
+    }
     else if (tool == dynamic_cast<ProgressItem*>(d->fingerPrintsGenerator))
     {
         d->fingerPrintsGenerator = 0;
@@ -168,6 +182,7 @@ void MaintenanceMngr::slotToolCanceled(ProgressItem* tool)
 {
     if (tool == dynamic_cast<ProgressItem*>(d->newItemsFinder)        ||
         tool == dynamic_cast<ProgressItem*>(d->thumbsGenerator)       ||
+        tool == dynamic_cast<ProgressItem*>(d->singlePassProcessor)   ||
         tool == dynamic_cast<ProgressItem*>(d->fingerPrintsGenerator) ||
         tool == dynamic_cast<ProgressItem*>(d->duplicatesFinder)      ||
         tool == dynamic_cast<ProgressItem*>(d->databaseCleaner)       ||
@@ -235,7 +250,14 @@ void MaintenanceMngr::stage3()
 {
     qCDebug(DIGIKAM_GENERAL_LOG) << "stage3";
 
-    if (d->settings.thumbnails)
+    if (d->useSinglePass())
+    {
+        d->singlePassProcessor = new SinglePassProcessor(d->settings);
+        d->singlePassProcessor->setNotificationEnabled(false);
+        d->singlePassProcessor->setUseMultiCoreCPU(d->settings.useMutiCoreCPU);
+        d->singlePassProcessor->start();
+    }
+    else if (d->settings.thumbnails)
     {
         bool rebuildAll = (d->settings.scanThumbs == false);
         AlbumList list;
@@ -257,7 +279,7 @@ void MaintenanceMngr::stage4()
 {
     qCDebug(DIGIKAM_GENERAL_LOG) << "stage4";
 
-    if (d->settings.fingerPrints)
+    if (d->settings.fingerPrints && !d->useSinglePass())
     {
         bool rebuildAll = (d->settings.scanFingerPrints == false);
         AlbumList list;
@@ -314,7 +336,7 @@ void MaintenanceMngr::stage7()
 {
     qCDebug(DIGIKAM_GENERAL_LOG) << "stage7";
 
-    if (d->settings.qualitySort && d->settings.quality.enableSorter)
+    if (d->settings.qualitySort && d->settings.quality.enableSorter && !d->useSinglePass())
     {
         AlbumList list;
         list << d->settings.albums;
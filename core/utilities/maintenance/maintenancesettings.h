@@ -59,6 +59,9 @@ public:
     /// Use Multi-core CPU to process items.
     bool                                    useMutiCoreCPU;
 
+    /// Decode each item only once to generate thumbnails, finger-prints and sort by image quality.
+    bool                                    singlePass;
+
     /// Find new items on whole collection.
     bool                                    newItems;
 
@@ -36,6 +36,7 @@
 #include "thumbstask.h"
 #include "fingerprintstask.h"
 #include "imagequalitytask.h"
+#include "singlepasstask.h"
 #include "imagequalitysettings.h"
 #include "databasetask.h"
 #include "maintenancedata.h"
@@ -169,6 +170,39 @@ void MaintenanceThread::sortByImageQuality(const QStringList& paths, const Image
     appendJobs(collection);
 }
 
+void MaintenanceThread::processInSinglePass(const QStringList& paths,
+                                            const QSet<QString>& thumbPaths,
+                                            const QSet<QString>& fingerprintPaths,
+                                            const QSet<QString>& qualityPaths,
+                                            const ImageQualitySettings& quality)
+{
+    ActionJobCollection collection;
+
+    data->setImagePaths(paths);
+
+    for (int i = 1; i <= maximumNumberOfThreads(); i++)
+    {
+        SinglePassTask* const t = new SinglePassTask();
+        t->setThumbnailPaths(thumbPaths);
+        t->setFingerprintPaths(fingerprintPaths);
+        t->setQualityPaths(qualityPaths);
+        t->setQuality(quality);
+        t->setMaintenanceData(data);
+
+        connect(t, SIGNAL(signalFinished(QImage)),
+                this, SIGNAL(signalAdvance(QImage)));
+
+        connect(this, SIGNAL(signalCanceled()),
+                t, SLOT(slotCancel()), Qt::QueuedConnection);
+
+        collection.insert(t, 0);
+
+        qCDebug(DIGIKAM_GENERAL_LOG) << "Creating a single pass task for thumbnails, fingerprints and image quality.";
+    }
+
+    appendJobs(collection);
+}
+
 void MaintenanceThread::computeDatabaseJunk(bool thumbsDb, bool facesDb, bool similarityDb)
 {
     ActionJobCollection collection;
@@ -239,6 +273,23 @@ void MaintenanceThread::cleanThumbsDb(const QList<int>& thumbnailIds)
     appendJobs(collection);
 }
 
+void MaintenanceThread::cleanThumbnailPack()
+{
+    ActionJobCollection collection;
+
+    DatabaseTask* const t = new DatabaseTask();
+    t->setMode(DatabaseTask::Mode::CleanThumbnailPack);
+
+    connect(t, SIGNAL(signalFinished()),
+            this, SIGNAL(signalAdvance()));
+
+    collection.insert(t, 0);
+
+    appendJobs(collection);
+
+    qCDebug(DIGIKAM_GENERAL_LOG) << "Creating a database task for removing stale thumbnails from the pack.";
+}
+
 void MaintenanceThread::cleanFacesDb(const QList<Identity>& staleIdentities)
 {
     ActionJobCollection collection;
@@ -263,6 +314,23 @@ void MaintenanceThread::cleanFacesDb(const QList<Identity>& staleIdentities)
     appendJobs(collection);
 }
 
+void MaintenanceThread::cleanFaceCaches()
+{
+    ActionJobCollection collection;
+
+    DatabaseTask* const t = new DatabaseTask();
+    t->setMode(DatabaseTask::Mode::CleanFaceCaches);
+
+    connect(t, SIGNAL(signalFinished()),
+            this, SIGNAL(signalAdvance()));
+
+    collection.insert(t, 0);
+
+    appendJobs(collection);
+
+    qCDebug(DIGIKAM_GENERAL_LOG) << "Creating a database task for removing stale cached faces.";
+}
+
 void MaintenanceThread::cleanSimilarityDb(const QList<qlonglong>& imageIds)
 {
     ActionJobCollection collection;
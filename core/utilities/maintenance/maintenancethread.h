@@ -25,6 +25,10 @@
 #ifndef DIGIKAM_MAINTENANCE_THREAD_H
 #define DIGIKAM_MAINTENANCE_THREAD_H
 
+// Qt includes
+
+#include <QSet>
+
 // Local includes
 
 #include "actionthreadbase.h"
@@ -56,10 +60,21 @@ public:
     void generateFingerprints(const QStringList& paths);
     void sortByImageQuality(const QStringList& paths, const ImageQualitySettings& quality);
 
+    /** Generate thumbnails, fingerprints and sort by image quality the items of paths,
+     *  decoding each item only once. The sets tell which operations are done for each item.
+     */
+    void processInSinglePass(const QStringList& paths,
+                             const QSet<QString>& thumbPaths,
+                             const QSet<QString>& fingerprintPaths,
+                             const QSet<QString>& qualityPaths,
+                             const ImageQualitySettings& quality);
+
     void computeDatabaseJunk(bool thumbsDb=false, bool facesDb=false, bool similarityDb=false);
     void cleanCoreDb(const QList<qlonglong>& imageIds);
     void cleanThumbsDb(const QList<int>& thumbnailIds);
+    void cleanThumbnailPack();
     void cleanFacesDb(const QList<Identity>& staleIdentities);
+    void cleanFaceCaches();
     void cleanSimilarityDb(const QList<qlonglong>& imageIds);
     void shrinkDatabases();
 
@@ -48,7 +48,8 @@ public:
 
     explicit Private()
         : mode(CompleteCollectionScan),
-          cancel(false)
+          cancel(false),
+          batchCommitSize(100)
     {
     }
 
@@ -56,6 +57,9 @@ public:
 
     bool        cancel;
 
+    /// New items are written to the database in batches, one transaction per batch.
+    const int   batchCommitSize;
+
     QStringList foldersToScan;
     QStringList foldersScanned;
 };
@@ -115,7 +119,7 @@ void NewItemsFinder::slotStart()
             connect(ScanController::instance(), SIGNAL(completeScanDone()),
                     this, SLOT(slotDone()));
 
-            ScanController::instance()->completeCollectionScanInBackground(false);
+            ScanController::instance()->completeCollectionScanInBackground(false, d->batchCommitSize);
             ScanController::instance()->allowToScanDeferredFiles();
             break;
         }
@@ -124,7 +128,7 @@ void NewItemsFinder::slotStart()
         {
             qCDebug(DIGIKAM_GENERAL_LOG) << "scan mode: CompleteCollectionScan";
 
-            ScanController::instance()->completeCollectionScanInBackground(false);
+            ScanController::instance()->completeCollectionScanInBackground(false, d->batchCommitSize);
 
             if (d->cancel)
             {
@@ -135,7 +139,7 @@ void NewItemsFinder::slotStart()
                     this, SLOT(slotDone()));
 
             ScanController::instance()->allowToScanDeferredFiles();
-            ScanController::instance()->completeCollectionScanInBackground(true);
+            ScanController::instance()->completeCollectionScanInBackground(true, d->batchCommitSize);
             break;
         }
 
@@ -151,7 +155,7 @@ void NewItemsFinder::slotStart()
                     break;
                 }
 
-                ScanController::instance()->scheduleCollectionScan(folder);
+                ScanController::instance()->scheduleCollectionScan(folder, d->batchCommitSize);
             }
 
             break;
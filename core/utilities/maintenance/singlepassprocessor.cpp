@@ -0,0 +1,281 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-20
+ * Description : maintenance tool to generate thumbnails, finger-prints
+ *               and sort by image quality with one decoding of each item.
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "singlepassprocessor.h"
+
+// Qt includes
+
+#include <QIcon>
+#include <QPixmap>
+#include <QSet>
+#include <QString>
+
+// KDE includes
+
+#include <klocalizedstring.h>
+#include <ksharedconfig.h>
+#include <kconfiggroup.h>
+
+// Local includes
+
+#include "digikam_debug.h"
+#include "albummanager.h"
+#include "coredb.h"
+#include "coredbaccess.h"
+#include "imageinfo.h"
+#include "maintenancesettings.h"
+#include "maintenancethread.h"
+#include "similaritydb.h"
+#include "similaritydbaccess.h"
+#include "tagscache.h"
+#include "thumbnailloadthread.h"
+
+namespace Digikam
+{
+
+class Q_DECL_HIDDEN SinglePassProcessor::Private
+{
+public:
+
+    explicit Private()
+      : thumbnails(false),
+        fingerPrints(false),
+        qualitySort(false),
+        thread(0)
+    {
+    }
+
+    bool                 thumbnails;
+    bool                 fingerPrints;
+    bool                 qualitySort;
+
+    MaintenanceSettings  settings;
+
+    AlbumList            albumList;
+
+    QStringList          allPicturesPath;
+    QSet<QString>        thumbPaths;
+    QSet<QString>        fingerprintPaths;
+    QSet<QString>        qualityPaths;
+
+    MaintenanceThread*   thread;
+};
+
+SinglePassProcessor::SinglePassProcessor(const MaintenanceSettings& settings, ProgressItem* const parent)
+    : MaintenanceTool(QLatin1String("SinglePassProcessor"), parent),
+      d(new Private)
+{
+    setLabel(i18n("Thumbs, Finger-prints and Image Quality"));
+    ProgressManager::addProgressItem(this);
+
+    d->settings      = settings;
+    d->thumbnails    = settings.thumbnails;
+    d->fingerPrints  = settings.fingerPrints;
+    d->qualitySort   = settings.qualitySort && settings.quality.enableSorter;
+    d->albumList    << settings.albums;
+    d->albumList    << settings.tags;
+    d->thread        = new MaintenanceThread(this);
+
+    connect(d->thread, SIGNAL(signalCompleted()),
+            this, SLOT(slotDone()));
+
+    connect(d->thread, SIGNAL(signalAdvance(QImage)),
+            this, SLOT(slotAdvance(QImage)));
+}
+
+SinglePassProcessor::~SinglePassProcessor()
+{
+    delete d;
+}
+
+int SinglePassProcessor::operationsCount(const MaintenanceSettings& settings)
+{
+    int count = 0;
+
+    if (settings.thumbnails)
+    {
+        count++;
+    }
+
+    if (settings.fingerPrints)
+    {
+        count++;
+    }
+
+    if (settings.qualitySort && settings.quality.enableSorter)
+    {
+        count++;
+    }
+
+    return count;
+}
+
+void SinglePassProcessor::setUseMultiCoreCPU(bool b)
+{
+    d->thread->setUseMultiCore(b);
+}
+
+void SinglePassProcessor::slotCancel()
+{
+    d->thread->cancel();
+    MaintenanceTool::slotCancel();
+}
+
+void SinglePassProcessor::slotStart()
+{
+    MaintenanceTool::slotStart();
+
+    if (d->albumList.isEmpty())
+    {
+        d->albumList = AlbumManager::instance()->allPAlbums();
+    }
+
+    // Items which already have a thumbnail, if only missing thumbnails are generated.
+    QSet<QString> thumbnailPaths;
+
+    if (d->thumbnails && d->settings.scanThumbs)
+    {
+        thumbnailPaths = ThumbnailLoadThread::filePathsWithThumbnail();
+    }
+
+    // Items with dirty or missing finger-prints, if only these ones are processed.
+    QSet<QString> dirtyFingerprints;
+
+    if (d->fingerPrints && d->settings.scanFingerPrints)
+    {
+        // Get all image infos for images (category 1) that are visible (status 1)
+        QList<ImageInfo> imageInfos;
+        QList<qlonglong> imageIds = CoreDbAccess().db()->getImageIds(DatabaseItem::Status::Visible, DatabaseItem::Category::Image);
+
+        foreach(const qlonglong& id, imageIds)
+        {
+            imageInfos << ImageInfo(id);
+        }
+
+        dirtyFingerprints = SimilarityDbAccess().db()->getDirtyOrMissingFingerprintURLs(imageInfos).toSet();
+    }
+
+    // Items which do not have any Pick Label assigned.
+    QSet<QString> noPickLabel;
+
+    if (d->qualitySort && d->settings.qualityScanMode == ImageQualitySorter::NonAssignedItems)
+    {
+        noPickLabel = CoreDbAccess().db()->getItemsURLsWithTag(TagsCache::instance()->tagForPickLabel(NoPickLabel)).toSet();
+    }
+
+    QSet<QString> allPaths;
+
+    for (AlbumList::ConstIterator it = d->albumList.constBegin();
+         !canceled() && (it != d->albumList.constEnd()); ++it)
+    {
+        if (!(*it))
+        {
+            continue;
+        }
+
+        QStringList aPaths;
+
+        if ((*it)->type() == Album::PHYSICAL)
+        {
+            aPaths = CoreDbAccess().db()->getItemURLsInAlbum((*it)->id());
+        }
+        else if ((*it)->type() == Album::TAG)
+        {
+            aPaths = CoreDbAccess().db()->getItemURLsInTag((*it)->id());
+        }
+
+        foreach(const QString& path, aPaths)
+        {
+            bool process = false;
+
+            if (d->thumbnails && !thumbnailPaths.contains(path))
+            {
+                ImageInfo info = ImageInfo::fromLocalFile(path);
+
+                // only image, video or audio files have a thumbnail
+                if (info.category() == DatabaseItem::Image ||
+                    info.category() == DatabaseItem::Video ||
+                    info.category() == DatabaseItem::Audio)
+                {
+                    d->thumbPaths << path;
+                    process = true;
+                }
+            }
+
+            if (d->fingerPrints && (!d->settings.scanFingerPrints || dirtyFingerprints.contains(path)))
+            {
+                d->fingerprintPaths << path;
+                process = true;
+            }
+
+            if (d->qualitySort && (d->settings.qualityScanMode == ImageQualitySorter::AllItems || noPickLabel.contains(path)))
+            {
+                d->qualityPaths << path;
+                process = true;
+            }
+
+            if (process && !allPaths.contains(path))
+            {
+                allPaths << path;
+                d->allPicturesPath << path;
+            }
+        }
+    }
+
+    if (d->allPicturesPath.isEmpty())
+    {
+        slotDone();
+        return;
+    }
+
+    qCDebug(DIGIKAM_GENERAL_LOG) << "Single pass on" << d->allPicturesPath.count() << "items:"
+                                 << d->thumbPaths.count()       << "thumbnails,"
+                                 << d->fingerprintPaths.count() << "finger-prints,"
+                                 << d->qualityPaths.count()     << "image quality";
+
+    setTotalItems(d->allPicturesPath.count());
+
+    d->thread->processInSinglePass(d->allPicturesPath, d->thumbPaths, d->fingerprintPaths,
+                                   d->qualityPaths, d->settings.quality);
+    d->thread->start();
+}
+
+void SinglePassProcessor::slotAdvance(const QImage& img)
+{
+    setThumbnail(QIcon(QPixmap::fromImage(img)));
+    advance(1);
+}
+
+void SinglePassProcessor::slotDone()
+{
+    if (d->fingerPrints)
+    {
+        // Switch on scanned for finger-prints flag on digiKam config file.
+        KSharedConfig::openConfig()->group(QLatin1String("General Settings")).writeEntry(QLatin1String("Finger Prints Generator First Run"), true);
+    }
+
+    MaintenanceTool::slotDone();
+}
+
+} // namespace Digikam
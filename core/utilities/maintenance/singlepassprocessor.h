@@ -0,0 +1,74 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-20
+ * Description : maintenance tool to generate thumbnails, finger-prints
+ *               and sort by image quality with one decoding of each item.
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_SINGLE_PASS_PROCESSOR_H
+#define DIGIKAM_SINGLE_PASS_PROCESSOR_H
+
+// Local includes
+
+#include "album.h"
+#include "maintenancetool.h"
+
+class QImage;
+
+namespace Digikam
+{
+
+class MaintenanceSettings;
+
+class SinglePassProcessor : public MaintenanceTool
+{
+    Q_OBJECT
+
+public:
+
+    /** Run the operations enabled in settings among thumbnails, finger-prints and image quality sorter,
+     *  selecting the items of each operation as ThumbsGenerator, FingerPrintsGenerator and ImageQualitySorter do.
+     *  If settings albums and tags lists are empty, whole Albums collection is processed.
+     */
+    explicit SinglePassProcessor(const MaintenanceSettings& settings, ProgressItem* const parent = 0);
+    ~SinglePassProcessor();
+
+    void setUseMultiCoreCPU(bool b);
+
+    /** Return the number of operations enabled in settings which can be done by this tool.
+     */
+    static int operationsCount(const MaintenanceSettings& settings);
+
+private Q_SLOTS:
+
+    void slotStart();
+    void slotDone();
+    void slotCancel();
+    void slotAdvance(const QImage&);
+
+private:
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace Digikam
+
+#endif // DIGIKAM_SINGLE_PASS_PROCESSOR_H
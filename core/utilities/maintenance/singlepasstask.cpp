@@ -0,0 +1,258 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-20
+ * Description : Thread actions task to compute thumbnails, fingerprints
+ *               and image quality with one decoding of each item.
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "singlepasstask.h"
+
+// Qt includes
+
+#include <QMutex>
+
+// Local includes
+
+#include "digikam_debug.h"
+#include "dimg.h"
+#include "haariface.h"
+#include "iccmanager.h"
+#include "iccsettings.h"
+#include "imageinfo.h"
+#include "imagequalitysettings.h"
+#include "imgqsort.h"
+#include "loadsavethread.h"
+#include "maintenancedata.h"
+#include "previewloadthread.h"
+#include "thumbnailloadthread.h"
+
+namespace Digikam
+{
+
+class Q_DECL_HIDDEN SinglePassTask::Private
+{
+public:
+
+    explicit Private()
+        : catcher(0),
+          imgqsort(0),
+          data(0)
+    {
+    }
+
+    QSet<QString>          thumbPaths;
+    QSet<QString>          fingerprintPaths;
+    QSet<QString>          qualityPaths;
+
+    ThumbnailImageCatcher* catcher;
+
+    ImageQualitySettings   quality;
+    ImgQSort*              imgqsort;
+    QMutex                 imgqsortMutex;
+
+    MaintenanceData*       data;
+};
+
+// -------------------------------------------------------
+
+SinglePassTask::SinglePassTask()
+    : ActionJob(),
+      d(new Private)
+{
+    ThumbnailLoadThread* const thread = new ThumbnailLoadThread;
+    thread->setPixmapRequested(false);
+    thread->setThumbnailSize(ThumbnailLoadThread::maximumThumbnailSize());
+    d->catcher                        = new ThumbnailImageCatcher(thread, this);
+}
+
+SinglePassTask::~SinglePassTask()
+{
+    slotCancel();
+    cancel();
+
+    d->catcher->setActive(false);
+    d->catcher->thread()->stopAllTasks();
+
+    delete d->catcher->thread();
+    delete d->catcher;
+    delete d;
+}
+
+void SinglePassTask::setThumbnailPaths(const QSet<QString>& paths)
+{
+    d->thumbPaths = paths;
+}
+
+void SinglePassTask::setFingerprintPaths(const QSet<QString>& paths)
+{
+    d->fingerprintPaths = paths;
+}
+
+void SinglePassTask::setQualityPaths(const QSet<QString>& paths)
+{
+    d->qualityPaths = paths;
+}
+
+void SinglePassTask::setQuality(const ImageQualitySettings& quality)
+{
+    d->quality = quality;
+}
+
+void SinglePassTask::setMaintenanceData(MaintenanceData* const data)
+{
+    d->data = data;
+}
+
+void SinglePassTask::slotCancel()
+{
+    QMutexLocker lock(&d->imgqsortMutex);
+
+    if (d->imgqsort)
+    {
+        d->imgqsort->cancelAnalyse();
+    }
+}
+
+void SinglePassTask::run()
+{
+    ThumbnailLoadThread* const thread = d->catcher->thread();
+    const int thumbSize               = thread->storedSize();
+
+    // While we have data (using this as check for non-null)
+    while (d->data)
+    {
+        if (m_cancel)
+        {
+            d->catcher->setActive(false);
+            thread->stopAllTasks();
+            return;
+        }
+
+        QString path = d->data->getImagePath();
+
+        if (path.isEmpty())
+        {
+            break;
+        }
+
+        const bool doThumb       = d->thumbPaths.contains(path);
+        const bool doFingerprint = d->fingerprintPaths.contains(path);
+        const bool doQuality     = d->qualityPaths.contains(path);
+
+        // Decode the item once, at the largest size needed by the operations to do.
+        // The quality analysis works on a 1024 pixels preview, as in ImageQualityTask.
+
+        int size = 0;
+
+        if (doThumb)
+        {
+            size = qMax(size, thumbSize);
+        }
+
+        if (doFingerprint)
+        {
+            size = qMax(size, HaarIface::preferredSize());
+        }
+
+        if (doQuality)
+        {
+            size = qMax(size, 1024);
+        }
+
+        DImg dimg;
+
+        if (size)
+        {
+            dimg = PreviewLoadThread::loadFastSynchronously(path, size);
+        }
+
+        if (doThumb)
+        {
+            thread->deleteThumbnail(path);
+
+            if (!dimg.isNull())
+            {
+                // The orientation is applied when the thumbnail is loaded: store it unrotated.
+
+                DImg thumb = dimg.smoothScale(thumbSize, thumbSize, Qt::KeepAspectRatio);
+
+                if (LoadSaveThread::wasExifRotated(thumb))
+                {
+                    LoadSaveThread::reverseExifRotate(thumb, path);
+                }
+
+                QImage qimage = thumb.copyQImage();
+
+                if (IccSettings::instance()->useManagedPreviews() && !dimg.getIccProfile().isNull())
+                {
+                    IccManager::transformToSRGB(qimage, dimg.getIccProfile());
+                }
+
+                thread->storeThumbnail(path, qimage);
+            }
+            else
+            {
+                // Not an image, for ex. a video: use the thumbnail loader.
+
+                d->catcher->setActive(true);
+                thread->find(ThumbnailIdentifier(path));
+                d->catcher->enqueue();
+                d->catcher->waitForThumbnails();
+                d->catcher->setActive(false);
+            }
+        }
+
+        if (!dimg.isNull() && doFingerprint && !m_cancel)
+        {
+            qCDebug(DIGIKAM_GENERAL_LOG) << "Updating fingerprints for file: " << path ;
+
+            // compute Haar fingerprint and store it to DB
+            HaarIface haarIface;
+            haarIface.indexImage(path, dimg);
+        }
+
+        if (!dimg.isNull() && doQuality && !m_cancel)
+        {
+            PickLabel pick;
+
+            {
+                QMutexLocker lock(&d->imgqsortMutex);
+                d->imgqsort = new ImgQSort(dimg, d->quality, &pick);
+            }
+
+            d->imgqsort->startAnalyse();
+
+            ImageInfo info = ImageInfo::fromLocalFile(path);
+            info.setPickLabel(pick);
+
+            QMutexLocker lock(&d->imgqsortMutex);
+            delete d->imgqsort; //delete image data after setting label
+            d->imgqsort = 0;
+        }
+
+        // Dispatch progress to Progress Manager
+        QImage qimg = dimg.smoothScale(22, 22, Qt::KeepAspectRatio).copyQImage();
+        emit signalFinished(qimg);
+    }
+
+    emit signalDone();
+}
+
+} // namespace Digikam
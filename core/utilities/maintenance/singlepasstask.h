@@ -0,0 +1,83 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2018-06-20
+ * Description : Thread actions task to compute thumbnails, fingerprints
+ *               and image quality with one decoding of each item.
+ *
+ * Copyright (C) 2018 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_SINGLE_PASS_TASK_H
+#define DIGIKAM_SINGLE_PASS_TASK_H
+
+// Qt includes
+
+#include <QImage>
+#include <QSet>
+#include <QString>
+
+// Local includes
+
+#include "actionthreadbase.h"
+
+namespace Digikam
+{
+
+class ImageQualitySettings;
+class MaintenanceData;
+
+class SinglePassTask : public ActionJob
+{
+    Q_OBJECT
+
+public:
+
+    explicit SinglePassTask();
+    ~SinglePassTask();
+
+    /** The items to process are taken from the maintenance data. For each item,
+     *  the sets below tell which operations must be done.
+     */
+    void setThumbnailPaths(const QSet<QString>& paths);
+    void setFingerprintPaths(const QSet<QString>& paths);
+    void setQualityPaths(const QSet<QString>& paths);
+
+    void setQuality(const ImageQualitySettings& quality);
+    void setMaintenanceData(MaintenanceData* const data=0);
+
+Q_SIGNALS:
+
+    void signalFinished(const QImage&);
+
+public Q_SLOTS:
+
+    void slotCancel();
+
+protected:
+
+    void run();
+
+private:
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace Digikam
+
+#endif // DIGIKAM_SINGLE_PASS_TASK_H
@@ -31,6 +31,7 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QPixmap>
+#include <QSet>
 
 // KDE includes
 
@@ -44,8 +45,7 @@
 #include "applicationsettings.h"
 #include "coredbaccess.h"
 #include "imageinfo.h"
-#include "thumbsdbaccess.h"
-#include "thumbsdb.h"
+#include "thumbnailloadthread.h"
 #include "maintenancethread.h"
 #include "digikam_config.h"
 
@@ -147,8 +147,8 @@ void ThumbsGenerator::slotStart()
 
     if (!d->rebuildAll)
     {
-        QHash<QString, int> filePaths = ThumbsDbAccess().db()->getFilePathsWithThumbnail();
-        QStringList::iterator it      = d->allPicturesPath.begin();
+        QSet<QString> filePaths  = ThumbnailLoadThread::filePathsWithThumbnail();
+        QStringList::iterator it = d->allPicturesPath.begin();
 
         while (it != d->allPicturesPath.end())
         {
@@ -347,7 +347,7 @@ bool BatchTool::isLastChainedTool() const
     return d->last;
 }
 
-void BatchTool::setOutputUrlFromInputUrl()
+void BatchTool::setOutputUrlFromInputUrl(bool reserveFile)
 {
     QString randomString(QUuid::createUuid().toString());
     QString path(workingUrl().toLocalFile());
@@ -359,6 +359,13 @@ void BatchTool::setOutputUrlFromInputUrl()
         suffix = fi.suffix();
     }
 
+    if (!reserveFile)
+    {
+        setOutputUrl(QUrl::fromLocalFile(path + QLatin1String("/BatchTool-") + randomString.mid(1, 36) +
+                                         QLatin1String(".digikamtempfile.") + suffix));
+        return;
+    }
+
     SafeTemporaryFile temp(path + QLatin1String("/BatchTool-XXXXXX-") + randomString.mid(1, 8) +
                            QLatin1String(".digikamtempfile.") + suffix);
 
@@ -498,6 +505,21 @@ bool BatchTool::apply()
     return toolOperations();
 }
 
+bool BatchTool::isPointOperation() const
+{
+    return false;
+}
+
+bool BatchTool::preparePointFilter(const DImg&)
+{
+    return true;
+}
+
+DImgThreadedFilter* BatchTool::createPointFilter(DImg* const) const
+{
+    return 0;
+}
+
 void BatchTool::applyFilter(DImgThreadedFilter* const filter)
 {
     filter->startFilterDirectly();
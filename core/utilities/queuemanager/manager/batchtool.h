@@ -136,8 +136,9 @@ public:
     /** Set output url using input url content + annotation based on time stamp + file
         extension defined by outputSuffix().
         if outputSuffix() return null, file extension is the same than original.
+        If reserveFile is false, the file is not created, for a tool which keeps the image in memory.
      */
-    void setOutputUrlFromInputUrl();
+    void setOutputUrlFromInputUrl(bool reserveFile = true);
 
     /** Load image data using input Url set by setInputUrl() to instance of internal
         DImg container.
@@ -203,6 +204,25 @@ public:
      */
     virtual int toolVersion() const { return 1; };
 
+    /** Re-implement this method to return true if the tool is a point operation, where each output pixel only
+        depends on the input pixel at the same position. The queue can then apply such tools one after the other
+        in one pass over the image, band by band, using preparePointFilter() and createPointFilter().
+     */
+    virtual bool isPointOperation() const;
+
+    /** Re-implement this method to prepare the point operation with the current settings before a fused pass.
+        image is the input image of the tool if the tool is the first of the pass, else it is null.
+        Return false if the tool needs its input image to compute the operation and image is null.
+        The default implementation returns true.
+     */
+    virtual bool preparePointFilter(const DImg& image);
+
+    /** Re-implement this method to return a new filter applying the point operation to band, a part of the image.
+        The caller takes ownership of the filter. This method can be called from several threads at the same time.
+        The default implementation returns 0.
+     */
+    virtual DImgThreadedFilter* createPointFilter(DImg* const band) const;
+
     /** Re-implement this method is you want customize cancellation of tool, for ex. to call
         a dedicated method to kill sub-threads parented to this tool instance.
         Unforget to call parent BatchTool::cancel() method in your customized implementation.
@@ -60,6 +60,7 @@ public:
     QueueSettings()
     {
         useMultiCoreCPU    = false;
+        fuseTools          = false;
         exifSetOrientation = true;
         useOrgAlbum        = true;
         conflictRule       = FileSaveConflictBox::DIFFNAME;
@@ -71,6 +72,9 @@ public:
 
     bool                              useMultiCoreCPU;
 
+    /// If true, consecutive point operation tools are applied in memory, band after band.
+    bool                              fuseTools;
+
     /// Setting managed through Metadata control panel.
     bool                              exifSetOrientation;
 
@@ -27,6 +27,8 @@
 // Qt includes
 
 #include <QFileInfo>
+#include <QScopedPointer>
+#include <QtConcurrent>    // krazy:exclude=includes
 
 // KDE includes
 
@@ -42,6 +44,7 @@
 #include "batchtool.h"
 #include "batchtoolsfactory.h"
 #include "dfileoperations.h"
+#include "dimgthreadedfilter.h"
 
 namespace Digikam
 {
@@ -60,6 +63,9 @@ public:
 
     BatchTool*         tool;
 
+    /// Point operation tools waiting to be applied in memory in one pass.
+    QList<BatchTool*>  pointTools;
+
     QueueSettings      settings;
     AssignedBatchTools tools;
 };
@@ -75,6 +81,7 @@ Task::Task()
 Task::~Task()
 {
     slotCancel();
+    qDeleteAll(d->pointTools);
     delete d;
 }
 
@@ -110,6 +117,84 @@ void Task::removeTempFiles(const QList<QUrl>& tmpList)
     }
 }
 
+/** Return the number of rows of a band of image, small enough to stay in the CPU cache
+ *  while all point operation tools are applied to it.
+ */
+static int pointBandHeight(const DImg& image)
+{
+    return qMax(1, (2 * 1024 * 1024) / qMax(1, (int)(image.width() * image.bytesDepth())));
+}
+
+/** Apply all point operation tools one after the other to the bands of rows in [start, stop) of image.
+ */
+static void applyPointToolsOnBands(const QList<BatchTool*>& tools, DImg* const image,
+                                   int start, int stop, const bool* const cancel)
+{
+    const int bandHeight = pointBandHeight(*image);
+
+    for (int y = start ; !(*cancel) && (y < stop) ; y += bandHeight)
+    {
+        DImg band = image->copy(0, y, image->width(), qMin(bandHeight, stop - y));
+
+        foreach (BatchTool* const tool, tools)
+        {
+            QScopedPointer<DImgThreadedFilter> filter(tool->createPointFilter(&band));
+            filter->startFilterDirectly();
+            band = filter->getTargetImage();
+        }
+
+        image->bitBltImage(&band, 0, y);
+    }
+}
+
+bool Task::applyPointTools(DImg& image)
+{
+    const int height     = image.height();
+    const int bandHeight = pointBandHeight(image);
+    const int bands      = (height + bandHeight - 1) / bandHeight;
+    const int chunkSize  = qMax(1, bands / QThreadPool::globalInstance()->maxThreadCount()) * bandHeight;
+
+    QList <QFuture<void> > tasks;
+
+    for (int start = 0 ; start < height ; start += chunkSize)
+    {
+        tasks.append(QtConcurrent::run(applyPointToolsOnBands,
+                                       d->pointTools,
+                                       &image,
+                                       start,
+                                       qMin(start + chunkSize, height),
+                                       &d->cancel
+                                      ));
+    }
+
+    foreach(QFuture<void> t, tasks)
+        t.waitForFinished();
+
+    if (d->cancel)
+    {
+        return false;
+    }
+
+    // Record the history of each tool, as if it was applied alone.
+
+    DImg probe(1, 1, image.sixteenBit(), image.hasAlpha());
+
+    foreach (BatchTool* const tool, d->pointTools)
+    {
+        QScopedPointer<DImgThreadedFilter> filter(tool->createPointFilter(&probe));
+        image.addFilterAction(filter->filterAction());
+    }
+
+    // The last tool of the pass saves the result to its output url if needed.
+
+    BatchTool* const last = d->pointTools.last();
+    last->setImageData(image);
+    bool success          = last->savefromDImg();
+    image                 = last->imageData();
+
+    return success;
+}
+
 void Task::emitActionData(ActionData::ActionStatus st, const QString& mess, const QUrl& dest)
 {
     ActionData ad;
@@ -182,20 +267,84 @@ void Task::run()
             d->tool->setLastChainedTool(false);
         }
 
-        d->tool->setOutputUrlFromInputUrl();
+        // In fused mode, the image stays in memory until the last chained tool:
+        // intermediate tools do not need to reserve a file.
+
+        d->tool->setOutputUrlFromInputUrl(!d->settings.fuseTools || d->tool->isLastChainedTool());
         d->tool->setBranchHistory(true);
 
         outUrl   = d->tool->outputUrl();
-        success  = d->tool->apply();
-        tmpImage = d->tool->imageData();
-        errMsg   = d->tool->errorDescription();
         tmp2del.append(outUrl);
 
+        if (d->settings.fuseTools && d->tool->isPointOperation())
+        {
+            // A point operation tool joins the current pass, or starts a new one
+            // if it needs its input image to be computed first.
+
+            if (!d->pointTools.isEmpty() && !d->tool->preparePointFilter(DImg()))
+            {
+                success = applyPointTools(tmpImage);
+                qDeleteAll(d->pointTools);
+                d->pointTools.clear();
+                d->tool->setImageData(tmpImage);
+            }
+            else
+            {
+                success = true;
+            }
+
+            if (success && d->pointTools.isEmpty())
+            {
+                success  = d->tool->loadToDImg();
+                tmpImage = d->tool->imageData();
+                d->tool->preparePointFilter(tmpImage);
+            }
+
+            if (success)
+            {
+                d->pointTools << d->tool;
+                d->tool = 0;
+
+                if (d->pointTools.last()->isLastChainedTool())
+                {
+                    success = applyPointTools(tmpImage);
+                    qDeleteAll(d->pointTools);
+                    d->pointTools.clear();
+                }
+            }
+
+            errMsg = success ? QString() : i18n("Failed to process image in memory...");
+        }
+        else
+        {
+            if (!d->pointTools.isEmpty())
+            {
+                success = applyPointTools(tmpImage);
+                qDeleteAll(d->pointTools);
+                d->pointTools.clear();
+                d->tool->setImageData(tmpImage);
+                errMsg  = success ? QString() : i18n("Failed to process image in memory...");
+            }
+            else
+            {
+                success = true;
+            }
+
+            if (success)
+            {
+                success  = d->tool->apply();
+                tmpImage = d->tool->imageData();
+                errMsg   = d->tool->errorDescription();
+            }
+        }
+
         delete d->tool;
         d->tool = 0;
 
         if (d->cancel)
         {
+            qDeleteAll(d->pointTools);
+            d->pointTools.clear();
             emitActionData(ActionData::BatchCanceled);
             removeTempFiles(tmp2del);
             emit signalDone();
@@ -203,6 +352,8 @@ void Task::run()
         }
         else if (!success)
         {
+            qDeleteAll(d->pointTools);
+            d->pointTools.clear();
             emitActionData(ActionData::BatchFailed, errMsg);
             break;
         }
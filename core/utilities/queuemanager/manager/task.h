@@ -39,6 +39,8 @@
 namespace Digikam
 {
 
+class DImg;
+
 class Task : public ActionJob
 {
     Q_OBJECT
@@ -67,6 +69,11 @@ protected:
 private:
 
     void removeTempFiles(const QList<QUrl>& tmpList);
+
+    /** Apply the pending point operation tools to image in memory, in one pass over bands of rows,
+     *  and save the result if the last tool of the pass is the last chained tool.
+     */
+    bool applyPointTools(DImg& image);
     void emitActionData(ActionData::ActionStatus st,
                         const QString& mess=QString(),
                         const QUrl& dest=QUrl());
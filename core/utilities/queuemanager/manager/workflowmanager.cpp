@@ -229,6 +229,10 @@ bool WorkflowManager::save()
             data.setAttribute(QLatin1String("value"), q.qSettings.useMultiCoreCPU);
             elm.appendChild(data);
 
+            data = doc.createElement(QLatin1String("fusetools"));
+            data.setAttribute(QLatin1String("value"), q.qSettings.fuseTools);
+            elm.appendChild(data);
+
             data = doc.createElement(QLatin1String("workingurl"));
             data.setAttribute(QLatin1String("value"), q.qSettings.workingUrl.toLocalFile());
             elm.appendChild(data);
@@ -417,6 +421,10 @@ bool WorkflowManager::load(QStringList& failed)
                 {
                     q.qSettings.useMultiCoreCPU = (bool)val2.toUInt(&ok);
                 }
+                else if (name2 == QLatin1String("fusetools"))
+                {
+                    q.qSettings.fuseTools = (bool)val2.toUInt(&ok);
+                }
                 else if (name2 == QLatin1String("workingurl"))
                 {
                     q.qSettings.workingUrl = QUrl::fromLocalFile(val2);
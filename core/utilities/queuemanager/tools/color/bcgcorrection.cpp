@@ -97,6 +97,21 @@ void BCGCorrection::slotSettingsChanged()
     BatchTool::slotSettingsChanged(prm);
 }
 
+static BCGContainer containerFromSettings(const BatchToolSettings& settings)
+{
+    BCGContainer prm;
+    prm.brightness = settings[QLatin1String("Brightness")].toDouble();
+    prm.contrast   = settings[QLatin1String("Contrast")].toDouble();
+    prm.gamma      = settings[QLatin1String("Gamma")].toDouble();
+
+    return prm;
+}
+
+DImgThreadedFilter* BCGCorrection::createPointFilter(DImg* const band) const
+{
+    return new BCGFilter(band, 0L, containerFromSettings(settings()));
+}
+
 bool BCGCorrection::toolOperations()
 {
     if (!loadToDImg())
@@ -104,12 +119,7 @@ bool BCGCorrection::toolOperations()
         return false;
     }
 
-    BCGContainer prm;
-    prm.brightness = settings()[QLatin1String("Brightness")].toDouble();
-    prm.contrast   = settings()[QLatin1String("Contrast")].toDouble();
-    prm.gamma      = settings()[QLatin1String("Gamma")].toDouble();
-
-    BCGFilter bcg(&image(), 0L, prm);
+    BCGFilter bcg(&image(), 0L, containerFromSettings(settings()));
     applyFilter(&bcg);
 
     return (savefromDImg());
@@ -48,6 +48,9 @@ public:
 
     void registerSettingsWidget();
 
+    bool                isPointOperation() const { return true; };
+    DImgThreadedFilter* createPointFilter(DImg* const band) const;
+
 private:
 
     bool toolOperations();
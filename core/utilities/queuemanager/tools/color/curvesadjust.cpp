@@ -167,6 +167,25 @@ void CurvesAdjust::slotSettingsLoad()
     slotSettingsChanged();
 }
 
+static CurvesContainer containerFromSettings(const BatchToolSettings& settings)
+{
+    CurvesContainer prm((ImageCurves::CurveType)settings[QLatin1String("curvesType")].toInt(),
+                        settings[QLatin1String("curvesDepth")].toBool());
+    prm.initialize();
+    prm.values[LuminosityChannel] = settings[QLatin1String("values[LuminosityChannel]")].value<QPolygon>();
+    prm.values[RedChannel]        = settings[QLatin1String("values[RedChannel]")].value<QPolygon>();
+    prm.values[GreenChannel]      = settings[QLatin1String("values[GreenChannel]")].value<QPolygon>();
+    prm.values[BlueChannel]       = settings[QLatin1String("values[BlueChannel]")].value<QPolygon>();
+    prm.values[AlphaChannel]      = settings[QLatin1String("values[AlphaChannel]")].value<QPolygon>();
+
+    return prm;
+}
+
+DImgThreadedFilter* CurvesAdjust::createPointFilter(DImg* const band) const
+{
+    return new CurvesFilter(band, 0L, containerFromSettings(settings()));
+}
+
 bool CurvesAdjust::toolOperations()
 {
     if (!loadToDImg())
@@ -174,16 +193,7 @@ bool CurvesAdjust::toolOperations()
         return false;
     }
 
-    CurvesContainer prm((ImageCurves::CurveType)settings()[QLatin1String("curvesType")].toInt(),
-                        settings()[QLatin1String("curvesDepth")].toBool());
-    prm.initialize();
-    prm.values[LuminosityChannel] = settings()[QLatin1String("values[LuminosityChannel]")].value<QPolygon>();
-    prm.values[RedChannel]        = settings()[QLatin1String("values[RedChannel]")].value<QPolygon>();
-    prm.values[GreenChannel]      = settings()[QLatin1String("values[GreenChannel]")].value<QPolygon>();
-    prm.values[BlueChannel]       = settings()[QLatin1String("values[BlueChannel]")].value<QPolygon>();
-    prm.values[AlphaChannel]      = settings()[QLatin1String("values[AlphaChannel]")].value<QPolygon>();
-
-    CurvesFilter curves(&image(), 0L, prm);
+    CurvesFilter curves(&image(), 0L, containerFromSettings(settings()));
     applyFilter(&curves);
 
     return (savefromDImg());
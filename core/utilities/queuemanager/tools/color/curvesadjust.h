@@ -50,6 +50,9 @@ public:
 
     void registerSettingsWidget();
 
+    bool                isPointOperation() const { return true; };
+    DImgThreadedFilter* createPointFilter(DImg* const band) const;
+
 public Q_SLOTS:
 
     void slotResetSettingsToDefault();
@@ -100,6 +100,22 @@ void HSLCorrection::slotSettingsChanged()
     BatchTool::slotSettingsChanged(prm);
 }
 
+static HSLContainer containerFromSettings(const BatchToolSettings& settings)
+{
+    HSLContainer prm;
+    prm.hue        = settings[QLatin1String("Hue")].toDouble();
+    prm.saturation = settings[QLatin1String("Saturation")].toDouble();
+    prm.lightness  = settings[QLatin1String("Lightness")].toDouble();
+    prm.vibrance   = settings[QLatin1String("Vibrance")].toDouble();
+
+    return prm;
+}
+
+DImgThreadedFilter* HSLCorrection::createPointFilter(DImg* const band) const
+{
+    return new HSLFilter(band, 0L, containerFromSettings(settings()));
+}
+
 bool HSLCorrection::toolOperations()
 {
     if (!loadToDImg())
@@ -107,13 +123,7 @@ bool HSLCorrection::toolOperations()
         return false;
     }
 
-    HSLContainer prm;
-    prm.hue        = settings()[QLatin1String("Hue")].toDouble();
-    prm.saturation = settings()[QLatin1String("Saturation")].toDouble();
-    prm.lightness  = settings()[QLatin1String("Lightness")].toDouble();
-    prm.vibrance   = settings()[QLatin1String("Vibrance")].toDouble();
-
-    HSLFilter hsl(&image(), 0L, prm);
+    HSLFilter hsl(&image(), 0L, containerFromSettings(settings()));
     applyFilter(&hsl);
 
     return (savefromDImg());
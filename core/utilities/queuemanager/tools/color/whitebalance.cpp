@@ -44,6 +44,9 @@ WhiteBalance::WhiteBalance(QObject* const parent)
     : BatchTool(QLatin1String("WhiteBalance"), ColorTool, parent)
 {
     m_settingsView = 0;
+    m_maxr         = -1;
+    m_maxg         = -1;
+    m_maxb         = -1;
 
     setToolTitle(i18n("White Balance"));
     setToolDescription(i18n("Adjust White Balance."));
@@ -116,25 +119,52 @@ void WhiteBalance::slotSettingsChanged()
     BatchTool::slotSettingsChanged(prm);
 }
 
-bool WhiteBalance::toolOperations()
+static WBContainer containerFromSettings(const BatchToolSettings& settings)
 {
-    if (!loadToDImg())
+    WBContainer prm;
+
+    prm.black          = settings[QLatin1String("black")].toDouble();
+    prm.temperature    = settings[QLatin1String("temperature")].toDouble();
+    prm.green          = settings[QLatin1String("green")].toDouble();
+    prm.dark           = settings[QLatin1String("dark")].toDouble();
+    prm.gamma          = settings[QLatin1String("gamma")].toDouble();
+    prm.saturation     = settings[QLatin1String("saturation")].toDouble();
+    prm.expositionMain = settings[QLatin1String("expositionMain")].toDouble();
+    prm.expositionFine = settings[QLatin1String("expositionFine")].toDouble();
+
+    return prm;
+}
+
+bool WhiteBalance::preparePointFilter(const DImg& image)
+{
+    if (image.isNull())
     {
         return false;
     }
 
-    WBContainer prm;
+    WBFilter::findChanelsMax(&image, m_maxr, m_maxg, m_maxb);
 
-    prm.black          = settings()[QLatin1String("black")].toDouble();
-    prm.temperature    = settings()[QLatin1String("temperature")].toDouble();
-    prm.green          = settings()[QLatin1String("green")].toDouble();
-    prm.dark           = settings()[QLatin1String("dark")].toDouble();
-    prm.gamma          = settings()[QLatin1String("gamma")].toDouble();
-    prm.saturation     = settings()[QLatin1String("saturation")].toDouble();
-    prm.expositionMain = settings()[QLatin1String("expositionMain")].toDouble();
-    prm.expositionFine = settings()[QLatin1String("expositionFine")].toDouble();
+    return true;
+}
+
+DImgThreadedFilter* WhiteBalance::createPointFilter(DImg* const band) const
+{
+    WBContainer prm = containerFromSettings(settings());
+    prm.maxr        = m_maxr;
+    prm.maxg        = m_maxg;
+    prm.maxb        = m_maxb;
+
+    return new WBFilter(band, 0L, prm);
+}
+
+bool WhiteBalance::toolOperations()
+{
+    if (!loadToDImg())
+    {
+        return false;
+    }
 
-    WBFilter wb(&image(), 0L, prm);
+    WBFilter wb(&image(), 0L, containerFromSettings(settings()));
     applyFilter(&wb);
 
     return (savefromDImg());
@@ -48,6 +48,13 @@ public:
 
     void registerSettingsWidget();
 
+    /** White balance needs the channel maxima of the whole image: it can only be the first
+     *  tool of a pass processed in memory.
+     */
+    bool                isPointOperation() const { return true; };
+    bool                preparePointFilter(const DImg& image);
+    DImgThreadedFilter* createPointFilter(DImg* const band) const;
+
 private:
 
     bool toolOperations();
@@ -60,6 +67,10 @@ private Q_SLOTS:
 private:
 
     WBSettings* m_settingsView;
+
+    int         m_maxr;
+    int         m_maxg;
+    int         m_maxb;
 };
 
 } // namespace Digikam
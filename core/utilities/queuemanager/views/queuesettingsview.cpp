@@ -90,6 +90,7 @@ public:
         demosaicingButton(0),
         useOrgAlbum(0),
         useMutiCoreCPU(0),
+        fuseTools(0),
         conflictBox(0),
         albumSel(0),
         advancedRenameManager(0),
@@ -117,6 +118,7 @@ public:
 
     QCheckBox*             useOrgAlbum;
     QCheckBox*             useMutiCoreCPU;
+    QCheckBox*             fuseTools;
 
     FileSaveConflictBox*   conflictBox;
     AlbumSelectWidget*     albumSel;
@@ -219,12 +221,18 @@ QueueSettingsView::QueueSettingsView(QWidget* const parent)
     d->useMutiCoreCPU = new QCheckBox(i18nc("@option:check", "Work on all processor cores"), panel);
     d->useMutiCoreCPU->setWhatsThis(i18n("Turn on this option to use all CPU core from your computer "
                                          "to process more than one item from a queue at the same time."));
+
+    d->fuseTools      = new QCheckBox(i18nc("@option:check", "Apply color tools in memory in one pass"), panel);
+    d->fuseTools->setWhatsThis(i18n("Turn on this option to apply consecutive color tools from a queue "
+                                    "to the image in memory, band after band, without saving "
+                                    "temporary files between tools."));
     // -------------
 
     layout->addWidget(d->rawLoadingLabel);
     layout->addWidget(rawLoadingBox);
     layout->addWidget(d->conflictBox);
     layout->addWidget(d->useMutiCoreCPU);
+    layout->addWidget(d->fuseTools);
     layout->setContentsMargins(spacing, spacing, spacing, spacing);
     layout->setSpacing(spacing);
     layout->addStretch();
@@ -299,6 +307,9 @@ QueueSettingsView::QueueSettingsView(QWidget* const parent)
     connect(d->useMutiCoreCPU, SIGNAL(toggled(bool)),
             this, SLOT(slotSettingsChanged()));
 
+    connect(d->fuseTools, SIGNAL(toggled(bool)),
+            this, SLOT(slotSettingsChanged()));
+
     connect(d->albumSel, SIGNAL(itemSelectionChanged()),
             this, SLOT(slotSettingsChanged()));
 
@@ -377,6 +388,7 @@ void QueueSettingsView::slotResetSettings()
     blockSignals(true);
     d->useOrgAlbum->setChecked(true);
     d->useMutiCoreCPU->setChecked(false);
+    d->fuseTools->setChecked(false);
     // TODO: reset d->albumSel
     d->renamingButtonGroup->button(QueueSettings::USEORIGINAL)->setChecked(true);
     d->conflictBox->setConflictRule(FileSaveConflictBox::DIFFNAME);
@@ -401,6 +413,7 @@ void QueueSettingsView::slotQueueSelected(int, const QueueSettings& settings, co
 {
     d->useOrgAlbum->setChecked(settings.useOrgAlbum);
     d->useMutiCoreCPU->setChecked(settings.useMultiCoreCPU);
+    d->fuseTools->setChecked(settings.fuseTools);
     d->albumSel->setEnabled(!settings.useOrgAlbum);
     d->albumSel->setCurrentAlbumUrl(settings.workingUrl);
 
@@ -435,6 +448,7 @@ void QueueSettingsView::slotSettingsChanged()
     d->albumSel->setEnabled(!d->useOrgAlbum->isChecked());
     settings.useOrgAlbum         = d->useOrgAlbum->isChecked();
     settings.useMultiCoreCPU     = d->useMutiCoreCPU->isChecked();
+    settings.fuseTools           = d->fuseTools->isChecked();
     settings.workingUrl          = d->albumSel->currentAlbumUrl();
 
     settings.renamingRule        = (QueueSettings::RenamingRule)d->renamingButtonGroup->checkedId();